@@ -0,0 +1,788 @@
+#include "generators.h"
+#include "counters.h"
+#include "dcel_validation.h"
+#include "segment_intersections.h"
+#include "overlay.h"
+#include "boolean_operations.h"
+#include "voronoi.h"
+#include "point_in_face.h"
+#include "range_index.h"
+#include "convex_hull.h"
+#include "quick_hull.h"
+#include "apply_hull.h"
+#include "triangulation.h"
+#include "trapezoidal_decomposition.h"
+#include "nearest_point.h"
+#include "nearest_line.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+
+
+#if IS_COUNTING
+// operator new of the counters counts the allocations of the process
+size_t get_allocations_count() noexcept
+{
+    return static_cast<size_t>(frm::get_allocations_count());
+}
+
+size_t get_allocated_bytes() noexcept
+{
+    return static_cast<size_t>(frm::get_allocated_bytes());
+}
+#else
+// every allocation of the process, the benchmarks take the difference around the timed code
+static std::atomic<size_t> allocations_count{ 0 };
+static std::atomic<size_t> allocated_bytes{ 0 };
+
+void * operator new(size_t size)
+{
+    ++allocations_count;
+    allocated_bytes += size;
+
+    if (void * const pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+size_t get_allocations_count() noexcept
+{
+    return allocations_count;
+}
+
+size_t get_allocated_bytes() noexcept
+{
+    return allocated_bytes;
+}
+#endif
+
+size_t get_peak_rss() noexcept
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // kilobytes on linux
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+std::vector<frm::Point> generate_queries(frm::dcel::DCEL const & dcel, size_t size, uint32_t seed) noexcept
+{
+    frm::Point min = dcel.vertices[0].coordinate;
+    frm::Point max = min;
+
+    for (frm::dcel::DCEL::Vertex const & vertex : dcel.vertices)
+    {
+        min = { std::min(min.x, vertex.coordinate.x), std::min(min.y, vertex.coordinate.y) };
+        max = { std::max(max.x, vertex.coordinate.x), std::max(max.y, vertex.coordinate.y) };
+    }
+
+    std::mt19937 generator{ seed };
+    std::uniform_real_distribution<float> x{ min.x, max.x };
+    std::uniform_real_distribution<float> y{ min.y, max.y };
+
+    std::vector<frm::Point> queries(size);
+    for (frm::Point & query : queries)
+    {
+        query = { x(generator), y(generator) };
+    }
+
+    return queries;
+}
+
+struct Options
+{
+    size_t min_size{ 100 };
+    size_t max_size{ 1000000 };
+    // samples of the benchmarks that time whole runs
+    size_t repeats{ 5 };
+    uint32_t seed{ 42 };
+    // only benchmarks with the substring in their names
+    std::string filter{};
+    // stdout if empty
+    std::string output{};
+    // if set, the generated inputs are written there instead of running the benchmarks
+    std::string inputs_directory{};
+};
+
+// Measurements of a benchmark for one input size
+struct Result
+{
+    std::string name;
+    size_t size;
+    // elements processed by one sample: built ones or answered queries
+    size_t items{ 0 };
+    // us, one per timed call
+    std::vector<double> latencies{};
+    size_t allocations{ 0 };
+    size_t allocated_bytes{ 0 };
+    size_t peak_rss{ 0 };
+    // JSON object of the counters of all samples and the input generation, empty if counting is off
+    std::string counters{};
+};
+
+// times the call as one sample of the result
+template<typename F>
+void sample(Result & result, F && f) noexcept
+{
+    size_t const allocations_before = get_allocations_count();
+    size_t const allocated_bytes_before = get_allocated_bytes();
+
+    auto const begin = std::chrono::steady_clock::now();
+    f();
+    auto const end = std::chrono::steady_clock::now();
+
+    result.allocations += get_allocations_count() - allocations_before;
+    result.allocated_bytes += get_allocated_bytes() - allocated_bytes_before;
+    result.latencies.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+}
+
+struct Benchmark
+{
+    std::string name;
+    // the case is skipped for larger sizes, superlinear ones would take hours
+    size_t max_size;
+    std::function<void(Options const & options, size_t size, Result & result)> run;
+};
+
+frm::SubdivisionKind const subdivision_kinds[] = {
+    frm::SubdivisionKind::SimplePolygon,
+    frm::SubdivisionKind::PolygonWithHoles,
+    frm::SubdivisionKind::Grid,
+    frm::SubdivisionKind::CellMap,
+    frm::SubdivisionKind::NestedIslands };
+
+frm::PointDistribution const point_distributions[] = {
+    frm::PointDistribution::Uniform,
+    frm::PointDistribution::Clustered,
+    frm::PointDistribution::Circular,
+    frm::PointDistribution::Collinear };
+
+// queries answered by one sample each
+size_t const queries_count = 10000;
+// for the queries that scan the whole dcel
+size_t const slow_queries_count = 256;
+
+std::vector<Benchmark> create_benchmarks() noexcept
+{
+    std::vector<Benchmark> benchmarks{};
+
+    for (frm::SubdivisionKind const kind : subdivision_kinds)
+    {
+        std::string const kind_name = frm::get_subdivision_kind_name(kind);
+
+        benchmarks.push_back({ "trapezoid_map/build/" + kind_name, 1000000,
+            [kind](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const dcel = frm::generate_dcel(kind, size, options.seed);
+                result.items = dcel.vertices.size();
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    sample(result, [&dcel]() noexcept
+                    {
+                        frm::trapezoid_data_and_graph_root_t const trapezoid_data_and_graph_root = frm::generate_trapezoid_data_and_graph_root(dcel);
+                    });
+                }
+            } });
+
+        benchmarks.push_back({ "trapezoid_map/get_face_index/" + kind_name, 1000000,
+            [kind](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const dcel = frm::generate_dcel(kind, size, options.seed);
+                frm::trapezoid_data_and_graph_root_t const trapezoid_data_and_graph_root = frm::generate_trapezoid_data_and_graph_root(dcel);
+                std::vector<frm::Point> const queries = generate_queries(dcel, queries_count, options.seed);
+                result.items = 1;
+
+                size_t volatile face_index = 0;
+                for (frm::Point const query : queries)
+                {
+                    sample(result, [&]() noexcept
+                    {
+                        face_index = frm::get_face_index(trapezoid_data_and_graph_root, query);
+                    });
+                }
+            } });
+
+        benchmarks.push_back({ "range_index/build/" + kind_name, 1000000,
+            [kind](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const dcel = frm::generate_dcel(kind, size, options.seed);
+                result.items = dcel.vertices.size() + dcel.edges.size() / 2;
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    sample(result, [&dcel]() noexcept
+                    {
+                        frm::dcel::RangeIndex index{};
+                        frm::dcel::build_range_index(index, dcel);
+                    });
+                }
+            } });
+
+        // windows with about 64 vertices each
+        benchmarks.push_back({ "range_index/query/" + kind_name, 1000000,
+            [kind](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const dcel = frm::generate_dcel(kind, size, options.seed);
+                frm::dcel::RangeIndex index{};
+                frm::dcel::build_range_index(index, dcel);
+                std::vector<frm::Point> const queries = generate_queries(dcel, queries_count, options.seed);
+                result.items = 1;
+
+                frm::Box bounds{ frm::empty_box };
+                for (frm::dcel::DCEL::Vertex const & vertex : dcel.vertices)
+                {
+                    frm::extend_box(bounds, vertex.coordinate);
+                }
+
+                float const area = (bounds.max.x - bounds.min.x) * (bounds.max.y - bounds.min.y);
+                float const half_side = std::sqrt(area * 64.f / static_cast<float>(dcel.vertices.size())) / 2.f;
+
+                size_t volatile found_count = 0;
+                for (frm::Point const query : queries)
+                {
+                    frm::Box const window{ { query.x - half_side, query.y - half_side }, { query.x + half_side, query.y + half_side } };
+
+                    sample(result, [&]() noexcept
+                    {
+                        size_t count = 0;
+                        frm::dcel::query_vertices(index, dcel, window, [&count](size_t) noexcept { ++count; });
+                        frm::dcel::query_edges(index, dcel, window, [&count](size_t) noexcept { ++count; });
+                        found_count = count;
+                    });
+                }
+            } });
+    }
+
+    benchmarks.push_back({ "point_in_face/is_point_inside", 1000000,
+        [](Options const & options, size_t size, Result & result) noexcept
+        {
+            frm::dcel::DCEL const dcel = frm::generate_simple_polygon(size, options.seed);
+            frm::dcel::FacePolygon const polygon = frm::dcel::make_face_polygon(dcel, 1);
+            std::vector<frm::Point> const queries = generate_queries(dcel, slow_queries_count, options.seed);
+            result.items = 1;
+
+            bool volatile is_inside = false;
+            for (frm::Point const query : queries)
+            {
+                sample(result, [&]() noexcept
+                {
+                    is_inside = frm::dcel::is_point_inside(polygon, query);
+                });
+            }
+        } });
+
+    for (size_t const batch_size : { size_t{ 16 }, queries_count })
+    {
+        benchmarks.push_back({ "point_in_face/get_points_inside/" + std::to_string(batch_size), 1000000,
+            [batch_size](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const dcel = frm::generate_simple_polygon(size, options.seed);
+                std::vector<frm::Point> const queries = generate_queries(dcel, batch_size, options.seed);
+                result.items = batch_size;
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    sample(result, [&dcel, &queries]() noexcept
+                    {
+                        std::vector<uint8_t> const is_inside = frm::dcel::get_points_inside(dcel, 1, queries);
+                    });
+                }
+            } });
+    }
+
+    benchmarks.push_back({ "triangulation", 10000,
+        [](Options const & options, size_t size, Result & result) noexcept
+        {
+            frm::dcel::DCEL const polygon = frm::generate_simple_polygon(size, options.seed);
+            result.items = size;
+
+            for (size_t i = 0; i < options.repeats; ++i)
+            {
+                frm::dcel::DCEL dcel = polygon;
+
+                sample(result, [&dcel]() noexcept
+                {
+                    frm::triangulation(dcel);
+                });
+            }
+        } });
+
+    benchmarks.push_back({ "apply_hull", 10000,
+        [](Options const & options, size_t size, Result & result) noexcept
+        {
+            frm::dcel::DCEL const polygon = frm::generate_simple_polygon(size, options.seed);
+
+            std::vector<frm::Point> points(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                points[i] = polygon.vertices[i].coordinate;
+            }
+
+            std::vector<frm::vvve::VVVE::edge_t> const hull_edges = frm::convex_hull(points.data(), points.size(), frm::HullAlgorithm::MonotoneChain);
+            result.items = size;
+
+            for (size_t i = 0; i < options.repeats; ++i)
+            {
+                frm::dcel::DCEL dcel = polygon;
+
+                sample(result, [&dcel, &hull_edges]() noexcept
+                {
+                    frm::apply_hull(dcel, hull_edges);
+                });
+            }
+        } });
+
+    for (bool const is_parallel : { false, true })
+    {
+        benchmarks.push_back({ is_parallel ? "quick_hull_parallel" : "quick_hull", 1000000,
+            [is_parallel](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::vvve::VVVE vvve = frm::generate_vvve(frm::PointDistribution::Uniform, size, options.seed);
+                result.items = size;
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    vvve.edges.clear();
+
+                    sample(result, [&vvve, is_parallel]() noexcept
+                    {
+                        is_parallel ? frm::quick_hull_parallel(vvve) : frm::quick_hull(vvve);
+                    });
+                }
+            } });
+    }
+
+    for (frm::PointDistribution const distribution : point_distributions)
+    {
+        for (frm::HullAlgorithm const algorithm : {
+            frm::HullAlgorithm::MonotoneChain,
+            frm::HullAlgorithm::QuickHull,
+            frm::HullAlgorithm::Chan })
+        {
+            std::string const name = std::string{ "convex_hull/" } + frm::get_hull_algorithm_name(algorithm) + '/' + frm::get_point_distribution_name(distribution);
+
+            benchmarks.push_back({ name, 1000000,
+                [distribution, algorithm](Options const & options, size_t size, Result & result) noexcept
+                {
+                    std::vector<frm::Point> const points = frm::generate_points(distribution, size, options.seed);
+                    result.items = size;
+
+                    for (size_t i = 0; i < options.repeats; ++i)
+                    {
+                        sample(result, [&points, algorithm]() noexcept
+                        {
+                            std::vector<frm::vvve::VVVE::edge_t> const edges = frm::convex_hull(points.data(), points.size(), algorithm);
+                        });
+                    }
+                } });
+        }
+    }
+
+    benchmarks.push_back({ "nearest_point", 1000000,
+        [](Options const & options, size_t size, Result & result) noexcept
+        {
+            frm::dcel::DCEL const dcel = frm::generate_simple_polygon(size, options.seed);
+            std::vector<frm::Point> const queries = generate_queries(dcel, slow_queries_count, options.seed);
+            result.items = 1;
+
+            size_t volatile vertex_index = 0;
+            for (frm::Point const query : queries)
+            {
+                sample(result, [&]() noexcept
+                {
+                    vertex_index = frm::nearest_point(dcel, query);
+                });
+            }
+        } });
+
+    benchmarks.push_back({ "nearest_line", 1000000,
+        [](Options const & options, size_t size, Result & result) noexcept
+        {
+            frm::dcel::DCEL const dcel = frm::generate_simple_polygon(size, options.seed);
+            std::vector<frm::Point> const queries = generate_queries(dcel, slow_queries_count, options.seed);
+            result.items = 1;
+
+            size_t volatile edge_index = 0;
+            for (frm::Point const query : queries)
+            {
+                sample(result, [&]() noexcept
+                {
+                    edge_index = frm::nearest_line(dcel, query);
+                });
+            }
+        } });
+
+    for (frm::SubdivisionKind const kind : subdivision_kinds)
+    {
+        benchmarks.push_back({ "dcel/validate/" + std::string{ frm::get_subdivision_kind_name(kind) }, 1000000,
+            [kind](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const dcel = frm::generate_dcel(kind, size, options.seed);
+                result.items = dcel.edges.size();
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    sample(result, [&dcel]() noexcept
+                    {
+                        frm::dcel::ValidationResult const validation = frm::dcel::validate(dcel);
+                    });
+                }
+            } });
+
+        benchmarks.push_back({ "dcel/find_intersections/" + std::string{ frm::get_subdivision_kind_name(kind) }, 1000000,
+            [kind](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const dcel = frm::generate_dcel(kind, size, options.seed);
+                result.items = dcel.edges.size() / 2;
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    sample(result, [&dcel]() noexcept
+                    {
+                        std::vector<frm::SegmentIntersection> const intersections = frm::dcel::find_intersections(dcel);
+                    });
+                }
+            } });
+    }
+
+    for (frm::SubdivisionKind const kind : subdivision_kinds)
+    {
+        benchmarks.push_back({ "dcel/overlay/" + std::string{ frm::get_subdivision_kind_name(kind) }, 1000000,
+            [kind](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const first = frm::generate_dcel(kind, size, options.seed);
+                frm::dcel::DCEL const second = frm::generate_dcel(kind, size, options.seed + 1);
+                result.items = first.edges.size() / 2 + second.edges.size() / 2;
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    sample(result, [&first, &second]() noexcept
+                    {
+                        frm::dcel::Overlay const overlay = frm::dcel::overlay(first, second);
+                    });
+                }
+            } });
+    }
+
+    for (frm::dcel::BooleanOperation const operation : { frm::dcel::BooleanOperation::Union,
+        frm::dcel::BooleanOperation::Intersection,
+        frm::dcel::BooleanOperation::Difference,
+        frm::dcel::BooleanOperation::SymmetricDifference })
+    {
+        benchmarks.push_back({ "dcel/boolean/" + std::string{ frm::dcel::get_boolean_operation_name(operation) }, 1000000,
+            [operation](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::dcel::DCEL const first = frm::generate_dcel(frm::SubdivisionKind::PolygonWithHoles, size, options.seed);
+                frm::dcel::DCEL const second = frm::generate_dcel(frm::SubdivisionKind::PolygonWithHoles, size, options.seed + 1);
+                result.items = first.edges.size() / 2 + second.edges.size() / 2;
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    sample(result, [&first, &second, operation]() noexcept
+                    {
+                        frm::dcel::BooleanResult const boolean_result = frm::dcel::apply_boolean_operation(first, second, operation);
+                    });
+                }
+            } });
+    }
+
+    for (frm::PointDistribution const distribution : point_distributions)
+    {
+        benchmarks.push_back({ "voronoi/" + std::string{ frm::get_point_distribution_name(distribution) }, 1000000,
+            [distribution](Options const & options, size_t size, Result & result) noexcept
+            {
+                frm::vvve::VVVE const vvve = frm::generate_vvve(distribution, size, options.seed);
+                result.items = size;
+
+                for (size_t i = 0; i < options.repeats; ++i)
+                {
+                    sample(result, [&vvve]() noexcept
+                    {
+                        frm::VoronoiDiagram const diagram = frm::build_voronoi_diagram(vvve);
+                    });
+                }
+            } });
+    }
+
+    benchmarks.push_back({ "dcel/save", 1000000,
+        [](Options const & options, size_t size, Result & result) noexcept
+        {
+            frm::dcel::DCEL const dcel = frm::generate_simple_polygon(size, options.seed);
+            std::string const path = (std::filesystem::temp_directory_path() / "benchmark_dcel.dat").string();
+            result.items = size;
+
+            for (size_t i = 0; i < options.repeats; ++i)
+            {
+                sample(result, [&dcel, &path]() noexcept
+                {
+                    frm::dcel::safe_to_file(path, dcel);
+                });
+            }
+
+            std::filesystem::remove(path);
+        } });
+
+    benchmarks.push_back({ "dcel/load", 1000000,
+        [](Options const & options, size_t size, Result & result) noexcept
+        {
+            std::string const path = (std::filesystem::temp_directory_path() / "benchmark_dcel.dat").string();
+            frm::dcel::safe_to_file(path, frm::generate_simple_polygon(size, options.seed));
+            result.items = size;
+
+            for (size_t i = 0; i < options.repeats; ++i)
+            {
+                frm::dcel::DCEL dcel{};
+
+                sample(result, [&dcel, &path]() noexcept
+                {
+                    frm::dcel::load_from_file(path, dcel);
+                });
+            }
+
+            std::filesystem::remove(path);
+        } });
+
+    return benchmarks;
+}
+
+// nearest rank, latencies are sorted
+double get_percentile(std::vector<double> const & latencies, double percentile) noexcept
+{
+    size_t const rank = static_cast<size_t>(std::ceil(percentile / 100. * static_cast<double>(latencies.size())));
+    return latencies[std::clamp<size_t>(rank, 1, latencies.size()) - 1];
+}
+
+void write_result(std::ostream & os, Result const & result) noexcept
+{
+    std::vector<double> latencies{ result.latencies };
+    std::sort(latencies.begin(), latencies.end());
+
+    double total = 0.;
+    for (double const latency : latencies)
+    {
+        total += latency;
+    }
+
+    size_t const samples_count = latencies.size();
+    double const throughput = total > 0. ? static_cast<double>(result.items * samples_count) / (total / 1000000.) : 0.;
+
+    os << "    {\n" <<
+        "      \"name\": \"" << result.name << "\",\n" <<
+        "      \"size\": " << result.size << ",\n" <<
+        "      \"samples\": " << samples_count << ",\n" <<
+        "      \"items_per_sample\": " << result.items << ",\n" <<
+        "      \"throughput_per_s\": " << throughput << ",\n" <<
+        "      \"latency_us\": { " <<
+        "\"min\": " << latencies.front() << ", " <<
+        "\"mean\": " << total / static_cast<double>(samples_count) << ", " <<
+        "\"p50\": " << get_percentile(latencies, 50.) << ", " <<
+        "\"p90\": " << get_percentile(latencies, 90.) << ", " <<
+        "\"p99\": " << get_percentile(latencies, 99.) << ", " <<
+        "\"max\": " << latencies.back() << " },\n" <<
+        "      \"allocations_per_sample\": " << result.allocations / samples_count << ",\n" <<
+        "      \"allocated_bytes_per_sample\": " << result.allocated_bytes / samples_count << ",\n" <<
+        "      \"peak_rss_bytes\": " << result.peak_rss;
+
+    if (!result.counters.empty())
+    {
+        os << ",\n      \"counters\": " << result.counters;
+    }
+
+    os << "\n    }";
+}
+
+void write_results(std::ostream & os, Options const & options, std::vector<Result> const & results) noexcept
+{
+    os << "{\n" <<
+        "  \"seed\": " << options.seed << ",\n" <<
+        "  \"repeats\": " << options.repeats << ",\n" <<
+        "  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        os << (i == 0 ? "\n" : ",\n");
+        write_result(os, results[i]);
+    }
+
+    os << "\n  ],\n" <<
+        "  \"peak_rss_bytes\": " << get_peak_rss() << "\n" <<
+        "}\n";
+}
+
+bool parse_options(int argc, char ** argv, Options & options) noexcept
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const argument = argv[i];
+
+        if (i + 1 == argc)
+        {
+            std::cerr << "no value for " << argument << '\n';
+            return false;
+        }
+
+        char const * const value = argv[++i];
+
+        if (argument == "--min-size")
+        {
+            options.min_size = std::max<size_t>(std::strtoull(value, nullptr, 10), 1);
+        }
+        else if (argument == "--max-size")
+        {
+            options.max_size = std::strtoull(value, nullptr, 10);
+        }
+        else if (argument == "--repeats")
+        {
+            options.repeats = std::max<size_t>(std::strtoull(value, nullptr, 10), 1);
+        }
+        else if (argument == "--seed")
+        {
+            options.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        else if (argument == "--filter")
+        {
+            options.filter = value;
+        }
+        else if (argument == "--output")
+        {
+            options.output = value;
+        }
+        else if (argument == "--write-inputs")
+        {
+            options.inputs_directory = value;
+        }
+        else
+        {
+            std::cerr << "unknown option " << argument << '\n';
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Dcel_<kind>_<size>.dat and Vvve_<distribution>_<size>.dat in the format of the application files
+void write_inputs(Options const & options) noexcept
+{
+    std::filesystem::path const directory{ options.inputs_directory };
+    std::error_code error{};
+    std::filesystem::create_directories(directory, error);
+
+    for (size_t size = options.min_size; size <= options.max_size; size *= 10)
+    {
+        std::string const size_name = '_' + std::to_string(size) + ".dat";
+
+        for (frm::SubdivisionKind const kind : subdivision_kinds)
+        {
+            std::filesystem::path const path = directory / ("Dcel_" + std::string{ frm::get_subdivision_kind_name(kind) } + size_name);
+            std::cerr << path.string() << '\n';
+
+            frm::dcel::safe_to_file(path.string(), frm::generate_dcel(kind, size, options.seed));
+        }
+
+        for (frm::PointDistribution const distribution : point_distributions)
+        {
+            std::filesystem::path const path = directory / ("Vvve_" + std::string{ frm::get_point_distribution_name(distribution) } + size_name);
+            std::cerr << path.string() << '\n';
+
+            frm::vvve::safe_to_file(path.string(), frm::generate_vvve(distribution, size, options.seed));
+        }
+    }
+}
+
+// Benchmark [--min-size 100] [--max-size 1000000] [--repeats 5] [--seed 42] [--filter name] [--output results.json]
+//           [--write-inputs directory]
+// Sizes go in powers of 10, progress is written to stderr, results as JSON to stdout or the output file.
+// With --write-inputs only the generated inputs of every size are saved.
+int main(int argc, char ** argv)
+{
+    Options options{};
+    if (!parse_options(argc, argv, options))
+    {
+        return 1;
+    }
+
+    if (!options.inputs_directory.empty())
+    {
+        write_inputs(options);
+        return 0;
+    }
+
+    std::vector<Result> results{};
+
+    for (Benchmark const & benchmark : create_benchmarks())
+    {
+        if (benchmark.name.find(options.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        for (size_t size = options.min_size; size <= std::min(options.max_size, benchmark.max_size); size *= 10)
+        {
+            std::cerr << benchmark.name << ' ' << size << '\n';
+
+            Result result{ benchmark.name, size };
+            frm::reset_counters();
+            benchmark.run(options, size, result);
+            result.peak_rss = get_peak_rss();
+
+            if (frm::is_counting)
+            {
+                std::ostringstream counters{};
+                frm::write_counters_json(counters);
+                result.counters = counters.str();
+            }
+
+            results.push_back(std::move(result));
+        }
+    }
+
+    if (options.output.empty())
+    {
+        write_results(std::cout, options, results);
+    }
+    else
+    {
+        std::ofstream file_output{ options.output };
+        write_results(file_output, options, results);
+    }
+}
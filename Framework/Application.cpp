@@ -1,8 +1,14 @@
 #include "Application.h"
+#include "profiler.h"
+#include "counters.h"
 
 #include "imgui/imgui-SFML.h"
 #include "imgui/imgui.h"
 
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
 
 namespace frm
 {
@@ -23,6 +29,12 @@ namespace frm
 
     Application::~Application()
     {
+        // results of the jobs are dropped, destruction of m_jobs waits for the workers
+        for (Job & job : m_jobs)
+        {
+            job.progress->is_cancelled = true;
+        }
+
         ImGui::SFML::Shutdown();
     }
 
@@ -41,21 +53,269 @@ namespace frm
         m_on_event = on_event;
     }
 
+    void Application::set_on_fixed_update(std::function<void(float)> const & on_fixed_update) noexcept
+    {
+        m_on_fixed_update = on_fixed_update;
+    }
+
+    void Application::set_on_render(std::function<void(float, sf::RenderWindow &)> const & on_render) noexcept
+    {
+        m_on_render = on_render;
+    }
+
+    void Application::add_sliced_task(task_step_t const & task_step) noexcept
+    {
+        m_sliced_tasks.push_back(task_step);
+    }
+
+    size_t Application::start_job(std::string const & name, job_work_t const & work, job_done_t const & on_done) noexcept
+    {
+        std::shared_ptr<JobProgress> progress = std::make_shared<JobProgress>();
+
+        std::future<void> result = std::async(std::launch::async, [work, progress]() noexcept
+            {
+                work(*progress);
+            });
+
+        m_jobs.push_back({ m_next_job_id, name, std::move(progress), std::move(result), on_done });
+
+        return m_next_job_id++;
+    }
+
+    void Application::cancel_job(size_t job_id) noexcept
+    {
+        for (Job & job : m_jobs)
+        {
+            if (job.id == job_id)
+            {
+                job.progress->is_cancelled = true;
+            }
+        }
+    }
+
+    bool Application::is_job_running(size_t job_id) const noexcept
+    {
+        return std::any_of(m_jobs.begin(), m_jobs.end(), [job_id](Job const & job) noexcept
+            {
+                return job.id == job_id;
+            });
+    }
+
+    void Application::finish_jobs() noexcept
+    {
+        // on_done may start new jobs, so finished jobs are taken out first
+        std::vector<Job> finished_jobs{};
+
+        for (size_t i = 0; i < m_jobs.size();)
+        {
+            if (m_jobs[i].result.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready)
+            {
+                finished_jobs.push_back(std::move(m_jobs[i]));
+                m_jobs.erase(m_jobs.begin() + i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        for (Job & job : finished_jobs)
+        {
+            job.result.get();
+            job.on_done(job.progress->is_cancelled);
+        }
+    }
+
+    void Application::show_jobs_ui() noexcept
+    {
+        if (m_jobs.empty())
+        {
+            return;
+        }
+
+        if (ImGui::Begin("Jobs"))
+        {
+            for (Job const & job : m_jobs)
+            {
+                ImGui::PushID(static_cast<int>(job.id));
+
+                ImGui::Text("%s", job.name.c_str());
+                ImGui::ProgressBar(job.progress->progress);
+
+                if (job.progress->is_cancelled)
+                {
+                    ImGui::Text("Cancelling");
+                }
+                else if (ImGui::Button("Cancel"))
+                {
+                    job.progress->is_cancelled = true;
+                }
+
+                ImGui::PopID();
+            }
+        }
+        ImGui::End();
+    }
+
+    void Application::set_fixed_step(float fixed_step) noexcept
+    {
+        m_fixed_step = fixed_step;
+    }
+
+    void Application::set_tasks_budget(float tasks_budget) noexcept
+    {
+        m_tasks_budget = tasks_budget;
+    }
+
+    void Application::set_frame_rate_limit(unsigned frame_rate_limit) noexcept
+    {
+        m_frame_rate_limit = static_cast<int>(frame_rate_limit);
+        m_window.setFramerateLimit(frame_rate_limit);
+    }
+
+    void Application::set_vertical_sync(bool is_vertical_sync) noexcept
+    {
+        m_is_vertical_sync = is_vertical_sync;
+        m_window.setVerticalSyncEnabled(is_vertical_sync);
+    }
+
+    void Application::run_fixed_updates(sf::Time time) noexcept
+    {
+        float const frame_time = static_cast<float>(time.asMicroseconds()) / 1000.f;
+
+        // negative speed factor runs the simulation backwards with the same step
+        m_accumulated_time += frame_time * std::abs(m_speed_factor);
+        float const step = m_speed_factor < 0.f ? -m_fixed_step : m_fixed_step;
+
+        size_t updates_count = 0;
+        while (m_accumulated_time >= m_fixed_step && updates_count < max_fixed_updates_per_frame)
+        {
+            m_on_fixed_update(step);
+
+            m_accumulated_time -= m_fixed_step;
+            ++updates_count;
+        }
+
+        if (updates_count == max_fixed_updates_per_frame)
+        {
+            m_accumulated_time = std::min(m_accumulated_time, m_fixed_step);
+        }
+    }
+
+    void Application::run_sliced_tasks() noexcept
+    {
+        sf::Clock const budget_clock{};
+
+        while (!m_sliced_tasks.empty())
+        {
+            if (m_sliced_tasks.front()())
+            {
+                m_sliced_tasks.pop_front();
+            }
+
+            if (budget_clock.getElapsedTime().asMicroseconds() >= static_cast<sf::Int64>(m_tasks_budget * 1000.f))
+            {
+                break;
+            }
+        }
+    }
+
+    void Application::show_scheduler_ui() noexcept
+    {
+        if (ImGui::Begin("Simulation speed"))
+        {
+            ImGui::SliderFloat("Speed Factor", &m_speed_factor, -2.f, 2.f, "%.3f", 4.f);
+            ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+            ImGui::SliderFloat("Fixed step, ms", &m_fixed_step, 1.f, 100.f);
+            ImGui::SliderFloat("Tasks budget, ms", &m_tasks_budget, 0.f, 33.f);
+            ImGui::Text("Sliced tasks %d", static_cast<int>(m_sliced_tasks.size()));
+
+            if (ImGui::SliderInt("Frame rate limit", &m_frame_rate_limit, 0, 240))
+            {
+                m_window.setFramerateLimit(static_cast<unsigned>(m_frame_rate_limit));
+            }
+            if (ImGui::Checkbox("Vertical sync", &m_is_vertical_sync))
+            {
+                m_window.setVerticalSyncEnabled(m_is_vertical_sync);
+            }
+        }
+        ImGui::End();
+    }
+
+    void Application::process_view_event(sf::Event const & event) noexcept
+    {
+        bool const is_mouse_free = !ImGui::GetIO().WantCaptureMouse;
+
+        if (event.type == sf::Event::Resized)
+        {
+            // keeps the scale, so the map is not stretched
+            float const scale = m_window.getView().getSize().x / static_cast<float>(m_width);
+
+            m_width = event.size.width;
+            m_height = event.size.height;
+
+            sf::View view = m_window.getView();
+            view.setSize(scale * static_cast<float>(m_width), scale * static_cast<float>(m_height));
+            m_window.setView(view);
+        }
+        else if (event.type == sf::Event::MouseWheelScrolled && is_mouse_free)
+        {
+            sf::Vector2i const pixel{ event.mouseWheelScroll.x, event.mouseWheelScroll.y };
+            sf::Vector2f const before = m_window.mapPixelToCoords(pixel);
+
+            sf::View view = m_window.getView();
+            view.zoom(event.mouseWheelScroll.delta > 0.f ? 1.f / zoom_step : zoom_step);
+            m_window.setView(view);
+
+            // point under the cursor stays in place
+            view.move(before - m_window.mapPixelToCoords(pixel));
+            m_window.setView(view);
+        }
+        else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Middle && is_mouse_free)
+        {
+            m_is_view_dragged = true;
+            m_drag_position = { event.mouseButton.x, event.mouseButton.y };
+        }
+        else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Middle)
+        {
+            m_is_view_dragged = false;
+        }
+        else if (event.type == sf::Event::MouseMoved && m_is_view_dragged)
+        {
+            sf::Vector2i const position{ event.mouseMove.x, event.mouseMove.y };
+
+            sf::View view = m_window.getView();
+            view.move(m_window.mapPixelToCoords(m_drag_position) - m_window.mapPixelToCoords(position));
+            m_window.setView(view);
+
+            m_drag_position = position;
+        }
+    }
+
     void Application::run() noexcept
     {
         m_window.resetGLStates();
         while (m_window.isOpen())
         {
-            sf::Event event;
-            while (m_window.pollEvent(event))
-            {
-                ImGui::SFML::ProcessEvent(event);
+            begin_profiler_frame();
 
-                m_on_event(event);
+            {
+                ProfileScope const scope{ "events" };
 
-                if (event.type == sf::Event::Closed)
+                sf::Event event;
+                while (m_window.pollEvent(event))
                 {
-                    m_window.close();
+                    ImGui::SFML::ProcessEvent(event);
+
+                    process_view_event(event);
+
+                    m_on_event(event);
+
+                    if (event.type == sf::Event::Closed)
+                    {
+                        m_window.close();
+                    }
                 }
             }
 
@@ -65,24 +325,54 @@ namespace frm
 
             ImGui::SFML::Update(m_window, time);
 
+            show_scheduler_ui();
+
+            show_profiler_ui();
+            show_counters_ui();
 
-            if (ImGui::Begin("Simulation speed"))
             {
-                ImGui::SliderFloat("Speed Factor", &m_speed_factor, -2.f, 2.f, "%.3f", 4.f);
-                ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+                ProfileScope const scope{ "fixed updates" };
+                run_fixed_updates(time);
             }
-            ImGui::End();
+
+            {
+                ProfileScope const scope{ "sliced tasks" };
+                run_sliced_tasks();
+            }
+
+            {
+                ProfileScope const scope{ "finish jobs" };
+                finish_jobs();
+            }
+
+            show_jobs_ui();
 
 
             m_window.clear(background_color);
 
 
-            m_on_update(dt, m_window);
+            {
+                ProfileScope const scope{ "update" };
+                m_on_update(dt, m_window);
+            }
+
+            {
+                ProfileScope const scope{ "render" };
+                m_on_render(m_accumulated_time / m_fixed_step, m_window);
+            }
 
 
-            ImGui::SFML::Render(m_window);
+            {
+                ProfileScope const scope{ "imgui render" };
+                ImGui::SFML::Render(m_window);
+            }
+
+            {
+                ProfileScope const scope{ "display" };
+                m_window.display();
+            }
 
-            m_window.display();
+            end_profiler_frame();
         }
     }
 }
\ No newline at end of file
@@ -3,18 +3,49 @@
 
 #include "SFML\Graphics.hpp"
 
+#include <deque>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+#include <string>
+#include <limits>
 #include <functional>
 
 
 // Framework
 namespace frm
 {
+    // Shared between a background job and the main thread
+    struct JobProgress
+    {
+        // [0, 1], set by the job
+        std::atomic<float> progress{ 0.f };
+        // set by the main thread, the job should check it between its stages and stop early
+        std::atomic<bool> is_cancelled{ false };
+    };
+
     class Application
     {
     public:
         static constexpr char const * default_title{ "Application" };
         static constexpr size_t default_width{ 1280 };
         static constexpr size_t default_height{ 720 };
+        // ms
+        static constexpr float default_fixed_step{ 1000.f / 60.f };
+        static constexpr float default_tasks_budget{ 4.f };
+
+        // Step of a long task, the task is sliced into steps spread over frames.
+        // Returns true when the task is finished.
+        using task_step_t = std::function<bool()>;
+
+        // Work of a background job, runs on a worker thread and must not touch data of the main thread,
+        // so it works on a snapshot of the data it needs
+        using job_work_t = std::function<void(JobProgress &)>;
+        // called on the main thread after the work is finished, to swap the result in
+        using job_done_t = std::function<void(bool is_cancelled)>;
+
+        static constexpr size_t invalid_job_id{ std::numeric_limits<size_t>::max() };
 
     public:
         Application(
@@ -34,12 +65,65 @@ namespace frm
 
         void set_on_update(std::function<void(float, sf::RenderWindow &)> const & on_update) noexcept;
         void set_on_event(std::function<void(sf::Event)> const & on_event) noexcept;
+        // called with the fixed step scaled by the sign of the speed factor,
+        // as many times per frame as the scaled frame time allows
+        void set_on_fixed_update(std::function<void(float)> const & on_fixed_update) noexcept;
+        // called after the update of every frame,
+        // alpha - part of the fixed step passed since the last fixed update, for interpolation
+        void set_on_render(std::function<void(float, sf::RenderWindow &)> const & on_render) noexcept;
+
+        // steps of the first task are run every frame until the tasks budget is spent,
+        // at least one step per frame
+        void add_sliced_task(task_step_t const & task_step) noexcept;
+
+        // jobs are shown in the "Jobs" window with their progress and can be cancelled there
+        size_t start_job(std::string const & name, job_work_t const & work, job_done_t const & on_done) noexcept;
+        void cancel_job(size_t job_id) noexcept;
+        // true until on_done of the job is called
+        bool is_job_running(size_t job_id) const noexcept;
+
+        // ms
+        void set_fixed_step(float fixed_step) noexcept;
+        // ms per frame
+        void set_tasks_budget(float tasks_budget) noexcept;
+        // 0 - no limit
+        void set_frame_rate_limit(unsigned frame_rate_limit) noexcept;
+        void set_vertical_sync(bool is_vertical_sync) noexcept;
 
         void run() noexcept;
         
+    private:
+        // mouse wheel zooms the view around the cursor, middle mouse button drags it
+        void process_view_event(sf::Event const & event) noexcept;
+
+        void run_fixed_updates(sf::Time time) noexcept;
+        void run_sliced_tasks() noexcept;
+        // calls on_done of the finished jobs
+        void finish_jobs() noexcept;
+
+        void show_jobs_ui() noexcept;
+
+        void show_scheduler_ui() noexcept;
+
     private:
         std::function<void(float, sf::RenderWindow &)> m_on_update{ [](float, sf::RenderWindow &) {} };
         std::function<void(sf::Event)> m_on_event{ [](sf::Event) {} };
+        std::function<void(float)> m_on_fixed_update{ [](float) {} };
+        std::function<void(float, sf::RenderWindow &)> m_on_render{ [](float, sf::RenderWindow &) {} };
+
+        std::deque<task_step_t> m_sliced_tasks{};
+
+        struct Job
+        {
+            size_t id;
+            std::string name;
+            std::shared_ptr<JobProgress> progress;
+            std::future<void> result;
+            job_done_t on_done;
+        };
+
+        std::vector<Job> m_jobs{};
+        size_t m_next_job_id{ 0 };
 
         sf::RenderWindow m_window;
         sf::Clock m_clock{};
@@ -51,7 +135,20 @@ namespace frm
 
         float m_speed_factor{ 1.f };
 
+        float m_fixed_step{ default_fixed_step };
+        // scaled time not yet consumed by fixed updates, ms
+        float m_accumulated_time{ 0.f };
+        float m_tasks_budget{ default_tasks_budget };
+        int m_frame_rate_limit{ 0 };
+        bool m_is_vertical_sync{ false };
+
+        bool m_is_view_dragged{ false };
+        sf::Vector2i m_drag_position{};
+
     private:
         sf::Color const background_color{ sf::Color::Black };
+        float const zoom_step{ 1.25f };
+        // the rest of a long frame is dropped, so slow updates don't pile up
+        size_t const max_fixed_updates_per_frame{ 8 };
     };
 }
\ No newline at end of file
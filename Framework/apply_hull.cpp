@@ -71,10 +71,15 @@ namespace frm
     }
 
     void apply_hull(dcel::DCEL & dcel, vvve::VVVE const & vvve) noexcept
+    {
+        apply_hull(dcel, vvve.edges);
+    }
+
+    void apply_hull(dcel::DCEL & dcel, std::vector<vvve::VVVE::edge_t> const & hull_edges) noexcept
     {
         std::vector<std::pair<size_t, size_t>> need_to_connects{};
 
-        for (vvve::VVVE::edge_t edge : vvve.edges)
+        for (vvve::VVVE::edge_t edge : hull_edges)
         {
             size_t const begin_vertex = edge.first;
             size_t const end_vertex = edge.second;
@@ -94,6 +99,11 @@ namespace frm
             }
         }
 
+        if (need_to_connects.empty())
+        {
+            return;
+        }
+
         Point center{ 0, 0 };
         for (dcel::DCEL::Vertex vertex : dcel.vertices)
         {
@@ -7,4 +7,8 @@
 namespace frm
 {
     void apply_hull(dcel::DCEL & dcel, vvve::VVVE const & vvve) noexcept;
+
+    // Connects hull edges that are missing in dcel, for example HullDelta::added_edges.
+    // Edges that are not on the hull anymore stay in dcel as inner edges.
+    void apply_hull(dcel::DCEL & dcel, std::vector<vvve::VVVE::edge_t> const & hull_edges) noexcept;
 }
@@ -0,0 +1,515 @@
+#include "boolean_operations.h"
+
+#include "segment_intersections.h"
+#include "view_culling.h"
+#include "profiler.h"
+
+#include <future>
+#include <thread>
+#include <limits>
+#include <algorithm>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        static constexpr size_t no_item = std::numeric_limits<size_t>::max();
+
+        // groups smaller than this are not worth a thread
+        static constexpr size_t parallel_boolean_threshold = 1 << 12;
+
+        // piece of the boundary of the region of an input, the region is on its left
+        struct BoundarySegment
+        {
+            Point begin;
+            Point end;
+            // 0 for the first input, 1 for the second one
+            uint8_t source;
+        };
+
+        bool is_inside(BooleanOperation operation, bool is_in_first, bool is_in_second) noexcept
+        {
+            switch (operation)
+            {
+            case BooleanOperation::Union:
+                return is_in_first || is_in_second;
+            case BooleanOperation::Intersection:
+                return is_in_first && is_in_second;
+            case BooleanOperation::Difference:
+                return is_in_first && !is_in_second;
+            case BooleanOperation::SymmetricDifference:
+                return is_in_first != is_in_second;
+            default:
+                return false;
+            }
+        }
+
+        // edges between a selected face and a not selected one, returns true if the region goes to infinity
+        bool add_region_boundary(DCEL const & dcel, std::vector<size_t> const & faces, uint8_t source, std::vector<BoundarySegment> & segments) noexcept
+        {
+            std::vector<uint8_t> is_face_selected(dcel.faces.size(), 0);
+            for (size_t const face : faces)
+            {
+                if (face < dcel.faces.size() && dcel.faces[face].is_exist)
+                {
+                    is_face_selected[face] = 1;
+                }
+            }
+
+            bool has_edges = false;
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                DCEL::Edge const & edge = dcel.edges[i];
+                if (!edge.is_exist || edge.twin_edge < i)
+                {
+                    continue;
+                }
+                has_edges = true;
+
+                bool const is_left_selected = is_face_selected[edge.incident_face];
+                bool const is_right_selected = is_face_selected[dcel.edges[edge.twin_edge].incident_face];
+                if (is_left_selected == is_right_selected)
+                {
+                    continue;
+                }
+
+                Point const begin = dcel.vertices[edge.origin_vertex].coordinate;
+                Point const end = dcel.vertices[dcel.edges[edge.twin_edge].origin_vertex].coordinate;
+
+                segments.push_back(is_left_selected ? BoundarySegment{ begin, end, source } : BoundarySegment{ end, begin, source });
+            }
+
+            // without edges the only face is the whole plane
+            if (!has_edges)
+            {
+                return std::find(is_face_selected.begin(), is_face_selected.end(), 1) != is_face_selected.end();
+            }
+
+            return is_face_selected[get_outside_face_index(dcel)] != 0;
+        }
+
+        size_t find_group(std::vector<size_t> & parents, size_t item) noexcept
+        {
+            while (parents[item] != item)
+            {
+                parents[item] = parents[parents[item]];
+                item = parents[item];
+            }
+            return item;
+        }
+
+        // Connected components of the segments with overlapping bounding boxes, in the order of their leftmost points.
+        // A component in a face of another one is inside of its box, so the groups don't affect each other.
+        std::vector<std::vector<BoundarySegment>> get_independent_groups(std::vector<BoundarySegment> const & segments) noexcept
+        {
+            std::vector<size_t> parents(segments.size());
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                parents[i] = i;
+            }
+
+            // segments with a common end point
+            std::vector<std::pair<Point, size_t>> ends{};
+            ends.reserve(2 * segments.size());
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                ends.push_back({ segments[i].begin, i });
+                ends.push_back({ segments[i].end, i });
+            }
+            std::sort(ends.begin(), ends.end(), [](std::pair<Point, size_t> const & first, std::pair<Point, size_t> const & second) noexcept
+                {
+                    return first.first.x < second.first.x || (first.first.x == second.first.x && first.first.y < second.first.y);
+                });
+
+            for (size_t i = 1; i < ends.size(); ++i)
+            {
+                if (ends[i].first.x == ends[i - 1].first.x && ends[i].first.y == ends[i - 1].first.y)
+                {
+                    parents[find_group(parents, ends[i].second)] = find_group(parents, ends[i - 1].second);
+                }
+            }
+
+            std::vector<Box> boxes(segments.size(), empty_box);
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                size_t const group = find_group(parents, i);
+                extend_box(boxes[group], segments[i].begin);
+                extend_box(boxes[group], segments[i].end);
+            }
+
+            std::vector<size_t> components{};
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                if (parents[i] == i)
+                {
+                    components.push_back(i);
+                }
+            }
+            std::sort(components.begin(), components.end(), [&boxes](size_t first, size_t second) noexcept
+                {
+                    return boxes[first].min.x < boxes[second].min.x;
+                });
+
+            // groups that the boxes of the next components can still reach
+            std::vector<size_t> active_groups{};
+            for (size_t const component : components)
+            {
+                size_t group = component;
+                Box box = boxes[component];
+
+                size_t kept = 0;
+                for (size_t const active_group : active_groups)
+                {
+                    if (boxes[active_group].max.x < box.min.x)
+                    {
+                        continue;
+                    }
+
+                    if (is_boxes_intersected(boxes[active_group], box))
+                    {
+                        parents[active_group] = group;
+                        extend_box(box, boxes[active_group].min);
+                        extend_box(box, boxes[active_group].max);
+                        continue;
+                    }
+
+                    active_groups[kept++] = active_group;
+                }
+                active_groups.resize(kept);
+
+                boxes[group] = box;
+                active_groups.push_back(group);
+            }
+
+            std::vector<size_t> group_indices(segments.size(), no_item);
+            std::vector<std::vector<BoundarySegment>> groups{};
+            for (size_t const component : components)
+            {
+                size_t const group = find_group(parents, component);
+                if (group_indices[group] == no_item)
+                {
+                    group_indices[group] = groups.size();
+                    groups.emplace_back();
+                }
+            }
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                groups[group_indices[find_group(parents, i)]].push_back(segments[i]);
+            }
+
+            return groups;
+        }
+
+        BooleanResult apply_to_group(std::vector<BoundarySegment> const & segments, BooleanOperation operation, bool const is_unbounded[2]) noexcept
+        {
+            std::vector<Point> points{};
+            std::vector<std::pair<size_t, size_t>> point_segments{};
+            points.reserve(2 * segments.size());
+            point_segments.reserve(segments.size());
+            for (BoundarySegment const & segment : segments)
+            {
+                point_segments.push_back({ points.size(), points.size() + 1 });
+                points.push_back(segment.begin);
+                points.push_back(segment.end);
+            }
+
+            Arrangement const arrangement = build_arrangement(points, point_segments);
+            DCEL const & overlay = arrangement.dcel;
+
+            // bit of every input with a boundary along the piece, edges 2i and 2i + 1 are piece i
+            std::vector<uint8_t> piece_sources(overlay.edges.size() / 2, 0);
+            for (SegmentEdge const & segment_edge : arrangement.segment_edges)
+            {
+                piece_sources[segment_edge.edge / 2] |= static_cast<uint8_t>(1 << segments[segment_edge.segment].source);
+            }
+
+            // edges of every face with its holes: face_edges[face_offsets[i], face_offsets[i + 1])
+            std::vector<size_t> face_offsets(overlay.faces.size() + 1, 0);
+            for (DCEL::Edge const & edge : overlay.edges)
+            {
+                ++face_offsets[edge.incident_face + 1];
+            }
+            for (size_t i = 1; i < face_offsets.size(); ++i)
+            {
+                face_offsets[i] += face_offsets[i - 1];
+            }
+
+            std::vector<size_t> face_edges(overlay.edges.size());
+            {
+                std::vector<size_t> next_positions(face_offsets.begin(), face_offsets.end() - 1);
+                for (size_t i = 0; i < overlay.edges.size(); ++i)
+                {
+                    face_edges[next_positions[overlay.edges[i].incident_face]++] = i;
+                }
+            }
+
+            // bit of every input with the face in its region, spread from the boundary over the other edges as in overlay
+            std::vector<uint8_t> face_regions(overlay.faces.size(), 0);
+            std::vector<uint8_t> is_face_reached(overlay.faces.size());
+            std::vector<size_t> queue{};
+            queue.reserve(overlay.faces.size());
+
+            for (uint8_t source = 0; source < 2; ++source)
+            {
+                uint8_t const source_bit = static_cast<uint8_t>(1 << source);
+
+                std::fill(is_face_reached.begin(), is_face_reached.end(), 0);
+                queue.clear();
+
+                for (SegmentEdge const & segment_edge : arrangement.segment_edges)
+                {
+                    if (segments[segment_edge.segment].source != source)
+                    {
+                        continue;
+                    }
+
+                    size_t const inner_face = overlay.edges[segment_edge.edge].incident_face;
+                    size_t const outer_face = overlay.edges[overlay.edges[segment_edge.edge].twin_edge].incident_face;
+
+                    if (!is_face_reached[inner_face])
+                    {
+                        is_face_reached[inner_face] = 1;
+                        face_regions[inner_face] |= source_bit;
+                        queue.push_back(inner_face);
+                    }
+                    if (!is_face_reached[outer_face])
+                    {
+                        is_face_reached[outer_face] = 1;
+                        queue.push_back(outer_face);
+                    }
+                }
+
+                // the group has no boundary of this input, so it is all on one side of it
+                if (queue.empty() && is_unbounded[source])
+                {
+                    for (uint8_t & face_region : face_regions)
+                    {
+                        face_region |= source_bit;
+                    }
+                }
+
+                for (size_t i = 0; i < queue.size(); ++i)
+                {
+                    size_t const face = queue[i];
+
+                    for (size_t j = face_offsets[face]; j < face_offsets[face + 1]; ++j)
+                    {
+                        size_t const edge = face_edges[j];
+                        size_t const other_face = overlay.edges[overlay.edges[edge].twin_edge].incident_face;
+
+                        if (!(piece_sources[edge / 2] & source_bit) && !is_face_reached[other_face])
+                        {
+                            is_face_reached[other_face] = 1;
+                            face_regions[other_face] |= face_regions[face] & source_bit;
+                            queue.push_back(other_face);
+                        }
+                    }
+                }
+            }
+
+            auto const is_face_inside = [&face_regions, operation](size_t face) noexcept
+                {
+                    return is_inside(operation, face_regions[face] & 1, face_regions[face] & 2);
+                };
+
+            // pieces between a face inside and a face outside, the result on the left
+            std::vector<size_t> vertex_points(overlay.vertices.size(), no_item);
+            std::vector<Point> result_points{};
+            std::vector<std::pair<size_t, size_t>> result_segments{};
+
+            auto const get_point = [&overlay, &vertex_points, &result_points](size_t vertex) noexcept
+                {
+                    if (vertex_points[vertex] == no_item)
+                    {
+                        vertex_points[vertex] = result_points.size();
+                        result_points.push_back(overlay.vertices[vertex].coordinate);
+                    }
+                    return vertex_points[vertex];
+                };
+
+            for (size_t i = 0; i < overlay.edges.size(); i += 2)
+            {
+                bool const is_left_inside = is_face_inside(overlay.edges[i].incident_face);
+                bool const is_right_inside = is_face_inside(overlay.edges[i + 1].incident_face);
+                if (is_left_inside == is_right_inside)
+                {
+                    continue;
+                }
+
+                size_t const begin = get_point(overlay.edges[is_left_inside ? i : i + 1].origin_vertex);
+                size_t const end = get_point(overlay.edges[is_left_inside ? i + 1 : i].origin_vertex);
+                result_segments.push_back({ begin, end });
+            }
+
+            // the pieces don't cross anymore, the sweep only links them into faces
+            Arrangement result_arrangement = build_arrangement(result_points, result_segments);
+
+            BooleanResult result{ std::move(result_arrangement.dcel), {} };
+            result.is_face_inside.assign(result.dcel.faces.size(), 0);
+            result.is_face_inside[0] = is_inside(operation, is_unbounded[0], is_unbounded[1]);
+
+            for (SegmentEdge const & segment_edge : result_arrangement.segment_edges)
+            {
+                result.is_face_inside[result.dcel.edges[segment_edge.edge].incident_face] = 1;
+            }
+
+            return result;
+        }
+
+        // faces of the group after the faces of the result, face 0 of both is the outside face
+        void append_group_result(BooleanResult & result, BooleanResult const & group) noexcept
+        {
+            size_t const vertex_offset = result.dcel.vertices.size();
+            size_t const edge_offset = result.dcel.edges.size();
+            size_t const face_offset = result.dcel.faces.size() - 1;
+
+            auto const get_face = [face_offset](size_t face) noexcept
+                {
+                    return face == 0 ? 0 : face + face_offset;
+                };
+
+            for (DCEL::Vertex const & vertex : group.dcel.vertices)
+            {
+                result.dcel.vertices.push_back({ vertex.coordinate, vertex.incident_edge == no_item ? no_item : vertex.incident_edge + edge_offset });
+            }
+
+            for (DCEL::Edge const & edge : group.dcel.edges)
+            {
+                result.dcel.edges.push_back({ edge.origin_vertex + vertex_offset,
+                    edge.twin_edge + edge_offset,
+                    get_face(edge.incident_face),
+                    edge.next_edge + edge_offset,
+                    edge.previous_edge + edge_offset });
+            }
+
+            for (size_t i = 1; i < group.dcel.faces.size(); ++i)
+            {
+                result.dcel.faces.push_back({ group.dcel.faces[i].edge + edge_offset });
+                result.is_face_inside.push_back(group.is_face_inside[i]);
+            }
+
+            if (result.dcel.faces[0].edge == no_item && group.dcel.faces[0].edge != no_item)
+            {
+                result.dcel.faces[0].edge = group.dcel.faces[0].edge + edge_offset;
+            }
+        }
+
+        BooleanResult apply_boolean_operation(DCEL const & first,
+            std::vector<size_t> const & first_faces,
+            DCEL const & second,
+            std::vector<size_t> const & second_faces,
+            BooleanOperation operation,
+            BooleanOptions const & options) noexcept
+        {
+            ProfileScope const scope{ "dcel::apply_boolean_operation" };
+
+            std::vector<BoundarySegment> segments{};
+            bool const is_unbounded[2] = {
+                add_region_boundary(first, first_faces, 0, segments),
+                add_region_boundary(second, second_faces, 1, segments) };
+
+            std::vector<std::vector<BoundarySegment>> const groups = get_independent_groups(segments);
+            std::vector<BooleanResult> group_results(groups.size());
+
+            size_t const threads_count = options.threads_count != 0 ?
+                options.threads_count :
+                std::max<size_t>(1, std::thread::hardware_concurrency());
+            size_t const chunks_count = std::max<size_t>(1, std::min({ threads_count, groups.size(), segments.size() / parallel_boolean_threshold }));
+
+            // chunks of the groups with about the same number of segments
+            std::vector<std::future<void>> tasks{};
+            size_t group = 0;
+            size_t segments_done = 0;
+            for (size_t chunk = 0; chunk < chunks_count; ++chunk)
+            {
+                size_t const begin = group;
+                size_t const chunk_end_segments = segments.size() * (chunk + 1) / chunks_count;
+                while (group < groups.size() && (segments_done < chunk_end_segments || chunk + 1 == chunks_count))
+                {
+                    segments_done += groups[group].size();
+                    ++group;
+                }
+
+                auto const apply_to_chunk = [&groups, &group_results, operation, &is_unbounded, begin, end = group]() noexcept
+                    {
+                        for (size_t i = begin; i < end; ++i)
+                        {
+                            group_results[i] = apply_to_group(groups[i], operation, is_unbounded);
+                        }
+                    };
+
+                if (chunks_count == 1)
+                {
+                    apply_to_chunk();
+                }
+                else
+                {
+                    tasks.push_back(std::async(std::launch::async, apply_to_chunk));
+                }
+            }
+
+            for (std::future<void> & task : tasks)
+            {
+                task.wait();
+            }
+
+            BooleanResult result{};
+            result.dcel.faces.push_back({ no_item });
+            result.is_face_inside.push_back(is_inside(operation, is_unbounded[0], is_unbounded[1]));
+
+            for (BooleanResult const & group_result : group_results)
+            {
+                append_group_result(result, group_result);
+            }
+
+            return result;
+        }
+
+        BooleanResult apply_boolean_operation(DCEL const & first,
+            DCEL const & second,
+            BooleanOperation operation,
+            BooleanOptions const & options) noexcept
+        {
+            auto const get_bounded_faces = [](DCEL const & dcel) noexcept
+                {
+                    bool has_edges = false;
+                    for (DCEL::Edge const & edge : dcel.edges)
+                    {
+                        has_edges |= edge.is_exist;
+                    }
+
+                    size_t const outside_face = has_edges ? get_outside_face_index(dcel) : no_item;
+
+                    std::vector<size_t> faces{};
+                    for (size_t i = 0; i < dcel.faces.size(); ++i)
+                    {
+                        if (dcel.faces[i].is_exist && i != outside_face)
+                        {
+                            faces.push_back(i);
+                        }
+                    }
+                    return faces;
+                };
+
+            return apply_boolean_operation(first, get_bounded_faces(first), second, get_bounded_faces(second), operation, options);
+        }
+
+        char const * get_boolean_operation_name(BooleanOperation operation) noexcept
+        {
+            switch (operation)
+            {
+            case BooleanOperation::Union:
+                return "union";
+            case BooleanOperation::Intersection:
+                return "intersection";
+            case BooleanOperation::Difference:
+                return "difference";
+            case BooleanOperation::SymmetricDifference:
+                return "symmetric_difference";
+            default:
+                return "unknown";
+            }
+        }
+    }
+}
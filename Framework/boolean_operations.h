@@ -0,0 +1,56 @@
+#pragma once
+
+
+#include "dcel.h"
+
+#include <vector>
+#include <cstdint>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        enum class BooleanOperation : uint8_t
+        {
+            Union,
+            Intersection,
+            // first without second
+            Difference,
+            SymmetricDifference
+        };
+
+        struct BooleanOptions
+        {
+            // Connected components of the boundaries with overlapping bounding boxes are computed together,
+            // groups apart from each other in parallel. 0 - std::thread::hardware_concurrency()
+            size_t threads_count{ 0 };
+        };
+
+        struct BooleanResult
+        {
+            DCEL dcel;
+            // for every face: 1 if it is a part of the result, 0 for the outside face and the holes
+            std::vector<uint8_t> is_face_inside;
+        };
+
+        // Regions are unions of faces of the inputs, first and second may be the same DCEL.
+        // Only the edges between a selected and a not selected face bound a region, so the overlay
+        // is built by the intersection sweep over the region boundaries, O((n + k)log(n)) for k intersections.
+        // Face 0 of the result is the outside face, the holes of a result face are faces that are not inside.
+        BooleanResult apply_boolean_operation(DCEL const & first,
+            std::vector<size_t> const & first_faces,
+            DCEL const & second,
+            std::vector<size_t> const & second_faces,
+            BooleanOperation operation,
+            BooleanOptions const & options = {}) noexcept;
+
+        // regions are all the faces of the inputs but the outside ones
+        BooleanResult apply_boolean_operation(DCEL const & first,
+            DCEL const & second,
+            BooleanOperation operation,
+            BooleanOptions const & options = {}) noexcept;
+
+        char const * get_boolean_operation_name(BooleanOperation operation) noexcept;
+    }
+}
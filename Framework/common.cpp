@@ -1,5 +1,8 @@
 #include "common.h"
 
+#include "predicates.h"
+#include "counters.h"
+
 #include <string>
 #include <cassert>
 #include <cmath>
@@ -111,63 +114,46 @@ namespace frm
         return std::sqrtf(sqr_distance_between_points(a, b));
     }
 
+    FRM_COUNTER(is_point_on_left_side_counter, "common/is_point_on_left_side", nullptr);
+    FRM_COUNTER(compare_point_by_x_counter, "common/compare_point_by_x", nullptr);
+    FRM_COUNTER(compare_point_by_y_counter, "common/compare_point_by_y", nullptr);
+
+    bool is_point_on_left_side(Point line_begin, Point line_end, Point point) noexcept
+    {
+        FRM_COUNT(is_point_on_left_side_counter);
+
+        return orient2d(line_begin, line_end, point) >= 0.;
+    }
+
     int compare_point_by_x(Point first, Point second) noexcept(!IS_DEBUG)
     {
-        if (abs(first.x - second.x) < frm::epsilon)
-        {
-            if (abs(first.y - second.y) < frm::epsilon)
-            {
-                return 0;
-            }
-            if (first.y - second.y < frm::epsilon)
-            {
-                return 1;
-            }
-            if (first.y - second.y > frm::epsilon)
-            {
-                return -1;
-            }
-        }
-        if (first.x - second.x < frm::epsilon)
+        FRM_COUNT(compare_point_by_x_counter);
+
+        if (first.x != second.x)
         {
-            return 1;
+            return first.x < second.x ? 1 : -1;
         }
-        if (first.x - second.x > frm::epsilon)
+        if (first.y != second.y)
         {
-            return -1;
+            return first.y < second.y ? 1 : -1;
         }
 
-        assert(false && "Compare error");
         return 0;
     }
     
     int compare_point_by_y(Point first, Point second) noexcept(!IS_DEBUG)
     {
-        if (abs(first.y - second.y) < frm::epsilon)
-        {
-            if (abs(first.x - second.x) < frm::epsilon)
-            {
-                return 0;
-            }
-            if (first.x - second.x < frm::epsilon)
-            {
-                return 1;
-            }
-            if (first.x - second.x > frm::epsilon)
-            {
-                return -1;
-            }
-        }
-        if (first.y - second.y < frm::epsilon)
+        FRM_COUNT(compare_point_by_y_counter);
+
+        if (first.y != second.y)
         {
-            return 1;
+            return first.y < second.y ? 1 : -1;
         }
-        if (first.y - second.y > frm::epsilon)
+        if (first.x != second.x)
         {
-            return -1;
+            return first.x < second.x ? 1 : -1;
         }
 
-        assert(false && "Compare error");
         return 0;
     }
 }
\ No newline at end of file
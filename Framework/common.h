@@ -53,10 +53,8 @@ namespace frm
         return point.y > line.x * point.x + line.y;
     }
 
-    static constexpr bool is_point_on_left_side(Point line_begin, Point line_end, Point point) noexcept
-    {
-        return (line_end.x - line_begin.x) * (point.y - line_begin.y) - (line_end.y - line_begin.y) * (point.x - line_begin.x) > -epsilon;
-    }
+    // point on the line counts as left side
+    bool is_point_on_left_side(Point line_begin, Point line_end, Point point) noexcept;
 
     float distance_between_point_and_line_segment(Point line_begin, Point line_end, Point point) noexcept;
 
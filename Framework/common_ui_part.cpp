@@ -2,6 +2,8 @@
 
 #include "imgui/imgui.h"
 
+#include <algorithm>
+
 
 namespace frm
 {
@@ -52,30 +54,115 @@ namespace frm
         );
     }
 
-    void draw_vertex_highlighted(Point point, float circle_color[4], float radius, sf::RenderWindow & window) noexcept
+    static constexpr unsigned marker_texture_size = 64;
+
+    // white disc with antialiased border, its center is used for the edges
+    sf::Texture const & get_marker_texture() noexcept
+    {
+        static sf::Texture const texture = []() noexcept
+        {
+            float const center = marker_texture_size / 2.f;
+
+            sf::Image image{};
+            image.create(marker_texture_size, marker_texture_size, sf::Color::Transparent);
+
+            for (unsigned y = 0; y < marker_texture_size; ++y)
+            {
+                for (unsigned x = 0; x < marker_texture_size; ++x)
+                {
+                    float const distance = distance_between_points({ x + 0.5f, y + 0.5f }, { center, center });
+                    float const alpha = std::max(0.f, std::min(1.f, center - distance));
+
+                    image.setPixel(x, y, sf::Color(255, 255, 255, static_cast<sf::Uint8>(alpha * 255.f)));
+                }
+            }
+
+            sf::Texture result{};
+            result.loadFromImage(image);
+            result.setSmooth(true);
+            return result;
+        }();
+
+        return texture;
+    }
+
+    void set_quad(sf::Vertex * vertices, sf::Vector2f const corners[4], sf::Vector2f const texture_corners[4], sf::Color color) noexcept
     {
-        sf::CircleShape circle{ radius };
-        circle.setFillColor(float4_to_uint8_t4(circle_color));
-        circle.setOrigin(radius, radius);
-        circle.setPosition(point.x, point.y);
-        window.draw(circle);
+        size_t const triangles[marker_vertices_count] = { 0, 1, 2, 0, 2, 3 };
+
+        for (size_t i = 0; i < marker_vertices_count; ++i)
+        {
+            vertices[i] = { corners[triangles[i]], color, texture_corners[triangles[i]] };
+        }
     }
 
-    void draw_edge_highlighted(Point begin_point, Point end_point, float color[4], float width, sf::RenderWindow & window) noexcept
+    void set_vertex_marker(sf::Vertex * vertices, Point point, sf::Color color, float radius) noexcept
     {
-        sf::Vector2f begin{ begin_point.x, begin_point.y };
-        sf::Vector2f end{ end_point.x, end_point.y };
+        float const size = static_cast<float>(marker_texture_size);
 
-        sf::Vector2f target{ end - begin };
+        sf::Vector2f const corners[4] =
+        {
+            { point.x - radius, point.y - radius },
+            { point.x + radius, point.y - radius },
+            { point.x + radius, point.y + radius },
+            { point.x - radius, point.y + radius }
+        };
+        sf::Vector2f const texture_corners[4] = { { 0.f, 0.f }, { size, 0.f }, { size, size }, { 0.f, size } };
 
-        sf::RectangleShape line{ sf::Vector2f(sqrt(target.x * target.x + target.y * target.y), width) };
-        line.setFillColor(float4_to_uint8_t4(color));
-        line.setOrigin(0.f, width / 2.f);
-        line.setRotation(atan2(target.y, target.x) * 180.f / 3.14f);
-        line.setPosition(begin);
-        window.draw(line);
+        set_quad(vertices, corners, texture_corners, color);
+    }
 
-        draw_vertex_highlighted(begin_point, color, width, window);
+    void add_vertex_marker(MarkerBatch & batch, Point point, sf::Color color, float radius) noexcept
+    {
+        batch.vertices.resize(batch.vertices.size() + marker_vertices_count);
+        set_vertex_marker(&batch.vertices[batch.vertices.size() - marker_vertices_count], point, color, radius);
     }
 
-}
\ No newline at end of file
+    void add_edge_marker(MarkerBatch & batch, Point begin_point, Point end_point, sf::Color color, float width) noexcept
+    {
+        float const length = distance_between_points(begin_point, end_point);
+
+        if (length > 0.f)
+        {
+            // half of the width along the normal
+            Point const offset = (width / 2.f / length) * Point{ begin_point.y - end_point.y, end_point.x - begin_point.x };
+
+            sf::Vector2f const corners[4] =
+            {
+                { begin_point.x + offset.x, begin_point.y + offset.y },
+                { end_point.x + offset.x, end_point.y + offset.y },
+                { end_point.x - offset.x, end_point.y - offset.y },
+                { begin_point.x - offset.x, begin_point.y - offset.y }
+            };
+
+            // every corner samples the opaque center of the disc
+            sf::Vector2f const center{ marker_texture_size / 2.f, marker_texture_size / 2.f };
+            sf::Vector2f const texture_corners[4] = { center, center, center, center };
+
+            batch.vertices.resize(batch.vertices.size() + marker_vertices_count);
+            set_quad(&batch.vertices[batch.vertices.size() - marker_vertices_count], corners, texture_corners, color);
+        }
+
+        add_vertex_marker(batch, begin_point, color, width);
+    }
+
+    sf::RenderStates get_marker_render_states() noexcept
+    {
+        return sf::RenderStates{ &get_marker_texture() };
+    }
+
+    void draw(MarkerBatch const & batch, sf::RenderWindow & window) noexcept
+    {
+        window.draw(batch.vertices.data(), batch.vertices.size(), sf::Triangles, get_marker_render_states());
+    }
+
+    void draw_vertex_highlighted(MarkerBatch & batch, Point point, float circle_color[4], float radius) noexcept
+    {
+        add_vertex_marker(batch, point, float4_to_uint8_t4(circle_color), radius);
+    }
+
+    void draw_edge_highlighted(MarkerBatch & batch, Point begin_point, Point end_point, float color[4], float width) noexcept
+    {
+        add_edge_marker(batch, begin_point, end_point, float4_to_uint8_t4(color), width);
+    }
+}
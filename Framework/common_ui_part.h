@@ -5,6 +5,8 @@
 
 #include "SFML\Graphics.hpp"
 
+#include <vector>
+
 
 namespace frm
 {
@@ -12,7 +14,28 @@ namespace frm
 
     sf::Color float4_to_uint8_t4(float circle_color[4]) noexcept;
 
-    void draw_vertex_highlighted(Point point, float circle_color[4], float radius, sf::RenderWindow & window) noexcept;
+    // Vertex discs and thick edges as textured triangles of one texture,
+    // so any number of them is drawn with a single draw call
+    struct MarkerBatch
+    {
+        std::vector<sf::Vertex> vertices{};
+    };
+
+    // each marker takes marker_vertices_count vertices
+    static constexpr size_t marker_vertices_count = 6;
+
+    void add_vertex_marker(MarkerBatch & batch, Point point, sf::Color color, float radius) noexcept;
+    void add_edge_marker(MarkerBatch & batch, Point begin_point, Point end_point, sf::Color color, float width) noexcept;
+
+    // writes the vertex marker to the vertices of an already added marker
+    void set_vertex_marker(sf::Vertex * vertices, Point point, sf::Color color, float radius) noexcept;
+
+    sf::RenderStates get_marker_render_states() noexcept;
+
+    void draw(MarkerBatch const & batch, sf::RenderWindow & window) noexcept;
+
+    // Markers of the ui colors, the caller draws the batch once per frame
+    void draw_vertex_highlighted(MarkerBatch & batch, Point point, float circle_color[4], float radius) noexcept;
 
-    void draw_edge_highlighted(Point begin_point, Point end_point, float color[4], float width, sf::RenderWindow & window) noexcept;
+    void draw_edge_highlighted(MarkerBatch & batch, Point begin_point, Point end_point, float color[4], float width) noexcept;
 }
\ No newline at end of file
@@ -0,0 +1,451 @@
+#include "convex_hull.h"
+
+#include "quick_hull.h"
+#include "predicates.h"
+#include "counters.h"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+
+namespace frm
+{
+    bool is_left_turn(Point begin, Point end, Point point) noexcept
+    {
+        return orient2d(begin, end, point) > 0.;
+    }
+
+    bool is_same_point(Point a, Point b) noexcept
+    {
+        return a.x == b.x && a.y == b.y;
+    }
+
+    // Maps float to unsigned integer with the same order, -0 and +0 are equal
+    uint32_t float_to_ordered_bits(float value) noexcept
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        // on bits, so fast floating point models can not drop it
+        if ((bits & 0x7FFFFFFFu) == 0)
+        {
+            bits = 0;
+        }
+
+        return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    }
+
+    // Sorts indices of points by x and then by y, the sort is stable,
+    // so ascending indices end up sorted by x, then by y, then by index.
+    // LSD radix sort over 64 bit keys by 16 bit digits, digits equal for all keys are skipped.
+    std::vector<size_t> radix_sort_by_x(Point const * points, std::vector<size_t> indices) noexcept
+    {
+        size_t const size = indices.size();
+        std::vector<uint64_t> keys(size);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            keys[i] = (static_cast<uint64_t>(float_to_ordered_bits(points[indices[i]].x)) << 32) |
+                float_to_ordered_bits(points[indices[i]].y);
+        }
+
+        std::vector<uint64_t> sorted_keys(size);
+        std::vector<size_t> sorted_indices(size);
+
+        std::vector<size_t> offsets(1 << 16);
+
+        for (size_t shift = 0; shift < 64; shift += 16)
+        {
+            std::fill(offsets.begin(), offsets.end(), 0);
+
+            for (uint64_t const key : keys)
+            {
+                ++offsets[(key >> shift) & 0xFFFF];
+            }
+
+            if (size == 0 || offsets[(keys[0] >> shift) & 0xFFFF] == size)
+            {
+                continue;
+            }
+
+            size_t sum = 0;
+            for (size_t & offset : offsets)
+            {
+                size_t const count = offset;
+                offset = sum;
+                sum += count;
+            }
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                size_t const position = offsets[(keys[i] >> shift) & 0xFFFF]++;
+                sorted_keys[position] = keys[i];
+                sorted_indices[position] = indices[i];
+            }
+
+            keys.swap(sorted_keys);
+            indices.swap(sorted_indices);
+        }
+
+        return indices;
+    }
+
+    // sorted_indices - indices sorted by x, then by y, then by index
+    // Returns hull vertices counterclockwise starting from the leftmost one
+    std::vector<size_t> monotone_chain_sorted(Point const * points, std::vector<size_t> const & sorted_indices) noexcept
+    {
+        // of equal points the one with the lowest index is used
+        std::vector<size_t> unique_indices{};
+        unique_indices.reserve(sorted_indices.size());
+
+        for (size_t const index : sorted_indices)
+        {
+            if (unique_indices.empty() || !is_same_point(points[unique_indices.back()], points[index]))
+            {
+                unique_indices.push_back(index);
+            }
+        }
+
+        if (unique_indices.size() < 3)
+        {
+            return unique_indices;
+        }
+
+        std::vector<size_t> hull{};
+        hull.reserve(unique_indices.size() + 1);
+
+        // lower hull
+        for (size_t const index : unique_indices)
+        {
+            while (hull.size() >= 2 && !is_left_turn(points[hull[hull.size() - 2]], points[hull.back()], points[index]))
+            {
+                hull.pop_back();
+            }
+            hull.push_back(index);
+        }
+
+        // upper hull
+        size_t const lower_size = hull.size() + 1;
+        for (size_t i = unique_indices.size() - 1; i-- > 0;)
+        {
+            size_t const index = unique_indices[i];
+
+            while (hull.size() >= lower_size && !is_left_turn(points[hull[hull.size() - 2]], points[hull.back()], points[index]))
+            {
+                hull.pop_back();
+            }
+            hull.push_back(index);
+        }
+
+        // first point is repeated at the end
+        hull.pop_back();
+
+        return hull;
+    }
+
+    std::vector<size_t> monotone_chain(Point const * points, size_t size) noexcept
+    {
+        std::vector<size_t> indices(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            indices[i] = i;
+        }
+
+        return monotone_chain_sorted(points, radix_sort_by_x(points, std::move(indices)));
+    }
+
+    // Below this size clearing the 2^16 digit counters of the radix sort costs more than a comparison sort
+    static constexpr size_t radix_sort_min_size = 1 << 12;
+
+    // candidates - any subset of points that contains all hull vertices
+    std::vector<size_t> monotone_chain_of_candidates(Point const * points, std::vector<size_t> candidates) noexcept
+    {
+        if (candidates.size() >= radix_sort_min_size)
+        {
+            // the radix sort keeps equal points by index only if they come in ascending order
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+            return monotone_chain_sorted(points, radix_sort_by_x(points, std::move(candidates)));
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [points](size_t a, size_t b) noexcept
+            {
+                if (points[a].x != points[b].x)
+                {
+                    return points[a].x < points[b].x;
+                }
+                if (points[a].y != points[b].y)
+                {
+                    return points[a].y < points[b].y;
+                }
+                return a < b;
+            });
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        return monotone_chain_sorted(points, candidates);
+    }
+
+    std::vector<size_t> quick_hull_vertices(Point const * points, size_t size) noexcept(!IS_DEBUG)
+    {
+        vvve::VVVE vvve{};
+        vvve.vertices.resize(size);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            vvve.vertices[i].coordinate = points[i];
+        }
+
+        quick_hull_parallel(vvve);
+
+        std::vector<size_t> candidates{};
+        candidates.reserve(2 * vvve.edges.size());
+
+        for (vvve::VVVE::edge_t const & edge : vvve.edges)
+        {
+            candidates.push_back(edge.first);
+            candidates.push_back(edge.second);
+        }
+
+        return monotone_chain_of_candidates(points, std::move(candidates));
+    }
+
+    // Returns index of point that all other points of the group hull are on the left side of the line from point to it.
+    // group_hull - counterclockwise
+    // tangent - position in group_hull to start from, it only moves forward while the wrapping goes around
+    size_t get_group_tangent(Point const * points, std::vector<size_t> const & group_hull, size_t point_index, size_t & tangent) noexcept
+    {
+        Point const point = points[point_index];
+        size_t const size = group_hull.size();
+
+        for (size_t step = 0; step < size; ++step)
+        {
+            size_t const current = group_hull[tangent % size];
+            size_t const next = group_hull[(tangent + 1) % size];
+
+            double const turn = orient2d(point, points[current], points[next]);
+
+            bool const need_move = is_same_point(points[current], point) ||
+                turn < 0. ||
+                (turn == 0. && sqr_distance_between_points(point, points[next]) > sqr_distance_between_points(point, points[current]));
+
+            if (!need_move)
+            {
+                break;
+            }
+
+            ++tangent;
+        }
+
+        return group_hull[tangent % size];
+    }
+
+    // Linear search of the first tangent, afterwards tangents are only advanced
+    size_t find_group_tangent(Point const * points, std::vector<size_t> const & group_hull, size_t point_index, size_t & tangent) noexcept
+    {
+        Point const point = points[point_index];
+
+        size_t best = std::numeric_limits<size_t>::max();
+
+        for (size_t i = 0; i < group_hull.size(); ++i)
+        {
+            Point const current = points[group_hull[i]];
+
+            if (is_same_point(current, point))
+            {
+                continue;
+            }
+
+            if (best == std::numeric_limits<size_t>::max())
+            {
+                best = i;
+                continue;
+            }
+
+            double const turn = orient2d(point, points[group_hull[best]], current);
+
+            if (turn < 0. ||
+                (turn == 0. && sqr_distance_between_points(point, current) > sqr_distance_between_points(point, points[group_hull[best]])))
+            {
+                best = i;
+            }
+        }
+
+        tangent = best == std::numeric_limits<size_t>::max() ? 0 : best;
+
+        return group_hull[tangent];
+    }
+
+    // Chan's algorithm with hull wrapping over group hulls
+    std::vector<size_t> chan(Point const * points, size_t size) noexcept
+    {
+        if (size < 3)
+        {
+            return monotone_chain(points, size);
+        }
+
+        size_t start_index = 0;
+        for (size_t i = 1; i < size; ++i)
+        {
+            if (points[i].x < points[start_index].x ||
+                (points[i].x == points[start_index].x && points[i].y < points[start_index].y))
+            {
+                start_index = i;
+            }
+        }
+
+        for (size_t t = 1;; ++t)
+        {
+            size_t const exponent = size_t{ 1 } << std::min<size_t>(t, 5);
+            size_t const group_size = exponent >= 64 ? size : std::min(size, size_t{ 1 } << exponent);
+            size_t const groups_count = (size + group_size - 1) / group_size;
+
+            std::vector<std::vector<size_t>> group_hulls(groups_count);
+
+            for (size_t group = 0; group < groups_count; ++group)
+            {
+                size_t const group_begin = group * group_size;
+                size_t const group_end = std::min(size, group_begin + group_size);
+
+                std::vector<size_t> group_indices(group_end - group_begin);
+                for (size_t i = group_begin; i < group_end; ++i)
+                {
+                    group_indices[i - group_begin] = i;
+                }
+
+                group_hulls[group] = monotone_chain_of_candidates(points, std::move(group_indices));
+            }
+
+            std::vector<size_t> tangents(groups_count, 0);
+            std::vector<size_t> hull{ start_index };
+
+            bool is_closed = false;
+
+            for (size_t step = 0; step < group_size && !is_closed; ++step)
+            {
+                size_t const current_index = hull.back();
+                Point const current = points[current_index];
+
+                size_t best_index = std::numeric_limits<size_t>::max();
+
+                for (size_t group = 0; group < groups_count; ++group)
+                {
+                    size_t const candidate_index = step == 0 ?
+                        find_group_tangent(points, group_hulls[group], current_index, tangents[group]) :
+                        get_group_tangent(points, group_hulls[group], current_index, tangents[group]);
+
+                    if (is_same_point(points[candidate_index], current))
+                    {
+                        continue;
+                    }
+
+                    if (best_index == std::numeric_limits<size_t>::max())
+                    {
+                        best_index = candidate_index;
+                        continue;
+                    }
+
+                    double const turn = orient2d(current, points[best_index], points[candidate_index]);
+
+                    if (turn < 0. ||
+                        (turn == 0. &&
+                            sqr_distance_between_points(current, points[candidate_index]) > sqr_distance_between_points(current, points[best_index])))
+                    {
+                        best_index = candidate_index;
+                    }
+                }
+
+                if (best_index == std::numeric_limits<size_t>::max() || best_index == start_index)
+                {
+                    is_closed = true;
+                }
+                else
+                {
+                    hull.push_back(best_index);
+                }
+            }
+
+            if (is_closed || group_size == size)
+            {
+                return monotone_chain_of_candidates(points, std::move(hull));
+            }
+        }
+    }
+
+    FRM_OPERATION_COUNTERS(convex_hull_counters, "convex_hull");
+
+    std::vector<vvve::VVVE::edge_t> convex_hull(Point const * points, size_t size, HullAlgorithm algorithm) noexcept(!IS_DEBUG)
+    {
+        FRM_COUNT_OPERATION(convex_hull_counters);
+
+        std::vector<size_t> hull{};
+
+        switch (algorithm)
+        {
+        case HullAlgorithm::QuickHull:
+            hull = size >= 3 ? quick_hull_vertices(points, size) : monotone_chain(points, size);
+            break;
+        case HullAlgorithm::MonotoneChain:
+            hull = monotone_chain(points, size);
+            break;
+        case HullAlgorithm::Chan:
+            hull = chan(points, size);
+            break;
+        default:
+            assert(false && "Unknown hull algorithm");
+        }
+
+        std::vector<vvve::VVVE::edge_t> edges{};
+
+        if (hull.size() < 2)
+        {
+            return edges;
+        }
+
+        edges.reserve(hull.size());
+
+        for (size_t i = 0; i < hull.size(); ++i)
+        {
+            edges.push_back({ hull[i], hull[(i + 1) % hull.size()] });
+        }
+
+        if (hull.size() == 2)
+        {
+            edges.pop_back();
+        }
+
+        return edges;
+    }
+
+    void convex_hull(vvve::VVVE & vvve, HullAlgorithm algorithm) noexcept(!IS_DEBUG)
+    {
+        std::vector<Point> points(vvve.vertices.size());
+
+        for (size_t i = 0; i < vvve.vertices.size(); ++i)
+        {
+            points[i] = vvve.vertices[i].coordinate;
+        }
+
+        std::vector<vvve::VVVE::edge_t> const edges = convex_hull(points.data(), points.size(), algorithm);
+
+        vvve::mark_structure_changed(vvve);
+        vvve.edges.insert(vvve.edges.end(), edges.begin(), edges.end());
+    }
+
+    char const * get_hull_algorithm_name(HullAlgorithm algorithm) noexcept
+    {
+        switch (algorithm)
+        {
+        case HullAlgorithm::QuickHull:
+            return "QuickHull";
+        case HullAlgorithm::MonotoneChain:
+            return "Monotone chain";
+        case HullAlgorithm::Chan:
+            return "Chan";
+        default:
+            return "Unknown";
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+
+#include "vvve.h"
+
+
+namespace frm
+{
+    enum class HullAlgorithm : uint8_t
+    {
+        // O(nlog(n)) on average, O(n^2) worst case
+        QuickHull,
+        // O(n) radix sort by x + O(n) scan
+        MonotoneChain,
+        // O(nlog(h)), h - amount of hull vertices
+        Chan
+    };
+
+    // Edges between indices of points along the hull, counterclockwise
+    // (with y axis pointing up) starting from the leftmost point.
+    // Collinear points on the hull are skipped.
+    // Output does not depend on the chosen algorithm.
+    std::vector<vvve::VVVE::edge_t> convex_hull(Point const * points, size_t size, HullAlgorithm algorithm) noexcept(!IS_DEBUG);
+
+    // Appends hull edges to vvve.edges
+    void convex_hull(vvve::VVVE & vvve, HullAlgorithm algorithm) noexcept(!IS_DEBUG);
+
+    char const * get_hull_algorithm_name(HullAlgorithm algorithm) noexcept;
+}
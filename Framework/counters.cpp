@@ -0,0 +1,245 @@
+#include "counters.h"
+
+#include "imgui/imgui.h"
+
+#include <new>
+#include <mutex>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace frm
+{
+    struct CounterRegistry
+    {
+        std::mutex mutex{};
+        std::vector<Counter *> counters{};
+    };
+
+    // counters are statics of other translation units, so the registry is created by the first of them
+    CounterRegistry & get_counter_registry() noexcept
+    {
+        static CounterRegistry registry{};
+        return registry;
+    }
+
+    // allocations of the process, operator new below counts them if counting is on
+    static std::atomic<uint64_t> allocations_count{ 0 };
+    static std::atomic<uint64_t> allocated_bytes{ 0 };
+
+    Counter::Counter(char const * name, Counter const * per) noexcept
+        : name{ name },
+        per{ per }
+    {
+        CounterRegistry & registry = get_counter_registry();
+        std::lock_guard<std::mutex> const lock{ registry.mutex };
+
+        registry.counters.push_back(this);
+    }
+
+    OperationCounters::OperationCounters(char const * name) noexcept
+        : calls_name{ std::string{ name } + "/calls" },
+        allocations_name{ std::string{ name } + "/allocations" },
+        allocated_bytes_name{ std::string{ name } + "/allocated_bytes" },
+        calls{ calls_name.c_str(), nullptr },
+        allocations{ allocations_name.c_str(), &calls },
+        allocated_bytes{ allocated_bytes_name.c_str(), &calls }
+    {
+    }
+
+    OperationScope::OperationScope(OperationCounters & counters) noexcept
+        : counters{ counters },
+        allocations_begin{ get_allocations_count() },
+        allocated_bytes_begin{ get_allocated_bytes() }
+    {
+        counters.calls.value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    OperationScope::~OperationScope()
+    {
+        // allocations of other threads during the scope are counted too, parallel parts of the operation among them
+        counters.allocations.value.fetch_add(get_allocations_count() - allocations_begin, std::memory_order_relaxed);
+        counters.allocated_bytes.value.fetch_add(get_allocated_bytes() - allocated_bytes_begin, std::memory_order_relaxed);
+    }
+
+    std::vector<CounterValue> get_counter_values() noexcept
+    {
+        CounterRegistry & registry = get_counter_registry();
+        std::vector<CounterValue> values{};
+
+        {
+            std::lock_guard<std::mutex> const lock{ registry.mutex };
+
+            values.reserve(registry.counters.size());
+            for (Counter const * const counter : registry.counters)
+            {
+                values.push_back({
+                    counter->name,
+                    counter->value.load(std::memory_order_relaxed),
+                    counter->per == nullptr ? nullptr : counter->per->name,
+                    counter->per == nullptr ? 0 : counter->per->value.load(std::memory_order_relaxed) });
+            }
+        }
+
+        std::sort(values.begin(), values.end(), [](CounterValue const & first, CounterValue const & second) noexcept
+            {
+                return std::string_view{ first.name } < std::string_view{ second.name };
+            });
+
+        return values;
+    }
+
+    void reset_counters() noexcept
+    {
+        CounterRegistry & registry = get_counter_registry();
+        std::lock_guard<std::mutex> const lock{ registry.mutex };
+
+        for (Counter * const counter : registry.counters)
+        {
+            counter->value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t get_allocations_count() noexcept
+    {
+        return allocations_count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t get_allocated_bytes() noexcept
+    {
+        return allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    double get_counter_ratio(CounterValue const & value) noexcept
+    {
+        return value.per_value == 0 ? 0. : static_cast<double>(value.value) / static_cast<double>(value.per_value);
+    }
+
+    void write_counters_json(std::ostream & os) noexcept
+    {
+        os << '{';
+
+        bool is_first = true;
+        for (CounterValue const & value : get_counter_values())
+        {
+            if (value.value == 0)
+            {
+                continue;
+            }
+
+            os << (is_first ? "" : ", ") << '"' << value.name << "\": " << value.value;
+            if (value.per_name != nullptr)
+            {
+                os << ", \"" << value.name << " per " << value.per_name << "\": " << get_counter_ratio(value);
+            }
+            is_first = false;
+        }
+
+        os << '}';
+    }
+
+    bool save_counters_to_json(std::string const & path) noexcept
+    {
+        std::ofstream file_output{ path };
+        if (!file_output)
+        {
+            return false;
+        }
+
+        write_counters_json(file_output);
+        file_output << '\n';
+
+        return static_cast<bool>(file_output);
+    }
+
+    void show_counters_ui() noexcept
+    {
+        // values of the previous frame
+        static std::unordered_map<char const *, uint64_t> previous_values{};
+
+        bool need_save_json = false;
+
+        if (ImGui::Begin("Counters"))
+        {
+            if (!is_counting)
+            {
+                ImGui::TextUnformatted("Counting is off, build with IS_COUNTING=true");
+            }
+
+            if (ImGui::Button("Reset"))
+            {
+                reset_counters();
+                previous_values.clear();
+            }
+            ImGui::SameLine();
+            need_save_json = ImGui::Button("Save JSON");
+
+            ImGui::Columns(4, "counters");
+            ImGui::TextUnformatted("Name");
+            ImGui::NextColumn();
+            ImGui::TextUnformatted("Total");
+            ImGui::NextColumn();
+            ImGui::TextUnformatted("Last frame");
+            ImGui::NextColumn();
+            ImGui::TextUnformatted("Per");
+            ImGui::NextColumn();
+            ImGui::Separator();
+
+            for (CounterValue const & value : get_counter_values())
+            {
+                uint64_t & previous_value = previous_values[value.name];
+
+                ImGui::TextUnformatted(value.name);
+                ImGui::NextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(value.value));
+                ImGui::NextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(value.value - std::min(previous_value, value.value)));
+                ImGui::NextColumn();
+                if (value.per_name != nullptr)
+                {
+                    ImGui::Text("%.2f per %s", get_counter_ratio(value), value.per_name);
+                }
+                ImGui::NextColumn();
+
+                previous_value = value.value;
+            }
+
+            ImGui::Columns(1);
+        }
+        ImGui::End();
+
+        if (need_save_json)
+        {
+            save_counters_to_json("counters.json");
+        }
+    }
+}
+
+#if IS_COUNTING
+// every allocation of the process, the default operator new[] calls this one too
+void * operator new(size_t size)
+{
+    frm::allocations_count.fetch_add(1, std::memory_order_relaxed);
+    frm::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void * const pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+
+// IS_COUNTING=true in the preprocessor definitions of a project turns the counters on,
+// otherwise the macros below expand to nothing and the geometry code has no counters at all
+#ifndef IS_COUNTING
+#define IS_COUNTING false
+#endif
+
+#if IS_COUNTING
+// static counter of the translation unit, per_counter is a counter declared before it or nullptr
+#define FRM_COUNTER(counter, name, per_counter) static ::frm::Counter counter{ name, per_counter }
+#define FRM_COUNT(counter) counter.value.fetch_add(1, std::memory_order_relaxed)
+#define FRM_COUNT_N(counter, amount) counter.value.fetch_add(static_cast<uint64_t>(amount), std::memory_order_relaxed)
+// counters of calls and allocations of an operation
+#define FRM_OPERATION_COUNTERS(counters, name) static ::frm::OperationCounters counters{ name }
+#define FRM_COUNT_OPERATION(counters) ::frm::OperationScope const counters##_scope{ counters }
+#else
+#define FRM_COUNTER(counter, name, per_counter)
+#define FRM_COUNT(counter)
+#define FRM_COUNT_N(counter, amount)
+#define FRM_OPERATION_COUNTERS(counters, name)
+#define FRM_COUNT_OPERATION(counters)
+#endif
+
+
+namespace frm
+{
+    static constexpr bool is_counting = IS_COUNTING;
+
+    // Counter of events of any thread, registers itself, so it has to live until the end of the program.
+    // Reports divide its value by the value of per, if there is one (nodes visited per query).
+    struct Counter
+    {
+        Counter(char const * name, Counter const * per) noexcept;
+
+        Counter(Counter const &) = delete;
+        Counter & operator=(Counter const &) = delete;
+
+        char const * name;
+        Counter const * per;
+        std::atomic<uint64_t> value{ 0 };
+    };
+
+    // <name>/calls and the allocations made by all threads during the calls
+    struct OperationCounters
+    {
+        explicit OperationCounters(char const * name) noexcept;
+
+        std::string const calls_name;
+        std::string const allocations_name;
+        std::string const allocated_bytes_name;
+
+        Counter calls;
+        Counter allocations;
+        Counter allocated_bytes;
+    };
+
+    struct OperationScope
+    {
+        explicit OperationScope(OperationCounters & counters) noexcept;
+        ~OperationScope();
+
+        OperationScope(OperationScope const &) = delete;
+        OperationScope & operator=(OperationScope const &) = delete;
+
+        OperationCounters & counters;
+        uint64_t allocations_begin;
+        uint64_t allocated_bytes_begin;
+    };
+
+    struct CounterValue
+    {
+        char const * name;
+        uint64_t value;
+        // nullptr if the counter is not divided by another one
+        char const * per_name;
+        uint64_t per_value;
+    };
+
+    // every registered counter sorted by name, empty if counting is off
+    std::vector<CounterValue> get_counter_values() noexcept;
+
+    void reset_counters() noexcept;
+
+    // Allocations of the whole process, counted by operator new of the counters.
+    // Always 0 if counting is off.
+    uint64_t get_allocations_count() noexcept;
+    uint64_t get_allocated_bytes() noexcept;
+
+    // {"name": value, ...} of the counters above 0, a counter with per also gets "name per per_name": ratio
+    void write_counters_json(std::ostream & os) noexcept;
+    bool save_counters_to_json(std::string const & path) noexcept;
+
+    // values, ratios and the change since the previous frame
+    void show_counters_ui() noexcept;
+}
@@ -1,6 +1,7 @@
 #include "dcel.h"
 
-#include "trapezoidal_decomposition.h"
+#include "point_in_face.h"
+#include "predicates.h"
 
 #include "imgui/imgui.h"
 
@@ -73,6 +74,8 @@ namespace frm
 
         std::istream & operator>>(std::istream & is, DCEL & dcel) noexcept
         {
+            mark_changed(dcel);
+
             std::string additional_symbols;
 
             is >> additional_symbols;
@@ -317,29 +320,192 @@ namespace frm
             return index;
         }
 
+        void add_operation(DCEL & dcel, bool is_untracked) noexcept
+        {
+            if (dcel.journal.is_enabled)
+            {
+                dcel.journal.operations.push_back({ dcel.version, dcel.journal.changes.size(), 0, is_untracked });
+            }
+        }
+
+        template<typename T>
+        void record_change(DCEL & dcel,
+            Change::Element element,
+            Change::Kind kind,
+            size_t index,
+            std::vector<T> const & records,
+            std::vector<T> & previous_records) noexcept
+        {
+            Journal & journal = dcel.journal;
+
+            if (journal.is_enabled)
+            {
+                assert(!journal.operations.empty());
+
+                bool const is_appended = index >= records.size();
+
+                journal.changes.push_back({ element, kind, is_appended, index });
+                ++journal.operations.back().changes_count;
+
+                if (journal.is_keeping_previous_records && !is_appended)
+                {
+                    previous_records.push_back(records[index]);
+                }
+            }
+        }
+
+        void record_vertex_change(DCEL & dcel, size_t vertex_index, Change::Kind kind = Change::Kind::Modified) noexcept
+        {
+            record_change(dcel, Change::Element::Vertex, kind, vertex_index, dcel.vertices, dcel.journal.previous_vertices);
+        }
+
+        void record_edge_change(DCEL & dcel, size_t edge_index, Change::Kind kind = Change::Kind::Modified) noexcept
+        {
+            record_change(dcel, Change::Element::Edge, kind, edge_index, dcel.edges, dcel.journal.previous_edges);
+        }
+
+        void record_face_change(DCEL & dcel, size_t face_index, Change::Kind kind = Change::Kind::Modified) noexcept
+        {
+            record_change(dcel, Change::Element::Face, kind, face_index, dcel.faces, dcel.journal.previous_faces);
+        }
+
+        // index the next get_free_index call returns
+        template<typename T_1, typename T_2>
+        size_t get_next_free_index(std::vector<T_1> const & free_indices, std::vector<T_2> const & data) noexcept
+        {
+            return free_indices.empty() ? data.size() : free_indices.back();
+        }
+
+        // the slot is recorded before get_free_index clears it
         size_t get_free_vertex_index(DCEL & dcel) noexcept
         {
+            record_vertex_change(dcel, get_next_free_index(dcel.free_vertices, dcel.vertices), Change::Kind::Inserted);
             return get_free_index(dcel.free_vertices, dcel.vertices);
         }
 
         size_t get_free_face_index(DCEL & dcel) noexcept
         {
+            record_face_change(dcel, get_next_free_index(dcel.free_faces, dcel.faces), Change::Kind::Inserted);
             return get_free_index(dcel.free_faces, dcel.faces);
         }
 
         size_t get_free_edge_index(DCEL & dcel) noexcept
         {
+            record_edge_change(dcel, get_next_free_index(dcel.free_edges, dcel.edges), Change::Kind::Inserted);
             return get_free_index(dcel.free_edges, dcel.edges);
         }
 
+        // counts a change made by the functions below, they record its elements themselves
+        void begin_operation(DCEL & dcel, bool is_geometry_changed) noexcept
+        {
+            ++dcel.version;
+            ++dcel.structure_version;
+            if (is_geometry_changed)
+            {
+                ++dcel.geometry_version;
+            }
+            dcel.moved_vertex = std::numeric_limits<size_t>::max();
+
+            add_operation(dcel, false);
+        }
+
+        void mark_changed(DCEL & dcel) noexcept
+        {
+            ++dcel.version;
+            ++dcel.structure_version;
+            ++dcel.geometry_version;
+            dcel.moved_vertex = std::numeric_limits<size_t>::max();
+
+            add_operation(dcel, true);
+        }
+
+        void mark_structure_changed(DCEL & dcel) noexcept
+        {
+            ++dcel.version;
+            ++dcel.structure_version;
+            dcel.moved_vertex = std::numeric_limits<size_t>::max();
+
+            add_operation(dcel, true);
+        }
+
+        void move_vertex(DCEL & dcel, size_t vertex_index, Point coordinate) noexcept
+        {
+            ++dcel.version;
+            ++dcel.geometry_version;
+            dcel.moved_vertex = vertex_index;
+
+            add_operation(dcel, false);
+            record_vertex_change(dcel, vertex_index);
+
+            dcel.vertices[vertex_index].coordinate = coordinate;
+        }
+
+        void enable_journal(DCEL & dcel, bool need_previous_records) noexcept
+        {
+            if (!dcel.journal.is_enabled || dcel.journal.is_keeping_previous_records != need_previous_records)
+            {
+                dcel.journal.is_enabled = true;
+                dcel.journal.is_keeping_previous_records = need_previous_records;
+                clear_journal(dcel);
+            }
+        }
+
+        void disable_journal(DCEL & dcel) noexcept
+        {
+            dcel.journal.is_enabled = false;
+            dcel.journal.is_keeping_previous_records = false;
+            clear_journal(dcel);
+        }
+
+        void clear_journal(DCEL & dcel) noexcept
+        {
+            dcel.journal.first_version = dcel.version;
+            dcel.journal.operations.clear();
+            dcel.journal.changes.clear();
+            dcel.journal.previous_vertices.clear();
+            dcel.journal.previous_edges.clear();
+            dcel.journal.previous_faces.clear();
+        }
+
+        bool get_changes_since(DCEL const & dcel, size_t version, std::vector<Change> & changes) noexcept
+        {
+            Journal const & journal = dcel.journal;
+
+            if (!journal.is_enabled || version < journal.first_version || version > dcel.version)
+            {
+                return false;
+            }
+
+            assert(journal.first_version + journal.operations.size() == dcel.version);
+
+            for (size_t i = version - journal.first_version; i < journal.operations.size(); ++i)
+            {
+                Journal::Operation const & operation = journal.operations[i];
+
+                if (operation.is_untracked)
+                {
+                    return false;
+                }
+
+                auto const first_change = journal.changes.begin() + static_cast<std::ptrdiff_t>(operation.first_change);
+                changes.insert(changes.end(), first_change, first_change + static_cast<std::ptrdiff_t>(operation.changes_count));
+            }
+
+            return true;
+        }
+
         void add_vertex(DCEL & dcel, Point coordinate) noexcept
         {
+            begin_operation(dcel, false);
+
             size_t const vertex_index = get_free_vertex_index(dcel);
             dcel.vertices[vertex_index] = { coordinate, std::numeric_limits<size_t>::max() };
         }
 
         void add_vertex_and_split_edge(DCEL & dcel, Point coordinate, size_t edge_index) noexcept
         {
+            begin_operation(dcel, false);
+
             size_t const current_edge_index = edge_index;
             size_t const next_after_current_edge_index = dcel.edges[current_edge_index].next_edge;
 
@@ -357,6 +523,11 @@ namespace frm
 
             size_t const edge_from_new_to_current_index = get_free_edge_index(dcel);
 
+            record_edge_change(dcel, current_edge_index);
+            record_edge_change(dcel, next_after_current_edge_index);
+            record_edge_change(dcel, twin_edge_index);
+            record_edge_change(dcel, next_after_twin_edge_index);
+
             DCEL::Edge & current_edge = dcel.edges[current_edge_index];
             DCEL::Edge & next_after_current_edge = dcel.edges[next_after_current_edge_index];
             DCEL::Edge & twin_edge = dcel.edges[twin_edge_index];
@@ -391,6 +562,8 @@ namespace frm
 
         void add_vertex_and_connect_to_edge_origin(DCEL & dcel, Point coordinate, size_t edge_index) noexcept
         {
+            begin_operation(dcel, false);
+
             size_t const current_edge_index = edge_index;
             size_t const previous_to_current_edge_index = dcel.edges[edge_index].previous_edge;
 
@@ -402,6 +575,9 @@ namespace frm
             size_t const edge_to_new_index = get_free_edge_index(dcel);
             size_t const edge_from_new_index = get_free_edge_index(dcel);
 
+            record_edge_change(dcel, current_edge_index);
+            record_edge_change(dcel, previous_to_current_edge_index);
+
             DCEL::Edge & current_edge = dcel.edges[current_edge_index];
             DCEL::Edge & previous_to_current_edge = dcel.edges[previous_to_current_edge_index];
             DCEL::Edge & edge_to_new = dcel.edges[edge_to_new_index];
@@ -428,6 +604,8 @@ namespace frm
 
         std::pair<size_t, size_t> add_edge_between_two_edges(DCEL & dcel, size_t begin_edge_index, size_t end_edge_index) noexcept
         {
+            begin_operation(dcel, false);
+
             size_t const previous_to_begin_edge_index = dcel.edges[begin_edge_index].previous_edge;
             size_t const previous_to_end_edge_index = dcel.edges[end_edge_index].previous_edge;
 
@@ -442,6 +620,12 @@ namespace frm
             size_t const edge_from_begin_to_end_index = get_free_edge_index(dcel);
             size_t const edge_from_end_to_begin_index = get_free_edge_index(dcel);
 
+            record_edge_change(dcel, begin_edge_index);
+            record_edge_change(dcel, previous_to_begin_edge_index);
+            record_edge_change(dcel, end_edge_index);
+            record_edge_change(dcel, previous_to_end_edge_index);
+            record_face_change(dcel, current_face_index);
+
             DCEL::Edge & begin_edge = dcel.edges[begin_edge_index];
             DCEL::Edge & previous_to_begin_edge = dcel.edges[previous_to_begin_edge_index];
             DCEL::Edge & end_edge = dcel.edges[end_edge_index];
@@ -477,6 +661,16 @@ namespace frm
 
             if (current_face_index != new_face_index)
             {
+                // only the edges that really move to the other face are recorded
+                auto const set_incident_face = [&dcel](size_t edge_index, size_t face_index) noexcept
+                {
+                    if (dcel.edges[edge_index].incident_face != face_index)
+                    {
+                        record_edge_change(dcel, edge_index);
+                        dcel.edges[edge_index].incident_face = face_index;
+                    }
+                };
+
                 size_t begin = edge_from_begin_to_end_index;
                 size_t current_index = begin;
 
@@ -486,26 +680,20 @@ namespace frm
                 {
                     new_face_edges.push_back(current_index);
 
-                    dcel.edges[current_index].incident_face = new_face_index;
+                    set_incident_face(current_index, new_face_index);
                     current_index = dcel.edges[current_index].next_edge;
                 } while (current_index != begin);
 
-                size_t left_edge_index = 0;
-                Point left_vertex_point = dcel.vertices[dcel.edges[new_face_edges[0]].origin_vertex].coordinate;
+                // the lowest of the leftmost vertices is convex, the turn at it tells the side of the face
+                size_t left_edge_index = new_face_edges[0];
+                Point left_vertex_point = dcel.vertices[dcel.edges[left_edge_index].origin_vertex].coordinate;
 
                 for (size_t new_face_edge : new_face_edges)
                 {
-                    Point current_point = dcel.vertices[dcel.edges[new_face_edge].origin_vertex].coordinate;
+                    Point const current_point = dcel.vertices[dcel.edges[new_face_edge].origin_vertex].coordinate;
 
-                    if (abs(current_point.x - left_vertex_point.x) < frm::epsilon)
-                    {
-                        if (current_point.y - left_vertex_point.y < frm::epsilon)
-                        {
-                            left_vertex_point = current_point;
-                            left_edge_index = new_face_edge;
-                        }
-                    }
-                    else if (current_point.x - left_vertex_point.x < frm::epsilon)
+                    if (current_point.x < left_vertex_point.x ||
+                        (current_point.x == left_vertex_point.x && current_point.y < left_vertex_point.y))
                     {
                         left_vertex_point = current_point;
                         left_edge_index = new_face_edge;
@@ -521,12 +709,15 @@ namespace frm
 
                 if (is_new_face_inside)
                 {
-                    frm::Point const current = get_vector_from_edge(dcel, left_edge_index);
-                    frm::Point const previuos = get_vector_from_edge(dcel, dcel.edges[left_edge_index].previous_edge);
-
-                    float const angle = frm::angle_between_vectors(current, previuos);
-
-                    is_new_face_inside = angle < -frm::epsilon;
+                    size_t const previous_edge_index = dcel.edges[left_edge_index].previous_edge;
+                    size_t const next_vertex_index = dcel.edges[dcel.edges[left_edge_index].twin_edge].origin_vertex;
+
+                    // counterclockwise turn from the previous edge, exact for the thin faces of a triangulation
+                    is_new_face_inside = get_orientation(
+                        dcel.vertices[dcel.edges[previous_edge_index].origin_vertex].coordinate,
+                        left_vertex_point,
+                        dcel.vertices[next_vertex_index].coordinate
+                    ) > 0;
                 }
 
                 std::vector<size_t> inside_face_edges{ new_face_edges };
@@ -546,13 +737,13 @@ namespace frm
                     {
                         inside_face_edges.push_back(current_index);
 
-                        dcel.edges[current_index].incident_face = current_face_index;
+                        set_incident_face(current_index, current_face_index);
                         current_index = dcel.edges[current_index].next_edge;
                     } while (current_index != begin);
 
                     for (size_t new_face_edge : new_face_edges)
                     {
-                        dcel.edges[new_face_edge].incident_face = new_face_index;
+                        set_incident_face(new_face_edge, new_face_index);
                     }
                 }
 
@@ -563,25 +754,32 @@ namespace frm
                     vertex_to_ignore.insert(dcel.edges[new_face_edge].origin_vertex);
                 }
 
-                DCEL detached_face = detach_face(dcel, inside_face_index);
+                // edges of the outside face that start inside of the new one, crossing tests for a few of them,
+                // the trapezoid map of the detached face for many
+                FacePolygon const polygon = make_face_polygon(dcel, inside_face_index);
+
+                std::vector<size_t> candidate_edges{};
+                std::vector<Point> candidate_points{};
 
-                trapezoid_data_and_graph_root_t trapezoid_data_and_graph_root =
-                    generate_trapezoid_data_and_graph_root(detached_face);
-    
                 for (size_t i = 0; i < dcel.edges.size(); ++i)
                 {
-                    if (vertex_to_ignore.find(dcel.edges[i].origin_vertex) == vertex_to_ignore.end())
+                    Point const origin = dcel.vertices[dcel.edges[i].origin_vertex].coordinate;
+
+                    if (dcel.edges[i].incident_face == outside_face_index && is_point_in_box(polygon.bounds, origin) &&
+                        vertex_to_ignore.find(dcel.edges[i].origin_vertex) == vertex_to_ignore.end())
                     {
-                        size_t const trapezoid_face_index =
-                            get_face_index(trapezoid_data_and_graph_root, dcel.vertices[dcel.edges[i].origin_vertex].coordinate);
-
-                        if (trapezoid_face_index == 1)
-                        {
-                            if (dcel.edges[i].incident_face == outside_face_index)
-                            {
-                                dcel.edges[i].incident_face = inside_face_index;
-                            }
-                        }
+                        candidate_edges.push_back(i);
+                        candidate_points.push_back(origin);
+                    }
+                }
+
+                std::vector<uint8_t> const is_inside = get_points_inside(dcel, inside_face_index, polygon, candidate_points);
+
+                for (size_t i = 0; i < candidate_edges.size(); ++i)
+                {
+                    if (is_inside[i])
+                    {
+                        set_incident_face(candidate_edges[i], inside_face_index);
                     }
                 }
             }
@@ -591,12 +789,17 @@ namespace frm
 
         std::pair<size_t, size_t> add_edge_between_two_points(DCEL & dcel, size_t begin_vertex_index, size_t end_vertex_index) noexcept
         {
+            begin_operation(dcel, false);
+
             size_t const edge_from_begin_to_end_index = get_free_edge_index(dcel);
             size_t const edge_from_end_to_begin_index = get_free_edge_index(dcel);
 
             DCEL::Edge & edge_from_begin_to_end = dcel.edges[edge_from_begin_to_end_index];
             DCEL::Edge & edge_from_end_to_begin = dcel.edges[edge_from_end_to_begin_index];
 
+            record_vertex_change(dcel, begin_vertex_index);
+            record_vertex_change(dcel, end_vertex_index);
+
             DCEL::Vertex & begin_vertex = dcel.vertices[begin_vertex_index];
             DCEL::Vertex & end_vertex = dcel.vertices[end_vertex_index];
 
@@ -621,6 +824,8 @@ namespace frm
 
         void add_face_from_three_points(DCEL & dcel, size_t first_vertex_index, size_t second_vertex_index, size_t third_vertex_index, size_t face_index) noexcept
         {
+            begin_operation(dcel, false);
+
             size_t const new_face_index = get_free_face_index(dcel);
 
             size_t const from_first_to_second_index = get_free_edge_index(dcel);
@@ -633,6 +838,10 @@ namespace frm
             DCEL::Face & new_face = dcel.faces[new_face_index];
             new_face.edge = from_first_to_second_index;
 
+            record_vertex_change(dcel, first_vertex_index);
+            record_vertex_change(dcel, second_vertex_index);
+            record_vertex_change(dcel, third_vertex_index);
+
             DCEL::Vertex & first_vertex = dcel.vertices[first_vertex_index];
             DCEL::Vertex & second_vertex = dcel.vertices[second_vertex_index];
             DCEL::Vertex & third_vertex = dcel.vertices[third_vertex_index];
@@ -777,29 +986,43 @@ namespace frm
 
         void remove_vertex_with_single_edge(DCEL & dcel, size_t vertex_index) noexcept
         {
-            dcel.free_vertices.push_back(vertex_index);
-            dcel.vertices[vertex_index].is_exist = false;
+            begin_operation(dcel, true);
 
             size_t const from_vertex_index = dcel.vertices[vertex_index].incident_edge;
             size_t const to_vertex_index = dcel.edges[from_vertex_index].twin_edge;
 
             size_t const face_index = dcel.edges[from_vertex_index].incident_face;
 
+            size_t const previous_to_to_vertex_index = dcel.edges[to_vertex_index].previous_edge;
+            size_t const next_after_from_vertex_index = dcel.edges[from_vertex_index].next_edge;
+
+            bool const is_face_edge_removed = dcel.faces[face_index].edge == from_vertex_index || dcel.faces[face_index].edge == to_vertex_index;
+
+            record_vertex_change(dcel, vertex_index, Change::Kind::Freed);
+            record_edge_change(dcel, from_vertex_index, Change::Kind::Freed);
+            record_edge_change(dcel, to_vertex_index, Change::Kind::Freed);
+            record_edge_change(dcel, previous_to_to_vertex_index);
+            record_edge_change(dcel, next_after_from_vertex_index);
+            if (is_face_edge_removed)
+            {
+                record_face_change(dcel, face_index);
+            }
+
+            dcel.free_vertices.push_back(vertex_index);
+            dcel.vertices[vertex_index].is_exist = false;
+
             dcel.free_edges.push_back(from_vertex_index);
             dcel.edges[from_vertex_index].is_exist = false;
             dcel.free_edges.push_back(to_vertex_index);
             dcel.edges[to_vertex_index].is_exist = false;
 
-            size_t const previous_to_to_vertex_index = dcel.edges[to_vertex_index].previous_edge;
-            size_t const next_after_from_vertex_index = dcel.edges[from_vertex_index].next_edge;
-
             DCEL::Edge & previous_to_to_vertex = dcel.edges[previous_to_to_vertex_index];
             DCEL::Edge & next_after_from_vertex = dcel.edges[next_after_from_vertex_index];
 
             previous_to_to_vertex.next_edge = next_after_from_vertex_index;
             next_after_from_vertex.previous_edge = previous_to_to_vertex_index;
 
-            if (dcel.faces[face_index].edge == from_vertex_index || dcel.faces[face_index].edge == to_vertex_index)
+            if (is_face_edge_removed)
             {
                 dcel.faces[face_index].edge = previous_to_to_vertex_index;
             }
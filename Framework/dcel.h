@@ -2,10 +2,14 @@
 
 
 #include "common.h"
+#include "view_culling.h"
+#include "dependency.h"
 
 #include "SFML\Graphics.hpp"
 
 #include <vector>
+#include <limits>
+#include <cstdint>
 #include <iostream>
 
 
@@ -14,6 +18,33 @@ namespace frm
     // Doubly Connected Edge List
     namespace dcel
     {
+        // Change of a single vertex, edge or face made by an operation on a dcel
+        struct Change
+        {
+            enum class Element : uint8_t
+            {
+                Vertex,
+                Edge,
+                Face
+            };
+
+            enum class Kind : uint8_t
+            {
+                // taken from the free list or appended
+                Inserted,
+                // any field of an existing record
+                Modified,
+                // put to the free list
+                Freed
+            };
+
+            Element element;
+            Kind kind;
+            // Inserted after the last record rather than into a slot from the free list
+            bool is_appended;
+            size_t index;
+        };
+
         struct DCEL
         {
             struct Vertex
@@ -39,12 +70,80 @@ namespace frm
                 bool is_exist{ true };
             };
 
+            // Log of the changes made by the dcel functions, recorded only while it is enabled.
+            // Every operation is recorded before it changes anything,
+            // an index can be listed by an operation more than once.
+            struct Journal
+            {
+                struct Operation
+                {
+                    // dcel version after the operation
+                    size_t version;
+                    // changes[first_change, first_change + changes_count)
+                    size_t first_change;
+                    size_t changes_count;
+                    // reported by mark_changed or mark_structure_changed, its changes are unknown
+                    bool is_untracked;
+                };
+
+                bool is_enabled{ false };
+                // dcel version when the journal was cleared, operations go one per version after it
+                size_t first_version{ 0 };
+                std::vector<Operation> operations{};
+                std::vector<Change> changes{};
+
+                // records of the elements before the changes, kept only while is_keeping_previous_records,
+                // one for every change of the element but the appended ones, in the order of the changes
+                bool is_keeping_previous_records{ false };
+                std::vector<Vertex> previous_vertices{};
+                std::vector<Edge> previous_edges{};
+                std::vector<Face> previous_faces{};
+            };
+
             std::vector<Vertex> vertices;
             std::vector<size_t> free_vertices{};
             std::vector<Face> faces;
             std::vector<size_t> free_faces{};
             std::vector<Edge> edges;
             std::vector<size_t> free_edges{};
+
+            // incremented by every change, see mark_changed and move_vertex
+            size_t version{ 0 };
+            // incremented when elements are added, removed or reconnected
+            size_t structure_version{ 0 };
+            // incremented when existing vertices are moved or removed,
+            // appended vertices change only the structure
+            size_t geometry_version{ 0 };
+            // vertex moved by the last change,
+            // std::numeric_limits<size_t>::max() if the last change was not a single vertex move
+            size_t moved_vertex{ std::numeric_limits<size_t>::max() };
+
+            Journal journal{};
+        };
+
+        using Journal = DCEL::Journal;
+
+        // Edges of a dcel kept in GPU memory between frames,
+        // rebuilt only if the dcel version changes and patched in place for a single vertex move.
+        // If a part of the dcel is outside of the view or the view is zoomed out,
+        // only the visible edges found by the grid are drawn.
+        struct RenderCache
+        {
+            sf::VertexBuffer buffer{ sf::Lines, sf::VertexBuffer::Static };
+            // copy of the buffer, drawn directly if vertex buffers are not available
+            std::vector<sf::Vertex> vertices{};
+            // index of the line of each edge in vertices,
+            // std::numeric_limits<size_t>::max() for edges that don't exist
+            std::vector<size_t> edge_lines{};
+            // bounds of the buffer, only grow with patches
+            Box bounds{ empty_box };
+            size_t version{ std::numeric_limits<size_t>::max() };
+            sf::Color color{};
+
+            // every edge once, built on demand
+            SegmentGrid grid{};
+            Dependency grid_dependency{};
+            VisibleGeometry visible{};
         };
 
         std::ostream & operator<<(std::ostream & os, DCEL const & dcel) noexcept;
@@ -68,6 +167,25 @@ namespace frm
         bool is_points_connected(DCEL const & dcel, size_t begin_vertex_index, size_t end_vertex_index) noexcept;
         bool is_edges_connected(DCEL const & dcel, size_t begin_edge_index, size_t end_edge_index) noexcept;
 
+        // Every change of a dcel made outside of the functions below has to be reported,
+        // so the data built from the dcel (render cache, trapezoid map) can find out that it is outdated
+        // changes of both structure and geometry
+        void mark_changed(DCEL & dcel) noexcept;
+        void mark_structure_changed(DCEL & dcel) noexcept;
+        void move_vertex(DCEL & dcel, size_t vertex_index, Point coordinate) noexcept;
+
+        // the journal grows until it is cleared, so its readers have to clear it
+        // once every one of them took the changes it needed
+        // previous records are needed to revert the changes
+        void enable_journal(DCEL & dcel, bool need_previous_records = false) noexcept;
+        void disable_journal(DCEL & dcel) noexcept;
+        void clear_journal(DCEL & dcel) noexcept;
+
+        // Changes made after the dcel had the version, in the order they were made.
+        // false if some of them are unknown: the journal was disabled or cleared since then,
+        // or an untracked change was made.
+        bool get_changes_since(DCEL const & dcel, size_t version, std::vector<Change> & changes) noexcept;
+
         void add_vertex(DCEL & dcel, Point coordinate) noexcept;
         void add_vertex_and_split_edge(DCEL & dcel, Point coordinate, size_t edge_index) noexcept;
         void add_vertex_and_connect_to_edge_origin(DCEL & dcel, Point coordinate, size_t edge_index) noexcept;
@@ -86,17 +204,23 @@ namespace frm
 
         // TODO: add remove
 
+        // panels select current_vertex, current_edge and current_face
+        // each time selection_version changes
         bool spawn_ui(DCEL & dcel,
             size_t current_vertex,
             size_t current_edge,
             size_t current_face,
             sf::RenderWindow & window,
             std::string const & path,
-            bool & is_dirty) noexcept;
+            size_t selection_version) noexcept;
 
+        // faces outside of the view are skipped
         void draw_face_highlighted(size_t face_index, DCEL const & dcel, float color[4], sf::RenderWindow & window) noexcept;
 
-        void draw(DCEL & dcel, sf::RenderWindow & window, sf::Color const & color = sf::Color::White) noexcept;
+        void draw(DCEL const & dcel, sf::RenderWindow & window, sf::Color const & color = sf::Color::White) noexcept;
+        // O(1) if neither dcel nor the view changed since the previous call with this cache,
+        // a changed view costs only the visible edges
+        void draw(DCEL const & dcel, RenderCache & cache, sf::RenderWindow & window, sf::Color const & color = sf::Color::White) noexcept;
 
         bool is_vertices_mode() noexcept;
         bool is_faces_mode() noexcept;
@@ -0,0 +1,364 @@
+#include "dcel_history.h"
+
+#include "imgui/imgui.h"
+
+#include <map>
+#include <limits>
+#include <cassert>
+#include <algorithm>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        template<typename T>
+        size_t get_memory_size(History::Delta::Elements<T> const & elements) noexcept
+        {
+            return (elements.indices.size() + elements.previous_free_indices.size() + elements.next_free_indices.size()) * sizeof(size_t) +
+                (elements.previous_records.size() + elements.next_records.size()) * sizeof(T);
+        }
+
+        size_t get_memory_size(History::Delta const & delta) noexcept
+        {
+            return sizeof(History::Delta) +
+                get_memory_size(delta.vertices) +
+                get_memory_size(delta.edges) +
+                get_memory_size(delta.faces);
+        }
+
+        void clear_history(History & history) noexcept
+        {
+            history.undo_deltas.clear();
+            history.redo_deltas.clear();
+            history.memory_size = 0;
+            history.moved_vertex = std::numeric_limits<size_t>::max();
+        }
+
+        void clear_redo_deltas(History & history) noexcept
+        {
+            for (History::Delta const & delta : history.redo_deltas)
+            {
+                history.memory_size -= delta.memory_size;
+            }
+
+            history.redo_deltas.clear();
+        }
+
+        void drop_oldest_deltas(History & history) noexcept
+        {
+            while (history.memory_size > history.memory_limit && !history.undo_deltas.empty())
+            {
+                history.memory_size -= history.undo_deltas.front().memory_size;
+                history.undo_deltas.pop_front();
+            }
+        }
+
+        // changes - changes of the journal, previous_records - journal records of the element
+        template<typename T>
+        History::Delta::Elements<T> create_elements_delta(std::vector<Change> const & changes,
+            Change::Element element,
+            std::vector<T> const & records,
+            std::vector<size_t> const & free_indices,
+            std::vector<T> const & previous_records) noexcept
+        {
+            static constexpr size_t no_record = std::numeric_limits<size_t>::max();
+
+            History::Delta::Elements<T> elements{};
+
+            // index - position of the record before the first change of the element
+            std::map<size_t, size_t> first_previous_records{};
+            size_t previous_record = 0;
+            size_t appended_count = 0;
+
+            for (Change const & change : changes)
+            {
+                if (change.element != element)
+                {
+                    continue;
+                }
+
+                if (change.is_appended)
+                {
+                    ++appended_count;
+                    first_previous_records.emplace(change.index, no_record);
+                }
+                else
+                {
+                    first_previous_records.emplace(change.index, previous_record++);
+                }
+            }
+
+            elements.next_count = records.size();
+            elements.previous_count = records.size() - appended_count;
+
+            elements.indices.reserve(first_previous_records.size());
+            elements.next_records.reserve(first_previous_records.size());
+
+            for (std::pair<size_t const, size_t> const & first_previous_record : first_previous_records)
+            {
+                size_t const index = first_previous_record.first;
+
+                if (index < elements.previous_count)
+                {
+                    assert(first_previous_record.second != no_record);
+                    elements.previous_records.push_back(previous_records[first_previous_record.second]);
+                }
+
+                elements.indices.push_back(index);
+                elements.next_records.push_back(records[index]);
+            }
+
+            // Free lists are stacks: an inserted element was taken from the end, a freed one was put there.
+            // Going back over the changes gives the end of the free list before them.
+            size_t common_count = free_indices.size();
+
+            for (auto change = changes.rbegin(); change != changes.rend(); ++change)
+            {
+                if (change->element != element)
+                {
+                    continue;
+                }
+
+                if (change->kind == Change::Kind::Freed)
+                {
+                    if (elements.previous_free_indices.empty())
+                    {
+                        assert(common_count > 0 && free_indices[common_count - 1] == change->index);
+                        --common_count;
+                    }
+                    else
+                    {
+                        assert(elements.previous_free_indices.back() == change->index);
+                        elements.previous_free_indices.pop_back();
+                    }
+                }
+                else if (change->kind == Change::Kind::Inserted && !change->is_appended)
+                {
+                    elements.previous_free_indices.push_back(change->index);
+                }
+            }
+
+            elements.free_common_count = common_count;
+            elements.next_free_indices.assign(free_indices.begin() + common_count, free_indices.end());
+
+            return elements;
+        }
+
+        History::Delta create_delta(DCEL const & dcel) noexcept
+        {
+            Journal const & journal = dcel.journal;
+
+            History::Delta delta{};
+            delta.vertices = create_elements_delta(journal.changes, Change::Element::Vertex, dcel.vertices, dcel.free_vertices, journal.previous_vertices);
+            delta.edges = create_elements_delta(journal.changes, Change::Element::Edge, dcel.edges, dcel.free_edges, journal.previous_edges);
+            delta.faces = create_elements_delta(journal.changes, Change::Element::Face, dcel.faces, dcel.free_faces, journal.previous_faces);
+            delta.memory_size = get_memory_size(delta);
+
+            return delta;
+        }
+
+        void push_delta(History & history, DCEL const & dcel) noexcept
+        {
+            clear_redo_deltas(history);
+
+            History::Delta delta = create_delta(dcel);
+
+            // the older deltas can't be undone without this one
+            if (delta.memory_size > history.memory_limit)
+            {
+                clear_history(history);
+            }
+            else
+            {
+                history.memory_size += delta.memory_size;
+                history.undo_deltas.push_back(std::move(delta));
+
+                drop_oldest_deltas(history);
+            }
+        }
+
+        // vertex the journal only moves, std::numeric_limits<size_t>::max() if there are other changes
+        size_t get_moved_vertex(DCEL const & dcel) noexcept
+        {
+            Journal const & journal = dcel.journal;
+
+            bool const is_single_vertex_move = dcel.moved_vertex != std::numeric_limits<size_t>::max() &&
+                std::all_of(journal.changes.begin(), journal.changes.end(), [&dcel](Change const & change) noexcept
+                    {
+                        return change.element == Change::Element::Vertex &&
+                            change.kind == Change::Kind::Modified &&
+                            change.index == dcel.moved_vertex;
+                    });
+
+            return is_single_vertex_move ? dcel.moved_vertex : std::numeric_limits<size_t>::max();
+        }
+
+        void update_history(History & history, DCEL & dcel, bool is_continued_move) noexcept
+        {
+            Journal const & journal = dcel.journal;
+
+            bool const is_journal_complete = journal.is_enabled &&
+                journal.is_keeping_previous_records &&
+                journal.first_version == history.version &&
+                std::none_of(journal.operations.begin(), journal.operations.end(),
+                    [](Journal::Operation const & operation) noexcept { return operation.is_untracked; });
+
+            if (!is_journal_complete)
+            {
+                clear_history(history);
+            }
+            else if (!journal.changes.empty())
+            {
+                size_t const moved_vertex = get_moved_vertex(dcel);
+
+                if (is_continued_move && moved_vertex != std::numeric_limits<size_t>::max() && moved_vertex == history.moved_vertex)
+                {
+                    // the delta keeps the record from before the move
+                    history.undo_deltas.back().vertices.next_records.front() = dcel.vertices[moved_vertex];
+                }
+                else
+                {
+                    push_delta(history, dcel);
+
+                    if (is_continued_move && !history.undo_deltas.empty())
+                    {
+                        history.moved_vertex = moved_vertex;
+                    }
+                }
+            }
+
+            if (!is_continued_move)
+            {
+                history.moved_vertex = std::numeric_limits<size_t>::max();
+            }
+
+            enable_journal(dcel, true);
+            clear_journal(dcel);
+            history.version = dcel.version;
+        }
+
+        template<typename T>
+        void revert_elements(History::Delta::Elements<T> const & elements, std::vector<T> & records, std::vector<size_t> & free_indices) noexcept
+        {
+            assert(records.size() == elements.next_count);
+
+            for (size_t i = 0; i < elements.previous_records.size(); ++i)
+            {
+                records[elements.indices[i]] = elements.previous_records[i];
+            }
+            records.resize(elements.previous_count);
+
+            free_indices.resize(elements.free_common_count);
+            free_indices.insert(free_indices.end(), elements.previous_free_indices.begin(), elements.previous_free_indices.end());
+        }
+
+        template<typename T>
+        void repeat_elements(History::Delta::Elements<T> const & elements, std::vector<T> & records, std::vector<size_t> & free_indices) noexcept
+        {
+            assert(records.size() == elements.previous_count);
+
+            records.resize(elements.next_count);
+            for (size_t i = 0; i < elements.next_records.size(); ++i)
+            {
+                records[elements.indices[i]] = elements.next_records[i];
+            }
+
+            free_indices.resize(elements.free_common_count);
+            free_indices.insert(free_indices.end(), elements.next_free_indices.begin(), elements.next_free_indices.end());
+        }
+
+        void revert_delta(History::Delta const & delta, DCEL & dcel) noexcept
+        {
+            revert_elements(delta.vertices, dcel.vertices, dcel.free_vertices);
+            revert_elements(delta.edges, dcel.edges, dcel.free_edges);
+            revert_elements(delta.faces, dcel.faces, dcel.free_faces);
+        }
+
+        void repeat_delta(History::Delta const & delta, DCEL & dcel) noexcept
+        {
+            repeat_elements(delta.vertices, dcel.vertices, dcel.free_vertices);
+            repeat_elements(delta.edges, dcel.edges, dcel.free_edges);
+            repeat_elements(delta.faces, dcel.faces, dcel.free_faces);
+        }
+
+        // the reverted or repeated changes are not taken by the history as new ones
+        void finish_history_change(History & history, DCEL & dcel) noexcept
+        {
+            mark_changed(dcel);
+            clear_journal(dcel);
+            history.version = dcel.version;
+            history.moved_vertex = std::numeric_limits<size_t>::max();
+        }
+
+        bool undo(History & history, DCEL & dcel) noexcept
+        {
+            update_history(history, dcel);
+
+            if (history.undo_deltas.empty())
+            {
+                return false;
+            }
+
+            revert_delta(history.undo_deltas.back(), dcel);
+
+            history.redo_deltas.push_back(std::move(history.undo_deltas.back()));
+            history.undo_deltas.pop_back();
+
+            finish_history_change(history, dcel);
+
+            return true;
+        }
+
+        bool redo(History & history, DCEL & dcel) noexcept
+        {
+            update_history(history, dcel);
+
+            if (history.redo_deltas.empty())
+            {
+                return false;
+            }
+
+            repeat_delta(history.redo_deltas.back(), dcel);
+
+            history.undo_deltas.push_back(std::move(history.redo_deltas.back()));
+            history.redo_deltas.pop_back();
+
+            finish_history_change(history, dcel);
+
+            return true;
+        }
+
+        void spawn_history_ui(History & history, DCEL & dcel) noexcept
+        {
+            // a dragged slider moves its vertex every frame, the drag is undone at once
+            update_history(history, dcel, ImGui::IsAnyItemActive());
+
+            ImGuiIO const & io = ImGui::GetIO();
+            bool const is_shortcut_available = io.KeyCtrl && !io.WantTextInput;
+
+            bool need_undo = is_shortcut_available && ImGui::IsKeyPressed(sf::Keyboard::Z);
+            bool need_redo = is_shortcut_available && ImGui::IsKeyPressed(sf::Keyboard::Y);
+
+            if (ImGui::Begin("History"))
+            {
+                need_undo |= ImGui::Button("Undo");
+                ImGui::SameLine();
+                need_redo |= ImGui::Button("Redo");
+
+                ImGui::Text("%d to undo, %d to redo", static_cast<int>(history.undo_deltas.size()), static_cast<int>(history.redo_deltas.size()));
+                ImGui::Text("%.1f of %.1f KB", static_cast<float>(history.memory_size) / 1024.f, static_cast<float>(history.memory_limit) / 1024.f);
+            }
+            ImGui::End();
+
+            if (need_undo)
+            {
+                undo(history, dcel);
+            }
+            else if (need_redo)
+            {
+                redo(history, dcel);
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+
+#include "dcel.h"
+
+#include <deque>
+#include <vector>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        // Undo and redo of dcel changes, read from the journal of the dcel.
+        // Only the records of the changed elements are stored, so an undo costs O(changed elements).
+        struct History
+        {
+            // Changes of the dcel between two updates of the history,
+            // every changed element is kept once with its records before and after the changes
+            struct Delta
+            {
+                template<typename T>
+                struct Elements
+                {
+                    // records count before and after the changes, elements from previous_count on were appended
+                    size_t previous_count{ 0 };
+                    size_t next_count{ 0 };
+
+                    // changed elements in increasing order, previous_records[i] is the record of indices[i]
+                    // and there are none for the appended elements, next_records has one for each
+                    std::vector<size_t> indices{};
+                    std::vector<T> previous_records{};
+                    std::vector<T> next_records{};
+
+                    // free lists are changed only at their ends,
+                    // [0, free_common_count) is the same before and after the changes
+                    size_t free_common_count{ 0 };
+                    std::vector<size_t> previous_free_indices{};
+                    std::vector<size_t> next_free_indices{};
+                };
+
+                Elements<DCEL::Vertex> vertices{};
+                Elements<DCEL::Edge> edges{};
+                Elements<DCEL::Face> faces{};
+                size_t memory_size{ 0 };
+            };
+
+            // the newest delta is at the back
+            std::deque<Delta> undo_deltas{};
+            std::vector<Delta> redo_deltas{};
+
+            // memory of both stacks, the oldest deltas are dropped above the limit,
+            // a delta above the limit alone clears the history
+            size_t memory_size{ 0 };
+            size_t memory_limit{ 64 * 1024 * 1024 };
+
+            // dcel version the deltas end at
+            size_t version{ std::numeric_limits<size_t>::max() };
+            // vertex the newest delta only moves while the move continues,
+            // std::numeric_limits<size_t>::max() if the next changes start a new delta
+            size_t moved_vertex{ std::numeric_limits<size_t>::max() };
+        };
+
+        void clear_history(History & history) noexcept;
+
+        // Moves the changes from the journal into a new delta, clears the redo stack if there were any.
+        // The history owns the journal: it is enabled here and cleared by every update.
+        // Changes it can't revert (untracked ones, another dcel) clear the history.
+        // is_continued_move - the changes continue the move of the previous update, like a drag of a slider,
+        // further moves of the same vertex go into its delta instead of a new one per update
+        void update_history(History & history, DCEL & dcel, bool is_continued_move = false) noexcept;
+
+        // false if there is nothing to undo or redo
+        bool undo(History & history, DCEL & dcel) noexcept;
+        bool redo(History & history, DCEL & dcel) noexcept;
+
+        // undo and redo buttons, Ctrl+Z and Ctrl+Y, updates the history first,
+        // changes made while an item is active are one move
+        void spawn_history_ui(History & history, DCEL & dcel) noexcept;
+    }
+}
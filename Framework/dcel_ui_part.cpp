@@ -1,9 +1,13 @@
 #include "dcel.h"
+#include "dcel_validation.h"
+#include "segment_intersections.h"
 #include "common_ui_part.h"
+#include "profiler.h"
 
 #include "imgui/imgui.h"
 
 #include <string>
+#include <sstream>
 #include <fstream>
 #include <filesystem>
 
@@ -16,22 +20,33 @@ namespace frm
 
         static char const * current_item = items[0];
 
+        // result of the last Validate, shown while the dcel has the validated version
+        static ValidationResult validation{};
+        static size_t validation_version{ std::numeric_limits<size_t>::max() };
+
 
         void draw_face_highlighted(size_t face_index, DCEL const & dcel, float color[4], sf::RenderWindow & window) noexcept
         {
-            sf::ConvexShape shape{};
-            shape.setFillColor(float4_to_uint8_t4(color));
-
             size_t const begin = dcel.faces[face_index].edge;
             size_t current_index = begin;
             size_t current_number = 0;
+            Box face_box{ empty_box };
 
             do
             {
+                extend_box(face_box, dcel.vertices[dcel.edges[current_index].origin_vertex].coordinate);
                 current_index = dcel.edges[current_index].next_edge;
                 ++current_number;
             } while (current_index != begin);
 
+            if (!is_boxes_intersected(face_box, get_view_box(window)))
+            {
+                return;
+            }
+
+            sf::ConvexShape shape{};
+            shape.setFillColor(float4_to_uint8_t4(color));
+
             shape.setPointCount(current_number);
 
             current_index = begin;
@@ -48,18 +63,19 @@ namespace frm
             window.draw(shape);
         }
 
-        bool show_vertices(DCEL & dcel, size_t current_vertex, sf::RenderWindow & window, bool & is_dirty) noexcept
+        bool show_vertices(DCEL & dcel, size_t current_vertex, MarkerBatch & markers, size_t selection_version) noexcept
         {
             bool is_dirty_vertices = false;
 
             ImGui::Columns(3);
 
             static size_t current = std::numeric_limits<size_t>::max();
+            static size_t current_selection_version = std::numeric_limits<size_t>::max();
 
-            if (is_dirty)
+            if (current_selection_version != selection_version)
             {
                 current = current_vertex;
-                is_dirty = false;
+                current_selection_version = selection_version;
             }
 
             show_indexed_combo(current, dcel.vertices.size(), "Vertex");
@@ -71,11 +87,17 @@ namespace frm
                 static float circle_color[4] = { 1.f, 0.0f, 0.f, 0.7f };
                 static float radius = 10.f;
 
-                Point & point = dcel.vertices[current].coordinate;
-                draw_vertex_highlighted(point, circle_color, radius, window);
+                Point point = dcel.vertices[current].coordinate;
+                draw_vertex_highlighted(markers, point, circle_color, radius);
 
-                is_dirty_vertices |= ImGui::SliderFloat("X", &point.x, 0.f, 1000.f);
-                is_dirty_vertices |= ImGui::SliderFloat("Y", &point.y, 0.f, 1000.f);
+                bool is_moved = ImGui::SliderFloat("X", &point.x, 0.f, 1000.f);
+                is_moved |= ImGui::SliderFloat("Y", &point.y, 0.f, 1000.f);
+
+                if (is_moved)
+                {
+                    move_vertex(dcel, current, point);
+                    is_dirty_vertices = true;
+                }
                 ImGui::Text("Edge %d", static_cast<int>(dcel.vertices[current].incident_edge));
 
                 ImGui::SliderFloat("Radius", &radius, 0.01f, 100.f);
@@ -97,7 +119,7 @@ namespace frm
 
                 static Point new_vertex = { 100.f, 100.f };
 
-                draw_vertex_highlighted(new_vertex, circle_color, radius, window);
+                draw_vertex_highlighted(markers, new_vertex, circle_color, radius);
 
                 ImGui::SliderFloat("new X", &new_vertex.x, 0.f, 1000.f);
                 ImGui::SliderFloat("new Y", &new_vertex.y, 0.f, 1000.f);
@@ -124,18 +146,19 @@ namespace frm
             return is_dirty_vertices;
         }
 
-        bool show_faces(DCEL & dcel, size_t current_face, sf::RenderWindow & window, bool & is_dirty) noexcept
+        bool show_faces(DCEL & dcel, size_t current_face, MarkerBatch & markers, sf::RenderWindow & window, size_t selection_version) noexcept
         {
             bool is_dirty_faces = false;
 
             ImGui::Columns(3);
 
             static size_t current = std::numeric_limits<size_t>::max();
+            static size_t current_selection_version = std::numeric_limits<size_t>::max();
 
-            if (is_dirty)
+            if (current_selection_version != selection_version)
             {
                 current = current_face;
-                is_dirty = false;
+                current_selection_version = selection_version;
             }
 
             show_indexed_combo(current, dcel.faces.size(), "Face");
@@ -182,7 +205,7 @@ namespace frm
 
                         Point new_vertex = dcel.vertices[first_vertex_index].coordinate;
 
-                        draw_vertex_highlighted(new_vertex, circle_color, radius, window);
+                        draw_vertex_highlighted(markers, new_vertex, circle_color, radius);
                     }
                     if (second_vertex_index != std::numeric_limits<size_t>::max())
                     {
@@ -191,7 +214,7 @@ namespace frm
 
                         Point new_vertex = dcel.vertices[second_vertex_index].coordinate;
 
-                        draw_vertex_highlighted(new_vertex, circle_color, radius, window);
+                        draw_vertex_highlighted(markers, new_vertex, circle_color, radius);
                     }
                     if (third_vertex_index != std::numeric_limits<size_t>::max())
                     {
@@ -200,7 +223,7 @@ namespace frm
 
                         Point new_vertex = dcel.vertices[third_vertex_index].coordinate;
 
-                        draw_vertex_highlighted(new_vertex, circle_color, radius, window);
+                        draw_vertex_highlighted(markers, new_vertex, circle_color, radius);
                     }
 
                     if (first_vertex_index != std::numeric_limits<size_t>::max() &&
@@ -217,18 +240,19 @@ namespace frm
             return is_dirty_faces;
         }
 
-        bool show_edges(DCEL & dcel, size_t current_edge, sf::RenderWindow & window, bool & is_dirty) noexcept
+        bool show_edges(DCEL & dcel, size_t current_edge, MarkerBatch & markers, size_t selection_version) noexcept
         {
             bool is_dirty_edges = false;
 
             ImGui::Columns(3);
 
             static size_t current = std::numeric_limits<size_t>::max();
+            static size_t current_selection_version = std::numeric_limits<size_t>::max();
 
-            if (is_dirty)
+            if (current_selection_version != selection_version)
             {
                 current = current_edge;
-                is_dirty = false;
+                current_selection_version = selection_version;
             }
 
             show_indexed_combo(current, dcel.edges.size(), "Edge");
@@ -241,17 +265,27 @@ namespace frm
                 static float width = 10.f;
 
                 size_t const begin_origin = dcel.edges[current].origin_vertex;
-                Point & begin_point = dcel.vertices[begin_origin].coordinate;
+                Point begin_point = dcel.vertices[begin_origin].coordinate;
                 size_t const end_origin = dcel.edges[dcel.edges[current].twin_edge].origin_vertex;
-                Point & end_point = dcel.vertices[end_origin].coordinate;
+                Point end_point = dcel.vertices[end_origin].coordinate;
+
+                draw_edge_highlighted(markers, begin_point, end_point, color, width);
 
-                draw_edge_highlighted(begin_point, end_point, color, width, window);
+                bool is_begin_moved = ImGui::SliderFloat("X begin", &begin_point.x, 0.f, 1000.f);
+                is_begin_moved |= ImGui::SliderFloat("Y begin", &begin_point.y, 0.f, 1000.f);
 
-                is_dirty_edges |= ImGui::SliderFloat("X begin", &begin_point.x, 0.f, 1000.f);
-                is_dirty_edges |= ImGui::SliderFloat("Y begin", &begin_point.y, 0.f, 1000.f);
+                bool is_end_moved = ImGui::SliderFloat("X end", &end_point.x, 0.f, 1000.f);
+                is_end_moved |= ImGui::SliderFloat("Y end", &end_point.y, 0.f, 1000.f);
 
-                is_dirty_edges |= ImGui::SliderFloat("X end", &end_point.x, 0.f, 1000.f);
-                is_dirty_edges |= ImGui::SliderFloat("Y end", &end_point.y, 0.f, 1000.f);
+                if (is_begin_moved)
+                {
+                    move_vertex(dcel, begin_origin, begin_point);
+                }
+                if (is_end_moved)
+                {
+                    move_vertex(dcel, end_origin, end_point);
+                }
+                is_dirty_edges |= is_begin_moved || is_end_moved;
 
                 ImGui::Text("Face %d", static_cast<int>(dcel.edges[current].incident_face));
                 ImGui::Text("Twin %d", static_cast<int>(dcel.edges[current].twin_edge));
@@ -279,7 +313,7 @@ namespace frm
 
                     static Point new_vertex = { 100.f, 100.f };
 
-                    draw_vertex_highlighted(new_vertex, circle_color, radius, window);
+                    draw_vertex_highlighted(markers, new_vertex, circle_color, radius);
 
                     ImGui::SliderFloat("new X", &new_vertex.x, 0.f, 1000.f);
                     ImGui::SliderFloat("new Y", &new_vertex.y, 0.f, 1000.f);
@@ -313,21 +347,21 @@ namespace frm
                 if (begin_edge < dcel.edges.size())
                 {
                     size_t const begin_origin = dcel.edges[begin_edge].origin_vertex;
-                    Point & begin_point = dcel.vertices[begin_origin].coordinate;
+                    Point begin_point = dcel.vertices[begin_origin].coordinate;
                     size_t const end_origin = dcel.edges[dcel.edges[begin_edge].twin_edge].origin_vertex;
-                    Point & end_point = dcel.vertices[end_origin].coordinate;
+                    Point end_point = dcel.vertices[end_origin].coordinate;
 
-                    draw_edge_highlighted(begin_point, end_point, color, width, window);
+                    draw_edge_highlighted(markers, begin_point, end_point, color, width);
                 }
 
                 if (end_edge < dcel.edges.size())
                 {
                     size_t const begin_origin = dcel.edges[end_edge].origin_vertex;
-                    Point & begin_point = dcel.vertices[begin_origin].coordinate;
+                    Point begin_point = dcel.vertices[begin_origin].coordinate;
                     size_t const end_origin = dcel.edges[dcel.edges[end_edge].twin_edge].origin_vertex;
-                    Point & end_point = dcel.vertices[end_origin].coordinate;
+                    Point end_point = dcel.vertices[end_origin].coordinate;
 
-                    draw_edge_highlighted(begin_point, end_point, color, width, window);
+                    draw_edge_highlighted(markers, begin_point, end_point, color, width);
                 }
 
                 if (begin_edge < dcel.edges.size() && end_edge < dcel.edges.size() && begin_edge != end_edge)
@@ -356,12 +390,12 @@ namespace frm
 
                 if (begin_point < dcel.vertices.size())
                 {
-                    draw_vertex_highlighted(dcel.vertices[begin_point].coordinate, color, width, window);
+                    draw_vertex_highlighted(markers, dcel.vertices[begin_point].coordinate, color, width);
                 }
 
                 if (end_point < dcel.vertices.size())
                 {
-                    draw_vertex_highlighted(dcel.vertices[end_point].coordinate, color, width, window);
+                    draw_vertex_highlighted(markers, dcel.vertices[end_point].coordinate, color, width);
                 }
 
                 if (begin_point < dcel.vertices.size() && end_point < dcel.vertices.size() && begin_point != end_point)
@@ -383,10 +417,16 @@ namespace frm
             size_t current_face,
             sf::RenderWindow & window,
             std::string const & path,
-            bool & is_dirty) noexcept
+            size_t selection_version) noexcept
         {
+            ProfileScope const scope{ "dcel::spawn_ui" };
+
             bool is_dirty_ui = false;
 
+            // markers of the panels, drawn with a single call after them
+            static MarkerBatch markers{};
+            markers.vertices.clear();
+
             std::string const name = std::filesystem::path{ path }.stem().string();
 
             static bool is_active = false;
@@ -403,9 +443,32 @@ namespace frm
                         load_from_file(path, dcel);
                         is_dirty_ui = true;
                     }
+                    if (ImGui::MenuItem("Validate"))
+                    {
+                        validation = validate(dcel);
+                        validation_version = dcel.version;
+                    }
+                    if (ImGui::MenuItem("Split at intersections"))
+                    {
+                        is_dirty_ui |= !split_at_intersections(dcel).empty();
+                    }
                     ImGui::EndMenuBar();
                 }
 
+                if (validation_version == dcel.version)
+                {
+                    ImGui::Text("Validation: %zu issues", validation.issues_count);
+
+                    for (ValidationIssue const & issue : validation.issues)
+                    {
+                        std::ostringstream text{};
+                        text << issue;
+                        ImGui::BulletText("%s", text.str().c_str());
+                    }
+
+                    ImGui::Separator();
+                }
+
 
                 if (ImGui::BeginCombo("Type", current_item))
                 {
@@ -429,53 +492,187 @@ namespace frm
 
                 if (current_item == items[0])
                 {
-                    is_dirty_ui |= show_vertices(dcel, current_vertex, window, is_dirty);
+                    is_dirty_ui |= show_vertices(dcel, current_vertex, markers, selection_version);
                 }
                 if (current_item == items[1])
                 {
-                    is_dirty_ui |= show_faces(dcel, current_face, window, is_dirty);
+                    is_dirty_ui |= show_faces(dcel, current_face, markers, window, selection_version);
                 }
                 if (current_item == items[2])
                 {
-                    is_dirty_ui |= show_edges(dcel, current_edge, window, is_dirty);
+                    is_dirty_ui |= show_edges(dcel, current_edge, markers, selection_version);
                 }
             }
             ImGui::End();
 
+            frm::draw(markers, window);
+
             return is_dirty_ui;
         }
 
-        void draw(DCEL & dcel, sf::RenderWindow & window, sf::Color const & color) noexcept
+        void push_edge_line(DCEL const & dcel, size_t edge_index, sf::Color const & color, std::vector<sf::Vertex> & vertices) noexcept
+        {
+            Point const begin = dcel.vertices[dcel.edges[edge_index].origin_vertex].coordinate;
+            Point const end = dcel.vertices[dcel.edges[dcel.edges[edge_index].twin_edge].origin_vertex].coordinate;
+
+            vertices.push_back({ { begin.x, begin.y }, color });
+            vertices.push_back({ { end.x, end.y }, color });
+        }
+
+        void draw(DCEL const & dcel, sf::RenderWindow & window, sf::Color const & color) noexcept
         {
-            size_t edge_count = 0;
+            std::vector<sf::Vertex> vertices{};
+            vertices.reserve(2 * dcel.edges.size());
 
             for (size_t i = 0; i < dcel.edges.size(); ++i)
             {
                 if (dcel.edges[i].is_exist)
                 {
-                    ++edge_count;
+                    push_edge_line(dcel, i, color, vertices);
                 }
             }
 
-            sf::VertexArray vertices{ sf::Lines, 2 * edge_count };
-            size_t index = 0;
+            window.draw(vertices.data(), vertices.size(), sf::Lines);
+        }
+
+        void rebuild_render_cache(DCEL const & dcel, RenderCache & cache, sf::Color const & color) noexcept
+        {
+            cache.vertices.clear();
+            cache.edge_lines.assign(dcel.edges.size(), std::numeric_limits<size_t>::max());
+            cache.bounds = empty_box;
 
             for (size_t i = 0; i < dcel.edges.size(); ++i)
             {
                 if (dcel.edges[i].is_exist)
                 {
-                    size_t const begin_origin = dcel.edges[i].origin_vertex;
-                    vertices[2 * index].position = { dcel.vertices[begin_origin].coordinate.x, dcel.vertices[begin_origin].coordinate.y };
-                    vertices[2 * index].color = color;
-
-                    size_t const end_origin = dcel.edges[dcel.edges[i].twin_edge].origin_vertex;
-                    vertices[2 * index + 1].position = { dcel.vertices[end_origin].coordinate.x, dcel.vertices[end_origin].coordinate.y };
-                    vertices[2 * index + 1].color = color;
-                    ++index;
+                    cache.edge_lines[i] = cache.vertices.size() / 2;
+                    push_edge_line(dcel, i, color, cache.vertices);
+                    extend_box(cache.bounds, dcel.vertices[dcel.edges[i].origin_vertex].coordinate);
+                }
+            }
+
+            if (sf::VertexBuffer::isAvailable() && cache.buffer.create(cache.vertices.size()))
+            {
+                cache.buffer.update(cache.vertices.data());
+            }
+
+            cache.version = dcel.version;
+            cache.color = color;
+        }
+
+        // Only lines of the edges around the vertex are updated
+        void patch_render_cache(DCEL const & dcel, RenderCache & cache, size_t vertex_index) noexcept
+        {
+            size_t const begin = dcel.vertices[vertex_index].incident_edge;
+            sf::Vector2f const position{ dcel.vertices[vertex_index].coordinate.x, dcel.vertices[vertex_index].coordinate.y };
+
+            auto const update = [&cache, position](size_t vertex_position) noexcept
+            {
+                cache.vertices[vertex_position].position = position;
+                if (cache.buffer.getVertexCount() == cache.vertices.size())
+                {
+                    cache.buffer.update(&cache.vertices[vertex_position], 1, static_cast<unsigned>(vertex_position));
+                }
+            };
+
+            if (begin != std::numeric_limits<size_t>::max())
+            {
+                size_t current = begin;
+
+                do
+                {
+                    size_t const twin = dcel.edges[current].twin_edge;
+
+                    // current starts at the vertex, its twin ends there
+                    update(2 * cache.edge_lines[current]);
+                    update(2 * cache.edge_lines[twin] + 1);
+
+                    current = dcel.edges[twin].next_edge;
+                } while (current != begin);
+
+                extend_box(cache.bounds, dcel.vertices[vertex_index].coordinate);
+            }
+
+            cache.version = dcel.version;
+        }
+
+        void update_render_cache(DCEL const & dcel, RenderCache & cache, sf::Color const & color) noexcept
+        {
+            if (cache.version != dcel.version || cache.color != color)
+            {
+                bool const is_single_move = cache.version + 1 == dcel.version &&
+                    cache.color == color &&
+                    dcel.moved_vertex != std::numeric_limits<size_t>::max();
+
+                if (is_single_move)
+                {
+                    patch_render_cache(dcel, cache, dcel.moved_vertex);
+                }
+                else
+                {
+                    rebuild_render_cache(dcel, cache, color);
+                }
+            }
+        }
+
+        void update_grid(DCEL const & dcel, RenderCache & cache) noexcept
+        {
+            if (!update_dependency(cache.grid_dependency, dcel))
+            {
+                return;
+            }
+
+            cache.grid.segments.clear();
+
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                DCEL::Edge const & edge = dcel.edges[i];
+
+                // an edge and its twin are the same segment
+                if (edge.is_exist && i < edge.twin_edge)
+                {
+                    cache.grid.segments.emplace_back(
+                        dcel.vertices[edge.origin_vertex].coordinate,
+                        dcel.vertices[dcel.edges[edge.twin_edge].origin_vertex].coordinate);
                 }
             }
 
-            window.draw(vertices);
+            build_segment_grid(cache.grid);
+        }
+
+        void draw(DCEL const & dcel, RenderCache & cache, sf::RenderWindow & window, sf::Color const & color) noexcept
+        {
+            ProfileScope const scope{ "dcel::draw" };
+
+            Box const view_box = get_view_box(window);
+            float const pixel_size = get_pixel_size(window);
+
+            // the buffer is kept up to date in both cases, its bounds choose between them
+            update_render_cache(dcel, cache, color);
+
+            if (pixel_size <= lod_pixel_size && is_box_inside(cache.bounds, view_box))
+            {
+                if (cache.buffer.getVertexCount() == cache.vertices.size())
+                {
+                    window.draw(cache.buffer);
+                }
+                else
+                {
+                    window.draw(cache.vertices.data(), cache.vertices.size(), sf::Lines);
+                }
+                return;
+            }
+
+            if (is_visible_geometry_outdated(cache.visible, view_box, pixel_size, dcel.version, color))
+            {
+                update_grid(dcel, cache);
+
+                begin_visible_geometry(cache.visible, view_box, pixel_size, dcel.version, color);
+                add_visible_segments(cache.visible, cache.grid);
+                end_visible_geometry(cache.visible);
+            }
+
+            frm::draw(cache.visible, window);
         }
 
         bool is_vertices_mode() noexcept
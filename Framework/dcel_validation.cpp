@@ -0,0 +1,591 @@
+#include "dcel_validation.h"
+
+#include "predicates.h"
+#include "view_culling.h"
+
+#include <deque>
+#include <future>
+#include <thread>
+#include <tuple>
+#include <algorithm>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        // below this number of elements a check is not split between threads
+        static constexpr size_t parallel_validation_threshold = 1 << 14;
+
+        size_t const no_index = std::numeric_limits<size_t>::max();
+
+        using Kind = ValidationIssue::Kind;
+
+        // issues found by one task, merged after all of them finish
+        struct Issues
+        {
+            std::vector<ValidationIssue> issues{};
+            size_t count{ 0 };
+        };
+
+        void add_issue(Issues & issues, size_t max_issues, ValidationIssue const & issue) noexcept
+        {
+            if (issues.issues.size() < max_issues)
+            {
+                issues.issues.push_back(issue);
+            }
+
+            ++issues.count;
+        }
+
+        template<typename T>
+        bool is_existing(std::vector<T> const & elements, size_t index) noexcept
+        {
+            return index < elements.size() && elements[index].is_exist;
+        }
+
+        // Starts check(begin, end, issues) for chunks of [0, size), every chunk gets its own issues
+        template<typename F>
+        void add_chunk_tasks(std::vector<std::future<void>> & tasks,
+            std::deque<Issues> & chunk_issues,
+            size_t size,
+            size_t threads_count,
+            F check) noexcept
+        {
+            size_t const chunks_count = std::max<size_t>(1, std::min(threads_count, size / parallel_validation_threshold));
+            size_t const chunk_size = (size + chunks_count - 1) / chunks_count;
+
+            for (size_t chunk = 0; chunk < chunks_count; ++chunk)
+            {
+                Issues & issues = chunk_issues.emplace_back();
+
+                size_t const begin = std::min(size, chunk * chunk_size);
+                size_t const end = std::min(size, begin + chunk_size);
+
+                tasks.push_back(std::async(std::launch::async, [check, &issues, begin, end]() noexcept
+                    {
+                        check(begin, end, issues);
+                    }));
+            }
+        }
+
+        // Marks the indices of a free list, out of range and repeated ones are issues
+        std::vector<uint8_t> get_free_marks(std::vector<size_t> const & free_list,
+            size_t elements_count,
+            Change::Element element,
+            size_t max_issues,
+            Issues & issues) noexcept
+        {
+            std::vector<uint8_t> is_free(elements_count, 0);
+
+            for (size_t const index : free_list)
+            {
+                if (index >= elements_count || is_free[index])
+                {
+                    add_issue(issues, max_issues, { Kind::FreeListMismatch, element, index });
+                    continue;
+                }
+
+                is_free[index] = 1;
+            }
+
+            return is_free;
+        }
+
+        // true if the edges cross, overlap or touch anywhere but at a shared vertex
+        bool is_edges_intersected(DCEL const & dcel, size_t first_edge, size_t second_edge) noexcept
+        {
+            size_t const first_begin = dcel.edges[first_edge].origin_vertex;
+            size_t const first_end = dcel.edges[dcel.edges[first_edge].twin_edge].origin_vertex;
+            size_t const second_begin = dcel.edges[second_edge].origin_vertex;
+            size_t const second_end = dcel.edges[dcel.edges[second_edge].twin_edge].origin_vertex;
+
+            bool const is_begin_shared = first_begin == second_begin || first_begin == second_end;
+            bool const is_end_shared = first_end == second_begin || first_end == second_end;
+
+            if (is_begin_shared && is_end_shared)
+            {
+                return true;
+            }
+
+            if (is_begin_shared || is_end_shared)
+            {
+                // edges from a shared vertex meet again only if they go the same way along a line
+                Point const shared = dcel.vertices[is_begin_shared ? first_begin : first_end].coordinate;
+                Point const first = dcel.vertices[is_begin_shared ? first_end : first_begin].coordinate;
+                size_t const shared_index = is_begin_shared ? first_begin : first_end;
+                Point const second = dcel.vertices[second_begin == shared_index ? second_end : second_begin].coordinate;
+
+                return get_orientation(shared, first, second) == 0 &&
+                    (first.x < shared.x) == (second.x < shared.x) && (first.x > shared.x) == (second.x > shared.x) &&
+                    (first.y < shared.y) == (second.y < shared.y) && (first.y > shared.y) == (second.y > shared.y);
+            }
+
+            Point const a = dcel.vertices[first_begin].coordinate;
+            Point const b = dcel.vertices[first_end].coordinate;
+            Point const c = dcel.vertices[second_begin].coordinate;
+            Point const d = dcel.vertices[second_end].coordinate;
+
+            int const c_side = get_orientation(a, b, c);
+            int const d_side = get_orientation(a, b, d);
+            int const a_side = get_orientation(c, d, a);
+            int const b_side = get_orientation(c, d, b);
+
+            if (c_side * d_side > 0 || a_side * b_side > 0)
+            {
+                return false;
+            }
+
+            if (c_side == 0 && d_side == 0)
+            {
+                // collinear, boxes of the segments are their projections
+                return std::max(std::min(a.x, b.x), std::min(c.x, d.x)) <= std::min(std::max(a.x, b.x), std::max(c.x, d.x)) &&
+                    std::max(std::min(a.y, b.y), std::min(c.y, d.y)) <= std::min(std::max(a.y, b.y), std::max(c.y, d.y));
+            }
+
+            return true;
+        }
+
+        // V - E + face cycles for consistent references
+        int64_t get_euler_characteristic(DCEL const & dcel, size_t & components_count, size_t & isolated_vertices_count) noexcept
+        {
+            // next is a permutation, so every walk closes
+            auto cycles_task = std::async(std::launch::async, [&dcel]() noexcept
+                {
+                    std::vector<uint8_t> is_visited(dcel.edges.size(), 0);
+                    size_t cycles_count = 0;
+
+                    for (size_t i = 0; i < dcel.edges.size(); ++i)
+                    {
+                        if (!dcel.edges[i].is_exist || is_visited[i])
+                        {
+                            continue;
+                        }
+
+                        ++cycles_count;
+
+                        size_t current = i;
+                        do
+                        {
+                            is_visited[current] = 1;
+                            current = dcel.edges[current].next_edge;
+                        } while (current != i);
+                    }
+
+                    return cycles_count;
+                });
+
+            // union-find of the vertices joined by edges
+            std::vector<size_t> parents(dcel.vertices.size());
+            std::vector<uint8_t> has_edges(dcel.vertices.size(), 0);
+            for (size_t i = 0; i < parents.size(); ++i)
+            {
+                parents[i] = i;
+            }
+
+            auto const find = [&parents](size_t vertex) noexcept
+            {
+                while (parents[vertex] != vertex)
+                {
+                    parents[vertex] = parents[parents[vertex]];
+                    vertex = parents[vertex];
+                }
+
+                return vertex;
+            };
+
+            size_t edges_count = 0;
+
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                DCEL::Edge const & edge = dcel.edges[i];
+
+                if (!edge.is_exist || edge.twin_edge < i)
+                {
+                    continue;
+                }
+
+                ++edges_count;
+
+                size_t const begin = edge.origin_vertex;
+                size_t const end = dcel.edges[edge.twin_edge].origin_vertex;
+
+                has_edges[begin] = 1;
+                has_edges[end] = 1;
+                parents[find(begin)] = find(end);
+            }
+
+            size_t vertices_count = 0;
+            components_count = 0;
+            isolated_vertices_count = 0;
+
+            for (size_t i = 0; i < dcel.vertices.size(); ++i)
+            {
+                if (!dcel.vertices[i].is_exist)
+                {
+                    continue;
+                }
+
+                ++vertices_count;
+
+                if (!has_edges[i])
+                {
+                    ++isolated_vertices_count;
+                }
+                else if (find(i) == i)
+                {
+                    ++components_count;
+                }
+            }
+
+            size_t const cycles_count = cycles_task.get();
+
+            return static_cast<int64_t>(vertices_count) - static_cast<int64_t>(edges_count) + static_cast<int64_t>(cycles_count);
+        }
+
+        ValidationResult validate(DCEL const & dcel, ValidationOptions const & options) noexcept
+        {
+            size_t const threads_count = options.threads_count != 0 ?
+                options.threads_count :
+                std::max<size_t>(1, std::thread::hardware_concurrency());
+            size_t const max_issues = options.max_issues;
+
+            // the issues of the references and of the geometry are kept apart,
+            // the Euler characteristic needs the references to be consistent
+            std::deque<Issues> reference_issues(1);
+            std::deque<Issues> geometry_issues(1);
+            std::vector<std::future<void>> reference_tasks{};
+            std::vector<std::future<void>> geometry_tasks{};
+
+            std::vector<uint8_t> const is_free_vertex = get_free_marks(dcel.free_vertices, dcel.vertices.size(), Change::Element::Vertex, max_issues, reference_issues.front());
+            std::vector<uint8_t> const is_free_edge = get_free_marks(dcel.free_edges, dcel.edges.size(), Change::Element::Edge, max_issues, reference_issues.front());
+            std::vector<uint8_t> const is_free_face = get_free_marks(dcel.free_faces, dcel.faces.size(), Change::Element::Face, max_issues, reference_issues.front());
+
+            add_chunk_tasks(reference_tasks, reference_issues, dcel.vertices.size(), threads_count,
+                [&dcel, &is_free_vertex, max_issues](size_t begin, size_t end, Issues & issues) noexcept
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        DCEL::Vertex const & vertex = dcel.vertices[i];
+
+                        if (vertex.is_exist == static_cast<bool>(is_free_vertex[i]))
+                        {
+                            add_issue(issues, max_issues, { Kind::FreeListMismatch, Change::Element::Vertex, i });
+                        }
+
+                        if (!vertex.is_exist || vertex.incident_edge == no_index)
+                        {
+                            continue;
+                        }
+
+                        if (!is_existing(dcel.edges, vertex.incident_edge))
+                        {
+                            add_issue(issues, max_issues, { Kind::BadReference, Change::Element::Vertex, i, vertex.incident_edge });
+                        }
+                        else if (dcel.edges[vertex.incident_edge].origin_vertex != i)
+                        {
+                            add_issue(issues, max_issues, { Kind::VertexEdgeNotOwned, Change::Element::Vertex, i, vertex.incident_edge });
+                        }
+                    }
+                });
+
+            add_chunk_tasks(reference_tasks, reference_issues, dcel.faces.size(), threads_count,
+                [&dcel, &is_free_face, max_issues](size_t begin, size_t end, Issues & issues) noexcept
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        DCEL::Face const & face = dcel.faces[i];
+
+                        if (face.is_exist == static_cast<bool>(is_free_face[i]))
+                        {
+                            add_issue(issues, max_issues, { Kind::FreeListMismatch, Change::Element::Face, i });
+                        }
+
+                        // the outside face has no boundary in an empty subdivision
+                        if (!face.is_exist || (i == 0 && face.edge == no_index))
+                        {
+                            continue;
+                        }
+
+                        if (!is_existing(dcel.edges, face.edge))
+                        {
+                            add_issue(issues, max_issues, { Kind::BadReference, Change::Element::Face, i, face.edge });
+                        }
+                        else if (dcel.edges[face.edge].incident_face != i)
+                        {
+                            add_issue(issues, max_issues, { Kind::FaceEdgeNotOwned, Change::Element::Face, i, face.edge });
+                        }
+                    }
+                });
+
+            add_chunk_tasks(reference_tasks, reference_issues, dcel.edges.size(), threads_count,
+                [&dcel, &is_free_edge, max_issues](size_t begin, size_t end, Issues & issues) noexcept
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        DCEL::Edge const & edge = dcel.edges[i];
+
+                        auto const add = [&issues, max_issues, i](Kind kind, size_t other_index) noexcept
+                        {
+                            add_issue(issues, max_issues, { kind, Change::Element::Edge, i, other_index });
+                        };
+
+                        if (edge.is_exist == static_cast<bool>(is_free_edge[i]))
+                        {
+                            add(Kind::FreeListMismatch, no_index);
+                        }
+
+                        if (!edge.is_exist)
+                        {
+                            continue;
+                        }
+
+                        bool is_referencing = true;
+
+                        for (size_t const edge_index : { edge.twin_edge, edge.next_edge, edge.previous_edge })
+                        {
+                            if (!is_existing(dcel.edges, edge_index))
+                            {
+                                add(Kind::BadReference, edge_index);
+                                is_referencing = false;
+                            }
+                        }
+
+                        if (!is_existing(dcel.vertices, edge.origin_vertex))
+                        {
+                            add(Kind::BadReference, edge.origin_vertex);
+                            is_referencing = false;
+                        }
+
+                        if (!is_existing(dcel.faces, edge.incident_face))
+                        {
+                            add(Kind::BadReference, edge.incident_face);
+                            is_referencing = false;
+                        }
+
+                        if (!is_referencing)
+                        {
+                            continue;
+                        }
+
+                        DCEL::Edge const & twin = dcel.edges[edge.twin_edge];
+                        DCEL::Edge const & next = dcel.edges[edge.next_edge];
+                        DCEL::Edge const & previous = dcel.edges[edge.previous_edge];
+
+                        if (edge.twin_edge == i || twin.twin_edge != i)
+                        {
+                            add(Kind::TwinNotSymmetric, edge.twin_edge);
+                        }
+
+                        if (next.previous_edge != i)
+                        {
+                            add(Kind::NextPreviousNotInverse, edge.next_edge);
+                        }
+
+                        if (previous.next_edge != i)
+                        {
+                            add(Kind::NextPreviousNotInverse, edge.previous_edge);
+                        }
+
+                        if (next.origin_vertex != twin.origin_vertex)
+                        {
+                            add(Kind::NextNotConnected, edge.next_edge);
+                        }
+
+                        if (next.incident_face != edge.incident_face)
+                        {
+                            add(Kind::FaceCycleMismatch, edge.next_edge);
+                        }
+
+                        if (dcel.vertices[edge.origin_vertex].incident_edge == no_index)
+                        {
+                            add_issue(issues, max_issues, { Kind::VertexEdgeNotOwned, Change::Element::Vertex, edge.origin_vertex, i });
+                        }
+                    }
+                });
+
+            // every edge once in a grid, pairs of edges are tested in the cells they share
+            SegmentGrid grid{};
+            std::vector<size_t> segment_edges{};
+            std::vector<Box> segment_boxes{};
+
+            if (options.is_checking_planarity)
+            {
+                grid.segments.reserve(dcel.edges.size() / 2);
+                segment_edges.reserve(dcel.edges.size() / 2);
+                segment_boxes.reserve(dcel.edges.size() / 2);
+
+                for (size_t i = 0; i < dcel.edges.size(); ++i)
+                {
+                    DCEL::Edge const & edge = dcel.edges[i];
+
+                    if (!edge.is_exist || !is_existing(dcel.edges, edge.twin_edge) || edge.twin_edge < i ||
+                        !is_existing(dcel.vertices, edge.origin_vertex) ||
+                        !is_existing(dcel.vertices, dcel.edges[edge.twin_edge].origin_vertex))
+                    {
+                        continue;
+                    }
+
+                    Point const begin = dcel.vertices[edge.origin_vertex].coordinate;
+                    Point const end = dcel.vertices[dcel.edges[edge.twin_edge].origin_vertex].coordinate;
+
+                    if (begin.x == end.x && begin.y == end.y)
+                    {
+                        add_issue(geometry_issues.front(), max_issues, { Kind::ZeroLengthEdge, Change::Element::Edge, i });
+                        continue;
+                    }
+
+                    grid.segments.push_back({ begin, end });
+                    segment_edges.push_back(i);
+                    segment_boxes.push_back(get_segment_box(grid.segments.back()));
+                }
+
+                build_segment_grid(grid);
+
+                add_chunk_tasks(geometry_tasks, geometry_issues, grid.columns * grid.rows, threads_count,
+                    [&dcel, &grid, &segment_edges, &segment_boxes, max_issues](size_t begin, size_t end, Issues & issues) noexcept
+                    {
+                        for (size_t cell = begin; cell < end; ++cell)
+                        {
+                            for (size_t i = grid.cell_offsets[cell]; i < grid.cell_offsets[cell + 1]; ++i)
+                            {
+                                for (size_t j = i + 1; j < grid.cell_offsets[cell + 1]; ++j)
+                                {
+                                    Box const & first = segment_boxes[grid.cell_segments[i]];
+                                    Box const & second = segment_boxes[grid.cell_segments[j]];
+
+                                    if (!is_boxes_intersected(first, second))
+                                    {
+                                        continue;
+                                    }
+
+                                    // the pair is tested only in the first cell of the intersection of the boxes
+                                    size_t const column = get_cell_index(std::max(first.min.x, second.min.x), grid.bounds.min.x, grid.cell_size.x, grid.columns);
+                                    size_t const row = get_cell_index(std::max(first.min.y, second.min.y), grid.bounds.min.y, grid.cell_size.y, grid.rows);
+
+                                    if (row * grid.columns + column != cell)
+                                    {
+                                        continue;
+                                    }
+
+                                    size_t const first_edge = segment_edges[grid.cell_segments[i]];
+                                    size_t const second_edge = segment_edges[grid.cell_segments[j]];
+
+                                    if (is_edges_intersected(dcel, first_edge, second_edge))
+                                    {
+                                        add_issue(issues, max_issues, { Kind::EdgesIntersect, Change::Element::Edge,
+                                            std::min(first_edge, second_edge), std::max(first_edge, second_edge) });
+                                    }
+                                }
+                            }
+                        }
+                    });
+            }
+
+            ValidationResult result{};
+
+            auto const merge = [&result](std::deque<Issues> const & chunk_issues) noexcept
+            {
+                for (Issues const & issues : chunk_issues)
+                {
+                    result.issues.insert(result.issues.end(), issues.issues.begin(), issues.issues.end());
+                    result.issues_count += issues.count;
+                }
+            };
+
+            for (std::future<void> & task : reference_tasks)
+            {
+                task.get();
+            }
+
+            merge(reference_issues);
+
+            // while the geometry tasks run
+            if (result.issues_count == 0)
+            {
+                size_t components_count = 0;
+                size_t isolated_vertices_count = 0;
+                int64_t const euler_characteristic = get_euler_characteristic(dcel, components_count, isolated_vertices_count);
+
+                if (euler_characteristic != static_cast<int64_t>(2 * components_count + isolated_vertices_count))
+                {
+                    result.issues.push_back({ Kind::EulerCharacteristic, Change::Element::Face, 0 });
+                    ++result.issues_count;
+                }
+            }
+
+            for (std::future<void> & task : geometry_tasks)
+            {
+                task.get();
+            }
+
+            merge(geometry_issues);
+
+            std::sort(result.issues.begin(), result.issues.end(), [](ValidationIssue const & a, ValidationIssue const & b) noexcept
+                {
+                    return std::tie(a.kind, a.element, a.index, a.other_index) < std::tie(b.kind, b.element, b.index, b.other_index);
+                });
+
+            if (result.issues.size() > max_issues)
+            {
+                result.issues.resize(max_issues);
+            }
+
+            return result;
+        }
+
+        bool is_valid(DCEL const & dcel) noexcept
+        {
+            ValidationOptions options{};
+            options.max_issues = 0;
+
+            return validate(dcel, options).issues_count == 0;
+        }
+
+        char const * get_validation_issue_name(ValidationIssue::Kind kind) noexcept
+        {
+            switch (kind)
+            {
+            case Kind::BadReference:
+                return "Bad reference";
+            case Kind::TwinNotSymmetric:
+                return "Twin not symmetric";
+            case Kind::NextPreviousNotInverse:
+                return "Next and previous not inverse";
+            case Kind::NextNotConnected:
+                return "Next not connected";
+            case Kind::FaceCycleMismatch:
+                return "Face cycle mismatch";
+            case Kind::VertexEdgeNotOwned:
+                return "Vertex edge not owned";
+            case Kind::FaceEdgeNotOwned:
+                return "Face edge not owned";
+            case Kind::FreeListMismatch:
+                return "Free list mismatch";
+            case Kind::EulerCharacteristic:
+                return "Euler characteristic";
+            case Kind::ZeroLengthEdge:
+                return "Zero length edge";
+            case Kind::EdgesIntersect:
+                return "Edges intersect";
+            default:
+                return "Unknown";
+            }
+        }
+
+        std::ostream & operator<<(std::ostream & os, ValidationIssue const & issue) noexcept
+        {
+            char const * const element_names[] = { "vertex", "edge", "face" };
+
+            os << get_validation_issue_name(issue.kind) << ": " <<
+                element_names[static_cast<size_t>(issue.element)] << ' ' << issue.index;
+
+            if (issue.other_index != no_index)
+            {
+                os << " -> " << issue.other_index;
+            }
+
+            return os;
+        }
+    }
+}
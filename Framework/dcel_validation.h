@@ -0,0 +1,81 @@
+#pragma once
+
+
+#include "dcel.h"
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <iostream>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        struct ValidationIssue
+        {
+            enum class Kind : uint8_t
+            {
+                // index out of range or of an element that doesn't exist
+                BadReference,
+                // twin of the twin is another edge
+                TwinNotSymmetric,
+                // previous of the next or next of the previous is another edge
+                NextPreviousNotInverse,
+                // next edge doesn't start at the end of the edge
+                NextNotConnected,
+                // next edge has another incident face
+                FaceCycleMismatch,
+                // incident edge of the vertex starts at another vertex,
+                // or the vertex has none while an edge starts at it
+                VertexEdgeNotOwned,
+                // edge of the face has another incident face
+                FaceEdgeNotOwned,
+                // free list and is_exist disagree, or the free list has an index twice
+                FreeListMismatch,
+                // V - E + face cycles is not 2 per connected component and 1 per isolated vertex,
+                // reported once for face 0
+                EulerCharacteristic,
+                ZeroLengthEdge,
+                // two edges cross, overlap or touch anywhere but at a shared vertex
+                EdgesIntersect
+            };
+
+            Kind kind;
+            Change::Element element;
+            size_t index;
+            // the other edge of intersecting edges or the wrong reference,
+            // std::numeric_limits<size_t>::max() if there is none
+            size_t other_index{ std::numeric_limits<size_t>::max() };
+        };
+
+        struct ValidationOptions
+        {
+            // finding intersecting edges is the slowest check
+            bool is_checking_planarity{ true };
+            // issues kept in the result, the rest are only counted
+            size_t max_issues{ 64 };
+            // 0 - std::thread::hardware_concurrency()
+            size_t threads_count{ 0 };
+        };
+
+        struct ValidationResult
+        {
+            // sorted by kind and index
+            std::vector<ValidationIssue> issues{};
+            size_t issues_count{ 0 };
+        };
+
+        // Checks the element arrays in parallel chunks, so it never walks a broken face cycle.
+        // The Euler characteristic is checked only if the references are consistent,
+        // isolated vertices (without an incident edge) and face 0 without an edge are allowed.
+        ValidationResult validate(DCEL const & dcel, ValidationOptions const & options = {}) noexcept;
+
+        bool is_valid(DCEL const & dcel) noexcept;
+
+        char const * get_validation_issue_name(ValidationIssue::Kind kind) noexcept;
+
+        std::ostream & operator<<(std::ostream & os, ValidationIssue const & issue) noexcept;
+    }
+}
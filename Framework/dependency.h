@@ -0,0 +1,57 @@
+#pragma once
+
+
+#include <limits>
+#include <cstdint>
+
+
+namespace frm
+{
+    // Changes of a dcel or vvve that derived data depends on
+    enum class DependsOn : uint8_t
+    {
+        // elements added, removed or reconnected
+        Structure = 1,
+        // existing vertices moved or removed
+        Geometry = 2,
+        Everything = Structure | Geometry
+    };
+
+    // Versions of the dcel or vvve that derived data was built from.
+    // A new dependency is outdated until the first update.
+    struct Dependency
+    {
+        DependsOn depends_on{ DependsOn::Everything };
+        size_t structure_version{ std::numeric_limits<size_t>::max() };
+        size_t geometry_version{ std::numeric_limits<size_t>::max() };
+    };
+
+    static constexpr bool is_depends_on(Dependency const & dependency, DependsOn depends_on) noexcept
+    {
+        return (static_cast<uint8_t>(dependency.depends_on) & static_cast<uint8_t>(depends_on)) != 0;
+    }
+
+    // Source - dcel::DCEL or vvve::VVVE
+    template<typename Source>
+    bool is_outdated(Dependency const & dependency, Source const & source) noexcept
+    {
+        return (is_depends_on(dependency, DependsOn::Structure) && dependency.structure_version != source.structure_version) ||
+            (is_depends_on(dependency, DependsOn::Geometry) && dependency.geometry_version != source.geometry_version);
+    }
+
+    template<typename Source>
+    void set_up_to_date(Dependency & dependency, Source const & source) noexcept
+    {
+        dependency.structure_version = source.structure_version;
+        dependency.geometry_version = source.geometry_version;
+    }
+
+    // true if the derived data has to be rebuilt, the dependency is up to date afterwards
+    template<typename Source>
+    bool update_dependency(Dependency & dependency, Source const & source) noexcept
+    {
+        bool const is_dependency_outdated = is_outdated(dependency, source);
+        set_up_to_date(dependency, source);
+        return is_dependency_outdated;
+    }
+}
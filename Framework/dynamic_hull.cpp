@@ -0,0 +1,224 @@
+#include "dynamic_hull.h"
+
+#include "predicates.h"
+
+#include <algorithm>
+#include <iterator>
+
+
+namespace frm
+{
+    struct ChainEdge
+    {
+        vvve::VVVE::edge_t edge;
+        Point begin;
+    };
+
+    bool operator==(ChainEdge const & a, ChainEdge const & b) noexcept
+    {
+        return a.edge == b.edge;
+    }
+
+    bool is_chain_edge(DynamicHull::chain_t const & chain, ChainEdge const & chain_edge) noexcept
+    {
+        auto const iterator = chain.find(chain_edge.begin);
+
+        return iterator != chain.end() &&
+            iterator->second == chain_edge.edge.first &&
+            std::next(iterator) != chain.end() &&
+            std::next(iterator)->second == chain_edge.edge.second;
+    }
+
+    bool contains(std::vector<ChainEdge> const & chain_edges, ChainEdge const & chain_edge) noexcept
+    {
+        return std::find(chain_edges.begin(), chain_edges.end(), chain_edge) != chain_edges.end();
+    }
+
+    // turn_sign: -1 - upper chain (only right turns are allowed), 1 - lower chain (only left turns)
+    void insert_point_to_chain(
+        DynamicHull::chain_t & chain,
+        Point point,
+        size_t index,
+        double turn_sign,
+        std::vector<ChainEdge> & added_edges,
+        std::vector<ChainEdge> & removed_edges) noexcept
+    {
+        if (chain.find(point) != chain.end())
+        {
+            return;
+        }
+
+        auto next = chain.lower_bound(point);
+
+        if (next != chain.end() && next != chain.begin())
+        {
+            auto const previous = std::prev(next);
+
+            // point is inside of the chain
+            if (turn_sign * orient2d(previous->first, point, next->first) <= 0.)
+            {
+                return;
+            }
+
+            removed_edges.push_back({ { previous->second, next->second }, previous->first });
+        }
+
+        auto const current = chain.emplace_hint(next, point, index);
+
+        // remove vertices that are not convex anymore
+        if (current != chain.begin())
+        {
+            auto previous = std::prev(current);
+
+            while (previous != chain.begin())
+            {
+                auto const before_previous = std::prev(previous);
+
+                if (turn_sign * orient2d(before_previous->first, previous->first, point) > 0.)
+                {
+                    break;
+                }
+
+                removed_edges.push_back({ { before_previous->second, previous->second }, before_previous->first });
+                chain.erase(previous);
+                previous = before_previous;
+            }
+
+            added_edges.push_back({ { previous->second, index }, previous->first });
+        }
+
+        next = std::next(current);
+        if (next != chain.end())
+        {
+            auto after_next = std::next(next);
+
+            while (after_next != chain.end())
+            {
+                if (turn_sign * orient2d(point, next->first, after_next->first) > 0.)
+                {
+                    break;
+                }
+
+                removed_edges.push_back({ { next->second, after_next->second }, next->first });
+                chain.erase(next);
+                next = after_next;
+                after_next = std::next(next);
+            }
+
+            added_edges.push_back({ { index, next->second }, point });
+        }
+    }
+
+    HullDelta insert_point(DynamicHull & hull, Point point, size_t index) noexcept
+    {
+        std::vector<ChainEdge> upper_added_edges{};
+        std::vector<ChainEdge> upper_removed_edges{};
+        std::vector<ChainEdge> lower_added_edges{};
+        std::vector<ChainEdge> lower_removed_edges{};
+
+        insert_point_to_chain(hull.upper, point, index, -1., upper_added_edges, upper_removed_edges);
+        insert_point_to_chain(hull.lower, point, index, 1., lower_added_edges, lower_removed_edges);
+
+        // Hull edges are the union of both chains, they share edges while the hull is a segment.
+        HullDelta delta{};
+
+        auto const was_chain_edge = [](DynamicHull::chain_t const & chain,
+            std::vector<ChainEdge> const & added_edges,
+            std::vector<ChainEdge> const & removed_edges,
+            ChainEdge const & chain_edge) noexcept
+        {
+            return (is_chain_edge(chain, chain_edge) && !contains(added_edges, chain_edge)) ||
+                contains(removed_edges, chain_edge);
+        };
+
+        for (ChainEdge const & chain_edge : upper_added_edges)
+        {
+            if (!was_chain_edge(hull.lower, lower_added_edges, lower_removed_edges, chain_edge))
+            {
+                delta.added_edges.push_back(chain_edge.edge);
+            }
+        }
+        for (ChainEdge const & chain_edge : lower_added_edges)
+        {
+            if (!was_chain_edge(hull.upper, upper_added_edges, upper_removed_edges, chain_edge) &&
+                !contains(upper_added_edges, chain_edge))
+            {
+                delta.added_edges.push_back(chain_edge.edge);
+            }
+        }
+
+        for (ChainEdge const & chain_edge : upper_removed_edges)
+        {
+            if (!is_chain_edge(hull.lower, chain_edge))
+            {
+                delta.removed_edges.push_back(chain_edge.edge);
+            }
+        }
+        for (ChainEdge const & chain_edge : lower_removed_edges)
+        {
+            if (!is_chain_edge(hull.upper, chain_edge) && !contains(upper_removed_edges, chain_edge))
+            {
+                delta.removed_edges.push_back(chain_edge.edge);
+            }
+        }
+
+        return delta;
+    }
+
+    void merge_hull_delta(HullDelta & accumulated, HullDelta const & delta) noexcept
+    {
+        for (vvve::VVVE::edge_t const & edge : delta.removed_edges)
+        {
+            auto const added = accumulated.added_edge_positions.find(edge);
+
+            if (added == accumulated.added_edge_positions.end())
+            {
+                accumulated.removed_edges.push_back(edge);
+                continue;
+            }
+
+            // the last added edge takes the place of the removed one
+            size_t const position = added->second;
+            accumulated.added_edge_positions.erase(added);
+
+            if (position + 1 != accumulated.added_edges.size())
+            {
+                accumulated.added_edges[position] = accumulated.added_edges.back();
+                accumulated.added_edge_positions[accumulated.added_edges[position]] = position;
+            }
+            accumulated.added_edges.pop_back();
+        }
+
+        for (vvve::VVVE::edge_t const & edge : delta.added_edges)
+        {
+            accumulated.added_edge_positions[edge] = accumulated.added_edges.size();
+            accumulated.added_edges.push_back(edge);
+        }
+    }
+
+    std::vector<vvve::VVVE::edge_t> get_hull_edges(DynamicHull const & hull) noexcept
+    {
+        std::vector<vvve::VVVE::edge_t> edges{};
+
+        for (DynamicHull::chain_t const * chain : { &hull.upper, &hull.lower })
+        {
+            for (auto current = chain->begin(); current != chain->end() && std::next(current) != chain->end(); ++current)
+            {
+                vvve::VVVE::edge_t const edge{ current->second, std::next(current)->second };
+
+                if (chain == &hull.upper || std::find(edges.begin(), edges.end(), edge) == edges.end())
+                {
+                    edges.push_back(edge);
+                }
+            }
+        }
+
+        return edges;
+    }
+
+    void clear(DynamicHull & hull) noexcept
+    {
+        hull.upper.clear();
+        hull.lower.clear();
+    }
+}
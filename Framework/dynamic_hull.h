@@ -0,0 +1,50 @@
+#pragma once
+
+
+#include "vvve.h"
+
+#include <map>
+
+
+namespace frm
+{
+    // Convex hull that supports insertion of points one at a time.
+    // Upper and lower chains are kept ordered by x (and by y for equal x).
+    struct DynamicHull
+    {
+        struct PointLess
+        {
+            bool operator()(Point a, Point b) const noexcept
+            {
+                return a.x < b.x || (a.x == b.x && a.y < b.y);
+            }
+        };
+
+        // point - index of vertex
+        using chain_t = std::map<Point, size_t, PointLess>;
+
+        chain_t upper{};
+        chain_t lower{};
+    };
+
+    // Hull edges are stored from the point with lower x to the point with higher x
+    struct HullDelta
+    {
+        std::vector<vvve::VVVE::edge_t> added_edges{};
+        std::vector<vvve::VVVE::edge_t> removed_edges{};
+
+        // edge - position in added_edges, kept by merge_hull_delta
+        std::map<vvve::VVVE::edge_t, size_t> added_edge_positions{};
+    };
+
+    // O(log(n)) amortized
+    HullDelta insert_point(DynamicHull & hull, Point point, size_t index) noexcept;
+
+    // Appends delta of the next insertion, edges that were added and removed again cancel out.
+    // O(log(n)) per edge, order of accumulated.added_edges is not kept
+    void merge_hull_delta(HullDelta & accumulated, HullDelta const & delta) noexcept;
+
+    std::vector<vvve::VVVE::edge_t> get_hull_edges(DynamicHull const & hull) noexcept;
+
+    void clear(DynamicHull & hull) noexcept;
+}
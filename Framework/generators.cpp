@@ -0,0 +1,533 @@
+#include "generators.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <algorithm>
+
+
+namespace frm
+{
+    size_t const no_index = std::numeric_limits<size_t>::max();
+
+    // distance kept between neighbour vertices
+    static constexpr float vertex_spacing = 10.f;
+
+    // [min, max) from the upper 24 bits, exact in float
+    float get_uniform(std::mt19937 & generator, float min, float max) noexcept
+    {
+        return min + (max - min) * static_cast<float>(generator() >> 8) * (1.f / 16777216.f);
+    }
+
+    // Box-Muller transform
+    float get_normal(std::mt19937 & generator, float deviation) noexcept
+    {
+        float const u = get_uniform(generator, 0.f, 1.f);
+        float const v = get_uniform(generator, 0.f, 1.f);
+
+        return deviation * std::sqrt(-2.f * std::log(1.f - u)) * std::cos(2.f * pi * v);
+    }
+
+    // radius of a star from generate_star with radii in [radius / 2, radius]
+    // that keeps its neighbour vertices vertex_spacing apart
+    float get_star_radius(size_t size) noexcept
+    {
+        return vertex_spacing * static_cast<float>(std::max<size_t>(size, 3)) / pi;
+    }
+
+    // Counterclockwise around the center with evenly spaced angles,
+    // simple for any radii because every vertex is seen from the center.
+    // The radius follows a few random waves with a small jitter, so the edges stay short.
+    std::vector<Point> generate_star(std::mt19937 & generator, Point center, size_t size, float min_radius, float max_radius) noexcept
+    {
+        size_t const waves_count = 3;
+        float frequencies[waves_count];
+        float phases[waves_count];
+
+        for (size_t i = 0; i < waves_count; ++i)
+        {
+            frequencies[i] = static_cast<float>(1 + generator() % 8);
+            phases[i] = get_uniform(generator, 0.f, 2.f * pi);
+        }
+
+        float const middle = 0.5f * (min_radius + max_radius);
+        float const amplitude = 0.5f * (max_radius - min_radius);
+        // at most half of the distance between neighbour vertices on the smallest radius
+        float const jitter = std::min(0.25f * amplitude, pi * min_radius / static_cast<float>(size));
+
+        std::vector<Point> points(size);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            float const angle = 2.f * pi * static_cast<float>(i) / static_cast<float>(size);
+
+            float wave = 0.f;
+            for (size_t j = 0; j < waves_count; ++j)
+            {
+                wave += std::sin(frequencies[j] * angle + phases[j]);
+            }
+
+            float const radius = middle + (amplitude - jitter) * wave / static_cast<float>(waves_count) +
+                get_uniform(generator, -jitter, jitter);
+
+            points[i] = { center.x + radius * std::cos(angle), center.y + radius * std::sin(angle) };
+        }
+
+        return points;
+    }
+
+    size_t add_face(dcel::DCEL & dcel) noexcept
+    {
+        dcel.faces.push_back({ no_index });
+
+        return dcel.faces.size() - 1;
+    }
+
+    // Closed ring of new vertices given counterclockwise, inside_face is on the left of it.
+    // The faces get an edge of the ring if they don't have one yet.
+    void add_ring(dcel::DCEL & dcel, std::vector<Point> const & points, size_t inside_face, size_t outside_face) noexcept
+    {
+        size_t const size = points.size();
+        size_t const first_vertex = dcel.vertices.size();
+        size_t const first_edge = dcel.edges.size();
+
+        // edge 2 * i goes from vertex i to vertex i + 1, edge 2 * i + 1 is its twin
+        for (size_t i = 0; i < size; ++i)
+        {
+            size_t const next = (i + 1) % size;
+            size_t const previous = (i + size - 1) % size;
+
+            dcel.vertices.push_back({ points[i], first_edge + 2 * i });
+
+            dcel.edges.push_back({ first_vertex + i, first_edge + 2 * i + 1, inside_face,
+                first_edge + 2 * next, first_edge + 2 * previous });
+            dcel.edges.push_back({ first_vertex + next, first_edge + 2 * i, outside_face,
+                first_edge + 2 * previous + 1, first_edge + 2 * next + 1 });
+        }
+
+        if (dcel.faces[inside_face].edge == no_index)
+        {
+            dcel.faces[inside_face].edge = first_edge;
+        }
+
+        if (dcel.faces[outside_face].edge == no_index)
+        {
+            dcel.faces[outside_face].edge = first_edge + 1;
+        }
+    }
+
+    dcel::DCEL make_dcel_from_cells(std::vector<Point> const & points,
+        std::vector<size_t> const & cells,
+        std::vector<size_t> const & cell_offsets) noexcept
+    {
+        dcel::DCEL dcel{};
+
+        size_t const cells_count = cell_offsets.size() - 1;
+
+        dcel.vertices.resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            dcel.vertices[i] = { points[i], no_index };
+        }
+
+        dcel.faces.resize(cells_count + 1, { no_index });
+        dcel.edges.reserve(2 * cells.size());
+
+        // the edge from cells[j] to the next vertex of its cell is edge j
+        for (size_t i = 0; i < cells_count; ++i)
+        {
+            size_t const first = cell_offsets[i];
+            size_t const count = cell_offsets[i + 1] - first;
+
+            for (size_t j = 0; j < count; ++j)
+            {
+                size_t const origin = cells[first + j];
+
+                dcel.edges.push_back({ origin, no_index, i + 1,
+                    first + (j + 1) % count, first + (j + count - 1) % count });
+                dcel.vertices[origin].incident_edge = first + j;
+            }
+
+            dcel.faces[i + 1].edge = first;
+        }
+
+        // twins are next to each other once sorted by their unordered vertices
+        std::vector<std::pair<uint64_t, size_t>> keys(cells.size());
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            uint64_t const origin = dcel.edges[i].origin_vertex;
+            uint64_t const destination = dcel.edges[dcel.edges[i].next_edge].origin_vertex;
+
+            keys[i] = { std::min(origin, destination) * points.size() + std::max(origin, destination), i };
+        }
+        std::sort(keys.begin(), keys.end());
+
+        for (size_t i = 0; i + 1 < keys.size(); ++i)
+        {
+            if (keys[i].first == keys[i + 1].first)
+            {
+                dcel.edges[keys[i].second].twin_edge = keys[i + 1].second;
+                dcel.edges[keys[i + 1].second].twin_edge = keys[i].second;
+                ++i;
+            }
+        }
+
+        size_t const inner_edges_count = dcel.edges.size();
+        std::vector<size_t> outgoing_boundary_edges(points.size(), no_index);
+
+        for (size_t i = 0; i < inner_edges_count; ++i)
+        {
+            if (dcel.edges[i].twin_edge == no_index)
+            {
+                size_t const destination = dcel.edges[dcel.edges[i].next_edge].origin_vertex;
+
+                dcel.edges[i].twin_edge = dcel.edges.size();
+                outgoing_boundary_edges[destination] = dcel.edges.size();
+
+                dcel.edges.push_back({ destination, i, 0, no_index, no_index });
+            }
+        }
+
+        // around the cells clockwise
+        for (size_t i = inner_edges_count; i < dcel.edges.size(); ++i)
+        {
+            size_t const destination = dcel.edges[dcel.edges[i].twin_edge].origin_vertex;
+            size_t const next = outgoing_boundary_edges[destination];
+
+            dcel.edges[i].next_edge = next;
+            dcel.edges[next].previous_edge = i;
+        }
+
+        dcel.faces[0].edge = inner_edges_count;
+
+        return dcel;
+    }
+
+    std::vector<Point> generate_points(PointDistribution distribution, size_t size, uint32_t seed) noexcept
+    {
+        std::mt19937 generator{ seed };
+
+        size_t const clusters_count = 16;
+        std::vector<Point> cluster_centers(clusters_count);
+        for (Point & cluster_center : cluster_centers)
+        {
+            cluster_center = { get_uniform(generator, 0.f, 1000.f), get_uniform(generator, 0.f, 1000.f) };
+        }
+
+        std::vector<Point> points(size);
+
+        for (Point & point : points)
+        {
+            switch (distribution)
+            {
+            case PointDistribution::Uniform:
+                point = { get_uniform(generator, 0.f, 1000.f), get_uniform(generator, 0.f, 1000.f) };
+                break;
+            case PointDistribution::Clustered:
+            {
+                Point const center = cluster_centers[generator() % clusters_count];
+                point = { center.x + get_normal(generator, 10.f), center.y + get_normal(generator, 10.f) };
+                break;
+            }
+            case PointDistribution::Circular:
+            {
+                float const angle = get_uniform(generator, 0.f, 2.f * pi);
+                point = { 500.f + 400.f * std::cos(angle), 500.f + 400.f * std::sin(angle) };
+                break;
+            }
+            case PointDistribution::Collinear:
+            {
+                // exact while 3 * size < 2^24
+                float const t = static_cast<float>(generator() % size);
+                point = { 3.f * t, 2.f * t };
+                break;
+            }
+            }
+        }
+
+        return points;
+    }
+
+    vvve::VVVE generate_vvve(PointDistribution distribution, size_t size, uint32_t seed) noexcept
+    {
+        std::vector<Point> const points = generate_points(distribution, size, seed);
+
+        vvve::VVVE vvve{};
+        vvve.vertices.resize(size);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            vvve.vertices[i].coordinate = points[i];
+        }
+
+        return vvve;
+    }
+
+    // Faces: 0 - outside, 1 - inside
+    dcel::DCEL generate_simple_polygon(size_t size, uint32_t seed) noexcept
+    {
+        std::mt19937 generator{ seed };
+
+        size = std::max<size_t>(size, 3);
+
+        dcel::DCEL dcel{};
+        size_t const outside_face = add_face(dcel);
+        size_t const inside_face = add_face(dcel);
+
+        float const radius = get_star_radius(size);
+        add_ring(dcel, generate_star(generator, { 0.f, 0.f }, size, 0.5f * radius, radius), inside_face, outside_face);
+
+        return dcel;
+    }
+
+    // Faces: 0 - outside, 1 - inside.
+    // Holes are stars in a square grid around the center of the polygon,
+    // the square fits into the smallest possible radius of the outer star.
+    dcel::DCEL generate_polygon_with_holes(size_t size, size_t holes_count, uint32_t seed) noexcept
+    {
+        std::mt19937 generator{ seed };
+
+        holes_count = std::max<size_t>(holes_count, 1);
+        size_t const hole_size = std::max<size_t>((size - size / 2) / holes_count, 3);
+        size_t const outer_size = std::max<size_t>(size - std::min(size, hole_size * holes_count), 3);
+
+        size_t const grid_size = static_cast<size_t>(std::ceil(std::sqrt(static_cast<float>(holes_count))));
+        float const hole_radius = get_star_radius(hole_size);
+        float const cell_size = 2.5f * hole_radius;
+        float const grid_side = cell_size * static_cast<float>(grid_size);
+
+        // corners of the grid are grid_side / sqrt(2) away from the center
+        float const radius = std::max(get_star_radius(outer_size), 1.5f * grid_side);
+
+        dcel::DCEL dcel{};
+        size_t const outside_face = add_face(dcel);
+        size_t const inside_face = add_face(dcel);
+
+        add_ring(dcel, generate_star(generator, { 0.f, 0.f }, outer_size, 0.5f * radius, radius), inside_face, outside_face);
+
+        for (size_t i = 0; i < holes_count; ++i)
+        {
+            Point const center{
+                -0.5f * grid_side + (static_cast<float>(i % grid_size) + 0.5f) * cell_size,
+                -0.5f * grid_side + (static_cast<float>(i / grid_size) + 0.5f) * cell_size };
+
+            add_ring(dcel, generate_star(generator, center, hole_size, 0.5f * hole_radius, hole_radius), outside_face, inside_face);
+        }
+
+        return dcel;
+    }
+
+    // Vertex (column, row) is vertex row * (columns + 1) + column,
+    // jitter of a quarter of a cell keeps the cells simple.
+    // Faces: 0 - outside, row * columns + column + 1 - cell
+    dcel::DCEL generate_grid(size_t columns, size_t rows, uint32_t seed) noexcept
+    {
+        std::mt19937 generator{ seed };
+
+        columns = std::max<size_t>(columns, 1);
+        rows = std::max<size_t>(rows, 1);
+
+        float const cell_size = 2.f * vertex_spacing;
+        float const jitter = 0.25f * cell_size;
+
+        std::vector<Point> points{};
+        points.reserve((columns + 1) * (rows + 1));
+
+        for (size_t row = 0; row <= rows; ++row)
+        {
+            for (size_t column = 0; column <= columns; ++column)
+            {
+                points.push_back({
+                    static_cast<float>(column) * cell_size + get_uniform(generator, -jitter, jitter),
+                    static_cast<float>(row) * cell_size + get_uniform(generator, -jitter, jitter) });
+            }
+        }
+
+        std::vector<size_t> cells{};
+        std::vector<size_t> cell_offsets{ 0 };
+        cells.reserve(4 * columns * rows);
+        cell_offsets.reserve(columns * rows + 1);
+
+        for (size_t row = 0; row < rows; ++row)
+        {
+            for (size_t column = 0; column < columns; ++column)
+            {
+                size_t const vertex = row * (columns + 1) + column;
+
+                cells.insert(cells.end(), { vertex, vertex + 1, vertex + columns + 2, vertex + columns + 1 });
+                cell_offsets.push_back(cells.size());
+            }
+        }
+
+        return make_dcel_from_cells(points, cells, cell_offsets);
+    }
+
+    // Brick wall: a grid of 2 * columns + 1 by rows + 1 vertices, where every cell takes two grid cells
+    // and odd rows are shifted by one grid cell, so their first and last cells are halves.
+    // Cells are hexagons with three vertices on the bottom and three on the top.
+    // Faces: 0 - outside, then cells row by row
+    dcel::DCEL generate_cell_map(size_t columns, size_t rows, uint32_t seed) noexcept
+    {
+        std::mt19937 generator{ seed };
+
+        columns = std::max<size_t>(columns, 1);
+        rows = std::max<size_t>(rows, 1);
+
+        size_t const grid_columns = 2 * columns + 1;
+
+        float const cell_size = 2.f * vertex_spacing;
+        float const jitter = 0.25f * cell_size;
+
+        std::vector<Point> points{};
+        points.reserve(grid_columns * (rows + 1));
+
+        for (size_t row = 0; row <= rows; ++row)
+        {
+            for (size_t column = 0; column < grid_columns; ++column)
+            {
+                points.push_back({
+                    static_cast<float>(column) * cell_size + get_uniform(generator, -jitter, jitter),
+                    static_cast<float>(row) * cell_size + get_uniform(generator, -jitter, jitter) });
+            }
+        }
+
+        std::vector<size_t> cells{};
+        std::vector<size_t> cell_offsets{ 0 };
+
+        for (size_t row = 0; row < rows; ++row)
+        {
+            // the first cell of an odd row starts one grid cell before the grid
+            for (size_t shifted_begin = 1 - row % 2; shifted_begin < grid_columns; shifted_begin += 2)
+            {
+                size_t const begin = shifted_begin == 0 ? 0 : shifted_begin - 1;
+                size_t const end = std::min(shifted_begin + 1, grid_columns - 1);
+
+                for (size_t column = begin; column <= end; ++column)
+                {
+                    cells.push_back(row * grid_columns + column);
+                }
+
+                for (size_t column = end + 1; column-- > begin; )
+                {
+                    cells.push_back((row + 1) * grid_columns + column);
+                }
+
+                cell_offsets.push_back(cells.size());
+            }
+        }
+
+        return make_dcel_from_cells(points, cells, cell_offsets);
+    }
+
+    // Islands are in a square grid, each of them is depth concentric stars,
+    // the radii of a ring are in [0.75, 1] of its largest radius and the next ring is 0.7 of it.
+    // Faces: 0 - outside, then the rings of the islands from the outer ones
+    dcel::DCEL generate_nested_islands(size_t islands_count, size_t depth, size_t ring_size, uint32_t seed) noexcept
+    {
+        std::mt19937 generator{ seed };
+
+        islands_count = std::max<size_t>(islands_count, 1);
+        depth = std::max<size_t>(depth, 1);
+        ring_size = std::max<size_t>(ring_size, 3);
+
+        float const ratio = 0.7f;
+        float const outer_radius = get_star_radius(ring_size) / std::pow(ratio, static_cast<float>(depth - 1));
+
+        size_t const grid_size = static_cast<size_t>(std::ceil(std::sqrt(static_cast<float>(islands_count))));
+        float const cell_size = 2.5f * outer_radius;
+
+        dcel::DCEL dcel{};
+        size_t const outside_face = add_face(dcel);
+
+        for (size_t i = 0; i < islands_count; ++i)
+        {
+            Point const center{
+                (static_cast<float>(i % grid_size) + 0.5f) * cell_size,
+                (static_cast<float>(i / grid_size) + 0.5f) * cell_size };
+
+            size_t around_face = outside_face;
+            float radius = outer_radius;
+
+            for (size_t j = 0; j < depth; ++j)
+            {
+                size_t const face = add_face(dcel);
+
+                add_ring(dcel, generate_star(generator, center, ring_size, 0.75f * radius, radius), face, around_face);
+
+                around_face = face;
+                radius *= ratio;
+            }
+        }
+
+        return dcel;
+    }
+
+    dcel::DCEL generate_dcel(SubdivisionKind kind, size_t size, uint32_t seed) noexcept
+    {
+        size_t const side = static_cast<size_t>(std::sqrt(static_cast<float>(size)));
+
+        switch (kind)
+        {
+        case SubdivisionKind::PolygonWithHoles:
+            return generate_polygon_with_holes(size, side / 4, seed);
+        case SubdivisionKind::Grid:
+        {
+            // side^2 vertices
+            size_t const cells_side = std::max<size_t>(side, 2) - 1;
+            return generate_grid(cells_side, cells_side, seed);
+        }
+        case SubdivisionKind::CellMap:
+        {
+            // (2 * columns + 1) * (rows + 1) vertices, at least 3 per row for a single cell
+            size_t const rows = std::max<size_t>(static_cast<size_t>(std::sqrt(0.5f * static_cast<float>(size))), 2) - 1;
+            return generate_cell_map((std::max<size_t>(size / (rows + 1), 3) - 1) / 2, rows, seed);
+        }
+        case SubdivisionKind::NestedIslands:
+        {
+            size_t const depth = 3;
+            size_t const islands_count = std::max<size_t>(side / 8, 1);
+            return generate_nested_islands(islands_count, depth, size / (islands_count * depth), seed);
+        }
+        case SubdivisionKind::SimplePolygon:
+        default:
+            return generate_simple_polygon(size, seed);
+        }
+    }
+
+    char const * get_point_distribution_name(PointDistribution distribution) noexcept
+    {
+        switch (distribution)
+        {
+        case PointDistribution::Uniform:
+            return "uniform";
+        case PointDistribution::Clustered:
+            return "clustered";
+        case PointDistribution::Circular:
+            return "circular";
+        case PointDistribution::Collinear:
+            return "collinear";
+        default:
+            return "unknown";
+        }
+    }
+
+    char const * get_subdivision_kind_name(SubdivisionKind kind) noexcept
+    {
+        switch (kind)
+        {
+        case SubdivisionKind::SimplePolygon:
+            return "simple_polygon";
+        case SubdivisionKind::PolygonWithHoles:
+            return "polygon_with_holes";
+        case SubdivisionKind::Grid:
+            return "grid";
+        case SubdivisionKind::CellMap:
+            return "cell_map";
+        case SubdivisionKind::NestedIslands:
+            return "nested_islands";
+        default:
+            return "unknown";
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include "dcel.h"
+#include "vvve.h"
+
+#include <vector>
+#include <cstdint>
+
+
+namespace frm
+{
+    // Synthetic inputs of any size. The same seed gives the same output on every platform:
+    // only std::mt19937 is used from <random>, its distributions are implementation defined.
+    // Neighbour vertices are kept at least a few units apart, far more than frm::epsilon.
+
+    enum class PointDistribution : uint8_t
+    {
+        Uniform,
+        // normal around 16 centers
+        Clustered,
+        // on a circle, every point is on the hull
+        Circular,
+        // on a single line with integer coordinates, with repeated points
+        Collinear
+    };
+
+    enum class SubdivisionKind : uint8_t
+    {
+        // star shaped polygon
+        SimplePolygon,
+        PolygonWithHoles,
+        // jittered quadrilaterals
+        Grid,
+        // jittered hexagons, three edges meet at every inner vertex like in a voronoi diagram
+        CellMap,
+        // groups of concentric polygons, every ring bounds a new face
+        NestedIslands
+    };
+
+    std::vector<Point> generate_points(PointDistribution distribution, size_t size, uint32_t seed) noexcept;
+    // vertices only
+    vvve::VVVE generate_vvve(PointDistribution distribution, size_t size, uint32_t seed) noexcept;
+
+    // Face 0 is the outside face in all of them, like in dcel::detach_face.
+    // Faces do not keep their holes: edges of a hole only have the face as incident_face,
+    // the edge of the face is on its outer boundary.
+    dcel::DCEL generate_simple_polygon(size_t size, uint32_t seed) noexcept;
+    dcel::DCEL generate_polygon_with_holes(size_t size, size_t holes_count, uint32_t seed) noexcept;
+    dcel::DCEL generate_grid(size_t columns, size_t rows, uint32_t seed) noexcept;
+    dcel::DCEL generate_cell_map(size_t columns, size_t rows, uint32_t seed) noexcept;
+    dcel::DCEL generate_nested_islands(size_t islands_count, size_t depth, size_t ring_size, uint32_t seed) noexcept;
+
+    // about size vertices, small sizes give the smallest subdivision of the kind
+    dcel::DCEL generate_dcel(SubdivisionKind kind, size_t size, uint32_t seed) noexcept;
+
+    // Cell i becomes face i + 1, its vertices are cells[cell_offsets[i], cell_offsets[i + 1]) counterclockwise.
+    // The cells have to cover a disc, so every vertex on its boundary has one boundary edge going out of it.
+    dcel::DCEL make_dcel_from_cells(std::vector<Point> const & points,
+        std::vector<size_t> const & cells,
+        std::vector<size_t> const & cell_offsets) noexcept;
+
+    char const * get_point_distribution_name(PointDistribution distribution) noexcept;
+    char const * get_subdivision_kind_name(SubdivisionKind kind) noexcept;
+}
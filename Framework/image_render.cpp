@@ -0,0 +1,535 @@
+#include "image_render.h"
+#include "profiler.h"
+
+#include <cmath>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+
+
+namespace frm
+{
+    static constexpr size_t tile_size = 128;
+
+    // below this number of primitives sorting into tiles is not split between threads
+    static constexpr size_t parallel_binning_threshold = 1 << 16;
+
+    void add_line(ImageScene & scene, Point begin, Point end, sf::Color color) noexcept
+    {
+        scene.lines.push_back({ begin, end, color });
+    }
+
+    void add_disc(ImageScene & scene, Point center, float radius, sf::Color color) noexcept
+    {
+        scene.discs.push_back({ center, radius, color });
+    }
+
+    void add_convex_polygon(ImageScene & scene, Point const * points, size_t points_count, sf::Color color) noexcept
+    {
+        scene.polygons.push_back({ scene.polygon_points.size(), points_count, color });
+        scene.polygon_points.insert(scene.polygon_points.end(), points, points + points_count);
+    }
+
+    void add_dcel(ImageScene & scene, dcel::DCEL const & dcel, sf::Color color) noexcept
+    {
+        for (size_t i = 0; i < dcel.edges.size(); ++i)
+        {
+            dcel::DCEL::Edge const & edge = dcel.edges[i];
+
+            // an edge and its twin are the same line
+            if (edge.is_exist && i < edge.twin_edge)
+            {
+                add_line(scene,
+                    dcel.vertices[edge.origin_vertex].coordinate,
+                    dcel.vertices[dcel.edges[edge.twin_edge].origin_vertex].coordinate,
+                    color);
+            }
+        }
+    }
+
+    void add_vvve(ImageScene & scene, vvve::VVVE const & vvve, sf::Color color) noexcept
+    {
+        for (vvve::VVVE::edge_t const & edge : vvve.edges)
+        {
+            add_line(scene, vvve.vertices[edge.first].coordinate, vvve.vertices[edge.second].coordinate, color);
+        }
+
+        for (vvve::VVVE::Vertex const & vertex : vvve.vertices)
+        {
+            add_disc(scene, vertex.coordinate, vvve::vertex_marker_radius, color);
+        }
+    }
+
+    void add_face(ImageScene & scene, dcel::DCEL const & dcel, size_t face_index, sf::Color color) noexcept
+    {
+        std::vector<Point> points{};
+
+        size_t const begin = dcel.faces[face_index].edge;
+        size_t current_index = begin;
+
+        do
+        {
+            points.push_back(dcel.vertices[dcel.edges[current_index].origin_vertex].coordinate);
+            current_index = dcel.edges[current_index].next_edge;
+        } while (current_index != begin);
+
+        add_convex_polygon(scene, points.data(), points.size(), color);
+    }
+
+    // y of the line segment at x, or the edge of the area for a missing segment
+    float get_segment_y(TrapezoidData const & trapezoid_data, size_t line_segment_index, float x, float missing_y) noexcept
+    {
+        if (line_segment_index == std::numeric_limits<size_t>::max())
+        {
+            return missing_y;
+        }
+
+        LineSegment const & line_segment = trapezoid_data.line_segments[line_segment_index];
+        Point const begin = trapezoid_data.ends_of_line_segment[line_segment.begin_index];
+        Point const end = trapezoid_data.ends_of_line_segment[line_segment.end_index];
+
+        return lerp(begin.y, end.y, (x - begin.x) / (end.x - begin.x));
+    }
+
+    // distinct translucent color of a trapezoid
+    sf::Color get_trapezoid_color(size_t trapezoid_index) noexcept
+    {
+        uint32_t const hash = static_cast<uint32_t>(trapezoid_index) * 2654435761u;
+
+        return {
+            static_cast<sf::Uint8>(64 + (hash >> 8) % 192),
+            static_cast<sf::Uint8>(64 + (hash >> 16) % 192),
+            static_cast<sf::Uint8>(64 + (hash >> 24) % 192),
+            96 };
+    }
+
+    void add_trapezoid_map(ImageScene & scene, TrapezoidData const & trapezoid_data, Box const & area, sf::Color color) noexcept
+    {
+        for (size_t i = 0; i < trapezoid_data.trapezoids.size(); ++i)
+        {
+            Trapezoid const & trapezoid = trapezoid_data.trapezoids[i];
+
+            float const left_x = trapezoid.left_end_index == std::numeric_limits<size_t>::max() ?
+                area.min.x :
+                std::max(area.min.x, trapezoid_data.ends_of_line_segment[trapezoid.left_end_index].x);
+            float const right_x = trapezoid.right_end_index == std::numeric_limits<size_t>::max() ?
+                area.max.x :
+                std::min(area.max.x, trapezoid_data.ends_of_line_segment[trapezoid.right_end_index].x);
+
+            if (left_x >= right_x)
+            {
+                continue;
+            }
+
+            // top is the side with the greater y
+            Point const points[4] = {
+                { left_x, get_segment_y(trapezoid_data, trapezoid.bottom_line_segment_index, left_x, area.min.y) },
+                { right_x, get_segment_y(trapezoid_data, trapezoid.bottom_line_segment_index, right_x, area.min.y) },
+                { right_x, get_segment_y(trapezoid_data, trapezoid.top_line_segment_index, right_x, area.max.y) },
+                { left_x, get_segment_y(trapezoid_data, trapezoid.top_line_segment_index, left_x, area.max.y) } };
+
+            add_convex_polygon(scene, points, 4, get_trapezoid_color(i));
+        }
+
+        for (LineSegment const & line_segment : trapezoid_data.line_segments)
+        {
+            add_line(scene,
+                trapezoid_data.ends_of_line_segment[line_segment.begin_index],
+                trapezoid_data.ends_of_line_segment[line_segment.end_index],
+                color);
+        }
+    }
+
+    Box get_scene_bounds(ImageScene const & scene) noexcept
+    {
+        Box bounds{ empty_box };
+
+        for (Point const point : scene.polygon_points)
+        {
+            extend_box(bounds, point);
+        }
+        for (ImageScene::Line const & line : scene.lines)
+        {
+            extend_box(bounds, line.begin);
+            extend_box(bounds, line.end);
+        }
+        for (ImageScene::Disc const & disc : scene.discs)
+        {
+            extend_box(bounds, { disc.center.x - disc.radius, disc.center.y - disc.radius });
+            extend_box(bounds, { disc.center.x + disc.radius, disc.center.y + disc.radius });
+        }
+
+        return bounds;
+    }
+
+    RasterImage create_image(size_t width, size_t height, Box const & area, sf::Color background) noexcept
+    {
+        return { width, height, area, std::vector<sf::Color>(width * height, background) };
+    }
+
+    // Pixel space: pixel (x, y) covers [x, x + 1) x [y, y + 1)
+    struct PixelTransform
+    {
+        Point origin;
+        Point scale;
+    };
+
+    Point to_pixel(PixelTransform const & transform, Point point) noexcept
+    {
+        return { (point.x - transform.origin.x) * transform.scale.x, (point.y - transform.origin.y) * transform.scale.y };
+    }
+
+    // pixels [min_x, max_x) x [min_y, max_y)
+    struct Tile
+    {
+        size_t min_x;
+        size_t min_y;
+        size_t max_x;
+        size_t max_y;
+    };
+
+    void blend(sf::Color & pixel, sf::Color color) noexcept
+    {
+        unsigned const alpha = color.a;
+        unsigned const inverse_alpha = 255 - alpha;
+
+        pixel.r = static_cast<sf::Uint8>((color.r * alpha + pixel.r * inverse_alpha + 127) / 255);
+        pixel.g = static_cast<sf::Uint8>((color.g * alpha + pixel.g * inverse_alpha + 127) / 255);
+        pixel.b = static_cast<sf::Uint8>((color.b * alpha + pixel.b * inverse_alpha + 127) / 255);
+        pixel.a = static_cast<sf::Uint8>(alpha + (pixel.a * inverse_alpha + 127) / 255);
+    }
+
+    // index of the pixel containing the coordinate, clamped to [min, max]
+    size_t get_pixel_index(float coordinate, size_t min, size_t max) noexcept
+    {
+        float const index = std::floor(coordinate);
+
+        if (!(index > static_cast<float>(min)))
+        {
+            return min;
+        }
+        if (!(index < static_cast<float>(max)))
+        {
+            return max;
+        }
+        return static_cast<size_t>(index);
+    }
+
+    // 1 pixel wide line, a pixel per step along the major axis
+    void rasterize_line(RasterImage & image, Tile const & tile, Point begin, Point end, sf::Color color) noexcept
+    {
+        bool const is_x_major = std::abs(end.x - begin.x) >= std::abs(end.y - begin.y);
+
+        if (is_x_major ? begin.x > end.x : begin.y > end.y)
+        {
+            std::swap(begin, end);
+        }
+
+        float const major_begin = is_x_major ? begin.x : begin.y;
+        float const major_end = is_x_major ? end.x : end.y;
+        float const minor_begin = is_x_major ? begin.y : begin.x;
+        float const minor_end = is_x_major ? end.y : end.x;
+
+        size_t const tile_major_min = is_x_major ? tile.min_x : tile.min_y;
+        size_t const tile_major_max = is_x_major ? tile.max_x : tile.max_y;
+        size_t const tile_minor_min = is_x_major ? tile.min_y : tile.min_x;
+        size_t const tile_minor_max = is_x_major ? tile.max_y : tile.max_x;
+
+        if (major_end < static_cast<float>(tile_major_min) || major_begin >= static_cast<float>(tile_major_max))
+        {
+            return;
+        }
+
+        size_t const first = get_pixel_index(major_begin, tile_major_min, tile_major_max - 1);
+        size_t const last = get_pixel_index(major_end, tile_major_min, tile_major_max - 1);
+        float const length = major_end - major_begin;
+
+        for (size_t major = first; major <= last; ++major)
+        {
+            float const t = length > 0.f ?
+                std::clamp((static_cast<float>(major) + 0.5f - major_begin) / length, 0.f, 1.f) :
+                0.f;
+            float const minor = std::floor(lerp(minor_begin, minor_end, t));
+
+            if (minor >= static_cast<float>(tile_minor_min) && minor < static_cast<float>(tile_minor_max))
+            {
+                size_t const minor_index = static_cast<size_t>(minor);
+                size_t const x = is_x_major ? major : minor_index;
+                size_t const y = is_x_major ? minor_index : major;
+
+                blend(image.pixels[y * image.width + x], color);
+            }
+        }
+    }
+
+    void rasterize_disc(RasterImage & image, Tile const & tile, Point center, float radius, sf::Color color) noexcept
+    {
+        size_t const min_x = get_pixel_index(center.x - radius, tile.min_x, tile.max_x - 1);
+        size_t const max_x = get_pixel_index(center.x + radius, tile.min_x, tile.max_x - 1);
+        size_t const min_y = get_pixel_index(center.y - radius, tile.min_y, tile.max_y - 1);
+        size_t const max_y = get_pixel_index(center.y + radius, tile.min_y, tile.max_y - 1);
+
+        float const sqr_radius = radius * radius;
+
+        for (size_t y = min_y; y <= max_y; ++y)
+        {
+            for (size_t x = min_x; x <= max_x; ++x)
+            {
+                Point const pixel_center{ static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f };
+
+                if (sqr_distance_between_points(pixel_center, center) <= sqr_radius)
+                {
+                    blend(image.pixels[y * image.width + x], color);
+                }
+            }
+        }
+    }
+
+    // scanline fill, a row of a convex polygon is a single span
+    void rasterize_convex_polygon(RasterImage & image, Tile const & tile, Point const * points, size_t points_count, sf::Color color) noexcept
+    {
+        Box bounds{ empty_box };
+        for (size_t i = 0; i < points_count; ++i)
+        {
+            extend_box(bounds, points[i]);
+        }
+
+        size_t const min_y = get_pixel_index(bounds.min.y, tile.min_y, tile.max_y - 1);
+        size_t const max_y = get_pixel_index(bounds.max.y, tile.min_y, tile.max_y - 1);
+
+        for (size_t y = min_y; y <= max_y; ++y)
+        {
+            float const row = static_cast<float>(y) + 0.5f;
+
+            float span_begin = std::numeric_limits<float>::max();
+            float span_end = std::numeric_limits<float>::lowest();
+
+            for (size_t i = 0; i < points_count; ++i)
+            {
+                Point const begin = points[i];
+                Point const end = points[(i + 1) % points_count];
+
+                if ((begin.y <= row) != (end.y <= row))
+                {
+                    float const x = lerp(begin.x, end.x, (row - begin.y) / (end.y - begin.y));
+                    span_begin = std::min(span_begin, x);
+                    span_end = std::max(span_end, x);
+                }
+            }
+
+            // pixels with the center inside of the span
+            float const first = std::ceil(span_begin - 0.5f);
+            float const last = std::ceil(span_end - 0.5f);
+
+            if (!(first < last) || last <= static_cast<float>(tile.min_x) || first >= static_cast<float>(tile.max_x))
+            {
+                continue;
+            }
+
+            size_t const min_x = std::max(tile.min_x, static_cast<size_t>(std::max(first, 0.f)));
+            size_t const max_x = std::min(tile.max_x, static_cast<size_t>(last));
+
+            for (size_t x = min_x; x < max_x; ++x)
+            {
+                blend(image.pixels[y * image.width + x], color);
+            }
+        }
+    }
+
+    void rasterize(ImageScene const & scene, RasterImage & image) noexcept
+    {
+        ProfileScope const scope{ "rasterize" };
+
+        if (image.width == 0 || image.height == 0)
+        {
+            return;
+        }
+
+        PixelTransform const transform{
+            image.area.min,
+            {
+                static_cast<float>(image.width) / std::max(image.area.max.x - image.area.min.x, epsilon),
+                static_cast<float>(image.height) / std::max(image.area.max.y - image.area.min.y, epsilon)
+            } };
+
+        // primitives in pixel space, indexed as polygons, then lines, then discs
+        std::vector<Point> polygon_points(scene.polygon_points.size());
+        std::transform(scene.polygon_points.begin(), scene.polygon_points.end(), polygon_points.begin(), [&transform](Point point) noexcept
+            {
+                return to_pixel(transform, point);
+            });
+
+        size_t const lines_offset = scene.polygons.size();
+        size_t const discs_offset = lines_offset + scene.lines.size();
+        size_t const primitives_count = discs_offset + scene.discs.size();
+
+        auto const get_pixel_bounds = [&scene, &polygon_points, &transform, lines_offset, discs_offset](size_t primitive) noexcept
+        {
+            Box bounds{ empty_box };
+
+            if (primitive < lines_offset)
+            {
+                ImageScene::Polygon const & polygon = scene.polygons[primitive];
+                for (size_t i = polygon.first_point; i < polygon.first_point + polygon.points_count; ++i)
+                {
+                    extend_box(bounds, polygon_points[i]);
+                }
+            }
+            else if (primitive < discs_offset)
+            {
+                ImageScene::Line const & line = scene.lines[primitive - lines_offset];
+                extend_box(bounds, to_pixel(transform, line.begin));
+                extend_box(bounds, to_pixel(transform, line.end));
+            }
+            else
+            {
+                ImageScene::Disc const & disc = scene.discs[primitive - discs_offset];
+                Point const center = to_pixel(transform, disc.center);
+                float const radius = disc.radius * transform.scale.x;
+                extend_box(bounds, { center.x - radius, center.y - radius });
+                extend_box(bounds, { center.x + radius, center.y + radius });
+            }
+
+            return bounds;
+        };
+
+        size_t const tile_columns = (image.width + tile_size - 1) / tile_size;
+        size_t const tile_rows = (image.height + tile_size - 1) / tile_size;
+        size_t const tiles_count = tile_columns * tile_rows;
+
+        size_t const threads_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+        // every chunk of primitives is sorted into its own bins,
+        // so the bins of a tile taken chunk by chunk keep the order of the primitives
+        size_t const chunks_count = std::max<size_t>(1, std::min(threads_count, primitives_count / parallel_binning_threshold));
+        size_t const chunk_size = (primitives_count + chunks_count - 1) / chunks_count;
+
+        std::vector<std::vector<std::vector<size_t>>> bins(chunks_count, std::vector<std::vector<size_t>>(tiles_count));
+        std::vector<std::future<void>> tasks{};
+
+        for (size_t chunk = 0; chunk < chunks_count; ++chunk)
+        {
+            tasks.push_back(std::async(std::launch::async, [&bins, &get_pixel_bounds, &image, chunk, chunk_size, primitives_count, tile_columns, tile_rows]() noexcept
+                {
+                    size_t const chunk_begin = chunk * chunk_size;
+                    size_t const chunk_end = std::min(primitives_count, chunk_begin + chunk_size);
+
+                    for (size_t primitive = chunk_begin; primitive < chunk_end; ++primitive)
+                    {
+                        Box const bounds = get_pixel_bounds(primitive);
+
+                        if (bounds.max.x < 0.f || bounds.max.y < 0.f ||
+                            bounds.min.x >= static_cast<float>(image.width) || bounds.min.y >= static_cast<float>(image.height))
+                        {
+                            continue;
+                        }
+
+                        size_t const min_column = get_pixel_index(bounds.min.x, 0, image.width - 1) / tile_size;
+                        size_t const max_column = get_pixel_index(bounds.max.x, 0, image.width - 1) / tile_size;
+                        size_t const min_row = get_pixel_index(bounds.min.y, 0, image.height - 1) / tile_size;
+                        size_t const max_row = get_pixel_index(bounds.max.y, 0, image.height - 1) / tile_size;
+
+                        for (size_t row = min_row; row <= max_row; ++row)
+                        {
+                            for (size_t column = min_column; column <= max_column; ++column)
+                            {
+                                bins[chunk][row * tile_columns + column].push_back(primitive);
+                            }
+                        }
+                    }
+                }));
+        }
+
+        for (std::future<void> & task : tasks)
+        {
+            task.get();
+        }
+        tasks.clear();
+
+        // tiles don't share pixels, threads take them one by one
+        std::atomic<size_t> next_tile{ 0 };
+
+        for (size_t thread = 0; thread < std::min(threads_count, tiles_count); ++thread)
+        {
+            tasks.push_back(std::async(std::launch::async, [&next_tile, &bins, &scene, &image, &polygon_points, &transform, tiles_count, tile_columns, lines_offset, discs_offset]() noexcept
+                {
+                    for (size_t tile_index = next_tile++; tile_index < tiles_count; tile_index = next_tile++)
+                    {
+                        size_t const column = tile_index % tile_columns;
+                        size_t const row = tile_index / tile_columns;
+
+                        Tile const tile{
+                            column * tile_size,
+                            row * tile_size,
+                            std::min(image.width, (column + 1) * tile_size),
+                            std::min(image.height, (row + 1) * tile_size) };
+
+                        for (std::vector<std::vector<size_t>> const & chunk_bins : bins)
+                        {
+                            for (size_t const primitive : chunk_bins[tile_index])
+                            {
+                                if (primitive < lines_offset)
+                                {
+                                    ImageScene::Polygon const & polygon = scene.polygons[primitive];
+                                    rasterize_convex_polygon(image, tile, &polygon_points[polygon.first_point], polygon.points_count, polygon.color);
+                                }
+                                else if (primitive < discs_offset)
+                                {
+                                    ImageScene::Line const & line = scene.lines[primitive - lines_offset];
+                                    rasterize_line(image, tile, to_pixel(transform, line.begin), to_pixel(transform, line.end), line.color);
+                                }
+                                else
+                                {
+                                    ImageScene::Disc const & disc = scene.discs[primitive - discs_offset];
+                                    rasterize_disc(image, tile, to_pixel(transform, disc.center), disc.radius * transform.scale.x, disc.color);
+                                }
+                            }
+                        }
+                    }
+                }));
+        }
+
+        for (std::future<void> & task : tasks)
+        {
+            task.get();
+        }
+    }
+
+    bool save_to_ppm(std::string const & path, RasterImage const & image) noexcept
+    {
+        std::ofstream file_output{ path, std::ios::binary };
+        if (!file_output)
+        {
+            return false;
+        }
+
+        file_output << "P6\n" << image.width << " " << image.height << "\n255\n";
+
+        std::vector<char> row(3 * image.width);
+        for (size_t y = 0; y < image.height; ++y)
+        {
+            for (size_t x = 0; x < image.width; ++x)
+            {
+                sf::Color const pixel = image.pixels[y * image.width + x];
+                row[3 * x] = static_cast<char>(pixel.r);
+                row[3 * x + 1] = static_cast<char>(pixel.g);
+                row[3 * x + 2] = static_cast<char>(pixel.b);
+            }
+            file_output.write(row.data(), static_cast<std::streamsize>(row.size()));
+        }
+
+        return static_cast<bool>(file_output);
+    }
+
+    bool save_to_file(std::string const & path, RasterImage const & image) noexcept
+    {
+        static_assert(sizeof(sf::Color) == 4, "pixels are passed to sf::Image as RGBA bytes");
+
+        sf::Image file_image{};
+        file_image.create(static_cast<unsigned>(image.width), static_cast<unsigned>(image.height), reinterpret_cast<sf::Uint8 const *>(image.pixels.data()));
+
+        return file_image.saveToFile(path);
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+
+#include "common.h"
+#include "view_culling.h"
+#include "dcel.h"
+#include "vvve.h"
+#include "trapezoidal_decomposition.h"
+
+#include "SFML\Graphics.hpp"
+
+#include <vector>
+#include <string>
+
+
+namespace frm
+{
+    // Rendering into memory on the CPU, without a window or a GL context,
+    // for batch jobs and reference images
+
+    // Lines, discs and convex polygons to be rasterized, drawn in this order,
+    // each kind in the order it was added
+    struct ImageScene
+    {
+        struct Line
+        {
+            Point begin;
+            Point end;
+            sf::Color color;
+        };
+
+        struct Disc
+        {
+            Point center;
+            float radius;
+            sf::Color color;
+        };
+
+        struct Polygon
+        {
+            // points: polygon_points[first_point, first_point + points_count)
+            size_t first_point;
+            size_t points_count;
+            sf::Color color;
+        };
+
+        std::vector<Polygon> polygons{};
+        std::vector<Point> polygon_points{};
+        std::vector<Line> lines{};
+        std::vector<Disc> discs{};
+    };
+
+    // RGBA image showing the area of the world
+    struct RasterImage
+    {
+        size_t width{ 0 };
+        size_t height{ 0 };
+        Box area{};
+        std::vector<sf::Color> pixels{};
+    };
+
+    void add_line(ImageScene & scene, Point begin, Point end, sf::Color color) noexcept;
+    void add_disc(ImageScene & scene, Point center, float radius, sf::Color color) noexcept;
+    void add_convex_polygon(ImageScene & scene, Point const * points, size_t points_count, sf::Color color) noexcept;
+
+    // same pictures as dcel::draw, vvve::draw and draw_face_highlighted
+    void add_dcel(ImageScene & scene, dcel::DCEL const & dcel, sf::Color color = sf::Color::White) noexcept;
+    void add_vvve(ImageScene & scene, vvve::VVVE const & vvve, sf::Color color = sf::Color::White) noexcept;
+    void add_face(ImageScene & scene, dcel::DCEL const & dcel, size_t face_index, sf::Color color) noexcept;
+    // every trapezoid is filled with its own color, unbounded ones are clipped by the area
+    void add_trapezoid_map(ImageScene & scene, TrapezoidData const & trapezoid_data, Box const & area, sf::Color color = sf::Color::White) noexcept;
+
+    Box get_scene_bounds(ImageScene const & scene) noexcept;
+
+    RasterImage create_image(size_t width, size_t height, Box const & area, sf::Color background = sf::Color::Black) noexcept;
+
+    // Image is split into tiles rasterized in parallel,
+    // primitives are sorted into the tiles they overlap beforehand
+    void rasterize(ImageScene const & scene, RasterImage & image) noexcept;
+
+    // binary PPM, alpha is dropped
+    bool save_to_ppm(std::string const & path, RasterImage const & image) noexcept;
+    // any format sf::Image can save, chosen by the extension of the path
+    bool save_to_file(std::string const & path, RasterImage const & image) noexcept;
+}
@@ -0,0 +1,168 @@
+#include "overlay.h"
+
+#include "segment_intersections.h"
+#include "profiler.h"
+
+#include <limits>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        static constexpr size_t no_face = std::numeric_limits<size_t>::max();
+
+        Overlay overlay(DCEL const & first, DCEL const & second) noexcept
+        {
+            ProfileScope const scope{ "dcel::overlay" };
+
+            DCEL const * const sources[2] = { &first, &second };
+
+            // existing vertices of both, the segments are the edges with index less than the index of the twin
+            std::vector<Point> points{};
+            std::vector<std::pair<size_t, size_t>> segments{};
+            // edge of the source going the same way as the segment
+            std::vector<size_t> segment_source_edges{};
+            size_t first_segments_count = 0;
+
+            for (size_t source = 0; source < 2; ++source)
+            {
+                DCEL const & dcel = *sources[source];
+
+                std::vector<size_t> vertex_points(dcel.vertices.size(), no_face);
+                for (size_t i = 0; i < dcel.vertices.size(); ++i)
+                {
+                    if (dcel.vertices[i].is_exist)
+                    {
+                        vertex_points[i] = points.size();
+                        points.push_back(dcel.vertices[i].coordinate);
+                    }
+                }
+
+                for (size_t i = 0; i < dcel.edges.size(); ++i)
+                {
+                    DCEL::Edge const & edge = dcel.edges[i];
+                    if (!edge.is_exist || edge.twin_edge < i)
+                    {
+                        continue;
+                    }
+
+                    segments.push_back({ vertex_points[edge.origin_vertex], vertex_points[dcel.edges[edge.twin_edge].origin_vertex] });
+                    segment_source_edges.push_back(i);
+                }
+
+                if (source == 0)
+                {
+                    first_segments_count = segments.size();
+                }
+            }
+
+            Arrangement arrangement = build_arrangement(points, segments);
+
+            Overlay result{ std::move(arrangement.dcel), {} };
+            DCEL & dcel = result.dcel;
+            result.source_faces.assign(dcel.faces.size(), { no_face, no_face });
+
+            // bit of every source with an edge along the piece, edges 2i and 2i + 1 are piece i
+            std::vector<uint8_t> piece_sources(dcel.edges.size() / 2, 0);
+            for (SegmentEdge const & segment_edge : arrangement.segment_edges)
+            {
+                piece_sources[segment_edge.edge / 2] |= static_cast<uint8_t>(segment_edge.segment < first_segments_count ? 1 : 2);
+            }
+
+            // edges of every face with its holes: face_edges[face_offsets[i], face_offsets[i + 1])
+            std::vector<size_t> face_offsets(dcel.faces.size() + 1, 0);
+            for (DCEL::Edge const & edge : dcel.edges)
+            {
+                ++face_offsets[edge.incident_face + 1];
+            }
+            for (size_t i = 1; i < face_offsets.size(); ++i)
+            {
+                face_offsets[i] += face_offsets[i - 1];
+            }
+
+            std::vector<size_t> face_edges(dcel.edges.size());
+            {
+                std::vector<size_t> next_positions(face_offsets.begin(), face_offsets.end() - 1);
+                for (size_t i = 0; i < dcel.edges.size(); ++i)
+                {
+                    face_edges[next_positions[dcel.edges[i].incident_face]++] = i;
+                }
+            }
+
+            // A face along a source edge gets the source face on the same side of it. Any other edge
+            // is inside of a source face, so the faces on both of its sides are in the same source face.
+            // Holes are edges of their faces, so every face is reached from the ones along the source edges.
+            std::vector<size_t> queue{};
+            queue.reserve(dcel.faces.size());
+
+            for (size_t source = 0; source < 2; ++source)
+            {
+                DCEL const & source_dcel = *sources[source];
+                uint8_t const source_bit = static_cast<uint8_t>(1 << source);
+                auto const get_face = [&result, source](size_t face) noexcept -> size_t &
+                    {
+                        return source == 0 ? result.source_faces[face].first : result.source_faces[face].second;
+                    };
+
+                queue.clear();
+                for (SegmentEdge const & segment_edge : arrangement.segment_edges)
+                {
+                    if ((segment_edge.segment < first_segments_count ? 0 : 1) != source)
+                    {
+                        continue;
+                    }
+
+                    DCEL::Edge const & source_edge = source_dcel.edges[segment_source_edges[segment_edge.segment]];
+                    std::pair<size_t, size_t> const sides[2] = {
+                        { dcel.edges[segment_edge.edge].incident_face, source_edge.incident_face },
+                        { dcel.edges[dcel.edges[segment_edge.edge].twin_edge].incident_face, source_dcel.edges[source_edge.twin_edge].incident_face } };
+
+                    for (std::pair<size_t, size_t> const & side : sides)
+                    {
+                        if (get_face(side.first) == no_face)
+                        {
+                            get_face(side.first) = side.second;
+                            queue.push_back(side.first);
+                        }
+                    }
+                }
+
+                // the whole plane is one face of the source
+                if (queue.empty())
+                {
+                    size_t face = no_face;
+                    for (size_t i = 0; i < source_dcel.faces.size() && face == no_face; ++i)
+                    {
+                        face = source_dcel.faces[i].is_exist ? i : no_face;
+                    }
+
+                    for (size_t i = 0; i < dcel.faces.size(); ++i)
+                    {
+                        get_face(i) = face;
+                    }
+                    continue;
+                }
+
+                for (size_t i = 0; i < queue.size(); ++i)
+                {
+                    size_t const face = queue[i];
+
+                    for (size_t j = face_offsets[face]; j < face_offsets[face + 1]; ++j)
+                    {
+                        size_t const edge = face_edges[j];
+                        size_t const other_face = dcel.edges[dcel.edges[edge].twin_edge].incident_face;
+
+                        if (!(piece_sources[edge / 2] & source_bit) && get_face(other_face) == no_face)
+                        {
+                            get_face(other_face) = get_face(face);
+                            queue.push_back(other_face);
+                        }
+                    }
+                }
+            }
+
+            return result;
+        }
+    }
+}
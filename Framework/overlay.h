@@ -0,0 +1,27 @@
+#pragma once
+
+
+#include "dcel.h"
+
+#include <vector>
+#include <utility>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        struct Overlay
+        {
+            DCEL dcel;
+            // for every face of dcel: the face of the first input and the face of the second one it lies in,
+            // std::numeric_limits<size_t>::max() for an input without faces
+            std::vector<std::pair<size_t, size_t>> source_faces;
+        };
+
+        // Subdivision by the edges of both inputs split at their intersections, O((n + k)log(n)) for k intersections.
+        // The sweep puts the holes into their faces, then the faces of the inputs spread from their edges
+        // over the faces of the result, so no point location is needed.
+        Overlay overlay(DCEL const & first, DCEL const & second) noexcept;
+    }
+}
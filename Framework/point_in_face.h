@@ -0,0 +1,44 @@
+#pragma once
+
+
+#include "dcel.h"
+#include "view_culling.h"
+
+#include <vector>
+#include <cstdint>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        // Boundary cycle of a face as flat coordinate arrays for the crossing number test.
+        // Like detach_face, only the cycle of the edge of the face bounds it, the holes are not part of the face record.
+        struct FacePolygon
+        {
+            Box bounds{ empty_box };
+            // edge i goes from (xs[i], ys[i]) to (xs[i + 1], ys[i + 1]), the first point is repeated at the end
+            std::vector<double> xs{};
+            std::vector<double> ys{};
+        };
+
+        // O(k) for k edges of the face
+        FacePolygon make_face_polygon(DCEL const & dcel, size_t face_index) noexcept;
+
+        // O(k) after the bounding box check, two edges per step with SSE2,
+        // a point on the boundary may be on either side
+        bool is_point_inside(FacePolygon const & polygon, Point point) noexcept;
+
+        // Crossing tests cost k for every point inside of the bounding box, the trapezoid map of the detached face
+        // O(k log(k)) to build and O(log(k)) per point, true if the map is cheaper for the points in the box.
+        bool is_trapezoid_map_cheaper(size_t edges_count, size_t points_in_box_count) noexcept;
+
+        // 1 for every point inside of the face, by the crossing tests or the trapezoid map, whichever is cheaper
+        std::vector<uint8_t> get_points_inside(DCEL const & dcel,
+            size_t face_index,
+            FacePolygon const & polygon,
+            std::vector<Point> const & points) noexcept;
+
+        std::vector<uint8_t> get_points_inside(DCEL const & dcel, size_t face_index, std::vector<Point> const & points) noexcept;
+    }
+}
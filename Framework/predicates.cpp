@@ -0,0 +1,338 @@
+#include "predicates.h"
+
+#include <array>
+#include <cmath>
+
+
+// Exact arithmetic below relies on every operation being rounded exactly once,
+// so the fast floating point model of the project is disabled for this file.
+#ifdef _MSC_VER
+#pragma float_control(precise, on, push)
+#pragma fp_contract(off)
+#endif
+
+
+namespace frm
+{
+    // Expansion arithmetic from J. R. Shewchuk, "Adaptive Precision Floating-Point
+    // Arithmetic and Fast Robust Geometric Predicates".
+    // Expansion - sum of nonoverlapping doubles in increasing order of magnitude,
+    // zero components are eliminated, zero is stored as a single component.
+
+    static constexpr double splitter = 134217729.; // 2^27 + 1
+
+    static constexpr double machine_epsilon = 1.1102230246251565e-16; // 2^-53
+    static constexpr double orient2d_error_bound = (3. + 16. * machine_epsilon) * machine_epsilon;
+    static constexpr double incircle_error_bound = (10. + 96. * machine_epsilon) * machine_epsilon;
+
+    template<size_t Capacity>
+    struct Expansion
+    {
+        std::array<double, Capacity> components{};
+        size_t size = 0;
+    };
+
+    // |a| >= |b|
+    void fast_two_sum(double a, double b, double & sum, double & error) noexcept
+    {
+        sum = a + b;
+        double const b_virtual = sum - a;
+        error = b - b_virtual;
+    }
+
+    void two_sum(double a, double b, double & sum, double & error) noexcept
+    {
+        sum = a + b;
+        double const b_virtual = sum - a;
+        double const a_virtual = sum - b_virtual;
+        error = (a - a_virtual) + (b - b_virtual);
+    }
+
+    void two_diff(double a, double b, double & difference, double & error) noexcept
+    {
+        difference = a - b;
+        double const b_virtual = a - difference;
+        double const a_virtual = difference + b_virtual;
+        error = (a - a_virtual) + (b_virtual - b);
+    }
+
+    void split(double a, double & high, double & low) noexcept
+    {
+        double const c = splitter * a;
+        high = c - (c - a);
+        low = a - high;
+    }
+
+    void two_product(double a, double b, double & product, double & error) noexcept
+    {
+        product = a * b;
+
+        double a_high, a_low, b_high, b_low;
+        split(a, a_high, a_low);
+        split(b, b_high, b_low);
+
+        error = a_low * b_low - (((product - a_high * b_high) - a_low * b_high) - a_high * b_low);
+    }
+
+    // h = e + f, h must have space for e_size + f_size components
+    size_t expansion_sum(double const * e, size_t e_size, double const * f, size_t f_size, double * h) noexcept
+    {
+        size_t e_index = 0;
+        size_t f_index = 0;
+        size_t h_size = 0;
+
+        // merges components of both expansions by magnitude
+        auto const next = [e, e_size, f, f_size, &e_index, &f_index]() noexcept
+        {
+            if (f_index == f_size || (e_index < e_size && std::abs(e[e_index]) < std::abs(f[f_index])))
+            {
+                return e[e_index++];
+            }
+            return f[f_index++];
+        };
+
+        double q = next();
+        double sum, error;
+
+        if (e_index + f_index < e_size + f_size)
+        {
+            fast_two_sum(next(), q, sum, error);
+            q = sum;
+            if (error != 0.)
+            {
+                h[h_size++] = error;
+            }
+        }
+
+        while (e_index + f_index < e_size + f_size)
+        {
+            two_sum(q, next(), sum, error);
+            q = sum;
+            if (error != 0.)
+            {
+                h[h_size++] = error;
+            }
+        }
+
+        if (q != 0. || h_size == 0)
+        {
+            h[h_size++] = q;
+        }
+
+        return h_size;
+    }
+
+    // h = e * b, h must have space for 2 * e_size components
+    size_t scale_expansion(double const * e, size_t e_size, double b, double * h) noexcept
+    {
+        size_t h_size = 0;
+
+        double q, error;
+        two_product(e[0], b, q, error);
+        if (error != 0.)
+        {
+            h[h_size++] = error;
+        }
+
+        for (size_t i = 1; i < e_size; ++i)
+        {
+            double product_high, product_low, sum;
+            two_product(e[i], b, product_high, product_low);
+
+            two_sum(q, product_low, sum, error);
+            if (error != 0.)
+            {
+                h[h_size++] = error;
+            }
+
+            fast_two_sum(product_high, sum, q, error);
+            if (error != 0.)
+            {
+                h[h_size++] = error;
+            }
+        }
+
+        if (q != 0. || h_size == 0)
+        {
+            h[h_size++] = q;
+        }
+
+        return h_size;
+    }
+
+    template<size_t ECapacity, size_t FCapacity>
+    Expansion<ECapacity + FCapacity> operator+(Expansion<ECapacity> const & e, Expansion<FCapacity> const & f) noexcept
+    {
+        Expansion<ECapacity + FCapacity> result{};
+        result.size = expansion_sum(e.components.data(), e.size, f.components.data(), f.size, result.components.data());
+        return result;
+    }
+
+    template<size_t Capacity>
+    Expansion<Capacity> operator-(Expansion<Capacity> e) noexcept
+    {
+        for (size_t i = 0; i < e.size; ++i)
+        {
+            e.components[i] = -e.components[i];
+        }
+        return e;
+    }
+
+    template<size_t ECapacity, size_t FCapacity>
+    Expansion<2 * ECapacity * FCapacity> operator*(Expansion<ECapacity> const & e, Expansion<FCapacity> const & f) noexcept
+    {
+        Expansion<2 * ECapacity * FCapacity> result{};
+        Expansion<2 * ECapacity * FCapacity> accumulated{};
+        std::array<double, 2 * ECapacity> scaled{};
+
+        accumulated.size = scale_expansion(e.components.data(), e.size, f.components[0], accumulated.components.data());
+
+        for (size_t i = 1; i < f.size; ++i)
+        {
+            size_t const scaled_size = scale_expansion(e.components.data(), e.size, f.components[i], scaled.data());
+            result.size = expansion_sum(accumulated.components.data(), accumulated.size, scaled.data(), scaled_size, result.components.data());
+            std::swap(result, accumulated);
+        }
+
+        return accumulated;
+    }
+
+    Expansion<2> get_difference(float a, float b) noexcept
+    {
+        Expansion<2> result{};
+        two_diff(a, b, result.components[1], result.components[0]);
+
+        if (result.components[0] == 0.)
+        {
+            result.components[0] = result.components[1];
+            result.size = 1;
+        }
+        else
+        {
+            result.size = 2;
+        }
+
+        return result;
+    }
+
+    // approximate value of the expansion with the exact sign of its largest component
+    template<size_t Capacity>
+    double estimate(Expansion<Capacity> const & e) noexcept
+    {
+        double const largest = e.components[e.size - 1];
+
+        double result = 0.;
+        for (size_t i = 0; i + 1 < e.size; ++i)
+        {
+            result += e.components[i];
+        }
+        result += largest;
+
+        return (result > 0.) == (largest > 0.) && result != 0. ? result : largest;
+    }
+
+    double orient2d_exact(Point a, Point b, Point c) noexcept
+    {
+        Expansion<2> const acx = get_difference(a.x, c.x);
+        Expansion<2> const acy = get_difference(a.y, c.y);
+        Expansion<2> const bcx = get_difference(b.x, c.x);
+        Expansion<2> const bcy = get_difference(b.y, c.y);
+
+        return estimate(acx * bcy + -(acy * bcx));
+    }
+
+    // The filter is compiled with the precise floating point model of this file,
+    // the fast model may contract or reorder it and break the error bound.
+    double orient2d(Point begin, Point end, Point point) noexcept
+    {
+        double const left = (static_cast<double>(begin.x) - point.x) * (static_cast<double>(end.y) - point.y);
+        double const right = (static_cast<double>(begin.y) - point.y) * (static_cast<double>(end.x) - point.x);
+        double const result = left - right;
+
+        double const error_bound = orient2d_error_bound * (std::abs(left) + std::abs(right));
+        if (std::abs(result) > error_bound)
+        {
+            return result;
+        }
+
+        return orient2d_exact(begin, end, point);
+    }
+
+    double incircle_exact(Point a, Point b, Point c, Point d) noexcept
+    {
+        Expansion<2> const adx = get_difference(a.x, d.x);
+        Expansion<2> const ady = get_difference(a.y, d.y);
+        Expansion<2> const bdx = get_difference(b.x, d.x);
+        Expansion<2> const bdy = get_difference(b.y, d.y);
+        Expansion<2> const cdx = get_difference(c.x, d.x);
+        Expansion<2> const cdy = get_difference(c.y, d.y);
+
+        Expansion<16> const a_lift = adx * adx + ady * ady;
+        Expansion<16> const b_lift = bdx * bdx + bdy * bdy;
+        Expansion<16> const c_lift = cdx * cdx + cdy * cdy;
+
+        Expansion<16> const bc = bdx * cdy + -(cdx * bdy);
+        Expansion<16> const ca = cdx * ady + -(adx * cdy);
+        Expansion<16> const ab = adx * bdy + -(bdx * ady);
+
+        return estimate(a_lift * bc + b_lift * ca + c_lift * ab);
+    }
+
+    double incircle(Point first, Point second, Point third, Point point) noexcept
+    {
+        double const adx = static_cast<double>(first.x) - point.x;
+        double const ady = static_cast<double>(first.y) - point.y;
+        double const bdx = static_cast<double>(second.x) - point.x;
+        double const bdy = static_cast<double>(second.y) - point.y;
+        double const cdx = static_cast<double>(third.x) - point.x;
+        double const cdy = static_cast<double>(third.y) - point.y;
+
+        double const bdx_cdy = bdx * cdy;
+        double const cdx_bdy = cdx * bdy;
+        double const a_lift = adx * adx + ady * ady;
+
+        double const cdx_ady = cdx * ady;
+        double const adx_cdy = adx * cdy;
+        double const b_lift = bdx * bdx + bdy * bdy;
+
+        double const adx_bdy = adx * bdy;
+        double const bdx_ady = bdx * ady;
+        double const c_lift = cdx * cdx + cdy * cdy;
+
+        double const result =
+            a_lift * (bdx_cdy - cdx_bdy) +
+            b_lift * (cdx_ady - adx_cdy) +
+            c_lift * (adx_bdy - bdx_ady);
+
+        double const permanent =
+            (std::abs(bdx_cdy) + std::abs(cdx_bdy)) * a_lift +
+            (std::abs(cdx_ady) + std::abs(adx_cdy)) * b_lift +
+            (std::abs(adx_bdy) + std::abs(bdx_ady)) * c_lift;
+
+        double const error_bound = incircle_error_bound * permanent;
+        if (result > error_bound || -result > error_bound)
+        {
+            return result;
+        }
+
+        return incircle_exact(first, second, third, point);
+    }
+
+    int get_orientation(Point begin, Point end, Point point) noexcept
+    {
+        double const orientation = orient2d(begin, end, point);
+        return (orientation > 0.) - (orientation < 0.);
+    }
+
+    bool is_point_over_line_segment(Point begin, Point end, Point point) noexcept
+    {
+        return begin.x < end.x ?
+            orient2d(begin, end, point) > 0. :
+            orient2d(end, begin, point) > 0.;
+    }
+}
+
+
+#ifdef _MSC_VER
+#pragma float_control(pop)
+#endif
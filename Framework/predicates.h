@@ -0,0 +1,30 @@
+#pragma once
+
+#include "common.h"
+
+
+namespace frm
+{
+    // Adaptive precision predicates: the result is evaluated in double first
+    // and recomputed with exact expansion arithmetic only if its sign is not certain.
+    // Sign of the result is exact for any finite coordinates, magnitude is approximate.
+
+    // (end - begin) x (point - begin)
+    // > 0 - point is on the left side of the line from begin to end (counterclockwise turn)
+    // < 0 - point is on the right side
+    //   0 - points are collinear
+    double orient2d(Point begin, Point end, Point point) noexcept;
+
+    // first, second, third - counterclockwise triangle
+    // > 0 - point is inside of the circumcircle
+    // < 0 - point is outside
+    //   0 - points are cocircular
+    double incircle(Point first, Point second, Point third, Point point) noexcept;
+
+    // -1, 0, 1 - sign of orient2d
+    int get_orientation(Point begin, Point end, Point point) noexcept;
+
+    // true if point is strictly over (greater y) the line through the segment,
+    // segment must not be vertical
+    bool is_point_over_line_segment(Point begin, Point end, Point point) noexcept;
+}
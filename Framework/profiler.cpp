@@ -0,0 +1,364 @@
+#include "profiler.h"
+
+#include "imgui/imgui.h"
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+
+
+namespace frm
+{
+    // Samples of one thread since the last end of frame,
+    // its lock is only contended while the frame collects them
+    struct ThreadSamples
+    {
+        std::mutex mutex{};
+
+        std::vector<ProfileSample> samples{};
+        size_t dropped_samples_count{ 0 };
+
+        uint32_t thread{ 0 };
+    };
+
+    struct Profiler
+    {
+        std::mutex mutex{};
+
+        std::chrono::steady_clock::time_point const start{ std::chrono::steady_clock::now() };
+
+        std::array<ProfileFrame, profiler_frames_count> frames{};
+        // frames ever begun, current frame is frames[frames_count % profiler_frames_count]
+        size_t frames_count{ 0 };
+
+        // buffers of the threads that recorded samples, the ones of finished threads are dropped once collected
+        std::vector<std::shared_ptr<ThreadSamples>> threads{};
+        uint32_t threads_count{ 0 };
+
+        bool is_paused{ false };
+
+        // false before the first frame and while paused, scopes check it without the lock
+        std::atomic<bool> is_enabled{ false };
+    };
+
+    static Profiler profiler{};
+
+    // depth of the next scope of the thread
+    static thread_local uint32_t scope_depth = 0;
+
+    static thread_local std::shared_ptr<ThreadSamples> thread_samples{};
+
+    int64_t get_profiler_time() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - profiler.start).count();
+    }
+
+    ThreadSamples & get_thread_samples() noexcept
+    {
+        if (!thread_samples)
+        {
+            thread_samples = std::make_shared<ThreadSamples>();
+
+            std::lock_guard<std::mutex> const lock{ profiler.mutex };
+
+            thread_samples->thread = profiler.threads_count++;
+            profiler.threads.push_back(thread_samples);
+        }
+
+        return *thread_samples;
+    }
+
+    void update_profiler_enabled() noexcept
+    {
+        profiler.is_enabled.store(!profiler.is_paused && profiler.frames_count != 0, std::memory_order_relaxed);
+    }
+
+    // a scope begun while the profiler is disabled records nothing
+    static constexpr int64_t disabled_scope_begin = -1;
+
+    ProfileScope::ProfileScope(char const * name) noexcept
+        : name{ name },
+        begin{ profiler.is_enabled.load(std::memory_order_relaxed) ? get_profiler_time() : disabled_scope_begin }
+    {
+        ++scope_depth;
+    }
+
+    ProfileScope::~ProfileScope()
+    {
+        --scope_depth;
+
+        if (begin == disabled_scope_begin || !profiler.is_enabled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        int64_t const end = get_profiler_time();
+
+        ThreadSamples & samples = get_thread_samples();
+        std::lock_guard<std::mutex> const lock{ samples.mutex };
+
+        if (samples.samples.size() >= profiler_frame_samples_limit)
+        {
+            ++samples.dropped_samples_count;
+            return;
+        }
+
+        samples.samples.push_back({
+            name,
+            begin,
+            end - begin,
+            scope_depth,
+            samples.thread });
+    }
+
+    // moves the samples of all threads into the current frame, profiler.mutex must be locked
+    void collect_thread_samples(ProfileFrame & frame) noexcept
+    {
+        for (std::shared_ptr<ThreadSamples> const & samples : profiler.threads)
+        {
+            std::lock_guard<std::mutex> const lock{ samples->mutex };
+
+            size_t const kept_count = std::min(samples->samples.size(), profiler_frame_samples_limit - frame.samples.size());
+
+            frame.samples.insert(frame.samples.end(), samples->samples.begin(), samples->samples.begin() + kept_count);
+            frame.dropped_samples_count += samples->samples.size() - kept_count + samples->dropped_samples_count;
+
+            samples->samples.clear();
+            samples->dropped_samples_count = 0;
+        }
+
+        // only the profiler refers to the buffers of finished threads
+        profiler.threads.erase(std::remove_if(profiler.threads.begin(), profiler.threads.end(),
+            [](std::shared_ptr<ThreadSamples> const & samples) noexcept
+            {
+                return samples.use_count() == 1;
+            }),
+            profiler.threads.end());
+    }
+
+    void begin_profiler_frame() noexcept
+    {
+        std::lock_guard<std::mutex> const lock{ profiler.mutex };
+
+        if (profiler.is_paused)
+        {
+            return;
+        }
+
+        ++profiler.frames_count;
+        update_profiler_enabled();
+
+        ProfileFrame & frame = profiler.frames[profiler.frames_count % profiler_frames_count];
+        frame.begin = get_profiler_time();
+        frame.duration = 0;
+        frame.samples.clear();
+        frame.dropped_samples_count = 0;
+    }
+
+    void end_profiler_frame() noexcept
+    {
+        std::lock_guard<std::mutex> const lock{ profiler.mutex };
+
+        if (profiler.is_paused)
+        {
+            return;
+        }
+
+        ProfileFrame & frame = profiler.frames[profiler.frames_count % profiler_frames_count];
+        frame.duration = get_profiler_time() - frame.begin;
+
+        collect_thread_samples(frame);
+    }
+
+    // finished frames, i = 0 is the oldest one
+    size_t get_finished_frames_count() noexcept
+    {
+        // frames[0] is never finished, the first frame is frames[1]
+        return profiler.frames_count == 0 ? 0 : std::min(profiler.frames_count - 1, profiler_frames_count - 1);
+    }
+
+    ProfileFrame const & get_finished_frame(size_t i) noexcept
+    {
+        return profiler.frames[(profiler.frames_count - get_finished_frames_count() + i) % profiler_frames_count];
+    }
+
+    ImU32 get_sample_color(char const * name) noexcept
+    {
+        // names are literals, so the address is enough to tell them apart
+        size_t const hash = std::hash<void const *>{}(name);
+
+        return ImColor{
+            static_cast<int>(96 + hash % 128),
+            static_cast<int>(96 + (hash / 128) % 128),
+            static_cast<int>(96 + (hash / 16384) % 128) };
+    }
+
+    void show_frame_timeline(ProfileFrame const & frame) noexcept
+    {
+        float const row_height = ImGui::GetTextLineHeightWithSpacing();
+        float const width = std::max(ImGui::GetContentRegionAvail().x, 1.f);
+        ImVec2 const origin = ImGui::GetCursorScreenPos();
+        ImDrawList * const draw_list = ImGui::GetWindowDrawList();
+
+        // every thread gets as many rows as its deepest scope needs
+        std::vector<uint32_t> thread_rows{};
+        for (ProfileSample const & sample : frame.samples)
+        {
+            if (sample.thread >= thread_rows.size())
+            {
+                thread_rows.resize(sample.thread + 1, 0);
+            }
+            thread_rows[sample.thread] = std::max(thread_rows[sample.thread], sample.depth + 1);
+        }
+
+        std::vector<uint32_t> thread_first_rows(thread_rows.size() + 1, 0);
+        for (size_t i = 0; i < thread_rows.size(); ++i)
+        {
+            thread_first_rows[i + 1] = thread_first_rows[i] + thread_rows[i];
+        }
+
+        float const us_to_pixels = width / static_cast<float>(std::max<int64_t>(frame.duration, 1));
+
+        for (ProfileSample const & sample : frame.samples)
+        {
+            float const row = static_cast<float>(thread_first_rows[sample.thread] + sample.depth);
+
+            ImVec2 const min{
+                origin.x + std::max(0.f, static_cast<float>(sample.begin - frame.begin) * us_to_pixels),
+                origin.y + row * row_height };
+            ImVec2 const max{
+                std::min(origin.x + width, min.x + std::max(1.f, static_cast<float>(sample.duration) * us_to_pixels)),
+                min.y + row_height - 1.f };
+
+            draw_list->AddRectFilled(min, max, get_sample_color(sample.name));
+
+            if (max.x - min.x > ImGui::CalcTextSize(sample.name).x)
+            {
+                draw_list->AddText(min, IM_COL32(0, 0, 0, 255), sample.name);
+            }
+
+            if (ImGui::IsMouseHoveringRect(min, max))
+            {
+                ImGui::SetTooltip("%s\n%.3f ms\nthread %d", sample.name, static_cast<float>(sample.duration) / 1000.f, static_cast<int>(sample.thread));
+            }
+        }
+
+        ImGui::Dummy(ImVec2{ width, static_cast<float>(thread_first_rows.back()) * row_height });
+    }
+
+    void show_profiler_ui() noexcept
+    {
+        bool need_save_csv = false;
+        bool need_save_chrome_trace = false;
+
+        if (ImGui::Begin("Profiler"))
+        {
+            need_save_csv = ImGui::Button("Save CSV");
+            ImGui::SameLine();
+            need_save_chrome_trace = ImGui::Button("Save Chrome trace");
+
+            std::lock_guard<std::mutex> const lock{ profiler.mutex };
+
+            if (ImGui::Checkbox("Pause", &profiler.is_paused))
+            {
+                update_profiler_enabled();
+            }
+
+            size_t const frames_count = get_finished_frames_count();
+
+            if (frames_count > 0)
+            {
+                std::array<float, profiler_frames_count> durations{};
+                for (size_t i = 0; i < frames_count; ++i)
+                {
+                    durations[i] = static_cast<float>(get_finished_frame(i).duration) / 1000.f;
+                }
+
+                ImGui::PlotHistogram("Frames, ms", durations.data(), static_cast<int>(frames_count), 0, nullptr, 0.f, FLT_MAX, ImVec2{ 0.f, 80.f });
+
+                // 0 - the last finished frame
+                static int frames_back = 0;
+                ImGui::SliderInt("Frames back", &frames_back, 0, static_cast<int>(frames_count) - 1);
+                frames_back = std::min(frames_back, static_cast<int>(frames_count) - 1);
+
+                ProfileFrame const & frame = get_finished_frame(frames_count - 1 - static_cast<size_t>(frames_back));
+                ImGui::Text("%.3f ms, %d samples", static_cast<float>(frame.duration) / 1000.f, static_cast<int>(frame.samples.size()));
+                if (frame.dropped_samples_count > 0)
+                {
+                    ImGui::SameLine();
+                    ImGui::Text("(%d dropped)", static_cast<int>(frame.dropped_samples_count));
+                }
+
+                show_frame_timeline(frame);
+            }
+        }
+        ImGui::End();
+
+        // saving takes the lock itself
+        if (need_save_csv)
+        {
+            save_profile_to_csv("profile.csv");
+        }
+        if (need_save_chrome_trace)
+        {
+            save_profile_to_chrome_trace("profile.json");
+        }
+    }
+
+    bool save_profile_to_csv(std::string const & path) noexcept
+    {
+        std::ofstream file_output{ path };
+        if (!file_output)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> const lock{ profiler.mutex };
+
+        file_output << "frame,thread,depth,name,begin_us,duration_us\n";
+
+        for (size_t i = 0; i < get_finished_frames_count(); ++i)
+        {
+            for (ProfileSample const & sample : get_finished_frame(i).samples)
+            {
+                file_output << i << ',' << sample.thread << ',' << sample.depth << ',' <<
+                    sample.name << ',' << sample.begin << ',' << sample.duration << '\n';
+            }
+        }
+
+        return static_cast<bool>(file_output);
+    }
+
+    bool save_profile_to_chrome_trace(std::string const & path) noexcept
+    {
+        std::ofstream file_output{ path };
+        if (!file_output)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> const lock{ profiler.mutex };
+
+        file_output << "{\"traceEvents\":[";
+
+        bool is_first = true;
+        for (size_t i = 0; i < get_finished_frames_count(); ++i)
+        {
+            for (ProfileSample const & sample : get_finished_frame(i).samples)
+            {
+                file_output << (is_first ? "\n" : ",\n") <<
+                    "{\"name\":\"" << sample.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << sample.thread <<
+                    ",\"ts\":" << sample.begin << ",\"dur\":" << sample.duration << '}';
+                is_first = false;
+            }
+        }
+
+        file_output << "\n]}\n";
+
+        return static_cast<bool>(file_output);
+    }
+}
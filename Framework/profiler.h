@@ -0,0 +1,68 @@
+#pragma once
+
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+namespace frm
+{
+    struct ProfileSample
+    {
+        char const * name;
+        // us since the start of the profiler
+        int64_t begin;
+        int64_t duration;
+        // nesting of the scope in its thread
+        uint32_t depth;
+        // threads are numbered in the order they recorded their first sample
+        uint32_t thread;
+    };
+
+    struct ProfileFrame
+    {
+        int64_t begin{ 0 };
+        int64_t duration{ 0 };
+        std::vector<ProfileSample> samples{};
+        // samples over profiler_frame_samples_limit are only counted
+        size_t dropped_samples_count{ 0 };
+    };
+
+    // frames kept in the ring buffer of the profiler
+    static constexpr size_t profiler_frames_count = 240;
+    // a long job can end millions of scopes in one frame
+    static constexpr size_t profiler_frame_samples_limit = 1 << 16;
+
+    // Times the code from its construction to the end of its block,
+    // the sample is buffered by its thread and goes into the frame that ends next.
+    // Nothing is recorded before the first frame or while paused, such scopes don't read the clock.
+    // Any thread can have scopes, name must outlive the profiler.
+    // Scopes cost a clock read and an uncontended lock, so they belong around batches, not single queries.
+    struct ProfileScope
+    {
+        explicit ProfileScope(char const * name) noexcept;
+        ~ProfileScope();
+
+        ProfileScope(ProfileScope const &) = delete;
+        ProfileScope(ProfileScope &&) = delete;
+        ProfileScope & operator=(ProfileScope const &) = delete;
+        ProfileScope & operator=(ProfileScope &&) = delete;
+
+        char const * name;
+        int64_t begin;
+    };
+
+    // called by the main loop around every frame
+    void begin_profiler_frame() noexcept;
+    void end_profiler_frame() noexcept;
+
+    // frame time histogram and the timeline of a chosen frame
+    void show_profiler_ui() noexcept;
+
+    // recorded frames from the oldest one
+    // frame,thread,depth,name,begin_us,duration_us
+    bool save_profile_to_csv(std::string const & path) noexcept;
+    // trace event format of chrome://tracing
+    bool save_profile_to_chrome_trace(std::string const & path) noexcept;
+}
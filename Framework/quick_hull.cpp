@@ -1,6 +1,17 @@
 #include "quick_hull.h"
 
+#include "predicates.h"
+#include "counters.h"
+
 #include <cassert>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <thread>
+
+#include <emmintrin.h>
 
 
 namespace frm
@@ -12,19 +23,27 @@ namespace frm
         OnLine
     };
 
+    FRM_COUNTER(get_side_counter, "quick_hull/get_side", nullptr);
+    // lanes of get_side_mask, uncertain ones are counted by get_side again
+    FRM_COUNTER(side_mask_lanes_counter, "quick_hull/side_mask_lanes", nullptr);
+    FRM_OPERATION_COUNTERS(quick_hull_counters, "quick_hull");
+    FRM_OPERATION_COUNTERS(quick_hull_parallel_counters, "quick_hull_parallel");
+
     SideByLine get_side(frm::Point begin, frm::Point end, frm::Point point) noexcept
     {
-        float const side = (point.y - begin.y) * (end.x - begin.x) - (end.y - begin.y) * (point.x - begin.x);
+        FRM_COUNT(get_side_counter);
+
+        double const side = frm::orient2d(begin, end, point);
 
-        if (abs(side) < frm::epsilon)
+        if (side > 0.)
         {
-            return SideByLine::OnLine;
+            return SideByLine::Right;
         }
-        if (side > frm::epsilon)
+        if (side < 0.)
         {
-            return SideByLine::Right;
+            return SideByLine::Left;
         }
-        return SideByLine::Left;
+        return SideByLine::OnLine;
     }
 
     constexpr SideByLine invert_side(SideByLine side) noexcept
@@ -34,28 +53,48 @@ namespace frm
             ));
     }
 
-    float distance_to_line(frm::Point begin, frm::Point end, frm::Point point) noexcept
+    // in double, so nearly collinear points still get distinct distances
+    double distance_to_line(frm::Point begin, frm::Point end, frm::Point point) noexcept
     {
-        return abs((point.y - begin.y) * (end.x - begin.x) - (end.y - begin.y) * (point.x - begin.x));
+        return std::abs(
+            (static_cast<double>(point.y) - begin.y) * (static_cast<double>(end.x) - begin.x) -
+            (static_cast<double>(end.y) - begin.y) * (static_cast<double>(point.x) - begin.x));
     }
 
-    void quick_hull(frm::vvve::VVVE & vvve, size_t begin_index, size_t end_index, SideByLine side) noexcept
+    // triangle_side - get_side(first, second, third), it is the same for every edge of the triangle
+    bool is_point_inside_triangle(frm::Point first, frm::Point second, frm::Point third, SideByLine triangle_side, frm::Point point) noexcept
+    {
+        return get_side(first, second, point) == triangle_side &&
+            get_side(second, third, point) == triangle_side &&
+            get_side(third, first, point) == triangle_side;
+    }
+
+    // indices[first, last) - points that lie on one side of the line from begin to end, in increasing order.
+    // buffer - scratch storage shared by the whole recursion.
+    void quick_hull(
+        frm::vvve::VVVE & vvve,
+        size_t begin_index,
+        size_t end_index,
+        std::vector<size_t> & indices,
+        size_t first,
+        size_t last,
+        std::vector<size_t> & buffer) noexcept
     {
         size_t index = std::numeric_limits<size_t>::max();
 
-        float max_distance = 0.f;
+        double max_distance = 0.;
 
         frm::Point const begin = vvve.vertices[begin_index].coordinate;
         frm::Point const end = vvve.vertices[end_index].coordinate;
 
-        for (size_t i = 0; i < vvve.vertices.size(); ++i)
+        for (size_t i = first; i < last; ++i)
         {
-            frm::Point const current_point = vvve.vertices[i].coordinate;
-            float const current_distance = distance_to_line(begin, end, current_point);
+            frm::Point const current_point = vvve.vertices[indices[i]].coordinate;
+            double const current_distance = distance_to_line(begin, end, current_point);
 
-            if (get_side(begin, end, current_point) == side && current_distance > max_distance)
+            if (current_distance > max_distance)
             {
-                index = i;
+                index = indices[i];
                 max_distance = current_distance;
             }
         }
@@ -67,16 +106,53 @@ namespace frm
         }
 
         frm::Point const point_by_index = vvve.vertices[index].coordinate;
-        quick_hull(vvve, index, begin_index, invert_side(get_side(point_by_index, begin, end)));
-        quick_hull(vvve, index, end_index, invert_side(get_side(point_by_index, end, begin)));
+
+        SideByLine const begin_side = invert_side(get_side(point_by_index, begin, end));
+        SideByLine const end_side = invert_side(get_side(point_by_index, end, begin));
+
+        // Stable partition: points outside of (index, begin) go to the front of the range,
+        // points outside of (index, end) follow them, points inside the triangle are discarded.
+        size_t middle = first;
+        buffer.clear();
+
+        for (size_t i = first; i < last; ++i)
+        {
+            frm::Point const current_point = vvve.vertices[indices[i]].coordinate;
+
+            if (get_side(point_by_index, begin, current_point) == begin_side)
+            {
+                indices[middle++] = indices[i];
+            }
+            else if (get_side(point_by_index, end, current_point) == end_side)
+            {
+                buffer.push_back(indices[i]);
+            }
+        }
+
+        std::copy(buffer.begin(), buffer.end(), indices.begin() + middle);
+        size_t const new_last = middle + buffer.size();
+
+        quick_hull(vvve, index, begin_index, indices, first, middle, buffer);
+        quick_hull(vvve, index, end_index, indices, middle, new_last, buffer);
     }
 
-    void quick_hull(frm::vvve::VVVE & vvve) noexcept(!IS_DEBUG)
+    struct HullSeed
     {
-        assert(vvve.vertices.size() >= 3);
+        size_t left_index;
+        size_t right_index;
 
+        // extreme by y point on each side of the line from left to right,
+        // std::numeric_limits<size_t>::max() if there is no such point
+        size_t right_side_extreme_index{ std::numeric_limits<size_t>::max() };
+        size_t left_side_extreme_index{ std::numeric_limits<size_t>::max() };
+    };
+
+    HullSeed get_hull_seed(frm::vvve::VVVE const & vvve) noexcept
+    {
         size_t left_index = 0;
         size_t right_index = 0;
+        size_t bottom_index = 0;
+        size_t top_index = 0;
 
 
         for (size_t i = 0; i < vvve.vertices.size(); ++i)
@@ -89,9 +165,486 @@ namespace frm
             {
                 right_index = i;
             }
+            if (vvve.vertices[i].coordinate.y < vvve.vertices[bottom_index].coordinate.y)
+            {
+                bottom_index = i;
+            }
+            if (vvve.vertices[i].coordinate.y > vvve.vertices[top_index].coordinate.y)
+            {
+                top_index = i;
+            }
+        }
+
+        HullSeed seed{ left_index, right_index };
+
+        frm::Point const left = vvve.vertices[left_index].coordinate;
+        frm::Point const right = vvve.vertices[right_index].coordinate;
+
+        for (size_t const extreme_index : { bottom_index, top_index })
+        {
+            SideByLine const extreme_side = get_side(left, right, vvve.vertices[extreme_index].coordinate);
+
+            if (extreme_side == SideByLine::Right)
+            {
+                seed.right_side_extreme_index = extreme_index;
+            }
+            if (extreme_side == SideByLine::Left)
+            {
+                seed.left_side_extreme_index = extreme_index;
+            }
+        }
+
+        return seed;
+    }
+
+    // Akl-Toussaint heuristic: the extreme points by x and y form a quadrilateral,
+    // points strictly inside it can not be on the hull.
+    // Left, Right - side of the line from left to right point
+    // OnLine - point can be discarded
+    SideByLine get_initial_side(frm::vvve::VVVE const & vvve, HullSeed const & seed, size_t vertex_index) noexcept
+    {
+        frm::Point const left = vvve.vertices[seed.left_index].coordinate;
+        frm::Point const right = vvve.vertices[seed.right_index].coordinate;
+
+        frm::Point const current_point = vvve.vertices[vertex_index].coordinate;
+        SideByLine const side = get_side(left, right, current_point);
+
+        size_t const extreme_index = side == SideByLine::Right ?
+            seed.right_side_extreme_index :
+            seed.left_side_extreme_index;
+
+        if (side != SideByLine::OnLine &&
+            extreme_index != std::numeric_limits<size_t>::max() &&
+            is_point_inside_triangle(left, vvve.vertices[extreme_index].coordinate, right, invert_side(side), current_point))
+        {
+            return SideByLine::OnLine;
+        }
+
+        return side;
+    }
+
+    // O(nlog(n)) on average, points are discarded as soon as they fall inside the hull
+    void quick_hull(frm::vvve::VVVE & vvve) noexcept(!IS_DEBUG)
+    {
+        assert(vvve.vertices.size() >= 3);
+        FRM_COUNT_OPERATION(quick_hull_counters);
+
+        frm::vvve::mark_structure_changed(vvve);
+
+        HullSeed const seed = get_hull_seed(vvve);
+
+        std::vector<size_t> indices{};
+        indices.reserve(vvve.vertices.size());
+
+        std::vector<size_t> buffer{};
+
+        for (size_t i = 0; i < vvve.vertices.size(); ++i)
+        {
+            SideByLine const side = get_initial_side(vvve, seed, i);
+
+            if (side == SideByLine::Right)
+            {
+                indices.push_back(i);
+            }
+            else if (side == SideByLine::Left)
+            {
+                buffer.push_back(i);
+            }
+        }
+
+        size_t const middle = indices.size();
+        indices.insert(indices.end(), buffer.begin(), buffer.end());
+
+        quick_hull(vvve, seed.left_index, seed.right_index, indices, 0, middle, buffer);
+        quick_hull(vvve, seed.left_index, seed.right_index, indices, middle, indices.size(), buffer);
+    }
+
+
+    // Points of one subproblem stored as structure of arrays,
+    // so the side and distance predicates can be evaluated for four points at once.
+    struct HullPoints
+    {
+        std::vector<float> x{};
+        std::vector<float> y{};
+        std::vector<size_t> index{};
+
+        void push_back(float point_x, float point_y, size_t point_index) noexcept
+        {
+            x.push_back(point_x);
+            y.push_back(point_y);
+            index.push_back(point_index);
+        }
+
+        void reserve(size_t size) noexcept
+        {
+            x.reserve(size);
+            y.reserve(size);
+            index.reserve(size);
+        }
+
+        void clear() noexcept
+        {
+            x.clear();
+            y.clear();
+            index.clear();
+        }
+    };
+
+    // Subproblems smaller than this are not worth a separate task
+    static constexpr size_t parallel_quick_hull_threshold = 1 << 15;
+
+    // levels of the recursion that may split into tasks, every level doubles the tasks,
+    // so ceil(log2(hardware_concurrency)) levels are enough to busy all threads
+    size_t get_parallel_quick_hull_depth() noexcept
+    {
+        size_t depth = 0;
+
+        for (size_t tasks_count = 1; tasks_count < std::thread::hardware_concurrency(); tasks_count *= 2)
+        {
+            ++depth;
+        }
+
+        return depth;
+    }
+
+    // relative bound of the float rounding error of the side value, (3 + 16u)u rounded up with u = 2^-24
+    static constexpr float side_value_error_bound = 2.5e-7f;
+
+    // (point.y - begin.y) * (end.x - begin.x) - (end.y - begin.y) * (point.x - begin.x) for four points,
+    // error_bound - the sign of the value is certain if its absolute value is greater
+    __m128 get_side_value(__m128 x, __m128 y, frm::Point begin, frm::Point end, __m128 & error_bound) noexcept
+    {
+        __m128 const offset_x = _mm_sub_ps(x, _mm_set1_ps(begin.x));
+        __m128 const offset_y = _mm_sub_ps(y, _mm_set1_ps(begin.y));
+
+        __m128 const left = _mm_mul_ps(offset_y, _mm_set1_ps(end.x - begin.x));
+        __m128 const right = _mm_mul_ps(_mm_set1_ps(end.y - begin.y), offset_x);
+
+        __m128 const sign_mask = _mm_set1_ps(-0.f);
+        error_bound = _mm_add_ps(
+            _mm_mul_ps(_mm_add_ps(_mm_andnot_ps(sign_mask, left), _mm_andnot_ps(sign_mask, right)), _mm_set1_ps(side_value_error_bound)),
+            _mm_set1_ps(std::numeric_limits<float>::min()));
+
+        return _mm_sub_ps(left, right);
+    }
+
+    // bit i is set if point i lies on the side, same result as get_side:
+    // lanes with uncertain sign of the float side value are resolved by get_side
+    int get_side_mask(__m128 x, __m128 y, frm::Point begin, frm::Point end, SideByLine side) noexcept
+    {
+        FRM_COUNT_N(side_mask_lanes_counter, 4);
+
+        __m128 error_bound;
+        __m128 const side_value = get_side_value(x, y, begin, end, error_bound);
+
+        int const right_mask = _mm_movemask_ps(_mm_cmpgt_ps(side_value, error_bound));
+        int const left_mask = _mm_movemask_ps(_mm_cmplt_ps(side_value, _mm_xor_ps(error_bound, _mm_set1_ps(-0.f))));
+        int const uncertain_mask = ~(right_mask | left_mask) & 0xF;
+
+        int mask = side == SideByLine::Right ? right_mask : (side == SideByLine::Left ? left_mask : 0);
+
+        if (uncertain_mask != 0)
+        {
+            float lane_x[4];
+            float lane_y[4];
+            _mm_storeu_ps(lane_x, x);
+            _mm_storeu_ps(lane_y, y);
+
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (((uncertain_mask >> lane) & 1) && get_side(begin, end, { lane_x[lane], lane_y[lane] }) == side)
+                {
+                    mask |= 1 << lane;
+                }
+            }
+        }
+
+        return mask;
+    }
+
+    // distance_to_line for two points, evaluated with the same operations
+    __m128d get_distance_to_line(__m128d x, __m128d y, frm::Point begin, frm::Point end) noexcept
+    {
+        __m128d const offset_x = _mm_sub_pd(x, _mm_set1_pd(begin.x));
+        __m128d const offset_y = _mm_sub_pd(y, _mm_set1_pd(begin.y));
+
+        __m128d const side_value = _mm_sub_pd(
+            _mm_mul_pd(offset_y, _mm_set1_pd(static_cast<double>(end.x) - begin.x)),
+            _mm_mul_pd(_mm_set1_pd(static_cast<double>(end.y) - begin.y), offset_x));
+
+        return _mm_andnot_pd(_mm_set1_pd(-0.), side_value);
+    }
+
+    // Returns position of the first farthest point from the line in [first, last)
+    // or std::numeric_limits<size_t>::max() if range is empty
+    size_t get_farthest_point_position(HullPoints const & points, size_t first, size_t last, frm::Point begin, frm::Point end) noexcept
+    {
+        // low and high halves of four points, positions are relative to first
+        __m128d max_distance[2] = { _mm_setzero_pd(), _mm_setzero_pd() };
+        __m128d max_position[2] = { _mm_set1_pd(-1.), _mm_set1_pd(-1.) };
+        __m128d position[2] = { _mm_setr_pd(0., 1.), _mm_setr_pd(2., 3.) };
+
+        __m128d const step = _mm_set1_pd(4.);
+
+        size_t i = first;
+        for (; i + 4 <= last; i += 4)
+        {
+            __m128 const x = _mm_loadu_ps(&points.x[i]);
+            __m128 const y = _mm_loadu_ps(&points.y[i]);
+
+            __m128d const distance[2] =
+            {
+                get_distance_to_line(_mm_cvtps_pd(x), _mm_cvtps_pd(y), begin, end),
+                get_distance_to_line(_mm_cvtps_pd(_mm_movehl_ps(x, x)), _mm_cvtps_pd(_mm_movehl_ps(y, y)), begin, end)
+            };
+
+            for (size_t half = 0; half < 2; ++half)
+            {
+                __m128d const is_greater = _mm_cmpgt_pd(distance[half], max_distance[half]);
+
+                max_distance[half] = _mm_or_pd(_mm_and_pd(is_greater, distance[half]), _mm_andnot_pd(is_greater, max_distance[half]));
+                max_position[half] = _mm_or_pd(_mm_and_pd(is_greater, position[half]), _mm_andnot_pd(is_greater, max_position[half]));
+                position[half] = _mm_add_pd(position[half], step);
+            }
+        }
+
+        double lane_distances[4];
+        double lane_positions[4];
+        _mm_storeu_pd(lane_distances, max_distance[0]);
+        _mm_storeu_pd(lane_distances + 2, max_distance[1]);
+        _mm_storeu_pd(lane_positions, max_position[0]);
+        _mm_storeu_pd(lane_positions + 2, max_position[1]);
+
+        size_t farthest_position = std::numeric_limits<size_t>::max();
+        double farthest_distance = 0.;
+
+        // equal distances are resolved to the lowest position, as the scalar scan does
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            if (lane_positions[lane] < 0.)
+            {
+                continue;
+            }
+
+            size_t const lane_position = first + static_cast<size_t>(lane_positions[lane]);
+
+            if (lane_distances[lane] > farthest_distance ||
+                (lane_distances[lane] == farthest_distance && lane_position < farthest_position))
+            {
+                farthest_distance = lane_distances[lane];
+                farthest_position = lane_position;
+            }
+        }
+
+        for (; i < last; ++i)
+        {
+            double const current_distance = distance_to_line(begin, end, { points.x[i], points.y[i] });
+
+            if (current_distance > farthest_distance)
+            {
+                farthest_distance = current_distance;
+                farthest_position = i;
+            }
+        }
+
+        return farthest_position;
+    }
+
+    void quick_hull_parallel(
+        std::vector<frm::vvve::VVVE::Vertex> const & vertices,
+        size_t begin_index,
+        size_t end_index,
+        HullPoints & points,
+        size_t first,
+        size_t last,
+        HullPoints & buffer,
+        std::vector<frm::vvve::VVVE::edge_t> & edges,
+        size_t parallel_depth) noexcept
+    {
+        frm::Point const begin = vertices[begin_index].coordinate;
+        frm::Point const end = vertices[end_index].coordinate;
+
+        size_t const farthest_position = get_farthest_point_position(points, first, last, begin, end);
+
+        if (farthest_position == std::numeric_limits<size_t>::max())
+        {
+            edges.push_back({ begin_index, end_index });
+            return;
+        }
+
+        size_t const index = points.index[farthest_position];
+        frm::Point const point_by_index = vertices[index].coordinate;
+
+        SideByLine const begin_side = invert_side(get_side(point_by_index, begin, end));
+        SideByLine const end_side = invert_side(get_side(point_by_index, end, begin));
+
+        size_t middle = first;
+        buffer.clear();
+
+        auto const move_point = [&points, &buffer, &middle](size_t i, bool is_begin_side, bool is_end_side) noexcept
+        {
+            if (is_begin_side)
+            {
+                points.x[middle] = points.x[i];
+                points.y[middle] = points.y[i];
+                points.index[middle] = points.index[i];
+                ++middle;
+            }
+            else if (is_end_side)
+            {
+                buffer.push_back(points.x[i], points.y[i], points.index[i]);
+            }
+        };
+
+        size_t i = first;
+        for (; i + 4 <= last; i += 4)
+        {
+            __m128 const x = _mm_loadu_ps(&points.x[i]);
+            __m128 const y = _mm_loadu_ps(&points.y[i]);
+
+            int const begin_mask = get_side_mask(x, y, point_by_index, begin, begin_side);
+            int const end_mask = get_side_mask(x, y, point_by_index, end, end_side);
+
+            if ((begin_mask | end_mask) == 0)
+            {
+                continue;
+            }
+
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                move_point(i + lane, (begin_mask >> lane) & 1, (end_mask >> lane) & 1);
+            }
+        }
+
+        for (; i < last; ++i)
+        {
+            frm::Point const current_point{ points.x[i], points.y[i] };
+
+            move_point(i,
+                get_side(point_by_index, begin, current_point) == begin_side,
+                get_side(point_by_index, end, current_point) == end_side);
+        }
+
+        std::copy(buffer.x.begin(), buffer.x.end(), points.x.begin() + middle);
+        std::copy(buffer.y.begin(), buffer.y.end(), points.y.begin() + middle);
+        std::copy(buffer.index.begin(), buffer.index.end(), points.index.begin() + middle);
+        size_t const new_last = middle + buffer.index.size();
+
+        if (parallel_depth == 0 || new_last - first < parallel_quick_hull_threshold)
+        {
+            quick_hull_parallel(vertices, index, begin_index, points, first, middle, buffer, edges, 0);
+            quick_hull_parallel(vertices, index, end_index, points, middle, new_last, buffer, edges, 0);
+            return;
         }
 
-        quick_hull(vvve, left_index, right_index, SideByLine::Right);
-        quick_hull(vvve, left_index, right_index, SideByLine::Left);
+        // ranges of the two subproblems do not overlap, so the second one runs as a separate task
+        std::vector<frm::vvve::VVVE::edge_t> end_edges{};
+        std::future<void> end_task = std::async(std::launch::async,
+            [&vertices, index, end_index, &points, middle, new_last, &end_edges, parallel_depth]() noexcept
+            {
+                HullPoints end_buffer{};
+                quick_hull_parallel(vertices, index, end_index, points, middle, new_last, end_buffer, end_edges, parallel_depth - 1);
+            });
+
+        quick_hull_parallel(vertices, index, begin_index, points, first, middle, buffer, edges, parallel_depth - 1);
+
+        end_task.get();
+        edges.insert(edges.end(), end_edges.begin(), end_edges.end());
+    }
+
+    void quick_hull_parallel(frm::vvve::VVVE & vvve) noexcept(!IS_DEBUG)
+    {
+        assert(vvve.vertices.size() >= 3);
+        FRM_COUNT_OPERATION(quick_hull_parallel_counters);
+
+        frm::vvve::mark_structure_changed(vvve);
+
+        HullSeed const seed = get_hull_seed(vvve);
+
+        size_t const threads_count = std::max<size_t>(1, std::min<size_t>(
+            std::thread::hardware_concurrency(),
+            vvve.vertices.size() / parallel_quick_hull_threshold));
+        size_t const chunk_size = (vvve.vertices.size() + threads_count - 1) / threads_count;
+
+        // first - right side points of chunk, second - left side points of chunk
+        std::vector<std::pair<HullPoints, HullPoints>> chunks(threads_count);
+        std::vector<std::future<void>> chunk_tasks{};
+
+        for (size_t chunk = 0; chunk < threads_count; ++chunk)
+        {
+            chunk_tasks.push_back(std::async(std::launch::async, [&vvve, &seed, &chunks, chunk, chunk_size]() noexcept
+                {
+                    size_t const chunk_begin = chunk * chunk_size;
+                    size_t const chunk_end = std::min(vvve.vertices.size(), chunk_begin + chunk_size);
+
+                    // for uniform data about a quarter of the points survive on each side
+                    chunks[chunk].first.reserve((chunk_end - chunk_begin) / 4);
+                    chunks[chunk].second.reserve((chunk_end - chunk_begin) / 4);
+
+                    for (size_t i = chunk_begin; i < chunk_end; ++i)
+                    {
+                        SideByLine const side = get_initial_side(vvve, seed, i);
+                        frm::Point const point = vvve.vertices[i].coordinate;
+
+                        if (side == SideByLine::Right)
+                        {
+                            chunks[chunk].first.push_back(point.x, point.y, i);
+                        }
+                        else if (side == SideByLine::Left)
+                        {
+                            chunks[chunk].second.push_back(point.x, point.y, i);
+                        }
+                    }
+                }));
+        }
+
+        for (std::future<void> & chunk_task : chunk_tasks)
+        {
+            chunk_task.get();
+        }
+
+        HullPoints points{};
+        points.reserve(std::accumulate(chunks.begin(), chunks.end(), size_t{ 0 },
+            [](size_t size, std::pair<HullPoints, HullPoints> const & chunk) noexcept
+            {
+                return size + chunk.first.index.size() + chunk.second.index.size();
+            }));
+
+        auto const append = [&points](HullPoints const & chunk_points) noexcept
+        {
+            points.x.insert(points.x.end(), chunk_points.x.begin(), chunk_points.x.end());
+            points.y.insert(points.y.end(), chunk_points.y.begin(), chunk_points.y.end());
+            points.index.insert(points.index.end(), chunk_points.index.begin(), chunk_points.index.end());
+        };
+
+        for (std::pair<HullPoints, HullPoints> const & chunk : chunks)
+        {
+            append(chunk.first);
+        }
+        size_t const middle = points.index.size();
+        for (std::pair<HullPoints, HullPoints> const & chunk : chunks)
+        {
+            append(chunk.second);
+        }
+
+        // the split into the two sides is the first parallel level
+        size_t const parallel_depth = get_parallel_quick_hull_depth();
+        size_t const sides_depth = parallel_depth == 0 ? 0 : parallel_depth - 1;
+
+        std::vector<frm::vvve::VVVE::edge_t> left_edges{};
+        std::future<void> left_task = std::async(parallel_depth == 0 ? std::launch::deferred : std::launch::async,
+            [&vvve, &seed, &points, middle, &left_edges, sides_depth]() noexcept
+            {
+                HullPoints left_buffer{};
+                quick_hull_parallel(vvve.vertices, seed.left_index, seed.right_index,
+                    points, middle, points.index.size(), left_buffer, left_edges, sides_depth);
+            });
+
+        HullPoints right_buffer{};
+        quick_hull_parallel(vvve.vertices, seed.left_index, seed.right_index,
+            points, 0, middle, right_buffer, vvve.edges, sides_depth);
+
+        left_task.get();
+        vvve.edges.insert(vvve.edges.end(), left_edges.begin(), left_edges.end());
     }
 }
@@ -5,5 +5,10 @@
 
 namespace frm
 {
+    // Points lying on a hull edge may be kept as hull vertices
     void quick_hull(frm::vvve::VVVE & vvve) noexcept(!IS_DEBUG);
+
+    // Same edges as quick_hull, points are kept as SoA float arrays and
+    // checked with SSE, large subproblems are solved as parallel tasks
+    void quick_hull_parallel(frm::vvve::VVVE & vvve) noexcept(!IS_DEBUG);
 }
@@ -0,0 +1,334 @@
+#include "range_index.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        // spreads the low 16 bits to the even ones
+        uint32_t interleave_with_zeros(uint32_t x) noexcept
+        {
+            x = (x | (x << 8u)) & 0x00FF00FFu;
+            x = (x | (x << 4u)) & 0x0F0F0F0Fu;
+            x = (x | (x << 2u)) & 0x33333333u;
+            x = (x | (x << 1u)) & 0x55555555u;
+
+            return x;
+        }
+
+        // Distance along the Hilbert curve through a 2^16 x 2^16 grid.
+        // The orientations of the quadrants are found for all the levels at once by the prefix scans
+        // of the bit operations, so there are no branches per level.
+        uint32_t get_hilbert_distance(uint32_t x, uint32_t y) noexcept
+        {
+            uint32_t a = x ^ y;
+            uint32_t b = 0xFFFFu ^ a;
+            uint32_t c = 0xFFFFu ^ (x | y);
+            uint32_t d = x & (y ^ 0xFFFFu);
+
+            uint32_t next_a = a | (b >> 1u);
+            uint32_t next_b = (a >> 1u) ^ a;
+            uint32_t next_c = ((c >> 1u) ^ (b & (d >> 1u))) ^ c;
+            uint32_t next_d = ((a & (c >> 1u)) ^ (d >> 1u)) ^ d;
+
+            for (uint32_t shift = 2; shift <= 8; shift *= 2)
+            {
+                a = next_a;
+                b = next_b;
+                c = next_c;
+                d = next_d;
+
+                next_a = (a & (a >> shift)) ^ (b & (b >> shift));
+                next_b = (a & (b >> shift)) ^ (b & ((a ^ b) >> shift));
+                next_c ^= (a & (c >> shift)) ^ (b & (d >> shift));
+                next_d ^= (b & (c >> shift)) ^ ((a ^ b) & (d >> shift));
+            }
+
+            a = next_c ^ (next_c >> 1u);
+            b = next_d ^ (next_d >> 1u);
+
+            uint32_t const i0 = x ^ y;
+            uint32_t const i1 = b | (0xFFFFu ^ (i0 | a));
+
+            return (interleave_with_zeros(i1) << 1u) | interleave_with_zeros(i0);
+        }
+
+        void build_range_tree(RangeTree & tree, std::vector<Box> const & item_boxes, std::vector<size_t> const & item_indices) noexcept
+        {
+            tree.boxes.clear();
+            tree.indices.clear();
+            tree.level_ends.clear();
+
+            if (item_boxes.empty())
+            {
+                return;
+            }
+
+            Box bounds{ empty_box };
+
+            for (Box const & box : item_boxes)
+            {
+                extend_box(bounds, box.min);
+                extend_box(bounds, box.max);
+            }
+
+            float const width = bounds.max.x - bounds.min.x;
+            float const height = bounds.max.y - bounds.min.y;
+            float const scale_x = width > 0.f ? 65535.f / width : 0.f;
+            float const scale_y = height > 0.f ? 65535.f / height : 0.f;
+
+            // hilbert distance of the center, position in item_boxes
+            std::vector<std::pair<uint32_t, size_t>> order(item_boxes.size());
+
+            for (size_t i = 0; i < item_boxes.size(); ++i)
+            {
+                Box const & box = item_boxes[i];
+                float const x = ((box.min.x + box.max.x) / 2.f - bounds.min.x) * scale_x;
+                float const y = ((box.min.y + box.max.y) / 2.f - bounds.min.y) * scale_y;
+
+                order[i] = { get_hilbert_distance(static_cast<uint32_t>(std::clamp(x, 0.f, 65535.f)),
+                    static_cast<uint32_t>(std::clamp(y, 0.f, 65535.f))), i };
+            }
+
+            std::sort(order.begin(), order.end());
+
+            size_t boxes_count = item_boxes.size();
+
+            for (size_t level_size = item_boxes.size(); level_size > 1;)
+            {
+                level_size = (level_size + RangeTree::node_size - 1) / RangeTree::node_size;
+                boxes_count += level_size;
+            }
+
+            tree.boxes.reserve(boxes_count);
+            tree.indices.reserve(boxes_count);
+
+            for (auto const & [distance, position] : order)
+            {
+                tree.boxes.push_back(item_boxes[position]);
+                tree.indices.push_back(item_indices[position]);
+            }
+
+            tree.level_ends.push_back(tree.boxes.size());
+
+            // every level unites the previous one until a single root is left
+            for (size_t level_begin = 0; tree.boxes.size() - level_begin > 1;)
+            {
+                size_t const level_end = tree.boxes.size();
+
+                for (size_t first_child = level_begin; first_child < level_end; first_child += RangeTree::node_size)
+                {
+                    size_t const children_end = std::min(first_child + RangeTree::node_size, level_end);
+                    Box node_box{ empty_box };
+
+                    for (size_t i = first_child; i < children_end; ++i)
+                    {
+                        extend_box(node_box, tree.boxes[i].min);
+                        extend_box(node_box, tree.boxes[i].max);
+                    }
+
+                    tree.boxes.push_back(node_box);
+                    tree.indices.push_back(first_child);
+                }
+
+                level_begin = level_end;
+                tree.level_ends.push_back(tree.boxes.size());
+            }
+        }
+
+        Box get_edge_box(DCEL const & dcel, size_t edge_index) noexcept
+        {
+            DCEL::Edge const & edge = dcel.edges[edge_index];
+
+            Box box{ empty_box };
+            extend_box(box, dcel.vertices[edge.origin_vertex].coordinate);
+            extend_box(box, dcel.vertices[dcel.edges[edge.twin_edge].origin_vertex].coordinate);
+
+            return box;
+        }
+
+        void build_range_index(RangeIndex & index, DCEL const & dcel) noexcept
+        {
+            ProfileScope const scope{ "build_range_index" };
+
+            std::vector<Box> boxes{};
+            std::vector<size_t> indices{};
+            boxes.reserve(std::max(dcel.vertices.size(), dcel.edges.size() / 2));
+            indices.reserve(boxes.capacity());
+
+            for (size_t i = 0; i < dcel.vertices.size(); ++i)
+            {
+                if (dcel.vertices[i].is_exist)
+                {
+                    Point const coordinate = dcel.vertices[i].coordinate;
+                    boxes.push_back({ coordinate, coordinate });
+                    indices.push_back(i);
+                }
+            }
+
+            build_range_tree(index.vertex_tree, boxes, indices);
+            index.items_count = boxes.size();
+
+            boxes.clear();
+            indices.clear();
+
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                if (dcel.edges[i].is_exist && i < dcel.edges[i].twin_edge)
+                {
+                    boxes.push_back(get_edge_box(dcel, i));
+                    indices.push_back(i);
+                }
+            }
+
+            build_range_tree(index.edge_tree, boxes, indices);
+            index.items_count += boxes.size();
+
+            index.changed_vertices.clear();
+            index.changed_edges.clear();
+            index.is_vertex_changed.assign(dcel.vertices.size(), 0);
+            index.is_edge_changed.assign(dcel.edges.size(), 0);
+
+            index.version = dcel.version;
+        }
+
+        void mark_range_index_edge_changed(RangeIndex & index, size_t edge_index) noexcept
+        {
+            if (index.is_edge_changed[edge_index] == 0)
+            {
+                index.is_edge_changed[edge_index] = 1;
+                index.changed_edges.push_back(edge_index);
+            }
+        }
+
+        // the edge and its twin, they share the tree item
+        void mark_range_index_edge_pair_changed(RangeIndex & index, DCEL const & dcel, size_t edge_index) noexcept
+        {
+            mark_range_index_edge_changed(index, edge_index);
+
+            size_t const twin_index = dcel.edges[edge_index].twin_edge;
+
+            if (dcel.edges[edge_index].is_exist && twin_index < dcel.edges.size())
+            {
+                mark_range_index_edge_changed(index, twin_index);
+            }
+        }
+
+        // the vertex and the edges around it, their boxes depend on its coordinate
+        void mark_range_index_vertex_changed(RangeIndex & index, DCEL const & dcel, size_t vertex_index) noexcept
+        {
+            if (index.is_vertex_changed[vertex_index] == 0)
+            {
+                index.is_vertex_changed[vertex_index] = 1;
+                index.changed_vertices.push_back(vertex_index);
+            }
+
+            DCEL::Vertex const & vertex = dcel.vertices[vertex_index];
+
+            if (!vertex.is_exist || vertex.incident_edge >= dcel.edges.size())
+            {
+                return;
+            }
+
+            size_t current_index = vertex.incident_edge;
+
+            // bounded by the edges count in case the edges around the vertex are not linked yet
+            for (size_t i = 0; i < dcel.edges.size() && dcel.edges[current_index].is_exist; ++i)
+            {
+                mark_range_index_edge_pair_changed(index, dcel, current_index);
+
+                current_index = dcel.edges[dcel.edges[current_index].twin_edge].next_edge;
+
+                if (current_index == vertex.incident_edge)
+                {
+                    break;
+                }
+            }
+        }
+
+        void update_range_index(RangeIndex & index, DCEL const & dcel) noexcept
+        {
+            if (index.version == dcel.version)
+            {
+                return;
+            }
+
+            index.changes.clear();
+
+            bool const is_changes_known = index.version != std::numeric_limits<size_t>::max() &&
+                get_changes_since(dcel, index.version, index.changes);
+
+            bool const is_single_move = !is_changes_known && index.version + 1 == dcel.version &&
+                dcel.moved_vertex != std::numeric_limits<size_t>::max();
+
+            if (!is_changes_known && !is_single_move)
+            {
+                build_range_index(index, dcel);
+                return;
+            }
+
+            if (is_single_move)
+            {
+                index.changes.push_back({ Change::Element::Vertex, Change::Kind::Modified, false, dcel.moved_vertex });
+            }
+
+            index.is_vertex_changed.resize(dcel.vertices.size(), 0);
+            index.is_edge_changed.resize(dcel.edges.size(), 0);
+
+            for (Change const & change : index.changes)
+            {
+                // changes are recorded before the elements are, so the last state is read from the dcel
+                if (change.element == Change::Element::Vertex && change.index < dcel.vertices.size())
+                {
+                    mark_range_index_vertex_changed(index, dcel, change.index);
+                }
+                else if (change.element == Change::Element::Edge && change.index < dcel.edges.size())
+                {
+                    mark_range_index_edge_pair_changed(index, dcel, change.index);
+                }
+            }
+
+            index.version = dcel.version;
+
+            if ((index.changed_vertices.size() + index.changed_edges.size()) * 16 > index.items_count)
+            {
+                build_range_index(index, dcel);
+            }
+        }
+
+        bool is_segment_intersecting_box(Point begin, Point end, Box const & box) noexcept
+        {
+            Box segment_box{ empty_box };
+            extend_box(segment_box, begin);
+            extend_box(segment_box, end);
+
+            if (!is_boxes_intersected(segment_box, box))
+            {
+                return false;
+            }
+
+            // the boxes intersect, so the segment misses the box only if all the corners are on one side of its line
+            double const dx = static_cast<double>(end.x) - begin.x;
+            double const dy = static_cast<double>(end.y) - begin.y;
+
+            auto const get_side = [&](float x, float y)
+            {
+                double const cross = dx * (static_cast<double>(y) - begin.y) - dy * (static_cast<double>(x) - begin.x);
+                return cross > 0. ? 1 : cross < 0. ? -1 : 0;
+            };
+
+            int const sides[4] = {
+                get_side(box.min.x, box.min.y),
+                get_side(box.max.x, box.min.y),
+                get_side(box.max.x, box.max.y),
+                get_side(box.min.x, box.max.y) };
+
+            return !(sides[0] == sides[1] && sides[1] == sides[2] && sides[2] == sides[3] && sides[0] != 0);
+        }
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+
+#include "dcel.h"
+#include "view_culling.h"
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+
+namespace frm
+{
+    namespace dcel
+    {
+        // Static packed R-tree: the boxes of the items sorted along the Hilbert curve of their centers
+        // are the leaves, every node_size consecutive boxes of a level are united into a box of the next one.
+        struct RangeTree
+        {
+            static constexpr size_t node_size = 16;
+            // a level of node_size^16 boxes is more than size_t can count
+            static constexpr size_t max_levels_count = 16;
+
+            // leaves first, then the levels up to the root, which is the last box
+            std::vector<Box> boxes{};
+            // item of a leaf, position of the first child of a node
+            std::vector<size_t> indices{};
+            // level i: boxes[level_ends[i - 1], level_ends[i]), level 0 are the leaves
+            std::vector<size_t> level_ends{};
+        };
+
+        // O(n log(n)), item_indices[i] is the item of item_boxes[i]
+        void build_range_tree(RangeTree & tree, std::vector<Box> const & item_boxes, std::vector<size_t> const & item_indices) noexcept;
+
+        // Calls callback(item) for every item with a box intersecting the box, O(log(n) + k) for k of them.
+        // Nodes to visit are kept on the stack, so the query allocates nothing.
+        template<typename Callback>
+        void query_range_tree(RangeTree const & tree, Box const & box, Callback && callback) noexcept
+        {
+            // the root is tested like any other node, a single item is both the root and a leaf
+            if (tree.boxes.empty() || !is_boxes_intersected(tree.boxes.back(), box))
+            {
+                return;
+            }
+
+            struct Node
+            {
+                size_t position;
+                size_t level;
+            };
+
+            // at most node_size - 1 siblings are left on every level above the current node
+            Node stack[RangeTree::max_levels_count * RangeTree::node_size];
+            size_t stack_size = 0;
+            stack[stack_size++] = { tree.boxes.size() - 1, tree.level_ends.size() - 1 };
+
+            while (stack_size != 0)
+            {
+                Node const node = stack[--stack_size];
+
+                if (node.level == 0)
+                {
+                    callback(tree.indices[node.position]);
+                    continue;
+                }
+
+                size_t const first_child = tree.indices[node.position];
+                size_t const children_end = std::min(first_child + RangeTree::node_size, tree.level_ends[node.level - 1]);
+
+                for (size_t i = first_child; i < children_end; ++i)
+                {
+                    if (is_boxes_intersected(tree.boxes[i], box))
+                    {
+                        stack[stack_size++] = { i, node.level - 1 };
+                    }
+                }
+            }
+        }
+
+        // Range trees over the vertices and the edges of a dcel, an edge is indexed once for both of its half-edges.
+        // Elements changed after the trees were built are listed apart: their tree items are skipped
+        // and they are tested one by one, until there are enough of them to rebuild the trees.
+        struct RangeIndex
+        {
+            RangeTree vertex_tree{};
+            // items are the half-edges with the smaller index in their twin pairs
+            RangeTree edge_tree{};
+
+            std::vector<size_t> changed_vertices{};
+            std::vector<size_t> changed_edges{};
+            std::vector<uint8_t> is_vertex_changed{};
+            std::vector<uint8_t> is_edge_changed{};
+
+            // vertices and edges in the trees
+            size_t items_count{ 0 };
+            size_t version{ std::numeric_limits<size_t>::max() };
+
+            // kept between updates to not allocate them again
+            std::vector<Change> changes{};
+        };
+
+        // O(n log(n)) for n vertices and edges
+        void build_range_index(RangeIndex & index, DCEL const & dcel) noexcept;
+
+        // Brings the index to the version of the dcel by the changes since index.version,
+        // O(k) for k changes known from the journal or the single vertex move, a rebuild otherwise
+        // or if the changed elements are more than a sixteenth of the items in the trees.
+        void update_range_index(RangeIndex & index, DCEL const & dcel) noexcept;
+
+        // true if the segment crosses or touches the box
+        bool is_segment_intersecting_box(Point begin, Point end, Box const & box) noexcept;
+
+        // Calls callback(vertex) for every existing vertex inside of the box,
+        // O(log(n) + k + c) for k of them and c changed vertices, the index has to be updated.
+        template<typename Callback>
+        void query_vertices(RangeIndex const & index, DCEL const & dcel, Box const & box, Callback && callback) noexcept
+        {
+            query_range_tree(index.vertex_tree, box, [&](size_t vertex_index)
+            {
+                if (index.is_vertex_changed[vertex_index] == 0)
+                {
+                    callback(vertex_index);
+                }
+            });
+
+            for (size_t const vertex_index : index.changed_vertices)
+            {
+                DCEL::Vertex const & vertex = dcel.vertices[vertex_index];
+
+                if (vertex.is_exist && is_point_in_box(box, vertex.coordinate))
+                {
+                    callback(vertex_index);
+                }
+            }
+        }
+
+        // Calls callback(edge) for every existing edge crossing the box, one half-edge of every twin pair,
+        // O(log(n) + k + c) for k edges with bounding boxes intersecting the box and c changed edges,
+        // the index has to be updated.
+        template<typename Callback>
+        void query_edges(RangeIndex const & index, DCEL const & dcel, Box const & box, Callback && callback) noexcept
+        {
+            auto const is_edge_in_box = [&](size_t edge_index)
+            {
+                DCEL::Edge const & edge = dcel.edges[edge_index];
+
+                return is_segment_intersecting_box(dcel.vertices[edge.origin_vertex].coordinate,
+                    dcel.vertices[dcel.edges[edge.twin_edge].origin_vertex].coordinate,
+                    box);
+            };
+
+            query_range_tree(index.edge_tree, box, [&](size_t edge_index)
+            {
+                if (index.is_edge_changed[edge_index] == 0 && is_edge_in_box(edge_index))
+                {
+                    callback(edge_index);
+                }
+            });
+
+            for (size_t const edge_index : index.changed_edges)
+            {
+                DCEL::Edge const & edge = dcel.edges[edge_index];
+
+                if (edge.is_exist && edge_index < edge.twin_edge && is_edge_in_box(edge_index))
+                {
+                    callback(edge_index);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,921 @@
+#include "segment_intersections.h"
+
+#include "predicates.h"
+#include "profiler.h"
+
+#include <set>
+#include <queue>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace frm
+{
+    static constexpr size_t no_segment = std::numeric_limits<size_t>::max();
+
+    // Segment directed from its lexicographically (x, then y) smaller end.
+    // The sweep line goes in the same order, as if the plane was slightly sheared,
+    // so vertical segments go up and need no special cases.
+    struct SweepSegment
+    {
+        Point left;
+        Point right;
+        size_t left_vertex;
+        size_t right_vertex;
+        // segment of the input
+        size_t index;
+        // the input segment goes from right to left
+        bool is_reversed;
+    };
+
+    // crossing point before it is rounded
+    struct SweepPoint
+    {
+        double x;
+        double y;
+    };
+
+    struct CrossingEvent
+    {
+        SweepPoint point;
+        size_t lower_segment;
+        size_t upper_segment;
+    };
+
+    struct EndEvent
+    {
+        Point point;
+        size_t segment;
+    };
+
+    // Segment of the sweep line status. Neighbors swap their segments in place at their crossing,
+    // as the order of the entries stays the same.
+    struct StatusEntry
+    {
+        mutable size_t segment;
+    };
+
+    bool is_sweep_point_less(SweepPoint first, SweepPoint second) noexcept
+    {
+        return first.x < second.x || (first.x == second.x && first.y < second.y);
+    }
+
+    bool is_end_point_less(Point first, Point second) noexcept
+    {
+        return first.x < second.x || (first.x == second.x && first.y < second.y);
+    }
+
+    bool is_end_point_equal(Point first, Point second) noexcept
+    {
+        return first.x == second.x && first.y == second.y;
+    }
+
+    struct CrossingEventGreater
+    {
+        bool operator()(CrossingEvent const & first, CrossingEvent const & second) const noexcept
+        {
+            return is_sweep_point_less(second.point, first.point);
+        }
+    };
+
+    // Order of the segments from bottom to top right after the current end point,
+    // entries are compared only when at least one of them goes through the point.
+    // The transparent overloads find the segments under, through and over the point.
+    struct StatusLess
+    {
+        using is_transparent = void;
+
+        std::vector<SweepSegment> const * segments;
+        Point const * point;
+
+        bool operator()(StatusEntry const & first, StatusEntry const & second) const noexcept
+        {
+            SweepSegment const & first_segment = (*segments)[first.segment];
+            SweepSegment const & second_segment = (*segments)[second.segment];
+
+            int const first_side = get_orientation(first_segment.left, first_segment.right, *point);
+            int const second_side = get_orientation(second_segment.left, second_segment.right, *point);
+
+            if (first_side == 0 && second_side == 0)
+            {
+                // both go through the point, the one turned clockwise is lower
+                int const turn = get_orientation(*point, first_segment.right, second_segment.right);
+                if (turn != 0)
+                {
+                    return turn > 0;
+                }
+
+                // overlapping
+                return first.segment < second.segment;
+            }
+            if (first_side == 0)
+            {
+                return second_side < 0;
+            }
+            if (second_side == 0)
+            {
+                return first_side > 0;
+            }
+
+            return first.segment < second.segment;
+        }
+
+        // the point is over the segment
+        bool operator()(StatusEntry const & entry, Point point) const noexcept
+        {
+            SweepSegment const & segment = (*segments)[entry.segment];
+            return get_orientation(segment.left, segment.right, point) > 0;
+        }
+
+        // the point is under the segment
+        bool operator()(Point point, StatusEntry const & entry) const noexcept
+        {
+            SweepSegment const & segment = (*segments)[entry.segment];
+            return get_orientation(segment.left, segment.right, point) < 0;
+        }
+    };
+
+    // true if second is before third counterclockwise around center, starting from the direction of the x axis
+    bool is_angle_less(Point center, Point second, Point third) noexcept
+    {
+        bool const is_second_lower = second.y < center.y || (second.y == center.y && second.x < center.x);
+        bool const is_third_lower = third.y < center.y || (third.y == center.y && third.x < center.x);
+
+        if (is_second_lower != is_third_lower)
+        {
+            return is_third_lower;
+        }
+
+        return get_orientation(center, second, third) > 0;
+    }
+
+    // lower is right under upper now and will be over it at the nearer right end, so they cross ahead
+    bool is_crossing_ahead(SweepSegment const & lower, SweepSegment const & upper) noexcept
+    {
+        if (!is_end_point_less(upper.right, lower.right))
+        {
+            return get_orientation(upper.left, upper.right, lower.right) > 0;
+        }
+
+        return get_orientation(lower.left, lower.right, upper.right) < 0;
+    }
+
+    SweepPoint get_crossing_point(SweepSegment const & first, SweepSegment const & second) noexcept
+    {
+        double const first_dx = static_cast<double>(first.right.x) - first.left.x;
+        double const first_dy = static_cast<double>(first.right.y) - first.left.y;
+        double const second_dx = static_cast<double>(second.right.x) - second.left.x;
+        double const second_dy = static_cast<double>(second.right.y) - second.left.y;
+
+        double const denominator = first_dx * second_dy - first_dy * second_dx;
+        if (denominator == 0.)
+        {
+            return { first.left.x, first.left.y };
+        }
+
+        double const dx = static_cast<double>(second.left.x) - first.left.x;
+        double const dy = static_cast<double>(second.left.y) - first.left.y;
+        double const t = std::clamp((dx * second_dy - dy * second_dx) / denominator, 0., 1.);
+
+        return { first.left.x + t * first_dx, first.left.y + t * first_dy };
+    }
+
+    void add_sweep_segment(std::vector<SweepSegment> & segments, Point begin, Point end, size_t begin_vertex, size_t end_vertex, size_t index) noexcept
+    {
+        if (is_end_point_equal(begin, end))
+        {
+            return;
+        }
+
+        if (is_end_point_less(begin, end))
+        {
+            segments.push_back({ begin, end, begin_vertex, end_vertex, index, false });
+        }
+        else
+        {
+            segments.push_back({ end, begin, end_vertex, begin_vertex, index, true });
+        }
+    }
+
+    struct SweepResult
+    {
+        // segments are the indices of the sweep segments, a pair can be listed more than once
+        std::vector<SegmentIntersection> intersections{};
+        // intersection points inside of the segments, collected only to build a subdivision
+        std::vector<std::pair<size_t, Point>> split_points{};
+        // segment right under every end point, no_segment if there is none, found only to build a subdivision
+        std::vector<size_t> segments_under_vertices{};
+    };
+
+    // Pairs of segments meeting at an end point: all of them but the ones with this end point in common,
+    // which meet elsewhere only if they go the same way.
+    void add_end_point_intersections(std::vector<SweepSegment> const & segments,
+        Point point,
+        std::vector<std::pair<size_t, size_t>> & vertex_segments,
+        std::vector<SegmentIntersection> & intersections) noexcept
+    {
+        auto const get_far_end = [&segments, point](size_t segment) noexcept
+            {
+                return is_end_point_equal(segments[segment].left, point) ? segments[segment].right : segments[segment].left;
+            };
+
+        std::sort(vertex_segments.begin(), vertex_segments.end(), [&get_far_end, point](std::pair<size_t, size_t> const & first, std::pair<size_t, size_t> const & second) noexcept
+            {
+                if (first.first != second.first)
+                {
+                    return first.first < second.first;
+                }
+                return is_angle_less(point, get_far_end(first.second), get_far_end(second.second));
+            });
+
+        for (size_t i = 0; i < vertex_segments.size(); ++i)
+        {
+            size_t const vertex = vertex_segments[i].first;
+            size_t const segment = vertex_segments[i].second;
+
+            size_t j = i + 1;
+            // overlapping segments of the same vertex go in a row
+            for (; j < vertex_segments.size() && vertex_segments[j].first == vertex; ++j)
+            {
+                Point const far_end = get_far_end(segment);
+                Point const other_far_end = get_far_end(vertex_segments[j].second);
+
+                if (is_angle_less(point, far_end, other_far_end) || is_angle_less(point, other_far_end, far_end))
+                {
+                    break;
+                }
+
+                intersections.push_back({ segment, vertex_segments[j].second, point });
+            }
+
+            while (j < vertex_segments.size() && vertex_segments[j].first == vertex)
+            {
+                ++j;
+            }
+
+            for (; j < vertex_segments.size(); ++j)
+            {
+                intersections.push_back({ segment, vertex_segments[j].second, point });
+            }
+        }
+    }
+
+    SweepResult sweep_segments(std::vector<SweepSegment> const & segments, size_t vertices_count, bool is_building) noexcept
+    {
+        SweepResult result{};
+        if (is_building)
+        {
+            result.segments_under_vertices.assign(vertices_count, no_segment);
+        }
+
+        std::vector<EndEvent> end_events{};
+        end_events.reserve(2 * segments.size());
+        for (size_t i = 0; i < segments.size(); ++i)
+        {
+            end_events.push_back({ segments[i].left, i });
+            end_events.push_back({ segments[i].right, i });
+        }
+        std::sort(end_events.begin(), end_events.end(), [](EndEvent const & first, EndEvent const & second) noexcept
+            {
+                return is_end_point_less(first.point, second.point);
+            });
+
+        // end point of the current event, the status is ordered right after it
+        Point point{};
+        // crossings found behind the sweep because of rounding are moved to it
+        SweepPoint sweep_point{ -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+
+        using Status = std::set<StatusEntry, StatusLess>;
+        Status status{ StatusLess{ &segments, &point } };
+        std::vector<Status::iterator> positions(segments.size(), status.end());
+        std::vector<uint8_t> is_in_status(segments.size(), 0);
+
+        std::priority_queue<CrossingEvent, std::vector<CrossingEvent>, CrossingEventGreater> crossings{};
+
+        auto const add_crossing = [&segments, &sweep_point, &crossings](Status::iterator lower, Status::iterator upper) noexcept
+            {
+                if (!is_crossing_ahead(segments[lower->segment], segments[upper->segment]))
+                {
+                    return;
+                }
+
+                SweepPoint crossing = get_crossing_point(segments[lower->segment], segments[upper->segment]);
+                if (is_sweep_point_less(crossing, sweep_point))
+                {
+                    crossing = sweep_point;
+                }
+
+                crossings.push({ crossing, lower->segment, upper->segment });
+            };
+
+        std::vector<size_t> through{};
+        std::vector<std::pair<size_t, size_t>> vertex_segments{};
+
+        size_t next_end_event = 0;
+        while (next_end_event < end_events.size() || !crossings.empty())
+        {
+            // an end point goes before the crossings at it, it reorders the segments through it anyway
+            if (!crossings.empty() && (next_end_event == end_events.size() ||
+                is_sweep_point_less(crossings.top().point, { end_events[next_end_event].point.x, end_events[next_end_event].point.y })))
+            {
+                CrossingEvent const crossing = crossings.top();
+                crossings.pop();
+
+                if (!is_in_status[crossing.lower_segment] || !is_in_status[crossing.upper_segment])
+                {
+                    continue;
+                }
+
+                Status::iterator const lower = positions[crossing.lower_segment];
+                Status::iterator const upper = std::next(lower);
+
+                // the pair is not neighbors anymore or has already been swapped
+                if (upper == status.end() || upper->segment != crossing.upper_segment ||
+                    !is_crossing_ahead(segments[crossing.lower_segment], segments[crossing.upper_segment]))
+                {
+                    continue;
+                }
+
+                sweep_point = crossing.point;
+                Point const crossing_point{ static_cast<float>(crossing.point.x), static_cast<float>(crossing.point.y) };
+
+                result.intersections.push_back({ crossing.lower_segment, crossing.upper_segment, crossing_point });
+                if (is_building)
+                {
+                    result.split_points.push_back({ crossing.lower_segment, crossing_point });
+                    result.split_points.push_back({ crossing.upper_segment, crossing_point });
+                }
+
+                lower->segment = crossing.upper_segment;
+                upper->segment = crossing.lower_segment;
+                positions[crossing.upper_segment] = lower;
+                positions[crossing.lower_segment] = upper;
+
+                if (lower != status.begin())
+                {
+                    add_crossing(std::prev(lower), lower);
+                }
+                if (std::next(upper) != status.end())
+                {
+                    add_crossing(upper, std::next(upper));
+                }
+
+                continue;
+            }
+
+            point = end_events[next_end_event].point;
+            sweep_point = { point.x, point.y };
+
+            size_t const events_begin = next_end_event;
+            while (next_end_event < end_events.size() && is_end_point_equal(end_events[next_end_event].point, point))
+            {
+                ++next_end_event;
+            }
+
+            // segments ending here, then the ones going through, then the ones starting here
+            vertex_segments.clear();
+            for (size_t i = events_begin; i < next_end_event; ++i)
+            {
+                size_t const segment = end_events[i].segment;
+                if (is_end_point_equal(segments[segment].right, point))
+                {
+                    vertex_segments.push_back({ segments[segment].right_vertex, segment });
+
+                    status.erase(positions[segment]);
+                    is_in_status[segment] = 0;
+                }
+            }
+
+            Status::iterator const through_begin = status.lower_bound(point);
+            Status::iterator const through_end = status.upper_bound(point);
+
+            through.clear();
+            for (Status::iterator i = through_begin; i != through_end; ++i)
+            {
+                through.push_back(i->segment);
+                is_in_status[i->segment] = 0;
+            }
+            status.erase(through_begin, through_end);
+
+            size_t const ending_count = vertex_segments.size();
+            for (size_t i = events_begin; i < next_end_event; ++i)
+            {
+                size_t const segment = end_events[i].segment;
+                if (is_end_point_equal(segments[segment].left, point))
+                {
+                    vertex_segments.push_back({ segments[segment].left_vertex, segment });
+                }
+            }
+
+            // the point is inside of the segments through it, so they intersect everything here
+            for (size_t i = 0; i < through.size(); ++i)
+            {
+                for (size_t j = i + 1; j < through.size(); ++j)
+                {
+                    result.intersections.push_back({ through[i], through[j], point });
+                }
+                for (std::pair<size_t, size_t> const & vertex_segment : vertex_segments)
+                {
+                    result.intersections.push_back({ through[i], vertex_segment.second, point });
+                }
+
+                if (is_building)
+                {
+                    result.split_points.push_back({ through[i], point });
+                }
+            }
+
+            // the segments under the point are the same for every one of its vertices
+            Status::iterator inserted_begin = through_end;
+            Status::iterator inserted_end = through_end;
+
+            for (size_t i = ending_count; i < vertex_segments.size(); ++i)
+            {
+                through.push_back(vertex_segments[i].second);
+            }
+            std::sort(through.begin(), through.end(), [&status](size_t first, size_t second) noexcept
+                {
+                    return status.key_comp()(StatusEntry{ first }, StatusEntry{ second });
+                });
+
+            for (size_t i = 0; i < through.size(); ++i)
+            {
+                Status::iterator const position = status.insert(through_end, StatusEntry{ through[i] });
+                positions[through[i]] = position;
+                is_in_status[through[i]] = 1;
+
+                if (i == 0)
+                {
+                    inserted_begin = position;
+                }
+            }
+
+            if (is_building)
+            {
+                size_t const under = inserted_begin == status.begin() ? no_segment : std::prev(inserted_begin)->segment;
+                for (std::pair<size_t, size_t> const & vertex_segment : vertex_segments)
+                {
+                    result.segments_under_vertices[vertex_segment.first] = under;
+                }
+            }
+
+            add_end_point_intersections(segments, point, vertex_segments, result.intersections);
+
+            if (inserted_begin != status.begin() && inserted_begin != status.end())
+            {
+                add_crossing(std::prev(inserted_begin), inserted_begin);
+            }
+            if (!through.empty() && inserted_end != status.end())
+            {
+                add_crossing(std::prev(inserted_end), inserted_end);
+            }
+        }
+
+        return result;
+    }
+
+    // pairs of the input segments, each once
+    std::vector<SegmentIntersection> get_input_intersections(std::vector<SweepSegment> const & segments, SweepResult const & sweep) noexcept
+    {
+        std::vector<SegmentIntersection> intersections{};
+        intersections.reserve(sweep.intersections.size());
+
+        for (SegmentIntersection const & intersection : sweep.intersections)
+        {
+            size_t const first = segments[intersection.first_segment].index;
+            size_t const second = segments[intersection.second_segment].index;
+
+            intersections.push_back({ std::min(first, second), std::max(first, second), intersection.point });
+        }
+
+        auto const is_pair_less = [](SegmentIntersection const & first, SegmentIntersection const & second) noexcept
+            {
+                return first.first_segment < second.first_segment ||
+                    (first.first_segment == second.first_segment && first.second_segment < second.second_segment);
+            };
+        std::stable_sort(intersections.begin(), intersections.end(), is_pair_less);
+
+        intersections.erase(std::unique(intersections.begin(), intersections.end(), [](SegmentIntersection const & first, SegmentIntersection const & second) noexcept
+            {
+                return first.first_segment == second.first_segment && first.second_segment == second.second_segment;
+            }), intersections.end());
+
+        return intersections;
+    }
+
+    std::vector<SegmentIntersection> find_segment_intersections(std::vector<Point> const & points,
+        std::vector<std::pair<size_t, size_t>> const & segments) noexcept
+    {
+        ProfileScope const scope{ "find_segment_intersections" };
+
+        std::vector<SweepSegment> sweep_segments_list{};
+        sweep_segments_list.reserve(segments.size());
+        for (size_t i = 0; i < segments.size(); ++i)
+        {
+            add_sweep_segment(sweep_segments_list, points[segments[i].first], points[segments[i].second], segments[i].first, segments[i].second, i);
+        }
+
+        return get_input_intersections(sweep_segments_list, sweep_segments(sweep_segments_list, points.size(), false));
+    }
+
+    namespace vvve
+    {
+        std::vector<SegmentIntersection> find_intersections(VVVE const & vvve) noexcept
+        {
+            std::vector<Point> points(vvve.vertices.size());
+            for (size_t i = 0; i < vvve.vertices.size(); ++i)
+            {
+                points[i] = vvve.vertices[i].coordinate;
+            }
+
+            return find_segment_intersections(points, vvve.edges);
+        }
+    }
+
+    namespace dcel
+    {
+        static constexpr size_t no_index = std::numeric_limits<size_t>::max();
+
+        // +0.f turns -0.f into 0.f, so equal coordinates get equal keys
+        uint64_t get_point_key(Point point) noexcept
+        {
+            float const x = point.x + 0.f;
+            float const y = point.y + 0.f;
+
+            uint32_t x_bits{};
+            uint32_t y_bits{};
+            std::memcpy(&x_bits, &x, sizeof(x_bits));
+            std::memcpy(&y_bits, &y, sizeof(y_bits));
+
+            return static_cast<uint64_t>(x_bits) << 32 | y_bits;
+        }
+
+        // Planar subdivision of the segments split at the intersection points of the sweep.
+        // Edges around every vertex are linked in angular order, then every cycle of edges
+        // that goes counterclockwise bounds a new face. A clockwise cycle is the outer boundary
+        // of a connected component, it gets the face over the segment right under its leftmost vertex.
+        Arrangement build_subdivision(std::vector<Point> const & points, std::vector<SweepSegment> const & segments, SweepResult const & sweep) noexcept
+        {
+            Arrangement arrangement{};
+            DCEL & dcel = arrangement.dcel;
+
+            dcel.vertices.reserve(points.size() + sweep.split_points.size() / 2);
+            std::unordered_map<uint64_t, size_t> point_vertices{};
+            point_vertices.reserve(points.size() + sweep.split_points.size() / 2);
+            auto const get_vertex = [&dcel, &point_vertices](Point point) noexcept
+                {
+                    auto const [vertex, is_inserted] = point_vertices.try_emplace(get_point_key(point), dcel.vertices.size());
+                    if (is_inserted)
+                    {
+                        dcel.vertices.push_back({ point, no_index });
+                    }
+                    return vertex->second;
+                };
+
+            std::vector<size_t> vertices_of_points(points.size());
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                vertices_of_points[i] = get_vertex(points[i]);
+            }
+
+            // vertices along every segment from its left end: chains[chain_offsets[i], chain_offsets[i + 1])
+            std::vector<std::pair<size_t, Point>> split_points{ sweep.split_points };
+            std::sort(split_points.begin(), split_points.end(), [](std::pair<size_t, Point> const & first, std::pair<size_t, Point> const & second) noexcept
+                {
+                    return first.first < second.first || (first.first == second.first && is_end_point_less(first.second, second.second));
+                });
+
+            std::vector<size_t> chain_offsets(segments.size() + 1, 0);
+            std::vector<size_t> chains{};
+            chains.reserve(2 * segments.size() + split_points.size());
+
+            size_t split_point = 0;
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                chain_offsets[i] = chains.size();
+                chains.push_back(vertices_of_points[segments[i].left_vertex]);
+
+                for (; split_point < split_points.size() && split_points[split_point].first == i; ++split_point)
+                {
+                    size_t const vertex = get_vertex(split_points[split_point].second);
+                    if (vertex != chains.back())
+                    {
+                        chains.push_back(vertex);
+                    }
+                }
+
+                size_t const right_vertex = vertices_of_points[segments[i].right_vertex];
+                if (right_vertex != chains.back())
+                {
+                    chains.push_back(right_vertex);
+                }
+            }
+            chain_offsets[segments.size()] = chains.size();
+
+            // pieces of the chains, overlapping segments share them
+            uint64_t const vertices_count = dcel.vertices.size();
+            std::unordered_map<uint64_t, size_t> piece_edges{};
+            piece_edges.reserve(chains.size());
+            arrangement.segment_edges.reserve(chains.size());
+            dcel.edges.reserve(2 * chains.size());
+
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                for (size_t j = chain_offsets[i]; j + 1 < chain_offsets[i + 1]; ++j)
+                {
+                    uint64_t const begin = chains[j];
+                    uint64_t const end = chains[j + 1];
+
+                    auto const [edge, is_inserted] = piece_edges.try_emplace(std::min(begin, end) * vertices_count + std::max(begin, end), dcel.edges.size());
+                    if (is_inserted)
+                    {
+                        size_t const index = dcel.edges.size();
+                        dcel.edges.push_back({ chains[j], index + 1, no_index, no_index, no_index });
+                        dcel.edges.push_back({ chains[j + 1], index, no_index, no_index, no_index });
+                    }
+
+                    // pieces go from left to right as the chains do
+                    arrangement.segment_edges.push_back({ segments[i].is_reversed ? edge->second + 1 : edge->second, segments[i].index });
+                }
+            }
+
+            // outgoing edges of every vertex counterclockwise: outgoing[outgoing_offsets[i], outgoing_offsets[i + 1])
+            std::vector<size_t> outgoing_offsets(dcel.vertices.size() + 1, 0);
+            for (DCEL::Edge const & edge : dcel.edges)
+            {
+                ++outgoing_offsets[edge.origin_vertex + 1];
+            }
+            for (size_t i = 1; i < outgoing_offsets.size(); ++i)
+            {
+                outgoing_offsets[i] += outgoing_offsets[i - 1];
+            }
+
+            std::vector<size_t> outgoing(dcel.edges.size());
+            {
+                std::vector<size_t> next_positions(outgoing_offsets.begin(), outgoing_offsets.end() - 1);
+                for (size_t i = 0; i < dcel.edges.size(); ++i)
+                {
+                    outgoing[next_positions[dcel.edges[i].origin_vertex]++] = i;
+                }
+            }
+
+            std::vector<size_t> outgoing_positions(dcel.edges.size());
+            for (size_t i = 0; i < dcel.vertices.size(); ++i)
+            {
+                Point const center = dcel.vertices[i].coordinate;
+
+                std::sort(outgoing.begin() + outgoing_offsets[i], outgoing.begin() + outgoing_offsets[i + 1], [&dcel, center](size_t first, size_t second) noexcept
+                    {
+                        return is_angle_less(center,
+                            dcel.vertices[dcel.edges[dcel.edges[first].twin_edge].origin_vertex].coordinate,
+                            dcel.vertices[dcel.edges[dcel.edges[second].twin_edge].origin_vertex].coordinate);
+                    });
+
+                for (size_t j = outgoing_offsets[i]; j < outgoing_offsets[i + 1]; ++j)
+                {
+                    outgoing_positions[outgoing[j]] = j;
+                }
+
+                if (outgoing_offsets[i] < outgoing_offsets[i + 1])
+                {
+                    dcel.vertices[i].incident_edge = outgoing[outgoing_offsets[i]];
+                }
+            }
+
+            // the face on the left of an edge goes on along the edge next to its twin clockwise
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                size_t const twin = dcel.edges[i].twin_edge;
+                size_t const vertex = dcel.edges[twin].origin_vertex;
+                size_t const first = outgoing_offsets[vertex];
+                size_t const count = outgoing_offsets[vertex + 1] - first;
+
+                size_t const next = outgoing[first + (outgoing_positions[twin] - first + count - 1) % count];
+
+                dcel.edges[i].next_edge = next;
+                dcel.edges[next].previous_edge = i;
+            }
+
+            std::vector<size_t> edge_cycles(dcel.edges.size(), no_index);
+            std::vector<size_t> cycle_edges{};
+            std::vector<size_t> cycle_leftmost_vertices{};
+
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                if (edge_cycles[i] != no_index)
+                {
+                    continue;
+                }
+
+                size_t const cycle = cycle_edges.size();
+                size_t leftmost_vertex = dcel.edges[i].origin_vertex;
+
+                size_t edge = i;
+                do
+                {
+                    edge_cycles[edge] = cycle;
+
+                    size_t const vertex = dcel.edges[edge].origin_vertex;
+                    if (is_end_point_less(dcel.vertices[vertex].coordinate, dcel.vertices[leftmost_vertex].coordinate))
+                    {
+                        leftmost_vertex = vertex;
+                    }
+
+                    edge = dcel.edges[edge].next_edge;
+                } while (edge != i);
+
+                cycle_edges.push_back(i);
+                cycle_leftmost_vertices.push_back(leftmost_vertex);
+            }
+
+            // the face of a clockwise cycle is around its leftmost vertex,
+            // the cycle may pass the vertex more than once, one of the passes turns clockwise
+            std::vector<uint8_t> is_cycle_clockwise(cycle_edges.size(), 0);
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                size_t const cycle = edge_cycles[i];
+                size_t const vertex = dcel.edges[i].origin_vertex;
+
+                if (vertex != cycle_leftmost_vertices[cycle])
+                {
+                    continue;
+                }
+
+                size_t const previous_vertex = dcel.edges[dcel.edges[i].previous_edge].origin_vertex;
+                size_t const next_vertex = dcel.edges[dcel.edges[i].twin_edge].origin_vertex;
+
+                if (previous_vertex == next_vertex ||
+                    get_orientation(dcel.vertices[vertex].coordinate, dcel.vertices[next_vertex].coordinate, dcel.vertices[previous_vertex].coordinate) < 0)
+                {
+                    is_cycle_clockwise[cycle] = 1;
+                }
+            }
+
+            dcel.faces.push_back({ no_index });
+
+            std::vector<size_t> cycle_faces(cycle_edges.size(), no_index);
+            std::vector<size_t> clockwise_cycles{};
+            for (size_t i = 0; i < cycle_edges.size(); ++i)
+            {
+                if (is_cycle_clockwise[i])
+                {
+                    clockwise_cycles.push_back(i);
+                }
+                else
+                {
+                    cycle_faces[i] = dcel.faces.size();
+                    dcel.faces.push_back({ cycle_edges[i] });
+                }
+            }
+
+            std::vector<size_t> vertex_under_segments(dcel.vertices.size(), no_segment);
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                if (sweep.segments_under_vertices[i] != no_segment)
+                {
+                    vertex_under_segments[vertices_of_points[i]] = sweep.segments_under_vertices[i];
+                }
+            }
+
+            // a component lies in the face of a component with the leftmost vertex before its own
+            std::sort(clockwise_cycles.begin(), clockwise_cycles.end(), [&dcel, &cycle_leftmost_vertices](size_t first, size_t second) noexcept
+                {
+                    return is_end_point_less(dcel.vertices[cycle_leftmost_vertices[first]].coordinate, dcel.vertices[cycle_leftmost_vertices[second]].coordinate);
+                });
+
+            for (size_t const cycle : clockwise_cycles)
+            {
+                size_t const vertex = cycle_leftmost_vertices[cycle];
+                size_t const under = vertex_under_segments[vertex];
+                size_t face = 0;
+
+                if (under != no_segment)
+                {
+                    Point const coordinate = dcel.vertices[vertex].coordinate;
+
+                    // piece of the segment under the vertex, from the last chain vertex before it
+                    auto const chain_begin = chains.begin() + chain_offsets[under];
+                    auto const chain_end = chains.begin() + chain_offsets[under + 1];
+                    auto piece_end = std::partition_point(chain_begin + 1, chain_end - 1, [&dcel, coordinate](size_t chain_vertex) noexcept
+                        {
+                            return is_end_point_less(dcel.vertices[chain_vertex].coordinate, coordinate);
+                        });
+
+                    uint64_t const begin = *(piece_end - 1);
+                    uint64_t const end = *piece_end;
+                    size_t edge = piece_edges[std::min(begin, end) * vertices_count + std::max(begin, end)];
+
+                    // edge to the right has its face over it
+                    if (dcel.edges[edge].origin_vertex != begin)
+                    {
+                        edge = dcel.edges[edge].twin_edge;
+                    }
+
+                    face = cycle_faces[edge_cycles[edge]] == no_index ? 0 : cycle_faces[edge_cycles[edge]];
+                }
+
+                cycle_faces[cycle] = face;
+                if (dcel.faces[face].edge == no_index)
+                {
+                    dcel.faces[face].edge = cycle_edges[cycle];
+                }
+            }
+
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                dcel.edges[i].incident_face = cycle_faces[edge_cycles[i]];
+            }
+
+            return arrangement;
+        }
+
+        Arrangement build_arrangement(std::vector<Point> const & points, std::vector<std::pair<size_t, size_t>> const & segments) noexcept
+        {
+            ProfileScope const scope{ "dcel::build_arrangement" };
+
+            std::vector<SweepSegment> sweep_segments_list{};
+            sweep_segments_list.reserve(segments.size());
+            for (size_t i = 0; i < segments.size(); ++i)
+            {
+                add_sweep_segment(sweep_segments_list, points[segments[i].first], points[segments[i].second], segments[i].first, segments[i].second, i);
+            }
+
+            return build_subdivision(points, sweep_segments_list, sweep_segments(sweep_segments_list, points.size(), true));
+        }
+
+        // existing edges with index less than the index of the twin, points are the existing vertices
+        std::vector<SweepSegment> get_sweep_segments(DCEL const & dcel, std::vector<Point> & points, std::vector<size_t> & vertex_points) noexcept
+        {
+            vertex_points.assign(dcel.vertices.size(), no_index);
+            for (size_t i = 0; i < dcel.vertices.size(); ++i)
+            {
+                if (dcel.vertices[i].is_exist)
+                {
+                    vertex_points[i] = points.size();
+                    points.push_back(dcel.vertices[i].coordinate);
+                }
+            }
+
+            std::vector<SweepSegment> segments{};
+            segments.reserve(dcel.edges.size() / 2);
+
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
+            {
+                DCEL::Edge const & edge = dcel.edges[i];
+                if (!edge.is_exist || edge.twin_edge < i)
+                {
+                    continue;
+                }
+
+                size_t const begin = vertex_points[edge.origin_vertex];
+                size_t const end = vertex_points[dcel.edges[edge.twin_edge].origin_vertex];
+
+                add_sweep_segment(segments, points[begin], points[end], begin, end, i);
+            }
+
+            return segments;
+        }
+
+        std::vector<SegmentIntersection> find_intersections(DCEL const & dcel) noexcept
+        {
+            ProfileScope const scope{ "dcel::find_intersections" };
+
+            std::vector<Point> points{};
+            std::vector<size_t> vertex_points{};
+            std::vector<SweepSegment> const segments = get_sweep_segments(dcel, points, vertex_points);
+
+            return get_input_intersections(segments, sweep_segments(segments, points.size(), false));
+        }
+
+        std::vector<SegmentIntersection> split_at_intersections(DCEL & dcel) noexcept
+        {
+            ProfileScope const scope{ "dcel::split_at_intersections" };
+
+            std::vector<Point> points{};
+            std::vector<size_t> vertex_points{};
+            std::vector<SweepSegment> const segments = get_sweep_segments(dcel, points, vertex_points);
+
+            SweepResult const sweep = sweep_segments(segments, points.size(), true);
+            if (sweep.intersections.empty())
+            {
+                return {};
+            }
+
+            DCEL subdivision = build_subdivision(points, segments, sweep).dcel;
+
+            dcel.vertices = std::move(subdivision.vertices);
+            dcel.faces = std::move(subdivision.faces);
+            dcel.edges = std::move(subdivision.edges);
+            dcel.free_vertices.clear();
+            dcel.free_faces.clear();
+            dcel.free_edges.clear();
+
+            mark_changed(dcel);
+
+            return get_input_intersections(segments, sweep);
+        }
+    }
+}
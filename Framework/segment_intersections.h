@@ -0,0 +1,68 @@
+#pragma once
+
+
+#include "common.h"
+#include "vvve.h"
+#include "dcel.h"
+
+#include <vector>
+#include <utility>
+
+
+namespace frm
+{
+    struct SegmentIntersection
+    {
+        // first_segment < second_segment
+        size_t first_segment;
+        size_t second_segment;
+        // crossing point rounded to float, for touching or overlapping segments one of the common points
+        Point point;
+    };
+
+    // Bentley-Ottmann sweep, O((n + k)log(n)) for n segments with k intersecting pairs.
+    // Segments are pairs of indices of points. Segments with a common end point touch only there,
+    // any other common point is an intersection: crossings, touches and overlaps are reported once per pair.
+    // Predicates are exact, only the reported crossing points are rounded. Zero length segments are skipped.
+    // Sorted by first_segment, then second_segment.
+    std::vector<SegmentIntersection> find_segment_intersections(std::vector<Point> const & points,
+        std::vector<std::pair<size_t, size_t>> const & segments) noexcept;
+
+    namespace vvve
+    {
+        // segments are the edges
+        std::vector<SegmentIntersection> find_intersections(VVVE const & vvve) noexcept;
+    }
+
+    namespace dcel
+    {
+        // segments are the existing edges with index less than the index of the twin
+        std::vector<SegmentIntersection> find_intersections(DCEL const & dcel) noexcept;
+
+        struct SegmentEdge
+        {
+            // half-edge of the subdivision going the same way as the segment
+            size_t edge;
+            size_t segment;
+        };
+
+        struct Arrangement
+        {
+            DCEL dcel;
+            // every piece of every segment, a piece shared by overlapping segments is listed for each of them
+            std::vector<SegmentEdge> segment_edges;
+        };
+
+        // Planar subdivision of the segments split at all their intersection points, built as split_at_intersections does.
+        // Vertices of the points come first in their order, edges 2i and 2i + 1 are twins.
+        Arrangement build_arrangement(std::vector<Point> const & points, std::vector<std::pair<size_t, size_t>> const & segments) noexcept;
+
+        // If some edges intersect, rebuilds the dcel from its edges split at all the intersection points,
+        // so it becomes planar, otherwise leaves it as it is.
+        // Vertices with equal coordinates are merged, existing vertices come first in their order,
+        // then the intersection points. Edges and faces are renumbered, face 0 is the outside face.
+        // Intersection points are rounded to float, which may leave new crossings near them in rare cases.
+        // Returns the intersections of the edges before the split.
+        std::vector<SegmentIntersection> split_at_intersections(DCEL & dcel) noexcept;
+    }
+}
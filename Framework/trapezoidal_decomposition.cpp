@@ -1,6 +1,9 @@
 #include "trapezoidal_decomposition.h"
 
-#include <set>
+#include "predicates.h"
+#include "profiler.h"
+#include "counters.h"
+
 #include <cassert>
 #include <algorithm>
 #include <random>
@@ -43,12 +46,40 @@ namespace frm
         }
     }
 
+    static constexpr size_t no_trapezoid = std::numeric_limits<size_t>::max();
+
+    // Ends are ordered by x, then by y, so no two ends share a vertical line
+    // and vertical line segments need no special case: over a vertical line segment is to the left of it.
+    bool is_point_right_of(frm::Point point, frm::Point other) noexcept
+    {
+        return point.x > other.x || (point.x == other.x && point.y > other.y);
+    }
+
+    bool is_point_over(TrapezoidData const & trapezoid_data, size_t line_segment_index, frm::Point point) noexcept
+    {
+        LineSegment const & line_segment = trapezoid_data.line_segments[line_segment_index];
+
+        return orient2d(
+            trapezoid_data.ends_of_line_segment[line_segment.begin_index],
+            trapezoid_data.ends_of_line_segment[line_segment.end_index],
+            point
+        ) > 0.;
+    }
+
+    FRM_COUNTER(get_face_index_counter, "trapezoidal_decomposition/get_face_index", nullptr);
+    FRM_COUNTER(nodes_visited_counter, "trapezoidal_decomposition/nodes_visited", &get_face_index_counter);
+    FRM_COUNTER(line_segments_inserted_counter, "trapezoidal_decomposition/line_segments_inserted", nullptr);
+    FRM_COUNTER(trapezoids_split_counter, "trapezoidal_decomposition/trapezoids_split", &line_segments_inserted_counter);
+    FRM_OPERATION_COUNTERS(generate_counters, "generate_trapezoid_data_and_graph_root");
+
     std::shared_ptr<GraphNode> get_trapezoid_index(
         TrapezoidData const & trapezoid_data,
         std::shared_ptr<GraphNode> const & current,
         frm::Point point
     ) noexcept(!IS_DEBUG)
     {
+        FRM_COUNT(nodes_visited_counter);
+
         if (current->type == GraphNode::Type::Leaf)
         {
             return current;
@@ -58,7 +89,7 @@ namespace frm
         {
             frm::Point const current_point = trapezoid_data.ends_of_line_segment[current->index_by_type];
 
-            if (point.x - current_point.x > frm::epsilon)
+            if (is_point_right_of(point, current_point))
             {
                 return get_trapezoid_index(trapezoid_data, current->right_child, point);
             }
@@ -67,17 +98,7 @@ namespace frm
 
         if (current->type == GraphNode::Type::YUnit)
         {
-            LineSegment const line_segment_indices = trapezoid_data.line_segments[current->index_by_type];
-
-            frm::Point const begin_point = trapezoid_data.ends_of_line_segment[line_segment_indices.begin_index];
-            frm::Point const end_point = trapezoid_data.ends_of_line_segment[line_segment_indices.end_index];
-
-            float const k = (end_point.y - begin_point.y) / (end_point.x - begin_point.x);
-            float const c = end_point.y - k * end_point.x;
-
-            bool const is_point_over_line = frm::is_point_over_line(point, { k, c });
-
-            if (is_point_over_line)
+            if (is_point_over(trapezoid_data, current->index_by_type, point))
             {
                 return get_trapezoid_index(trapezoid_data, current->left_child, point);
             }
@@ -88,6 +109,43 @@ namespace frm
         return 0;
     }
 
+    // Trapezoid which the line segment from begin_index to end_index goes into right after begin_index.
+    // begin_index may already be an end of other line segments, then the other end decides.
+    std::shared_ptr<GraphNode> get_line_segment_trapezoid_index(
+        TrapezoidData const & trapezoid_data,
+        std::shared_ptr<GraphNode> const & root,
+        size_t begin_index,
+        size_t end_index
+    ) noexcept(!IS_DEBUG)
+    {
+        frm::Point const begin = trapezoid_data.ends_of_line_segment[begin_index];
+        frm::Point const end = trapezoid_data.ends_of_line_segment[end_index];
+
+        std::shared_ptr<GraphNode> current = root;
+
+        while (current->type != GraphNode::Type::Leaf)
+        {
+            bool is_left{};
+
+            if (current->type == GraphNode::Type::XUnit)
+            {
+                is_left = current->index_by_type != begin_index &&
+                    !is_point_right_of(begin, trapezoid_data.ends_of_line_segment[current->index_by_type]);
+            }
+            else
+            {
+                LineSegment const & line_segment = trapezoid_data.line_segments[current->index_by_type];
+                bool const is_common_begin = line_segment.begin_index == begin_index;
+
+                is_left = is_point_over(trapezoid_data, current->index_by_type, is_common_begin ? end : begin);
+            }
+
+            current = is_left ? current->left_child : current->right_child;
+        }
+
+        return current;
+    }
+
     size_t get_free_trapezoid_index(TrapezoidData & trapezoid_data) noexcept(!IS_DEBUG)
     {
         size_t const index = trapezoid_data.trapezoids.size();
@@ -95,948 +153,353 @@ namespace frm
         return index;
     }
 
-    void update_famous_neighbors(TrapezoidData & trapezoid_data, size_t trapezoid_index) noexcept(!IS_DEBUG)
+    // Neighbor indices of a trapezoid with a single neighbor on a side are both equal to it.
+    void replace_left_neighbor(TrapezoidData & trapezoid_data, size_t trapezoid_index, size_t old_index, size_t new_index) noexcept
     {
-        Trapezoid const & trapezoid = trapezoid_data.trapezoids[trapezoid_index];
-
-        if (trapezoid.top_left_neighbor_index != std::numeric_limits<size_t>::max())
+        if (trapezoid_index == no_trapezoid)
         {
-            Trapezoid & neighbor_trapezoid = trapezoid_data.trapezoids[trapezoid.top_left_neighbor_index];
-            neighbor_trapezoid.top_right_neighbor_index = trapezoid_index;
+            return;
         }
-        if (trapezoid.bottom_left_neighbor_index != std::numeric_limits<size_t>::max())
-        {
-            Trapezoid & neighbor_trapezoid = trapezoid_data.trapezoids[trapezoid.bottom_left_neighbor_index];
-            neighbor_trapezoid.bottom_right_neighbor_index = trapezoid_index;
-        }
-        if (trapezoid.top_right_neighbor_index != std::numeric_limits<size_t>::max())
+
+        Trapezoid & trapezoid = trapezoid_data.trapezoids[trapezoid_index];
+        if (trapezoid.top_left_neighbor_index == old_index)
         {
-            Trapezoid & neighbor_trapezoid = trapezoid_data.trapezoids[trapezoid.top_right_neighbor_index];
-            neighbor_trapezoid.top_left_neighbor_index = trapezoid_index;
+            trapezoid.top_left_neighbor_index = new_index;
         }
-        if (trapezoid.bottom_right_neighbor_index != std::numeric_limits<size_t>::max())
+        if (trapezoid.bottom_left_neighbor_index == old_index)
         {
-            Trapezoid & neighbor_trapezoid = trapezoid_data.trapezoids[trapezoid.bottom_right_neighbor_index];
-            neighbor_trapezoid.bottom_left_neighbor_index = trapezoid_index;
+            trapezoid.bottom_left_neighbor_index = new_index;
         }
     }
 
-
-    void handle_inside_one_trapezoid(
-        TrapezoidData & trapezoid_data,
-        std::shared_ptr<GraphNode> trapezoid,
-        size_t begin_index,
-        size_t end_index,
-        size_t line_index
-    ) noexcept(!IS_DEBUG)
+    void replace_right_neighbor(TrapezoidData & trapezoid_data, size_t trapezoid_index, size_t old_index, size_t new_index) noexcept
     {
-        bool const begin_is_existing_end = trapezoid_data.trapezoids[trapezoid->index_by_type].left_end_index == begin_index;
-        bool const end_is_existing_end = trapezoid_data.trapezoids[trapezoid->index_by_type].right_end_index == end_index;
-
-        if (begin_is_existing_end && end_is_existing_end)
+        if (trapezoid_index == no_trapezoid)
         {
-            size_t const old_trapezoid_index = trapezoid->index_by_type;
-            Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
-
-            size_t const top_trapezoid_index = old_trapezoid_index;
-            size_t const bottom_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-
-            Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-            top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            top_trapezoid.bottom_line_segment_index = line_index;
-            top_trapezoid.left_end_index = begin_index;
-            top_trapezoid.right_end_index = end_index;
-            top_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-            top_trapezoid.bottom_left_neighbor_index = std::numeric_limits<size_t>::max();
-            top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-            top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-            Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-            bottom_trapezoid.top_line_segment_index = line_index;
-            bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            bottom_trapezoid.left_end_index = begin_index;
-            bottom_trapezoid.right_end_index = end_index;
-            bottom_trapezoid.top_left_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-            bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-            update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
-
-            std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-            top_trapezoid_node->type = GraphNode::Type::Leaf;
-            top_trapezoid_node->index_by_type = top_trapezoid_index;
-            top_trapezoid.trapezoid_node = top_trapezoid_node;
-
-            std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-            bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-            bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-            bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
-
-            std::shared_ptr<GraphNode> line_node = trapezoid;
-            line_node->type = GraphNode::Type::YUnit;
-            line_node->index_by_type = line_index;
-
-            line_node->left_child = top_trapezoid_node;
-            line_node->right_child = bottom_trapezoid_node;
+            return;
         }
 
-        if (begin_is_existing_end && !end_is_existing_end)
+        Trapezoid & trapezoid = trapezoid_data.trapezoids[trapezoid_index];
+        if (trapezoid.top_right_neighbor_index == old_index)
         {
-            size_t const old_trapezoid_index = trapezoid->index_by_type;
-            Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
-
-            size_t const right_trapezoid_index = old_trapezoid_index;
-            size_t const top_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-            size_t const bottom_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-
-            Trapezoid & right_trapezoid = trapezoid_data.trapezoids[right_trapezoid_index];
-            right_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            right_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            right_trapezoid.left_end_index = end_index;
-            right_trapezoid.right_end_index = old_trapezoid.right_end_index;
-            right_trapezoid.top_left_neighbor_index = top_trapezoid_index;
-            right_trapezoid.bottom_left_neighbor_index = bottom_trapezoid_index;
-            right_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-            right_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-            Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-            top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            top_trapezoid.bottom_line_segment_index = line_index;
-            top_trapezoid.left_end_index = begin_index;
-            top_trapezoid.right_end_index = end_index;
-            top_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-            top_trapezoid.bottom_left_neighbor_index = std::numeric_limits<size_t>::max();
-            top_trapezoid.top_right_neighbor_index = right_trapezoid_index;
-            top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-            Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-            bottom_trapezoid.top_line_segment_index = line_index;
-            bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            bottom_trapezoid.left_end_index = begin_index;
-            bottom_trapezoid.right_end_index = end_index;
-            bottom_trapezoid.top_left_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-            bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_right_neighbor_index = right_trapezoid_index;
-
-            update_famous_neighbors(trapezoid_data, right_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
-
-            std::shared_ptr<GraphNode> right_trapezoid_node = std::make_shared<GraphNode>();
-            right_trapezoid_node->type = GraphNode::Type::Leaf;
-            right_trapezoid_node->index_by_type = right_trapezoid_index;
-            right_trapezoid.trapezoid_node = right_trapezoid_node;
-
-            std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-            top_trapezoid_node->type = GraphNode::Type::Leaf;
-            top_trapezoid_node->index_by_type = top_trapezoid_index;
-            top_trapezoid.trapezoid_node = top_trapezoid_node;
-
-            std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-            bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-            bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-            bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
-
-            std::shared_ptr<GraphNode> end_node = trapezoid;
-            end_node->type = GraphNode::Type::XUnit;
-            end_node->index_by_type = end_index;
-
-            std::shared_ptr<GraphNode> line_node = std::make_shared<GraphNode>();
-            line_node->type = GraphNode::Type::YUnit;
-            line_node->index_by_type = line_index;
-
-            end_node->left_child = line_node;
-            end_node->right_child = right_trapezoid_node;
-
-            line_node->left_child = top_trapezoid_node;
-            line_node->right_child = bottom_trapezoid_node;
+            trapezoid.top_right_neighbor_index = new_index;
         }
-
-        if (!begin_is_existing_end && end_is_existing_end)
+        if (trapezoid.bottom_right_neighbor_index == old_index)
         {
-            size_t const old_trapezoid_index = trapezoid->index_by_type;
-            Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
-
-            size_t const left_trapezoid_index = old_trapezoid_index;
-            size_t const top_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-            size_t const bottom_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-
-            Trapezoid & left_trapezoid = trapezoid_data.trapezoids[left_trapezoid_index];
-            left_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            left_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            left_trapezoid.left_end_index = old_trapezoid.left_end_index;
-            left_trapezoid.right_end_index = begin_index;
-            left_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-            left_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-            left_trapezoid.top_right_neighbor_index = top_trapezoid_index;
-            left_trapezoid.bottom_right_neighbor_index = bottom_trapezoid_index;
-
-            Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-            top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            top_trapezoid.bottom_line_segment_index = line_index;
-            top_trapezoid.left_end_index = begin_index;
-            top_trapezoid.right_end_index = end_index;
-            top_trapezoid.top_left_neighbor_index = left_trapezoid_index;
-            top_trapezoid.bottom_left_neighbor_index = std::numeric_limits<size_t>::max();
-            top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-            top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-            Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-            bottom_trapezoid.top_line_segment_index = line_index;
-            bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            bottom_trapezoid.left_end_index = begin_index;
-            bottom_trapezoid.right_end_index = end_index;
-            bottom_trapezoid.top_left_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_left_neighbor_index = left_trapezoid_index;
-            bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-            update_famous_neighbors(trapezoid_data, left_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
-
-            std::shared_ptr<GraphNode> left_trapezoid_node = std::make_shared<GraphNode>();
-            left_trapezoid_node->type = GraphNode::Type::Leaf;
-            left_trapezoid_node->index_by_type = left_trapezoid_index;
-            left_trapezoid.trapezoid_node = left_trapezoid_node;
-
-            std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-            top_trapezoid_node->type = GraphNode::Type::Leaf;
-            top_trapezoid_node->index_by_type = top_trapezoid_index;
-            top_trapezoid.trapezoid_node = top_trapezoid_node;
-
-            std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-            bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-            bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-            bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
-
-            std::shared_ptr<GraphNode> begin_node = trapezoid;
-            begin_node->type = GraphNode::Type::XUnit;
-            begin_node->index_by_type = begin_index;
-
-            std::shared_ptr<GraphNode> line_node = std::make_shared<GraphNode>();
-            line_node->type = GraphNode::Type::YUnit;
-            line_node->index_by_type = line_index;
-
-            begin_node->left_child = left_trapezoid_node;
-            begin_node->right_child = line_node;
-
-            line_node->left_child = top_trapezoid_node;
-            line_node->right_child = bottom_trapezoid_node;
-        }
-
-        if (!begin_is_existing_end && !end_is_existing_end)
-        {
-            size_t const old_trapezoid_index = trapezoid->index_by_type;
-            Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
-
-            size_t const left_trapezoid_index = old_trapezoid_index;
-            size_t const right_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-            size_t const top_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-            size_t const bottom_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-
-            Trapezoid & left_trapezoid = trapezoid_data.trapezoids[left_trapezoid_index];
-            left_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            left_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            left_trapezoid.left_end_index = old_trapezoid.left_end_index;
-            left_trapezoid.right_end_index = begin_index;
-            left_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-            left_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-            left_trapezoid.top_right_neighbor_index = top_trapezoid_index;
-            left_trapezoid.bottom_right_neighbor_index = bottom_trapezoid_index;
-
-            Trapezoid & right_trapezoid = trapezoid_data.trapezoids[right_trapezoid_index];
-            right_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            right_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            right_trapezoid.left_end_index = end_index;
-            right_trapezoid.right_end_index = old_trapezoid.right_end_index;
-            right_trapezoid.top_left_neighbor_index = top_trapezoid_index;
-            right_trapezoid.bottom_left_neighbor_index = bottom_trapezoid_index;
-            right_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-            right_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-            Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-            top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            top_trapezoid.bottom_line_segment_index = line_index;
-            top_trapezoid.left_end_index = begin_index;
-            top_trapezoid.right_end_index = end_index;
-            top_trapezoid.top_left_neighbor_index = left_trapezoid_index;
-            top_trapezoid.bottom_left_neighbor_index = std::numeric_limits<size_t>::max();
-            top_trapezoid.top_right_neighbor_index = right_trapezoid_index;
-            top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-            Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-            bottom_trapezoid.top_line_segment_index = line_index;
-            bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            bottom_trapezoid.left_end_index = begin_index;
-            bottom_trapezoid.right_end_index = end_index;
-            bottom_trapezoid.top_left_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_left_neighbor_index = left_trapezoid_index;
-            bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_right_neighbor_index = right_trapezoid_index;
-
-            update_famous_neighbors(trapezoid_data, left_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, right_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
-
-            std::shared_ptr<GraphNode> left_trapezoid_node = std::make_shared<GraphNode>();
-            left_trapezoid_node->type = GraphNode::Type::Leaf;
-            left_trapezoid_node->index_by_type = left_trapezoid_index;
-            left_trapezoid.trapezoid_node = left_trapezoid_node;
-
-            std::shared_ptr<GraphNode> right_trapezoid_node = std::make_shared<GraphNode>();
-            right_trapezoid_node->type = GraphNode::Type::Leaf;
-            right_trapezoid_node->index_by_type = right_trapezoid_index;
-            right_trapezoid.trapezoid_node = right_trapezoid_node;
-
-            std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-            top_trapezoid_node->type = GraphNode::Type::Leaf;
-            top_trapezoid_node->index_by_type = top_trapezoid_index;
-            top_trapezoid.trapezoid_node = top_trapezoid_node;
-
-            std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-            bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-            bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-            bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
-
-            std::shared_ptr<GraphNode> begin_node = trapezoid;
-            begin_node->type = GraphNode::Type::XUnit;
-            begin_node->index_by_type = begin_index;
-
-            std::shared_ptr<GraphNode> end_node = std::make_shared<GraphNode>();
-            end_node->type = GraphNode::Type::XUnit;
-            end_node->index_by_type = end_index;
-
-            std::shared_ptr<GraphNode> line_node = std::make_shared<GraphNode>();
-            line_node->type = GraphNode::Type::YUnit;
-            line_node->index_by_type = line_index;
-
-            begin_node->left_child = left_trapezoid_node;
-            begin_node->right_child = end_node;
-
-            end_node->left_child = line_node;
-            end_node->right_child = right_trapezoid_node;
-
-            line_node->left_child = top_trapezoid_node;
-            line_node->right_child = bottom_trapezoid_node;
+            trapezoid.bottom_right_neighbor_index = new_index;
         }
     }
 
-    void handle_first_trapezoid_with_existing_vertex(
-        TrapezoidData & trapezoid_data,
-        std::shared_ptr<GraphNode> trapezoid,
-        std::shared_ptr<GraphNode> & last_top_node,
-        std::shared_ptr<GraphNode> & last_bottom_node,
-        size_t begin_index,
-        size_t end_index,
-        size_t line_index,
-        bool is_right_end_of_begin_trapezoid_over_line
-    ) noexcept(!IS_DEBUG)
+    void set_left_neighbors(Trapezoid & trapezoid, size_t top_index, size_t bottom_index) noexcept
     {
-        size_t const old_trapezoid_index = trapezoid->index_by_type;
-        Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
-
-        size_t const top_trapezoid_index = old_trapezoid_index;
-        size_t const bottom_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-
-        Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-        top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-        top_trapezoid.bottom_line_segment_index = line_index;
-        top_trapezoid.left_end_index = begin_index;
-        if (is_right_end_of_begin_trapezoid_over_line)
-        {
-            top_trapezoid.right_end_index = old_trapezoid.right_end_index;
-        }
-        top_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-        top_trapezoid.bottom_left_neighbor_index = std::numeric_limits<size_t>::max();
-        top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-        top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-        Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-        bottom_trapezoid.top_line_segment_index = line_index;
-        bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-        bottom_trapezoid.left_end_index = begin_index;
-        if (!is_right_end_of_begin_trapezoid_over_line)
-        {
-            bottom_trapezoid.right_end_index = old_trapezoid.right_end_index;
-        }
-        bottom_trapezoid.top_left_neighbor_index = std::numeric_limits<size_t>::max();
-        bottom_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-        bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-        bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-        update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-        update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
+        trapezoid.top_left_neighbor_index = top_index;
+        trapezoid.bottom_left_neighbor_index = bottom_index;
+    }
 
-        std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-        top_trapezoid_node->type = GraphNode::Type::Leaf;
-        top_trapezoid_node->index_by_type = top_trapezoid_index;
-        top_trapezoid.trapezoid_node = top_trapezoid_node;
+    void set_right_neighbors(Trapezoid & trapezoid, size_t top_index, size_t bottom_index) noexcept
+    {
+        trapezoid.top_right_neighbor_index = top_index;
+        trapezoid.bottom_right_neighbor_index = bottom_index;
+    }
 
-        std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-        bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-        bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-        bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
+    size_t add_trapezoid(TrapezoidData & trapezoid_data, size_t top_line_segment_index, size_t bottom_line_segment_index, size_t left_end_index) noexcept(!IS_DEBUG)
+    {
+        size_t const index = get_free_trapezoid_index(trapezoid_data);
+        Trapezoid & trapezoid = trapezoid_data.trapezoids[index];
 
-        std::shared_ptr<GraphNode> line_node = trapezoid;
-        line_node->type = GraphNode::Type::YUnit;
-        line_node->index_by_type = line_index;
+        trapezoid.top_line_segment_index = top_line_segment_index;
+        trapezoid.bottom_line_segment_index = bottom_line_segment_index;
+        trapezoid.left_end_index = left_end_index;
 
-        line_node->left_child = top_trapezoid_node;
-        line_node->right_child = bottom_trapezoid_node;
+        trapezoid.trapezoid_node = std::make_shared<GraphNode>();
+        trapezoid.trapezoid_node->type = GraphNode::Type::Leaf;
+        trapezoid.trapezoid_node->index_by_type = index;
 
-        last_top_node = top_trapezoid_node;
-        last_bottom_node = bottom_trapezoid_node;
+        return index;
     }
 
-    void handle_first_trapezoid_without_existing_vertex(
-        TrapezoidData & trapezoid_data,
-        std::shared_ptr<GraphNode> trapezoid,
-        std::shared_ptr<GraphNode> & last_top_node,
-        std::shared_ptr<GraphNode> & last_bottom_node,
-        size_t begin_index,
-        size_t end_index,
-        size_t line_index,
-        bool is_right_end_of_begin_trapezoid_over_line
-    ) noexcept(!IS_DEBUG)
+    std::shared_ptr<GraphNode> make_node(GraphNode::Type type, size_t index_by_type, std::shared_ptr<GraphNode> left_child, std::shared_ptr<GraphNode> right_child) noexcept
     {
-        size_t const old_trapezoid_index = trapezoid->index_by_type;
-        Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
-
-        size_t const left_trapezoid_index = old_trapezoid_index;
-        size_t const top_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-        size_t const bottom_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-
-        Trapezoid & left_trapezoid = trapezoid_data.trapezoids[left_trapezoid_index];
-        left_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-        left_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-        left_trapezoid.left_end_index = old_trapezoid.left_end_index;
-        left_trapezoid.right_end_index = begin_index;
-        left_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-        left_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-        left_trapezoid.top_right_neighbor_index = top_trapezoid_index;
-        left_trapezoid.bottom_right_neighbor_index = bottom_trapezoid_index;
-
-        Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-        top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-        top_trapezoid.bottom_line_segment_index = line_index;
-        top_trapezoid.left_end_index = begin_index;
-        if (is_right_end_of_begin_trapezoid_over_line)
-        {
-            top_trapezoid.right_end_index = old_trapezoid.right_end_index;
-        }
-        top_trapezoid.top_left_neighbor_index = left_trapezoid_index;
-        top_trapezoid.bottom_left_neighbor_index = std::numeric_limits<size_t>::max();
-        top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-        top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-        Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-        bottom_trapezoid.top_line_segment_index = line_index;
-        bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-        bottom_trapezoid.left_end_index = begin_index;
-        if (!is_right_end_of_begin_trapezoid_over_line)
-        {
-            bottom_trapezoid.right_end_index = old_trapezoid.right_end_index;
-        }
-        bottom_trapezoid.top_left_neighbor_index = std::numeric_limits<size_t>::max();
-        bottom_trapezoid.bottom_left_neighbor_index = left_trapezoid_index;
-        bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-        bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-        update_famous_neighbors(trapezoid_data, left_trapezoid_index);
-        update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-        update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
-
-        std::shared_ptr<GraphNode> left_trapezoid_node = std::make_shared<GraphNode>();
-        left_trapezoid_node->type = GraphNode::Type::Leaf;
-        left_trapezoid_node->index_by_type = left_trapezoid_index;
-        left_trapezoid.trapezoid_node = left_trapezoid_node;
-
-        std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-        top_trapezoid_node->type = GraphNode::Type::Leaf;
-        top_trapezoid_node->index_by_type = top_trapezoid_index;
-        top_trapezoid.trapezoid_node = top_trapezoid_node;
-
-        std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-        bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-        bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-        bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
-
-        std::shared_ptr<GraphNode> begin_node = trapezoid;
-        begin_node->type = GraphNode::Type::XUnit;
-        begin_node->index_by_type = begin_index;
-
-        std::shared_ptr<GraphNode> line_node = std::make_shared<GraphNode>();
-        line_node->type = GraphNode::Type::YUnit;
-        line_node->index_by_type = line_index;
-
-        begin_node->left_child = left_trapezoid_node;
-        begin_node->right_child = line_node;
-
-        line_node->left_child = top_trapezoid_node;
-        line_node->right_child = bottom_trapezoid_node;
-
-        last_top_node = top_trapezoid_node;
-        last_bottom_node = bottom_trapezoid_node;
+        auto node = std::make_shared<GraphNode>();
+        node->type = type;
+        node->index_by_type = index_by_type;
+        node->left_child = std::move(left_child);
+        node->right_child = std::move(right_child);
+        return node;
     }
 
-
-    void handle_middle_trapezoid(
-        TrapezoidData & trapezoid_data,
-        std::shared_ptr<GraphNode> trapezoid,
-        std::shared_ptr<GraphNode> & last_top_node,
-        std::shared_ptr<GraphNode> & last_bottom_node,
-        size_t begin_index,
-        size_t end_index,
-        size_t line_index,
-        bool is_last_point_over_line,
-        bool is_current_point_over_line
-    ) noexcept(!IS_DEBUG)
+    // Randomized incremental step: the trapezoids crossed by the line segment are split into the parts
+    // to the left of its begin, to the right of its end, over and under it.
+    // The parts over (under) it are merged along the walls which the line segment cuts off.
+    // Replaced trapezoids are left without a node and removed after all the line segments are inserted.
+    void insert_line_segment(TrapezoidData & trapezoid_data, std::shared_ptr<GraphNode> const & root, size_t line_segment_index) noexcept(!IS_DEBUG)
     {
-        size_t const old_trapezoid_index = trapezoid->index_by_type;
-        Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
-
-        size_t const last_top_trapezoid_index = last_top_node->index_by_type;
-        size_t const last_bottom_trapezoid_index = last_bottom_node->index_by_type;
+        LineSegment const line_segment = trapezoid_data.line_segments[line_segment_index];
+        size_t const begin_index = line_segment.begin_index;
+        size_t const end_index = line_segment.end_index;
 
-        Trapezoid & last_top_trapezoid = trapezoid_data.trapezoids[last_top_trapezoid_index];
-        Trapezoid & last_bottom_trapezoid = trapezoid_data.trapezoids[last_bottom_trapezoid_index];
+        frm::Point const begin = trapezoid_data.ends_of_line_segment[begin_index];
+        frm::Point const end = trapezoid_data.ends_of_line_segment[end_index];
 
-        if (is_last_point_over_line)
+        // crossed trapezoids from left to right
+        std::vector<size_t> crossed{ get_line_segment_trapezoid_index(trapezoid_data, root, begin_index, end_index)->index_by_type };
+        while (true)
         {
-            size_t const top_trapezoid_index = old_trapezoid_index;
-
-            last_top_trapezoid.right_end_index = old_trapezoid.left_end_index;
-            last_top_trapezoid.bottom_right_neighbor_index = top_trapezoid_index;
-
-            if (!is_current_point_over_line)
-            {
-                last_bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-            }
-
-            Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-            top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            top_trapezoid.bottom_line_segment_index = line_index;
-            top_trapezoid.left_end_index = old_trapezoid.left_end_index;
-            if (is_current_point_over_line)
+            Trapezoid const & last = trapezoid_data.trapezoids[crossed.back()];
+            if (last.right_end_index == end_index || !is_point_right_of(end, trapezoid_data.ends_of_line_segment[last.right_end_index]))
             {
-                top_trapezoid.right_end_index = old_trapezoid.right_end_index;
+                break;
             }
-            top_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-            top_trapezoid.bottom_left_neighbor_index = last_top_trapezoid_index;
-            top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-            top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-            update_famous_neighbors(trapezoid_data, last_top_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, top_trapezoid_index);
 
-            std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-            top_trapezoid_node->type = GraphNode::Type::Leaf;
-            top_trapezoid_node->index_by_type = top_trapezoid_index;
-            top_trapezoid.trapezoid_node = top_trapezoid_node;
+            bool const is_wall_over = orient2d(begin, end, trapezoid_data.ends_of_line_segment[last.right_end_index]) > 0.;
+            size_t const next = is_wall_over ? last.bottom_right_neighbor_index : last.top_right_neighbor_index;
 
-            std::shared_ptr<GraphNode> line_node = trapezoid;
-            line_node->type = GraphNode::Type::YUnit;
-            line_node->index_by_type = line_index;
+            assert("Line segments cross" && next != no_trapezoid);
+            crossed.push_back(next);
+        }
 
-            line_node->left_child = top_trapezoid_node;
-            line_node->right_child = last_bottom_node;
+        FRM_COUNT(line_segments_inserted_counter);
+        FRM_COUNT_N(trapezoids_split_counter, crossed.size());
 
-            last_top_node = top_trapezoid_node;
-        }
-        else
+        std::vector<Trapezoid> old(crossed.size());
+        for (size_t i = 0; i < crossed.size(); ++i)
         {
-            size_t const bottom_trapezoid_index = old_trapezoid_index;
-
-            last_bottom_trapezoid.right_end_index = old_trapezoid.left_end_index;
-            last_bottom_trapezoid.top_right_neighbor_index = bottom_trapezoid_index;
+            old[i] = trapezoid_data.trapezoids[crossed[i]];
+        }
 
-            if (is_current_point_over_line)
+        auto const is_line_segment_from = [&trapezoid_data](size_t index, size_t end_of_line_segment_index) noexcept
             {
-                last_top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-            }
-
-            Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-            bottom_trapezoid.top_line_segment_index = line_index;
-            bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            bottom_trapezoid.left_end_index = old_trapezoid.left_end_index;
-            if (!is_current_point_over_line)
+                return trapezoid_data.line_segments[index].begin_index == end_of_line_segment_index;
+            };
+        auto const is_line_segment_to = [&trapezoid_data](size_t index, size_t end_of_line_segment_index) noexcept
             {
-                bottom_trapezoid.right_end_index = old_trapezoid.right_end_index;
-            }
-            bottom_trapezoid.top_left_neighbor_index = last_bottom_trapezoid_index;
-            bottom_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-            bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
+                return trapezoid_data.line_segments[index].end_index == end_of_line_segment_index;
+            };
 
-            update_famous_neighbors(trapezoid_data, last_bottom_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
+        Trapezoid const & first = old.front();
 
-            std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-            bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-            bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-            bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
+        size_t left_index = no_trapezoid;
+        size_t upper_index = add_trapezoid(trapezoid_data, first.top_line_segment_index, line_segment_index, begin_index);
+        size_t lower_index = add_trapezoid(trapezoid_data, line_segment_index, first.bottom_line_segment_index, begin_index);
 
-            std::shared_ptr<GraphNode> line_node = trapezoid;
-            line_node->type = GraphNode::Type::YUnit;
-            line_node->index_by_type = line_index;
+        if (first.left_end_index != begin_index)
+        {
+            left_index = add_trapezoid(trapezoid_data, first.top_line_segment_index, first.bottom_line_segment_index, first.left_end_index);
+            Trapezoid & left = trapezoid_data.trapezoids[left_index];
 
-            line_node->left_child = last_top_node;
-            line_node->right_child = bottom_trapezoid_node;
+            left.right_end_index = begin_index;
+            set_left_neighbors(left, first.top_left_neighbor_index, first.bottom_left_neighbor_index);
+            set_right_neighbors(left, upper_index, lower_index);
+            replace_right_neighbor(trapezoid_data, first.top_left_neighbor_index, crossed.front(), left_index);
+            replace_right_neighbor(trapezoid_data, first.bottom_left_neighbor_index, crossed.front(), left_index);
 
-            last_bottom_node = bottom_trapezoid_node;
+            set_left_neighbors(trapezoid_data.trapezoids[upper_index], left_index, left_index);
+            set_left_neighbors(trapezoid_data.trapezoids[lower_index], left_index, left_index);
         }
-    }
-
-    void handle_last_trapezoid_with_existing_vertex(
-        TrapezoidData & trapezoid_data,
-        std::shared_ptr<GraphNode> trapezoid,
-        std::shared_ptr<GraphNode> & last_top_node,
-        std::shared_ptr<GraphNode> & last_bottom_node,
-        size_t begin_index,
-        size_t end_index,
-        size_t line_index,
-        bool is_last_point_over_line
-    ) noexcept(!IS_DEBUG)
-    {
-        size_t const old_trapezoid_index = trapezoid->index_by_type;
-        Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
-
-        if (is_last_point_over_line)
+        else if (is_line_segment_from(first.top_line_segment_index, begin_index))
         {
-            size_t const last_top_trapezoid_index = last_top_node->index_by_type;
-            size_t const top_trapezoid_index = old_trapezoid_index;
-
-            Trapezoid & last_top_trapezoid = trapezoid_data.trapezoids[last_top_trapezoid_index];
-            last_top_trapezoid.right_end_index = old_trapezoid.left_end_index;
-            last_top_trapezoid.bottom_right_neighbor_index = top_trapezoid_index;
-
-            Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-            top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            top_trapezoid.bottom_line_segment_index = line_index;
-            top_trapezoid.left_end_index = old_trapezoid.left_end_index;
-            top_trapezoid.right_end_index = end_index;
-            top_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-            top_trapezoid.bottom_left_neighbor_index = last_top_trapezoid_index;
-            top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-            top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-            update_famous_neighbors(trapezoid_data, last_top_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-
-            std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-            top_trapezoid_node->type = GraphNode::Type::Leaf;
-            top_trapezoid_node->index_by_type = top_trapezoid_index;
-            top_trapezoid.trapezoid_node = top_trapezoid_node;
-
-            last_top_node = top_trapezoid_node;
+            // nothing is over the begin, the left neighbors are under the line segment
+            set_left_neighbors(trapezoid_data.trapezoids[lower_index], first.top_left_neighbor_index, first.bottom_left_neighbor_index);
+            replace_right_neighbor(trapezoid_data, first.top_left_neighbor_index, crossed.front(), lower_index);
+            replace_right_neighbor(trapezoid_data, first.bottom_left_neighbor_index, crossed.front(), lower_index);
+        }
+        else if (is_line_segment_from(first.bottom_line_segment_index, begin_index))
+        {
+            set_left_neighbors(trapezoid_data.trapezoids[upper_index], first.top_left_neighbor_index, first.bottom_left_neighbor_index);
+            replace_right_neighbor(trapezoid_data, first.top_left_neighbor_index, crossed.front(), upper_index);
+            replace_right_neighbor(trapezoid_data, first.bottom_left_neighbor_index, crossed.front(), upper_index);
         }
         else
         {
-            size_t const last_bottom_trapezoid_index = last_bottom_node->index_by_type;
-            size_t const bottom_trapezoid_index = old_trapezoid_index;
-
-            Trapezoid & last_bottom_trapezoid = trapezoid_data.trapezoids[last_bottom_trapezoid_index];
-            last_bottom_trapezoid.right_end_index = old_trapezoid.left_end_index;
-            last_bottom_trapezoid.top_right_neighbor_index = bottom_trapezoid_index;
-
-            Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-            bottom_trapezoid.top_line_segment_index = line_index;
-            bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            bottom_trapezoid.left_end_index = old_trapezoid.left_end_index;
-            bottom_trapezoid.right_end_index = end_index;
-            bottom_trapezoid.top_left_neighbor_index = last_bottom_trapezoid_index;
-            bottom_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-            bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-            update_famous_neighbors(trapezoid_data, last_bottom_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
-
-            std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-            bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-            bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-            bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
-
-            last_bottom_node = bottom_trapezoid_node;
+            // line segments end at the begin from the left, the wall is split by it
+            set_left_neighbors(trapezoid_data.trapezoids[upper_index], first.top_left_neighbor_index, first.top_left_neighbor_index);
+            set_left_neighbors(trapezoid_data.trapezoids[lower_index], first.bottom_left_neighbor_index, first.bottom_left_neighbor_index);
+            replace_right_neighbor(trapezoid_data, first.top_left_neighbor_index, crossed.front(), upper_index);
+            replace_right_neighbor(trapezoid_data, first.bottom_left_neighbor_index, crossed.front(), lower_index);
         }
 
-        size_t const top_trapezoid_index = last_top_node->index_by_type;
-        size_t const bottom_trapezoid_index = last_bottom_node->index_by_type;
+        // parts over and under the line segment for every crossed trapezoid
+        std::vector<size_t> upper_indices(crossed.size());
+        std::vector<size_t> lower_indices(crossed.size());
+        upper_indices[0] = upper_index;
+        lower_indices[0] = lower_index;
 
-        Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-        top_trapezoid.right_end_index = end_index;
-        top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-        top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
+        for (size_t i = 1; i < crossed.size(); ++i)
+        {
+            Trapezoid const & previous = old[i - 1];
+            Trapezoid const & current = old[i];
 
-        Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-        bottom_trapezoid.right_end_index = end_index;
-        bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-        bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
+            size_t const wall_index = current.left_end_index;
+            bool const is_wall_over = orient2d(begin, end, trapezoid_data.ends_of_line_segment[wall_index]) > 0.;
 
-        update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-        update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
+            if (is_wall_over)
+            {
+                // the wall stays over the line segment, the part under it is cut off
+                assert(previous.bottom_line_segment_index == current.bottom_line_segment_index);
 
-        std::shared_ptr<GraphNode> line_node = trapezoid;
-        line_node->type = GraphNode::Type::YUnit;
-        line_node->index_by_type = line_index;
+                size_t const next_upper_index = add_trapezoid(trapezoid_data, current.top_line_segment_index, line_segment_index, wall_index);
+                trapezoid_data.trapezoids[upper_index].right_end_index = wall_index;
 
-        line_node->left_child = last_top_node;
-        line_node->right_child = last_bottom_node;
-    }
+                if (is_line_segment_to(previous.top_line_segment_index, wall_index))
+                {
+                    set_right_neighbors(trapezoid_data.trapezoids[upper_index], next_upper_index, next_upper_index);
+                }
+                else
+                {
+                    set_right_neighbors(trapezoid_data.trapezoids[upper_index], previous.top_right_neighbor_index, next_upper_index);
+                    replace_left_neighbor(trapezoid_data, previous.top_right_neighbor_index, crossed[i - 1], upper_index);
+                }
 
-    void handle_last_trapezoid_without_existing_vertex(
-        TrapezoidData & trapezoid_data,
-        std::shared_ptr<GraphNode> trapezoid,
-        std::shared_ptr<GraphNode> & last_top_node,
-        std::shared_ptr<GraphNode> & last_bottom_node,
-        size_t begin_index,
-        size_t end_index,
-        size_t line_index,
-        bool is_last_point_over_line
-    ) noexcept(!IS_DEBUG)
-    {
-        size_t const old_trapezoid_index = trapezoid->index_by_type;
-        Trapezoid const old_trapezoid = trapezoid_data.trapezoids[old_trapezoid_index];
+                if (is_line_segment_from(current.top_line_segment_index, wall_index))
+                {
+                    set_left_neighbors(trapezoid_data.trapezoids[next_upper_index], upper_index, upper_index);
+                }
+                else
+                {
+                    set_left_neighbors(trapezoid_data.trapezoids[next_upper_index], current.top_left_neighbor_index, upper_index);
+                    replace_right_neighbor(trapezoid_data, current.top_left_neighbor_index, crossed[i], next_upper_index);
+                }
 
-        if (is_last_point_over_line)
-        {
-            size_t const last_top_trapezoid_index = last_top_node->index_by_type;
-            size_t const top_trapezoid_index = old_trapezoid_index;
-
-            Trapezoid & last_top_trapezoid = trapezoid_data.trapezoids[last_top_trapezoid_index];
-            last_top_trapezoid.right_end_index = old_trapezoid.left_end_index;
-            last_top_trapezoid.bottom_right_neighbor_index = top_trapezoid_index;
-
-            Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-            top_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-            top_trapezoid.bottom_line_segment_index = line_index;
-            top_trapezoid.left_end_index = old_trapezoid.left_end_index;
-            top_trapezoid.right_end_index = end_index;
-            top_trapezoid.top_left_neighbor_index = old_trapezoid.top_left_neighbor_index;
-            top_trapezoid.bottom_left_neighbor_index = last_top_trapezoid_index;
-            top_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-            top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-            update_famous_neighbors(trapezoid_data, last_top_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-
-            std::shared_ptr<GraphNode> top_trapezoid_node = std::make_shared<GraphNode>();
-            top_trapezoid_node->type = GraphNode::Type::Leaf;
-            top_trapezoid_node->index_by_type = top_trapezoid_index;
-            top_trapezoid.trapezoid_node = top_trapezoid_node;
-
-            last_top_node = top_trapezoid_node;
-        }
-        else
-        {
-            size_t const last_bottom_trapezoid_index = last_bottom_node->index_by_type;
-            size_t const bottom_trapezoid_index = old_trapezoid_index;
-
-            Trapezoid & last_bottom_trapezoid = trapezoid_data.trapezoids[last_bottom_trapezoid_index];
-            last_bottom_trapezoid.right_end_index = old_trapezoid.left_end_index;
-            last_bottom_trapezoid.top_right_neighbor_index = bottom_trapezoid_index;
-
-            Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-            bottom_trapezoid.top_line_segment_index = line_index;
-            bottom_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-            bottom_trapezoid.left_end_index = old_trapezoid.left_end_index;
-            bottom_trapezoid.right_end_index = end_index;
-            bottom_trapezoid.top_left_neighbor_index = last_bottom_trapezoid_index;
-            bottom_trapezoid.bottom_left_neighbor_index = old_trapezoid.bottom_left_neighbor_index;
-            bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-            bottom_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-            update_famous_neighbors(trapezoid_data, last_bottom_trapezoid_index);
-            update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
-
-            std::shared_ptr<GraphNode> bottom_trapezoid_node = std::make_shared<GraphNode>();
-            bottom_trapezoid_node->type = GraphNode::Type::Leaf;
-            bottom_trapezoid_node->index_by_type = bottom_trapezoid_index;
-            bottom_trapezoid.trapezoid_node = bottom_trapezoid_node;
-
-            last_bottom_node = bottom_trapezoid_node;
-        }
+                upper_index = next_upper_index;
+            }
+            else
+            {
+                assert(previous.top_line_segment_index == current.top_line_segment_index);
 
-        size_t const top_trapezoid_index = last_top_node->index_by_type;
-        size_t const bottom_trapezoid_index = last_bottom_node->index_by_type;
-        size_t const right_trapezoid_index = get_free_trapezoid_index(trapezoid_data);
-
-        Trapezoid & right_trapezoid = trapezoid_data.trapezoids[right_trapezoid_index];
-        right_trapezoid.top_line_segment_index = old_trapezoid.top_line_segment_index;
-        right_trapezoid.bottom_line_segment_index = old_trapezoid.bottom_line_segment_index;
-        right_trapezoid.left_end_index = end_index;
-        right_trapezoid.right_end_index = old_trapezoid.right_end_index;
-        right_trapezoid.top_left_neighbor_index = top_trapezoid_index;
-        right_trapezoid.bottom_left_neighbor_index = bottom_trapezoid_index;
-        right_trapezoid.top_right_neighbor_index = old_trapezoid.top_right_neighbor_index;
-        right_trapezoid.bottom_right_neighbor_index = old_trapezoid.bottom_right_neighbor_index;
-
-        Trapezoid & top_trapezoid = trapezoid_data.trapezoids[top_trapezoid_index];
-        top_trapezoid.right_end_index = end_index;
-        top_trapezoid.top_right_neighbor_index = right_trapezoid_index;
-        top_trapezoid.bottom_right_neighbor_index = std::numeric_limits<size_t>::max();
-
-        Trapezoid & bottom_trapezoid = trapezoid_data.trapezoids[bottom_trapezoid_index];
-        bottom_trapezoid.right_end_index = end_index;
-        bottom_trapezoid.top_right_neighbor_index = std::numeric_limits<size_t>::max();
-        bottom_trapezoid.bottom_right_neighbor_index = right_trapezoid_index;
-
-        update_famous_neighbors(trapezoid_data, right_trapezoid_index);
-        update_famous_neighbors(trapezoid_data, top_trapezoid_index);
-        update_famous_neighbors(trapezoid_data, bottom_trapezoid_index);
-
-        std::shared_ptr<GraphNode> right_trapezoid_node = std::make_shared<GraphNode>();
-        right_trapezoid_node->type = GraphNode::Type::Leaf;
-        right_trapezoid_node->index_by_type = right_trapezoid_index;
-        right_trapezoid.trapezoid_node = right_trapezoid_node;
-
-        std::shared_ptr<GraphNode> end_node = trapezoid;
-        end_node->type = GraphNode::Type::XUnit;
-        end_node->index_by_type = end_index;
-
-        std::shared_ptr<GraphNode> line_node = std::make_shared<GraphNode>();
-        line_node->type = GraphNode::Type::YUnit;
-        line_node->index_by_type = line_index;
-
-        end_node->left_child = line_node;
-        end_node->right_child = right_trapezoid_node;
-
-        line_node->left_child = last_top_node;
-        line_node->right_child = last_bottom_node;
-    }
+                size_t const next_lower_index = add_trapezoid(trapezoid_data, line_segment_index, current.bottom_line_segment_index, wall_index);
+                trapezoid_data.trapezoids[lower_index].right_end_index = wall_index;
 
-    void handle_between_trapezoids(
-        TrapezoidData & trapezoid_data,
-        std::shared_ptr<GraphNode> begin_trapezoid,
-        std::shared_ptr<GraphNode> end_trapezoid,
-        size_t begin_index,
-        size_t end_index,
-        size_t line_index
-    ) noexcept(!IS_DEBUG)
-    {
-        std::shared_ptr<GraphNode> last_top_node;
-        std::shared_ptr<GraphNode> last_bottom_node;
+                if (is_line_segment_to(previous.bottom_line_segment_index, wall_index))
+                {
+                    set_right_neighbors(trapezoid_data.trapezoids[lower_index], next_lower_index, next_lower_index);
+                }
+                else
+                {
+                    set_right_neighbors(trapezoid_data.trapezoids[lower_index], next_lower_index, previous.bottom_right_neighbor_index);
+                    replace_left_neighbor(trapezoid_data, previous.bottom_right_neighbor_index, crossed[i - 1], lower_index);
+                }
 
-        frm::Point const begin_point = trapezoid_data.ends_of_line_segment[begin_index];
-        frm::Point const end_point = trapezoid_data.ends_of_line_segment[end_index];
+                if (is_line_segment_from(current.bottom_line_segment_index, wall_index))
+                {
+                    set_left_neighbors(trapezoid_data.trapezoids[next_lower_index], lower_index, lower_index);
+                }
+                else
+                {
+                    set_left_neighbors(trapezoid_data.trapezoids[next_lower_index], lower_index, current.bottom_left_neighbor_index);
+                    replace_right_neighbor(trapezoid_data, current.bottom_left_neighbor_index, crossed[i], next_lower_index);
+                }
+
+                lower_index = next_lower_index;
+            }
 
-        float const k = (end_point.y - begin_point.y) / (end_point.x - begin_point.x);
-        float const c = end_point.y - k * end_point.x;
+            upper_indices[i] = upper_index;
+            lower_indices[i] = lower_index;
+        }
 
-        bool const is_right_end_of_begin_trapezoid_over_line = frm::is_point_over_line(
-            trapezoid_data.ends_of_line_segment[trapezoid_data.trapezoids[begin_trapezoid->index_by_type].right_end_index],
-            { k, c }
-        );
+        Trapezoid const & last = old.back();
 
-        std::shared_ptr<GraphNode> next_node;
+        size_t right_index = no_trapezoid;
+        trapezoid_data.trapezoids[upper_index].right_end_index = end_index;
+        trapezoid_data.trapezoids[lower_index].right_end_index = end_index;
 
-        if (is_right_end_of_begin_trapezoid_over_line)
+        if (last.right_end_index != end_index)
         {
-            size_t const bottom_right_neighbor_index = trapezoid_data.trapezoids[begin_trapezoid->index_by_type].bottom_right_neighbor_index;
-            next_node = trapezoid_data.trapezoids[bottom_right_neighbor_index].trapezoid_node;
+            right_index = add_trapezoid(trapezoid_data, last.top_line_segment_index, last.bottom_line_segment_index, end_index);
+            Trapezoid & right = trapezoid_data.trapezoids[right_index];
+
+            right.right_end_index = last.right_end_index;
+            set_left_neighbors(right, upper_index, lower_index);
+            set_right_neighbors(right, last.top_right_neighbor_index, last.bottom_right_neighbor_index);
+            replace_left_neighbor(trapezoid_data, last.top_right_neighbor_index, crossed.back(), right_index);
+            replace_left_neighbor(trapezoid_data, last.bottom_right_neighbor_index, crossed.back(), right_index);
+
+            set_right_neighbors(trapezoid_data.trapezoids[upper_index], right_index, right_index);
+            set_right_neighbors(trapezoid_data.trapezoids[lower_index], right_index, right_index);
         }
-        else
+        else if (is_line_segment_to(last.top_line_segment_index, end_index))
         {
-            size_t const top_right_neighbor_index = trapezoid_data.trapezoids[begin_trapezoid->index_by_type].top_right_neighbor_index;
-            next_node = trapezoid_data.trapezoids[top_right_neighbor_index].trapezoid_node;
+            set_right_neighbors(trapezoid_data.trapezoids[lower_index], last.top_right_neighbor_index, last.bottom_right_neighbor_index);
+            replace_left_neighbor(trapezoid_data, last.top_right_neighbor_index, crossed.back(), lower_index);
+            replace_left_neighbor(trapezoid_data, last.bottom_right_neighbor_index, crossed.back(), lower_index);
         }
-
-        // connect to existing
-        if (trapezoid_data.trapezoids[begin_trapezoid->index_by_type].left_end_index == begin_index)
+        else if (is_line_segment_to(last.bottom_line_segment_index, end_index))
         {
-            handle_first_trapezoid_with_existing_vertex(
-                trapezoid_data,
-                begin_trapezoid,
-                last_top_node,
-                last_bottom_node,
-                begin_index,
-                end_index,
-                line_index,
-                is_right_end_of_begin_trapezoid_over_line
-            );
+            set_right_neighbors(trapezoid_data.trapezoids[upper_index], last.top_right_neighbor_index, last.bottom_right_neighbor_index);
+            replace_left_neighbor(trapezoid_data, last.top_right_neighbor_index, crossed.back(), upper_index);
+            replace_left_neighbor(trapezoid_data, last.bottom_right_neighbor_index, crossed.back(), upper_index);
         }
         else
         {
-            handle_first_trapezoid_without_existing_vertex(
-                trapezoid_data, begin_trapezoid,
-                last_top_node, last_bottom_node,
-                begin_index, end_index,
-                line_index,
-                is_right_end_of_begin_trapezoid_over_line
-            );
+            set_right_neighbors(trapezoid_data.trapezoids[upper_index], last.top_right_neighbor_index, last.top_right_neighbor_index);
+            set_right_neighbors(trapezoid_data.trapezoids[lower_index], last.bottom_right_neighbor_index, last.bottom_right_neighbor_index);
+            replace_left_neighbor(trapezoid_data, last.top_right_neighbor_index, crossed.back(), upper_index);
+            replace_left_neighbor(trapezoid_data, last.bottom_right_neighbor_index, crossed.back(), lower_index);
         }
 
-        bool is_last_point_over_line = is_right_end_of_begin_trapezoid_over_line;
-
-        while (next_node != end_trapezoid)
+        // leaves of the crossed trapezoids become the search nodes of the parts, other nodes keep pointing to them
+        for (size_t i = 0; i < crossed.size(); ++i)
         {
-            std::shared_ptr<GraphNode> current_trapezoid = next_node;
-            bool const is_current_point_over_line = frm::is_point_over_line(
-                trapezoid_data.ends_of_line_segment[trapezoid_data.trapezoids[current_trapezoid->index_by_type].right_end_index],
-                { k, c }
-            );
+            std::shared_ptr<GraphNode> node = make_node(GraphNode::Type::YUnit, line_segment_index,
+                trapezoid_data.trapezoids[upper_indices[i]].trapezoid_node,
+                trapezoid_data.trapezoids[lower_indices[i]].trapezoid_node);
 
-            if (is_current_point_over_line)
+            if (i + 1 == crossed.size() && right_index != no_trapezoid)
             {
-                size_t const bottom_right_neighbor_index = trapezoid_data.trapezoids[current_trapezoid->index_by_type].bottom_right_neighbor_index;
-                next_node = trapezoid_data.trapezoids[bottom_right_neighbor_index].trapezoid_node;
+                node = make_node(GraphNode::Type::XUnit, end_index, node, trapezoid_data.trapezoids[right_index].trapezoid_node);
             }
-            else
+            if (i == 0 && left_index != no_trapezoid)
             {
-                size_t const top_right_neighbor_index = trapezoid_data.trapezoids[current_trapezoid->index_by_type].top_right_neighbor_index;
-                next_node = trapezoid_data.trapezoids[top_right_neighbor_index].trapezoid_node;
+                node = make_node(GraphNode::Type::XUnit, begin_index, trapezoid_data.trapezoids[left_index].trapezoid_node, node);
             }
 
-            handle_middle_trapezoid(
-                trapezoid_data,
-                current_trapezoid,
-                last_top_node,
-                last_bottom_node,
-                begin_index,
-                end_index,
-                line_index,
-                is_last_point_over_line,
-                is_current_point_over_line
-            );
-            is_last_point_over_line = is_current_point_over_line;
+            *old[i].trapezoid_node = std::move(*node);
+            trapezoid_data.trapezoids[crossed[i]].trapezoid_node.reset();
         }
+    }
 
-        // connect to existing
-        if (trapezoid_data.trapezoids[end_trapezoid->index_by_type].right_end_index == end_index)
+    // Removes the trapezoids replaced by insert_line_segment
+    void remove_replaced_trapezoids(TrapezoidData & trapezoid_data) noexcept
+    {
+        std::vector<size_t> new_indices(trapezoid_data.trapezoids.size(), no_trapezoid);
+
+        size_t count = 0;
+        for (size_t i = 0; i < trapezoid_data.trapezoids.size(); ++i)
         {
-            handle_last_trapezoid_with_existing_vertex(
-                trapezoid_data,
-                end_trapezoid,
-                last_top_node,
-                last_bottom_node,
-                begin_index,
-                end_index,
-                line_index,
-                is_last_point_over_line
-            );
+            if (trapezoid_data.trapezoids[i].trapezoid_node)
+            {
+                if (count != i)
+                {
+                    trapezoid_data.trapezoids[count] = std::move(trapezoid_data.trapezoids[i]);
+                }
+                new_indices[i] = count++;
+            }
         }
-        else
+        trapezoid_data.trapezoids.resize(count);
+
+        auto const get_new_index = [&new_indices](size_t index) noexcept
+            {
+                return index == no_trapezoid ? no_trapezoid : new_indices[index];
+            };
+
+        for (size_t i = 0; i < trapezoid_data.trapezoids.size(); ++i)
         {
-            handle_last_trapezoid_without_existing_vertex(
-                trapezoid_data,
-                end_trapezoid,
-                last_top_node,
-                last_bottom_node,
-                begin_index,
-                end_index,
-                line_index,
-                is_last_point_over_line
-            );
+            Trapezoid & trapezoid = trapezoid_data.trapezoids[i];
+
+            trapezoid.top_left_neighbor_index = get_new_index(trapezoid.top_left_neighbor_index);
+            trapezoid.bottom_left_neighbor_index = get_new_index(trapezoid.bottom_left_neighbor_index);
+            trapezoid.top_right_neighbor_index = get_new_index(trapezoid.top_right_neighbor_index);
+            trapezoid.bottom_right_neighbor_index = get_new_index(trapezoid.bottom_right_neighbor_index);
+            trapezoid.trapezoid_node->index_by_type = i;
         }
     }
 
-    trapezoid_data_and_graph_root_t generate_trapezoid_data_and_graph_root(frm::dcel::DCEL const & dcel) noexcept(!IS_DEBUG)
+    trapezoid_data_and_graph_root_t generate_trapezoid_data_and_graph_root(
+        frm::dcel::DCEL const & dcel,
+        std::atomic<bool> const * is_cancelled) noexcept(!IS_DEBUG)
     {
+        ProfileScope const scope{ "generate_trapezoid_data_and_graph_root" };
+        FRM_COUNT_OPERATION(generate_counters);
+
         TrapezoidData trapezoid_data{};
         std::shared_ptr<GraphNode> root;
 
@@ -1050,70 +513,37 @@ namespace frm
                 trapezoid_data.ends_of_line_segment[i] = dcel.vertices[i].coordinate;
             }
 
-            std::vector<LineSegment> double_edges(dcel.edges.size());
-
-            for (size_t i = 0; i < double_edges.size(); ++i)
+            // every pair of twin edges is a line segment from the left end to the right one,
+            // the incident face of an edge is on the left of it
+            for (size_t i = 0; i < dcel.edges.size(); ++i)
             {
+                size_t const twin_edge = dcel.edges[i].twin_edge;
+                if (!dcel.edges[i].is_exist || twin_edge < i)
+                {
+                    continue;
+                }
+
                 size_t first_vertex = dcel.edges[i].origin_vertex;
-                size_t second_vertex = dcel.edges[dcel.edges[i].twin_edge].origin_vertex;
+                size_t second_vertex = dcel.edges[twin_edge].origin_vertex;
+
+                size_t face_over_line = dcel.edges[i].incident_face;
+                size_t face_under_line = dcel.edges[twin_edge].incident_face;
 
                 frm::Point const begin = dcel.vertices[first_vertex].coordinate;
                 frm::Point const end = dcel.vertices[second_vertex].coordinate;
 
-                size_t face_over_line;
-                size_t face_under_line;
-
-                if (end.x - begin.x < frm::epsilon)
-                {
-                    face_under_line = dcel.edges[i].incident_face;
-                    face_over_line = dcel.edges[dcel.edges[i].twin_edge].incident_face;
-                }
-                else
+                if (begin.x == end.x && begin.y == end.y)
                 {
-                    face_over_line = dcel.edges[i].incident_face;
-                    face_under_line = dcel.edges[dcel.edges[i].twin_edge].incident_face;
+                    continue;
                 }
 
-                if (second_vertex > first_vertex)
+                if (is_point_right_of(begin, end))
                 {
                     std::swap(first_vertex, second_vertex);
+                    std::swap(face_over_line, face_under_line);
                 }
 
-                double_edges[i] = { first_vertex, second_vertex, face_over_line, face_under_line };
-            }
-
-            std::sort(double_edges.begin(), double_edges.end(), [&dcel](LineSegment a, LineSegment b) noexcept -> bool
-                {
-                    if (a.begin_index == b.begin_index)
-                    {
-                        return a.end_index < b.end_index;
-                    }
-                    return a.begin_index < b.begin_index;
-                });
-
-            trapezoid_data.line_segments.resize(double_edges.size() / 2);
-
-            for (size_t i = 0; i < double_edges.size(); i += 2)
-            {
-                trapezoid_data.line_segments[i / 2] = double_edges[i];
-            }
-
-            for (size_t i = 0; i < trapezoid_data.line_segments.size(); ++i)
-            {
-                size_t const begin_index = trapezoid_data.line_segments[i].begin_index;
-                size_t const end_index = trapezoid_data.line_segments[i].end_index;
-                frm::Point const begin = trapezoid_data.ends_of_line_segment[begin_index];
-                frm::Point const end = trapezoid_data.ends_of_line_segment[end_index];
-
-                if (begin.x - end.x > frm::epsilon)
-                {
-                    trapezoid_data.line_segments[i] = {
-                        end_index,
-                        begin_index,
-                        trapezoid_data.line_segments[i].face_over_line,
-                        trapezoid_data.line_segments[i].face_under_line
-                    };
-                }
+                trapezoid_data.line_segments.push_back({ first_vertex, second_vertex, face_over_line, face_under_line });
             }
 
             std::shuffle(trapezoid_data.line_segments.begin(), trapezoid_data.line_segments.end(), std::default_random_engine{});
@@ -1168,31 +598,16 @@ namespace frm
 
         for (size_t i = 0; i < trapezoid_data.line_segments.size() - 2; ++i)
         {
-            size_t const begin_index = trapezoid_data.line_segments[i].begin_index;
-            size_t const end_index = trapezoid_data.line_segments[i].end_index;
-
-            frm::Point const begin = trapezoid_data.ends_of_line_segment[begin_index];
-            frm::Point const end = trapezoid_data.ends_of_line_segment[end_index];
-
-            if (abs(begin.x - end.x) > frm::epsilon)
+            if (is_cancelled != nullptr && is_cancelled->load(std::memory_order_relaxed))
             {
-                frm::Point const begin_offseted = frm::lerp(begin, end, frm::epsilon * 10.f);
-                frm::Point const end_offseted = frm::lerp(end, begin, frm::epsilon * 10.f);
-
-                std::shared_ptr<GraphNode> begin_trapezoid = get_trapezoid_index(trapezoid_data, root, begin_offseted);
-                std::shared_ptr<GraphNode> end_trapezoid = get_trapezoid_index(trapezoid_data, root, end_offseted);
-
-                if (begin_trapezoid == end_trapezoid)
-                {
-                    handle_inside_one_trapezoid(trapezoid_data, begin_trapezoid, begin_index, end_index, i);
-                }
-                if (begin_trapezoid != end_trapezoid)
-                {
-                    handle_between_trapezoids(trapezoid_data, begin_trapezoid, end_trapezoid, begin_index, end_index, i);
-                }
+                return {};
             }
+
+            insert_line_segment(trapezoid_data, root, i);
         }
 
+        remove_replaced_trapezoids(trapezoid_data);
+
         trapezoid_data_and_graph_root_t trapezoid_data_and_graph_root{};
         trapezoid_data_and_graph_root.first = outside_face_index;
         trapezoid_data_and_graph_root.second.first = std::move(trapezoid_data);
@@ -1203,6 +618,8 @@ namespace frm
 
     size_t get_face_index(trapezoid_data_and_graph_root_t const & trapezoid_data_and_graph_root, frm::Point point) noexcept(!IS_DEBUG)
     {
+        FRM_COUNT(get_face_index_counter);
+
         std::shared_ptr<GraphNode> trapezoid_node = get_trapezoid_index(trapezoid_data_and_graph_root.second.first, trapezoid_data_and_graph_root.second.second, point);
 
         size_t const trapezoid_index = trapezoid_node->index_by_type;
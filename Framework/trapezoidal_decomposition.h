@@ -3,6 +3,8 @@
 
 #include "dcel.h"
 
+#include <atomic>
+
 
 namespace frm
 {
@@ -62,7 +64,10 @@ namespace frm
     using trapezoid_data_and_graph_root_t = std::pair<size_t, std::pair<TrapezoidData, std::shared_ptr<GraphNode>>>;
 
     // O(nlog(n))
-    trapezoid_data_and_graph_root_t generate_trapezoid_data_and_graph_root(frm::dcel::DCEL const & dcel) noexcept(!IS_DEBUG);
+    // is_cancelled - checked before every inserted segment, a cancelled build returns an empty map without root
+    trapezoid_data_and_graph_root_t generate_trapezoid_data_and_graph_root(
+        frm::dcel::DCEL const & dcel,
+        std::atomic<bool> const * is_cancelled = nullptr) noexcept(!IS_DEBUG);
 
 
     // O(log(n))
@@ -1,5 +1,9 @@
 #include "triangulation.h"
 
+#include "predicates.h"
+#include "profiler.h"
+#include "counters.h"
+
 #include "imgui/imgui.h"
 
 #include <set>
@@ -8,6 +12,11 @@
 
 namespace frm
 {
+    // diagonals splitting the faces into y-monotone ones and the y-monotone faces into triangles
+    FRM_COUNTER(monotone_diagonals_counter, "triangulation/monotone_diagonals", nullptr);
+    FRM_COUNTER(triangle_diagonals_counter, "triangulation/triangle_diagonals", nullptr);
+    FRM_OPERATION_COUNTERS(triangulation_counters, "triangulation");
+
     size_t get_edges_count_in_face(dcel::DCEL & dcel, size_t face_index) noexcept
     {
         size_t const begin = dcel.faces[face_index].edge;
@@ -62,7 +71,28 @@ namespace frm
         Point const to_point = dcel.vertices[to_vertex_index].coordinate;
         Point const wall_point = dcel.vertices[wall_vertex_index].coordinate;
 
-        return (is_left_side == std::signbit((to_point.x - from_point.x) * (wall_point.y - from_point.y) - (to_point.y - from_point.y) * (wall_point.x - from_point.x)));
+        // strict on both sides, a collinear wall vertex would be on the diagonal
+        int const orientation = get_orientation(from_point, to_point, wall_point);
+        return is_left_side ? orientation < 0 : orientation > 0;
+    }
+
+    // Edge from the origin of from_edge_index in the face of to_edge_index
+    size_t get_edge_in_face_of(dcel::DCEL const & dcel, size_t from_edge_index, size_t to_edge_index) noexcept
+    {
+        size_t const face_index = dcel.edges[to_edge_index].incident_face;
+        size_t current_index = from_edge_index;
+
+        do
+        {
+            if (dcel.edges[current_index].incident_face == face_index)
+            {
+                return current_index;
+            }
+
+            current_index = dcel.edges[dcel.edges[current_index].twin_edge].next_edge;
+        } while (current_index != from_edge_index);
+
+        return from_edge_index;
     }
 
     void triangulation_y_monotone(dcel::DCEL & dcel, size_t face_index) noexcept
@@ -124,6 +154,7 @@ namespace frm
                 {
                     size_t const current_edge_index = stack.back();
                     stack.pop_back();
+                    FRM_COUNT(triangle_diagonals_counter);
                     std::pair<size_t, size_t> new_edges_index = dcel::add_edge_between_two_edges(dcel, current_right_edge, edges[current_edge_index].first);
                     if (last_left_edge == std::numeric_limits<size_t>::max())
                     {
@@ -200,6 +231,7 @@ namespace frm
 
                 while (!stack.empty() && is_diagonal(dcel, edges[i].first, edges[stack.back()].first, edges[current_edge_index].first, edges[i].second))
                 {
+                    FRM_COUNT(triangle_diagonals_counter);
                     std::pair<size_t, size_t> new_edges_index = dcel::add_edge_between_two_edges(dcel, edges[i].first, edges[stack.back()].first);
                     if (edges[i].second)
                     {
@@ -245,7 +277,11 @@ namespace frm
         {
             size_t const current_edge_index = stack.back();
             stack.pop_back();
-            dcel::add_edge_between_two_edges(dcel, edges.back().first, edges[stack.back()].first);
+
+            // the previous diagonal may have left the edge of the bottom vertex in the cut off triangle
+            size_t const bottom_edge_index = get_edge_in_face_of(dcel, edges.back().first, edges[stack.back()].first);
+            FRM_COUNT(triangle_diagonals_counter);
+            dcel::add_edge_between_two_edges(dcel, bottom_edge_index, edges[stack.back()].first);
         }
     }
 
@@ -434,11 +470,6 @@ namespace frm
         return { current_edge_index, { previous_edge_to_current_index, next_edge_after_current_index } };
     }
 
-    float get_intersection_line_with_horizontal_line(Point begin, Point end, float y) noexcept
-    {
-        return begin.x + (y - begin.y) * (begin.x - end.x) / (begin.y - end.y);
-    }
-
     enum VertexType
     {
         Undefined       = 0b0000'0000,
@@ -487,49 +518,55 @@ namespace frm
         return a.begin_vertex_index < b.begin_vertex_index;
     };
 
+    // ends of the edge in the sweep order, the sweep line crosses it between them
+    std::pair<Point, Point> get_swept_edge(dcel::DCEL const & dcel, StatusComponent const & status_component) noexcept
+    {
+        Point const begin = dcel.vertices[status_component.begin_vertex_index].coordinate;
+        Point const end = dcel.vertices[status_component.end_vertex_index].coordinate;
+
+        return compare_point_by_y(begin, end) > 0 ? std::make_pair(begin, end) : std::make_pair(end, begin);
+    }
+
+    // true if the first edge is to the right of the second one on the sweep line crossing both,
+    // the edges don't cross, the later of the first points is compared with the other edge
+    bool is_edge_on_right_side(std::pair<Point, Point> first, std::pair<Point, Point> second) noexcept
+    {
+        if (compare_point_by_y(first.first, second.first) < 0)
+        {
+            int const orientation = get_orientation(second.first, second.second, first.first);
+            return (orientation != 0 ? orientation : get_orientation(second.first, second.second, first.second)) < 0;
+        }
+
+        int const orientation = get_orientation(first.first, first.second, second.first);
+        return (orientation != 0 ? orientation : get_orientation(first.first, first.second, second.second)) > 0;
+    }
+
+    // exact, the edges of the status are compared by the side the vertex or the other edge is on
     std::set<StatusComponent, decltype(status_component_comparator)>::iterator get_nearest_left_component(
         dcel::DCEL const & dcel,
         std::set<StatusComponent, decltype(status_component_comparator)> & status,
         size_t current_vertex_index
     ) noexcept
     {
-        auto nearest_left_component = status.begin();
+        auto nearest_left_component = status.end();
+        std::pair<Point, Point> nearest_left_edge{};
 
         Point const current_point = dcel.vertices[current_vertex_index].coordinate;
-        float nearest_x = -1000000000.f;
 
-        auto current_iterator = status.begin();
-        for (; current_iterator != status.end(); ++current_iterator)
+        for (auto current_iterator = status.begin(); current_iterator != status.end(); ++current_iterator)
         {
-            StatusComponent const & status_component = *current_iterator;
-            Point const begin = dcel.vertices[status_component.begin_vertex_index].coordinate;
-            Point const end = dcel.vertices[status_component.end_vertex_index].coordinate;
+            std::pair<Point, Point> const edge = get_swept_edge(dcel, *current_iterator);
 
-            if (abs(begin.y - end.y) < epsilon)
+            // the vertex is on the right side of the edge going up the sweep
+            if (get_orientation(edge.first, edge.second, current_point) < 0 &&
+                (nearest_left_component == status.end() || is_edge_on_right_side(edge, nearest_left_edge)))
             {
-                if (begin.x < current_point.x && begin.x > nearest_x)
-                {
-                    nearest_x = begin.x;
-                    nearest_left_component = current_iterator;
-                }
-                if (end.x < current_point.x && end.x > nearest_x)
-                {
-                    nearest_x = end.x;
-                    nearest_left_component = current_iterator;
-                }
-            }
-            else
-            {
-                float const x_position = get_intersection_line_with_horizontal_line(begin, end, current_point.y);
-
-                if (x_position < current_point.x && x_position > nearest_x)
-                {
-                    nearest_x = x_position;
-                    nearest_left_component = current_iterator;
-                }
+                nearest_left_component = current_iterator;
+                nearest_left_edge = edge;
             }
         }
-        return nearest_left_component;
+
+        return nearest_left_component == status.end() ? status.begin() : nearest_left_component;
     }
 
     void handle_start(
@@ -607,6 +644,7 @@ namespace frm
                         next_neighbour_after_helper
                     ).first;
 
+                FRM_COUNT(monotone_diagonals_counter);
                 dcel::add_edge_between_two_edges(dcel, current_edge_index, helper_edge_index);
             }
         }
@@ -650,6 +688,7 @@ namespace frm
                 next_neighbour_after_helper
             ).first;
 
+        FRM_COUNT(monotone_diagonals_counter);
         dcel::add_edge_between_two_edges(dcel, current_edge_index, helper_edge_index);
 
         status.erase(nearest_left_component);
@@ -719,6 +758,7 @@ namespace frm
                         next_neighbour_after_helper
                     ).first;
 
+                FRM_COUNT(monotone_diagonals_counter);
                 dcel::add_edge_between_two_edges(dcel, current_edge_index, helper_edge_index);
 
                 future_next_neighbour = helper;
@@ -754,6 +794,7 @@ namespace frm
                     next_neighbour_after_helper
                 ).first;
 
+            FRM_COUNT(monotone_diagonals_counter);
             dcel::add_edge_between_two_edges(dcel, current_edge_index, helper_edge_index);
 
             future_previous_neighbour = helper;
@@ -793,6 +834,8 @@ namespace frm
 
         auto iterator_to_status_component = status.find(status_component);
 
+        size_t future_next_neighbour = vertex_neighbours[vertex_index].second;
+
         if (iterator_to_status_component == status.end())
         {
             assert(false && "Status error: existing component not found");
@@ -814,7 +857,11 @@ namespace frm
                         next_neighbour_after_helper
                     ).first;
 
+                FRM_COUNT(monotone_diagonals_counter);
                 dcel::add_edge_between_two_edges(dcel, current_edge_index, helper_edge_index);
+
+                // the diagonal to the helper bounds the part of the face that is still swept
+                future_next_neighbour = helper;
             }
         }
 
@@ -825,7 +872,7 @@ namespace frm
         new_status_component.end_vertex_index = dcel.edges[previous_edge_to_current_index].origin_vertex;
         new_status_component.helper = vertex_index;
         new_status_component.previous_neighbour_to_helper = vertex_neighbours[vertex_index].first;
-        new_status_component.next_neighbour_after_helper = vertex_neighbours[vertex_index].second;
+        new_status_component.next_neighbour_after_helper = future_next_neighbour;
 
         status.insert(new_status_component);
     }
@@ -871,6 +918,7 @@ namespace frm
                     next_neighbour_after_helper
                 ).first;
 
+            FRM_COUNT(monotone_diagonals_counter);
             dcel::add_edge_between_two_edges(dcel, current_edge_index, helper_edge_index);
 
             future_previous_neighbour = helper;
@@ -884,8 +932,27 @@ namespace frm
         status.insert(nearest_left);
     }
 
-    void triangulation(dcel::DCEL & dcel) noexcept
+    // vertices swept between the checks of the cancellation
+    static constexpr size_t triangulation_progress_step = 256;
+
+    void triangulation(dcel::DCEL & dcel, std::atomic<bool> const * is_cancelled, std::atomic<float> * progress) noexcept
     {
+        ProfileScope const scope{ "triangulation" };
+        FRM_COUNT_OPERATION(triangulation_counters);
+
+        auto const is_stopped = [is_cancelled]() noexcept
+        {
+            return is_cancelled != nullptr && is_cancelled->load(std::memory_order_relaxed);
+        };
+
+        auto const report_progress = [progress](float value) noexcept
+        {
+            if (progress != nullptr)
+            {
+                progress->store(value, std::memory_order_relaxed);
+            }
+        };
+
         std::set<size_t> const & outside_faces = get_outside_faces(dcel);
 
         std::vector<VertexType> vertex_types(dcel.vertices.size(), VertexType::Undefined);
@@ -915,40 +982,26 @@ namespace frm
             Point const previous_point = dcel.vertices[dcel.edges[previous_edge_to_current_index].origin_vertex].coordinate;
             Point const next_point = dcel.vertices[dcel.edges[next_edge_after_current_index].origin_vertex].coordinate;
 
-            float const angle = angle_between_vectors(previous_point - current_point, next_point - current_point);
+            // exact sign of the angle from the previous neighbor to the next one, < 0 - convex vertex
+            int const orientation = get_orientation(current_point, previous_point, next_point);
 
-            if (current_point.y < previous_point.y && current_point.y <= next_point.y && angle < epsilon)
-            {
-                vertex_types[i] = VertexType::Start;
-            }
-            else if (current_point.y <= previous_point.y && current_point.y < next_point.y && angle > -epsilon)
-            {
-                vertex_types[i] = VertexType::Split;
-            }
-            else if (current_point.y > previous_point.y && current_point.y >= next_point.y && angle < epsilon)
-            {
-                vertex_types[i] = VertexType::End;
-            }
-            else if (current_point.y >= previous_point.y && current_point.y > next_point.y && angle > -epsilon)
+            // same exact order as the sweep, so vertices with equal y get consistent types
+            bool const is_under_previous = compare_point_by_y(current_point, previous_point) > 0;
+            bool const is_under_next = compare_point_by_y(current_point, next_point) > 0;
+
+            if (is_under_previous && is_under_next)
             {
-                vertex_types[i] = VertexType::Merge;
+                vertex_types[i] = orientation < 0 ? VertexType::Start : VertexType::Split;
             }
-            else if (abs(current_point.y - next_point.y) < epsilon && abs(current_point.y - previous_point.y) < epsilon)
+            else if (!is_under_previous && !is_under_next)
             {
-                if (current_point.x < next_point.x)
-                {
-                    vertex_types[i] = VertexType::RegularRight;
-                }
-                else
-                {
-                    vertex_types[i] = VertexType::RegularLeft;
-                }
+                vertex_types[i] = orientation < 0 ? VertexType::End : VertexType::Merge;
             }
-            else if (current_point.y >= next_point.y && current_point.y <= previous_point.y)
+            else if (is_under_previous)
             {
                 vertex_types[i] = VertexType::RegularLeft;
             }
-            else if (current_point.y <= next_point.y && current_point.y >= previous_point.y)
+            else
             {
                 vertex_types[i] = VertexType::RegularRight;
             }
@@ -978,15 +1031,8 @@ namespace frm
 
         std::sort(vertices.begin(), vertices.end(), [&dcel](size_t a, size_t b) noexcept -> bool
             {
-                frm::Point point_a = dcel.vertices[a].coordinate;
-                frm::Point point_b = dcel.vertices[b].coordinate;
-
-                if (abs(point_a.y - point_b.y) < frm::epsilon)
-                {
-                    return point_a.x < point_b.x;
-                }
-
-                return point_a.y < point_b.y;
+                // exact, an epsilon makes the order intransitive and breaks the sort
+                return compare_point_by_y(dcel.vertices[a].coordinate, dcel.vertices[b].coordinate) > 0;
             });
 
         std::set<StatusComponent, decltype(status_component_comparator)> status(status_component_comparator);
@@ -1023,6 +1069,15 @@ namespace frm
 
         for (size_t i = 0; i < vertices.size(); ++i)
         {
+            if (i % triangulation_progress_step == 0)
+            {
+                if (is_stopped())
+                {
+                    return;
+                }
+                report_progress(0.5f * static_cast<float>(i) / static_cast<float>(vertices.size()));
+            }
+
             if (vertex_types_second[vertices[i]] == VertexType::Undefined)
             {
                 handle_vertex(vertex_neighbours, vertex_types, vertices[i]);
@@ -1048,9 +1103,17 @@ namespace frm
         {
             if (!is_outside_face(dcel, outside_faces, i))
             {
+                if (is_stopped())
+                {
+                    return;
+                }
+                report_progress(0.5f + 0.5f * static_cast<float>(i) / static_cast<float>(face_count));
+
                 triangulation_y_monotone(dcel, i);
             }
         }
+
+        report_progress(1.f);
     }
 
     bool spawn_triangulation_button(dcel::DCEL & dcel) noexcept
@@ -3,10 +3,17 @@
 
 #include "dcel.h"
 
+#include <atomic>
+
 
 namespace frm
 {
-    void triangulation(dcel::DCEL & dcel) noexcept;
+    // is_cancelled - checked while the vertices are swept and before every y-monotone face,
+    // a cancelled triangulation leaves dcel with a part of the diagonals
+    // progress - [0, 1], the sweep is the first half and the y-monotone faces the second one
+    void triangulation(dcel::DCEL & dcel,
+        std::atomic<bool> const * is_cancelled = nullptr,
+        std::atomic<float> * progress = nullptr) noexcept;
 
     bool spawn_triangulation_button(dcel::DCEL & dcel) noexcept;
 }
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include "view_culling.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+namespace frm
+{
+    // cells along a side of a grid, so a grid of a huge map stays in memory
+    static constexpr size_t max_grid_side = 1024;
+    // a segment is stored in every cell of its box, long segments make the grid coarser
+    static constexpr size_t max_grid_cells_per_segment = 8;
+
+    void extend_box(Box & box, Point point) noexcept
+    {
+        box.min.x = std::min(box.min.x, point.x);
+        box.min.y = std::min(box.min.y, point.y);
+        box.max.x = std::max(box.max.x, point.x);
+        box.max.y = std::max(box.max.y, point.y);
+    }
+
+    bool is_boxes_intersected(Box const & first, Box const & second) noexcept
+    {
+        return first.min.x <= second.max.x && second.min.x <= first.max.x &&
+            first.min.y <= second.max.y && second.min.y <= first.max.y;
+    }
+
+    bool is_box_inside(Box const & inner, Box const & outer) noexcept
+    {
+        return inner.min.x >= outer.min.x && inner.max.x <= outer.max.x &&
+            inner.min.y >= outer.min.y && inner.max.y <= outer.max.y;
+    }
+
+    bool is_point_in_box(Box const & box, Point point) noexcept
+    {
+        return point.x >= box.min.x && point.x <= box.max.x && point.y >= box.min.y && point.y <= box.max.y;
+    }
+
+    Box get_view_box(sf::RenderWindow const & window) noexcept
+    {
+        sf::Vector2f const center = window.getView().getCenter();
+        sf::Vector2f const size = window.getView().getSize();
+
+        // size is negative for flipped views
+        Point const half_size{ std::abs(size.x) / 2.f, std::abs(size.y) / 2.f };
+
+        return { { center.x - half_size.x, center.y - half_size.y }, { center.x + half_size.x, center.y + half_size.y } };
+    }
+
+    float get_pixel_size(sf::RenderWindow const & window) noexcept
+    {
+        unsigned const width = window.getSize().x;
+
+        return width == 0 ? 1.f : std::abs(window.getView().getSize().x) / static_cast<float>(width);
+    }
+
+    Box get_segment_box(segment_t const & segment) noexcept
+    {
+        Box box{ segment.first, segment.first };
+        extend_box(box, segment.second);
+        return box;
+    }
+
+    size_t get_cell_index(float coordinate, float min, float cell_size, size_t cells_count) noexcept
+    {
+        float const index = std::floor((coordinate - min) / cell_size);
+
+        if (!(index > 0.f))
+        {
+            return 0;
+        }
+
+        return std::min(static_cast<size_t>(std::min(index, static_cast<float>(cells_count))), cells_count - 1);
+    }
+
+    void build_segment_grid(SegmentGrid & grid) noexcept
+    {
+        grid.bounds = empty_box;
+        for (segment_t const & segment : grid.segments)
+        {
+            extend_box(grid.bounds, segment.first);
+            extend_box(grid.bounds, segment.second);
+        }
+
+        size_t side = std::clamp(static_cast<size_t>(std::ceil(std::sqrt(static_cast<float>(grid.segments.size())))), size_t{ 1 }, max_grid_side);
+
+        auto const set_side = [&grid](size_t cells_side) noexcept
+        {
+            grid.columns = cells_side;
+            grid.rows = cells_side;
+
+            grid.cell_size = {
+                std::max((grid.bounds.max.x - grid.bounds.min.x) / static_cast<float>(grid.columns), epsilon),
+                std::max((grid.bounds.max.y - grid.bounds.min.y) / static_cast<float>(grid.rows), epsilon) };
+        };
+
+        // cells of the boxes of all segments, counting stops above the limit
+        size_t const max_cells_count = max_grid_cells_per_segment * grid.segments.size();
+        auto const get_cells_count = [&grid, max_cells_count]() noexcept
+        {
+            size_t cells_count = 0;
+
+            for (size_t i = 0; i < grid.segments.size() && cells_count <= max_cells_count; ++i)
+            {
+                Box const box = get_segment_box(grid.segments[i]);
+
+                cells_count +=
+                    (get_cell_index(box.max.x, grid.bounds.min.x, grid.cell_size.x, grid.columns) -
+                        get_cell_index(box.min.x, grid.bounds.min.x, grid.cell_size.x, grid.columns) + 1) *
+                    (get_cell_index(box.max.y, grid.bounds.min.y, grid.cell_size.y, grid.rows) -
+                        get_cell_index(box.min.y, grid.bounds.min.y, grid.cell_size.y, grid.rows) + 1);
+            }
+
+            return cells_count;
+        };
+
+        set_side(side);
+        while (side > 1 && get_cells_count() > max_cells_count)
+        {
+            side /= 2;
+            set_side(side);
+        }
+
+        // calls on_cell for every cell overlapped by the box of the segment
+        auto const for_each_cell = [&grid](segment_t const & segment, auto const & on_cell) noexcept
+        {
+            Box const box = get_segment_box(segment);
+
+            size_t const min_column = get_cell_index(box.min.x, grid.bounds.min.x, grid.cell_size.x, grid.columns);
+            size_t const max_column = get_cell_index(box.max.x, grid.bounds.min.x, grid.cell_size.x, grid.columns);
+            size_t const min_row = get_cell_index(box.min.y, grid.bounds.min.y, grid.cell_size.y, grid.rows);
+            size_t const max_row = get_cell_index(box.max.y, grid.bounds.min.y, grid.cell_size.y, grid.rows);
+
+            for (size_t row = min_row; row <= max_row; ++row)
+            {
+                for (size_t column = min_column; column <= max_column; ++column)
+                {
+                    on_cell(row * grid.columns + column);
+                }
+            }
+        };
+
+        // counting sort of the segments by cell
+        grid.cell_offsets.assign(grid.columns * grid.rows + 1, 0);
+        for (segment_t const & segment : grid.segments)
+        {
+            for_each_cell(segment, [&grid](size_t cell) noexcept
+                {
+                    ++grid.cell_offsets[cell + 1];
+                });
+        }
+        for (size_t i = 1; i < grid.cell_offsets.size(); ++i)
+        {
+            grid.cell_offsets[i] += grid.cell_offsets[i - 1];
+        }
+
+        grid.cell_segments.resize(grid.cell_offsets.back());
+        std::vector<size_t> next_positions(grid.cell_offsets.begin(), grid.cell_offsets.end() - 1);
+        for (size_t i = 0; i < grid.segments.size(); ++i)
+        {
+            for_each_cell(grid.segments[i], [&grid, &next_positions, i](size_t cell) noexcept
+                {
+                    grid.cell_segments[next_positions[cell]++] = i;
+                });
+        }
+
+        grid.segment_queries.assign(grid.segments.size(), 0);
+        grid.query = 0;
+    }
+
+    void query_segment_grid(SegmentGrid & grid, Box const & box, std::vector<size_t> & segment_indices) noexcept
+    {
+        if (grid.segments.empty() || !is_boxes_intersected(box, grid.bounds))
+        {
+            return;
+        }
+
+        ++grid.query;
+
+        size_t const min_column = get_cell_index(box.min.x, grid.bounds.min.x, grid.cell_size.x, grid.columns);
+        size_t const max_column = get_cell_index(box.max.x, grid.bounds.min.x, grid.cell_size.x, grid.columns);
+        size_t const min_row = get_cell_index(box.min.y, grid.bounds.min.y, grid.cell_size.y, grid.rows);
+        size_t const max_row = get_cell_index(box.max.y, grid.bounds.min.y, grid.cell_size.y, grid.rows);
+
+        for (size_t row = min_row; row <= max_row; ++row)
+        {
+            for (size_t column = min_column; column <= max_column; ++column)
+            {
+                size_t const cell = row * grid.columns + column;
+
+                for (size_t i = grid.cell_offsets[cell]; i < grid.cell_offsets[cell + 1]; ++i)
+                {
+                    size_t const segment_index = grid.cell_segments[i];
+
+                    if (grid.segment_queries[segment_index] != grid.query)
+                    {
+                        grid.segment_queries[segment_index] = grid.query;
+
+                        // cells are larger than the box, so the segment itself is checked too
+                        if (is_boxes_intersected(box, get_segment_box(grid.segments[segment_index])))
+                        {
+                            segment_indices.push_back(segment_index);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    bool is_visible_geometry_outdated(VisibleGeometry const & geometry,
+        Box const & view_box,
+        float pixel_size,
+        size_t version,
+        sf::Color const & color) noexcept
+    {
+        return geometry.version != version ||
+            geometry.color != color ||
+            geometry.pixel_size != pixel_size ||
+            geometry.view_box.min.x != view_box.min.x ||
+            geometry.view_box.min.y != view_box.min.y ||
+            geometry.view_box.max.x != view_box.max.x ||
+            geometry.view_box.max.y != view_box.max.y;
+    }
+
+    void begin_visible_geometry(VisibleGeometry & geometry,
+        Box const & view_box,
+        float pixel_size,
+        size_t version,
+        sf::Color const & color) noexcept
+    {
+        geometry.lines.clear();
+        geometry.points.clear();
+        geometry.markers.vertices.clear();
+        geometry.merged_pixels.clear();
+
+        geometry.view_box = view_box;
+        geometry.pixel_size = pixel_size;
+        geometry.version = version;
+        geometry.color = color;
+    }
+
+    // pixel of the view the point falls into, packed as row << 32 | column
+    void merge_into_pixel(VisibleGeometry & geometry, Point point) noexcept
+    {
+        if (!is_boxes_intersected(geometry.view_box, { point, point }))
+        {
+            return;
+        }
+
+        uint64_t const column = static_cast<uint64_t>((point.x - geometry.view_box.min.x) / geometry.pixel_size);
+        uint64_t const row = static_cast<uint64_t>((point.y - geometry.view_box.min.y) / geometry.pixel_size);
+
+        geometry.merged_pixels.push_back(row << 32 | column);
+    }
+
+    void add_visible_segments(VisibleGeometry & geometry, SegmentGrid & grid) noexcept
+    {
+        geometry.segment_indices.clear();
+        query_segment_grid(grid, geometry.view_box, geometry.segment_indices);
+
+        for (size_t const segment_index : geometry.segment_indices)
+        {
+            segment_t const & segment = grid.segments[segment_index];
+
+            float const length = std::max(std::abs(segment.second.x - segment.first.x), std::abs(segment.second.y - segment.first.y));
+
+            if (length < geometry.pixel_size)
+            {
+                merge_into_pixel(geometry, lerp(segment.first, segment.second, 0.5f));
+            }
+            else
+            {
+                geometry.lines.push_back({ { segment.first.x, segment.first.y }, geometry.color });
+                geometry.lines.push_back({ { segment.second.x, segment.second.y }, geometry.color });
+            }
+        }
+    }
+
+    void add_visible_vertices(VisibleGeometry & geometry, SegmentGrid & grid, float radius) noexcept
+    {
+        // markers reach into the view from points outside of it
+        Box const marker_box{
+            { geometry.view_box.min.x - radius, geometry.view_box.min.y - radius },
+            { geometry.view_box.max.x + radius, geometry.view_box.max.y + radius } };
+
+        geometry.segment_indices.clear();
+        query_segment_grid(grid, marker_box, geometry.segment_indices);
+
+        bool const is_merged = 2.f * radius < geometry.pixel_size;
+
+        for (size_t const segment_index : geometry.segment_indices)
+        {
+            Point const point = grid.segments[segment_index].first;
+
+            if (is_merged)
+            {
+                merge_into_pixel(geometry, point);
+            }
+            else
+            {
+                add_vertex_marker(geometry.markers, point, geometry.color, radius);
+            }
+        }
+    }
+
+    void end_visible_geometry(VisibleGeometry & geometry) noexcept
+    {
+        std::sort(geometry.merged_pixels.begin(), geometry.merged_pixels.end());
+        geometry.merged_pixels.erase(std::unique(geometry.merged_pixels.begin(), geometry.merged_pixels.end()), geometry.merged_pixels.end());
+
+        geometry.points.reserve(geometry.merged_pixels.size());
+
+        for (uint64_t const pixel : geometry.merged_pixels)
+        {
+            float const column = static_cast<float>(pixel & 0xFFFFFFFF);
+            float const row = static_cast<float>(pixel >> 32);
+
+            geometry.points.push_back({ {
+                    geometry.view_box.min.x + (column + 0.5f) * geometry.pixel_size,
+                    geometry.view_box.min.y + (row + 0.5f) * geometry.pixel_size },
+                geometry.color });
+        }
+    }
+
+    void draw(VisibleGeometry const & geometry, sf::RenderWindow & window) noexcept
+    {
+        window.draw(geometry.lines.data(), geometry.lines.size(), sf::Lines);
+        window.draw(geometry.points.data(), geometry.points.size(), sf::Points);
+        draw(geometry.markers, window);
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+
+#include "common.h"
+#include "common_ui_part.h"
+
+#include "SFML\Graphics.hpp"
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+
+namespace frm
+{
+    // axis aligned bounding box
+    struct Box
+    {
+        Point min;
+        Point max;
+    };
+
+    // box that contains nothing, any point extends it
+    static constexpr Box empty_box{
+        { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() },
+        { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() } };
+
+    void extend_box(Box & box, Point point) noexcept;
+
+    bool is_boxes_intersected(Box const & first, Box const & second) noexcept;
+    bool is_box_inside(Box const & inner, Box const & outer) noexcept;
+    bool is_point_in_box(Box const & box, Point point) noexcept;
+
+    // part of the world shown by the current view of the window
+    Box get_view_box(sf::RenderWindow const & window) noexcept;
+
+    // world units per pixel of the current view of the window
+    float get_pixel_size(sf::RenderWindow const & window) noexcept;
+
+    // Views zoomed out further than this are drawn with the level of detail of VisibleGeometry
+    static constexpr float lod_pixel_size = 1.f;
+
+    using segment_t = std::pair<Point, Point>;
+
+    Box get_segment_box(segment_t const & segment) noexcept;
+
+    // Uniform grid over the bounding boxes of segments,
+    // a segment is stored in every cell its box overlaps.
+    // Points are stored as segments of zero length.
+    struct SegmentGrid
+    {
+        std::vector<segment_t> segments{};
+
+        Box bounds{ empty_box };
+        Point cell_size{};
+        size_t columns{ 0 };
+        size_t rows{ 0 };
+
+        // segments of cell i: cell_segments[cell_offsets[i], cell_offsets[i + 1])
+        std::vector<size_t> cell_offsets{};
+        std::vector<size_t> cell_segments{};
+
+        // last query that reported the segment, so segments of several cells are reported once
+        std::vector<size_t> segment_queries{};
+        size_t query{ 0 };
+    };
+
+    // builds cells of grid.segments
+    void build_segment_grid(SegmentGrid & grid) noexcept;
+
+    // column or row of the coordinate, clamped to the grid
+    size_t get_cell_index(float coordinate, float min, float cell_size, size_t cells_count) noexcept;
+
+    // indices of the segments with a bounding box intersecting the box, every segment once
+    void query_segment_grid(SegmentGrid & grid, Box const & box, std::vector<size_t> & segment_indices) noexcept;
+
+    // Part of a map inside a view.
+    // Segments shorter than a pixel and vertex markers smaller than a pixel
+    // are merged into a single point per pixel they fall into.
+    struct VisibleGeometry
+    {
+        std::vector<sf::Vertex> lines{};
+        std::vector<sf::Vertex> points{};
+        MarkerBatch markers{};
+
+        Box view_box{ empty_box };
+        float pixel_size{ 0.f };
+        size_t version{ std::numeric_limits<size_t>::max() };
+        sf::Color color{};
+
+        // per frame storage, kept to avoid allocations
+        std::vector<size_t> segment_indices{};
+        std::vector<uint64_t> merged_pixels{};
+    };
+
+    // true if the geometry was built for another view or map
+    bool is_visible_geometry_outdated(VisibleGeometry const & geometry,
+        Box const & view_box,
+        float pixel_size,
+        size_t version,
+        sf::Color const & color) noexcept;
+
+    void begin_visible_geometry(VisibleGeometry & geometry,
+        Box const & view_box,
+        float pixel_size,
+        size_t version,
+        sf::Color const & color) noexcept;
+
+    void add_visible_segments(VisibleGeometry & geometry, SegmentGrid & grid) noexcept;
+
+    // grid of points, every point gets a vertex marker of the radius
+    void add_visible_vertices(VisibleGeometry & geometry, SegmentGrid & grid, float radius) noexcept;
+
+    // turns the merged pixels into points
+    void end_visible_geometry(VisibleGeometry & geometry) noexcept;
+
+    void draw(VisibleGeometry const & geometry, sf::RenderWindow & window) noexcept;
+}
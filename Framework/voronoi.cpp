@@ -0,0 +1,1152 @@
+#include "voronoi.h"
+
+#include "generators.h"
+#include "predicates.h"
+#include "profiler.h"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+
+namespace frm
+{
+    static constexpr size_t no_site = std::numeric_limits<size_t>::max();
+
+    // Delaunay triangulation grown from a seed triangle by the points in the order of their distance from its circumcenter,
+    // every point is outside of the hull of the previous ones, so it only adds triangles over the hull edges it sees.
+    // Triangle t is triangles[3t, 3t + 3) counterclockwise, half-edge e goes from triangles[e] to the next vertex of its triangle.
+    struct RadialSweep
+    {
+        std::vector<Point> const & points;
+
+        std::vector<size_t> triangles{};
+        // half-edge of the neighbor triangle, no_site on the hull
+        std::vector<size_t> opposite_edges{};
+
+        // counterclockwise hull, removed vertices are their own next vertices
+        std::vector<size_t> hull_next{};
+        std::vector<size_t> hull_previous{};
+        // half-edge of a triangle along the hull edge from the vertex
+        std::vector<size_t> hull_edges{};
+        size_t hull_start{ no_site };
+
+        std::vector<size_t> edge_stack{};
+    };
+
+    size_t get_next_half_edge(size_t edge) noexcept
+    {
+        return edge - edge % 3 + (edge + 1) % 3;
+    }
+
+    void link_half_edges(RadialSweep & sweep, size_t first, size_t second) noexcept
+    {
+        sweep.opposite_edges[first] = second;
+        if (second != no_site)
+        {
+            sweep.opposite_edges[second] = first;
+        }
+    }
+
+    size_t add_triangle(RadialSweep & sweep,
+        size_t first,
+        size_t second,
+        size_t third,
+        size_t first_opposite,
+        size_t second_opposite,
+        size_t third_opposite) noexcept
+    {
+        size_t const triangle = sweep.triangles.size();
+
+        sweep.triangles.insert(sweep.triangles.end(), { first, second, third });
+        sweep.opposite_edges.insert(sweep.opposite_edges.end(), { no_site, no_site, no_site });
+
+        link_half_edges(sweep, triangle, first_opposite);
+        link_half_edges(sweep, triangle + 1, second_opposite);
+        link_half_edges(sweep, triangle + 2, third_opposite);
+
+        return triangle;
+    }
+
+    // Flips the edge while the opposite vertex is inside of the circumcircle, then the edges it uncovers.
+    // Returns the half-edge before the given one in its triangle after the flips.
+    size_t legalize_edge(RadialSweep & sweep, size_t edge) noexcept
+    {
+        std::vector<size_t> & stack = sweep.edge_stack;
+        std::vector<size_t> & triangles = sweep.triangles;
+        std::vector<size_t> & opposite_edges = sweep.opposite_edges;
+
+        size_t a = edge;
+        size_t ar = 0;
+
+        while (true)
+        {
+            size_t const b = opposite_edges[a];
+            size_t const a0 = a - a % 3;
+            ar = a0 + (a + 2) % 3;
+
+            if (b == no_site)
+            {
+                if (stack.empty())
+                {
+                    break;
+                }
+                a = stack.back();
+                stack.pop_back();
+                continue;
+            }
+
+            size_t const b0 = b - b % 3;
+            size_t const al = a0 + (a + 1) % 3;
+            size_t const bl = b0 + (b + 2) % 3;
+
+            size_t const p0 = triangles[ar];
+            size_t const pr = triangles[a];
+            size_t const pl = triangles[al];
+            size_t const p1 = triangles[bl];
+
+            if (incircle(sweep.points[p0], sweep.points[pr], sweep.points[pl], sweep.points[p1]) > 0)
+            {
+                triangles[a] = p1;
+                triangles[b] = p0;
+
+                size_t const hbl = opposite_edges[bl];
+
+                // the edge swapped on the other side of the hull
+                if (hbl == no_site)
+                {
+                    size_t vertex = sweep.hull_start;
+                    do
+                    {
+                        if (sweep.hull_edges[vertex] == bl)
+                        {
+                            sweep.hull_edges[vertex] = a;
+                            break;
+                        }
+                        vertex = sweep.hull_previous[vertex];
+                    } while (vertex != sweep.hull_start);
+                }
+
+                link_half_edges(sweep, a, hbl);
+                link_half_edges(sweep, b, opposite_edges[ar]);
+                link_half_edges(sweep, ar, bl);
+
+                stack.push_back(b0 + (b + 1) % 3);
+            }
+            else
+            {
+                if (stack.empty())
+                {
+                    break;
+                }
+                a = stack.back();
+                stack.pop_back();
+            }
+        }
+
+        return ar;
+    }
+
+    struct Circumcircle
+    {
+        double x;
+        double y;
+        double squared_radius;
+    };
+
+    Circumcircle get_circumcircle(Point first, Point second, Point third) noexcept
+    {
+        double const dx = static_cast<double>(second.x) - first.x;
+        double const dy = static_cast<double>(second.y) - first.y;
+        double const ex = static_cast<double>(third.x) - first.x;
+        double const ey = static_cast<double>(third.y) - first.y;
+
+        double const bl = dx * dx + dy * dy;
+        double const cl = ex * ex + ey * ey;
+        double const d = 0.5 / (dx * ey - dy * ex);
+
+        double const x = (ey * bl - dy * cl) * d;
+        double const y = (dx * cl - ex * bl) * d;
+
+        return { first.x + x, first.y + y, x * x + y * y };
+    }
+
+    // bucket of the hull vertices by their angle around the center, the angle is monotone but not exact
+    size_t get_hash_key(Point point, double center_x, double center_y, size_t hash_size) noexcept
+    {
+        double const dx = point.x - center_x;
+        double const dy = point.y - center_y;
+
+        double const length = std::abs(dx) + std::abs(dy);
+        if (length == 0.)
+        {
+            return 0;
+        }
+
+        double const p = dx / length;
+        double const angle = (dy > 0. ? 3. - p : 1. + p) / 4.;
+
+        return static_cast<size_t>(std::floor(angle * static_cast<double>(hash_size))) % hash_size;
+    }
+
+    // the hull edge from begin to end sees the point
+    bool is_visible(RadialSweep const & sweep, Point point, size_t begin, size_t end) noexcept
+    {
+        return orient2d(sweep.points[begin], sweep.points[end], point) < 0;
+    }
+
+    // points are unique, false if they are all on a line
+    bool triangulate(RadialSweep & sweep) noexcept
+    {
+        std::vector<Point> const & points = sweep.points;
+        size_t const points_count = points.size();
+
+        Box box = empty_box;
+        for (Point const point : points)
+        {
+            extend_box(box, point);
+        }
+
+        double const box_center_x = (static_cast<double>(box.min.x) + box.max.x) / 2.;
+        double const box_center_y = (static_cast<double>(box.min.y) + box.max.y) / 2.;
+
+        auto const get_squared_distance = [](double first_x, double first_y, Point second) noexcept
+            {
+                double const dx = second.x - first_x;
+                double const dy = second.y - first_y;
+                return dx * dx + dy * dy;
+            };
+
+        // seed triangle: the point nearest to the center, the point nearest to it and the smallest circumcircle with them
+        size_t seeds[3] = { 0, no_site, no_site };
+        for (size_t i = 1; i < points_count; ++i)
+        {
+            if (get_squared_distance(box_center_x, box_center_y, points[i]) < get_squared_distance(box_center_x, box_center_y, points[seeds[0]]))
+            {
+                seeds[0] = i;
+            }
+        }
+
+        Point const first_seed = points[seeds[0]];
+        double min_distance = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < points_count; ++i)
+        {
+            double const distance = get_squared_distance(first_seed.x, first_seed.y, points[i]);
+            if (i != seeds[0] && distance < min_distance)
+            {
+                seeds[1] = i;
+                min_distance = distance;
+            }
+        }
+
+        double min_radius = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < points_count; ++i)
+        {
+            if (i == seeds[0] || i == seeds[1] || orient2d(first_seed, points[seeds[1]], points[i]) == 0.)
+            {
+                continue;
+            }
+
+            double const radius = get_circumcircle(first_seed, points[seeds[1]], points[i]).squared_radius;
+            if (radius < min_radius)
+            {
+                seeds[2] = i;
+                min_radius = radius;
+            }
+        }
+
+        if (seeds[2] == no_site)
+        {
+            return false;
+        }
+
+        if (orient2d(points[seeds[0]], points[seeds[1]], points[seeds[2]]) < 0.)
+        {
+            std::swap(seeds[1], seeds[2]);
+        }
+
+        Circumcircle const seed_circle = get_circumcircle(points[seeds[0]], points[seeds[1]], points[seeds[2]]);
+
+        std::vector<double> distances(points_count);
+        std::vector<size_t> order(points_count);
+        for (size_t i = 0; i < points_count; ++i)
+        {
+            distances[i] = get_squared_distance(seed_circle.x, seed_circle.y, points[i]);
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&distances](size_t first, size_t second) noexcept
+            {
+                return distances[first] < distances[second] || (distances[first] == distances[second] && first < second);
+            });
+
+        size_t const hash_size = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(points_count))));
+        std::vector<size_t> hull_hash(hash_size, no_site);
+        auto const get_key = [&seed_circle, hash_size](Point point) noexcept
+            {
+                return get_hash_key(point, seed_circle.x, seed_circle.y, hash_size);
+            };
+
+        sweep.triangles.reserve(6 * points_count);
+        sweep.opposite_edges.reserve(6 * points_count);
+        sweep.hull_next.assign(points_count, no_site);
+        sweep.hull_previous.assign(points_count, no_site);
+        sweep.hull_edges.assign(points_count, no_site);
+
+        sweep.hull_start = seeds[0];
+        for (size_t i = 0; i < 3; ++i)
+        {
+            sweep.hull_next[seeds[i]] = seeds[(i + 1) % 3];
+            sweep.hull_previous[seeds[i]] = seeds[(i + 2) % 3];
+            sweep.hull_edges[seeds[i]] = i;
+            hull_hash[get_key(points[seeds[i]])] = seeds[i];
+        }
+
+        add_triangle(sweep, seeds[0], seeds[1], seeds[2], no_site, no_site, no_site);
+
+        for (size_t const i : order)
+        {
+            if (i == seeds[0] || i == seeds[1] || i == seeds[2])
+            {
+                continue;
+            }
+
+            Point const point = points[i];
+            size_t const key = get_key(point);
+
+            // a hull vertex near the angle of the point, then the first hull edge that sees it
+            size_t start = no_site;
+            for (size_t j = 0; j < hash_size; ++j)
+            {
+                start = hull_hash[(key + j) % hash_size];
+                if (start != no_site && start != sweep.hull_next[start])
+                {
+                    break;
+                }
+            }
+            start = sweep.hull_previous[start];
+
+            size_t edge = start;
+            while (!is_visible(sweep, point, edge, sweep.hull_next[edge]))
+            {
+                edge = sweep.hull_next[edge];
+                if (edge == start)
+                {
+                    edge = no_site;
+                    break;
+                }
+            }
+
+            // inside of the hull, the order of the points rules it out
+            if (edge == no_site)
+            {
+                continue;
+            }
+
+            size_t triangle = add_triangle(sweep, edge, i, sweep.hull_next[edge], no_site, no_site, sweep.hull_edges[edge]);
+            sweep.hull_edges[i] = legalize_edge(sweep, triangle + 2);
+            sweep.hull_edges[edge] = triangle;
+
+            // hull edges after the first one that see the point
+            size_t next = sweep.hull_next[edge];
+            while (is_visible(sweep, point, next, sweep.hull_next[next]))
+            {
+                size_t const after_next = sweep.hull_next[next];
+                triangle = add_triangle(sweep, next, i, after_next, sweep.hull_edges[i], no_site, sweep.hull_edges[next]);
+                sweep.hull_edges[i] = legalize_edge(sweep, triangle + 2);
+                sweep.hull_next[next] = next;
+                next = after_next;
+            }
+
+            // and before it, if the search started in the middle of the visible edges
+            if (edge == start)
+            {
+                while (is_visible(sweep, point, sweep.hull_previous[edge], edge))
+                {
+                    size_t const previous = sweep.hull_previous[edge];
+                    triangle = add_triangle(sweep, previous, i, edge, no_site, sweep.hull_edges[edge], sweep.hull_edges[previous]);
+                    legalize_edge(sweep, triangle + 2);
+                    sweep.hull_edges[previous] = triangle;
+                    sweep.hull_next[edge] = edge;
+                    edge = previous;
+                }
+            }
+
+            sweep.hull_start = edge;
+            sweep.hull_previous[i] = edge;
+            sweep.hull_next[edge] = i;
+            sweep.hull_previous[next] = i;
+            sweep.hull_next[i] = next;
+
+            hull_hash[key] = i;
+            hull_hash[get_key(points[edge])] = edge;
+        }
+
+        return true;
+    }
+
+    // Part of x + t * dx, y + t * dy for t in [t_begin, t_end] inside of the box,
+    // an end cut by a side of the box is put exactly on it, so the sides are split there.
+    bool clip_to_box(Box const & box, double x, double y, double dx, double dy, double t_begin, double t_end, Point & begin, Point & end) noexcept
+    {
+        double const p[4] = { -dx, dx, -dy, dy };
+        double const q[4] = { x - box.min.x, box.max.x - x, y - box.min.y, box.max.y - y };
+
+        size_t begin_side = 4;
+        size_t end_side = 4;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            if (p[i] == 0.)
+            {
+                if (q[i] < 0.)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            double const t = q[i] / p[i];
+            if (p[i] < 0. && t > t_begin)
+            {
+                t_begin = t;
+                begin_side = i;
+            }
+            else if (p[i] > 0. && t < t_end)
+            {
+                t_end = t;
+                end_side = i;
+            }
+        }
+
+        if (!(t_begin < t_end))
+        {
+            return false;
+        }
+
+        auto const get_point = [&box, x, y, dx, dy](double t, size_t side) noexcept
+            {
+                Point point{ static_cast<float>(x + t * dx), static_cast<float>(y + t * dy) };
+                switch (side)
+                {
+                case 0:
+                    point.x = box.min.x;
+                    break;
+                case 1:
+                    point.x = box.max.x;
+                    break;
+                case 2:
+                    point.y = box.min.y;
+                    break;
+                case 3:
+                    point.y = box.max.y;
+                    break;
+                default:
+                    break;
+                }
+                return point;
+            };
+
+        begin = get_point(t_begin, begin_side);
+        end = get_point(t_end, end_side);
+
+        return begin.x != end.x || begin.y != end.y;
+    }
+
+    // boundary point index in the vertex of a cell piece until the boundary points are sorted
+    static constexpr size_t boundary_flag = size_t{ 1 } << (std::numeric_limits<size_t>::digits - 1);
+
+    // part of a cell boundary, counterclockwise around the cell, no_site vertices if it is outside of the box
+    struct CellPiece
+    {
+        size_t begin_vertex{ no_site };
+        size_t end_vertex{ no_site };
+    };
+
+    CellPiece get_reversed(CellPiece piece) noexcept
+    {
+        return { piece.end_vertex, piece.begin_vertex };
+    }
+
+    bool is_on_boundary(Box const & box, Point point) noexcept
+    {
+        return point.x == box.min.x || point.x == box.max.x || point.y == box.min.y || point.y == box.max.y;
+    }
+
+    // distance along the boundary counterclockwise from box.min
+    double get_boundary_position(Box const & box, Point point) noexcept
+    {
+        double const width = static_cast<double>(box.max.x) - box.min.x;
+        double const height = static_cast<double>(box.max.y) - box.min.y;
+
+        if (point.y == box.min.y)
+        {
+            return static_cast<double>(point.x) - box.min.x;
+        }
+        if (point.x == box.max.x)
+        {
+            return width + (static_cast<double>(point.y) - box.min.y);
+        }
+        if (point.y == box.max.y)
+        {
+            return width + height + (static_cast<double>(box.max.x) - point.x);
+        }
+
+        return 2. * width + height + (static_cast<double>(box.max.y) - point.y);
+    }
+
+    // the next float after the point on the boundary counterclockwise
+    Point get_next_boundary_point(Box const & box, Point point) noexcept
+    {
+        if (point.y == box.min.y && point.x < box.max.x)
+        {
+            point.x = std::nextafter(point.x, box.max.x);
+        }
+        else if (point.x == box.max.x && point.y < box.max.y)
+        {
+            point.y = std::nextafter(point.y, box.max.y);
+        }
+        else if (point.y == box.max.y && point.x > box.min.x)
+        {
+            point.x = std::nextafter(point.x, box.min.x);
+        }
+        else
+        {
+            point.y = std::nextafter(point.y, box.min.y);
+        }
+
+        return point;
+    }
+
+    VoronoiDiagram build_voronoi_diagram(vvve::VVVE const & sites, Box const & box) noexcept
+    {
+        ProfileScope const scope{ "build_voronoi_diagram" };
+
+        // unique sites in the order of x, then y, with the first vertex of each
+        std::vector<size_t> vertices(sites.vertices.size());
+        std::iota(vertices.begin(), vertices.end(), size_t{ 0 });
+        std::sort(vertices.begin(), vertices.end(), [&sites](size_t first, size_t second) noexcept
+            {
+                Point const first_point = sites.vertices[first].coordinate;
+                Point const second_point = sites.vertices[second].coordinate;
+                return first_point.x < second_point.x ||
+                    (first_point.x == second_point.x && (first_point.y < second_point.y || (first_point.y == second_point.y && first < second)));
+            });
+
+        std::vector<Point> points{};
+        std::vector<size_t> point_sites{};
+        for (size_t const vertex : vertices)
+        {
+            Point const point = sites.vertices[vertex].coordinate;
+            if (points.empty() || points.back().x != point.x || points.back().y != point.y)
+            {
+                points.push_back(point);
+                point_sites.push_back(vertex);
+            }
+        }
+
+        // counterclockwise
+        Point const corners[4] = { box.min, { box.max.x, box.min.y }, box.max, { box.min.x, box.max.y } };
+
+        // centers of the triangles inside of the box, then the points on its boundary once they are sorted along it
+        std::vector<Point> cell_points{};
+        std::vector<Point> boundary_points{ corners, corners + 4 };
+
+        auto const add_boundary_point = [&boundary_points](Point point) noexcept
+            {
+                boundary_points.push_back(point);
+                return boundary_flag | (boundary_points.size() - 1);
+            };
+
+        // pieces of the cell of site i counterclockwise are cell_pieces[cell_piece_offsets[i], cell_piece_offsets[i + 1])
+        std::vector<CellPiece> cell_pieces{};
+        std::vector<size_t> cell_piece_offsets{ 0 };
+
+        auto const add_cell_piece = [&cell_pieces](CellPiece piece) noexcept
+            {
+                // a piece inside of a group of triangles has no length
+                if (piece.begin_vertex != no_site && piece.begin_vertex != piece.end_vertex)
+                {
+                    cell_pieces.push_back(piece);
+                }
+            };
+
+        double const infinity = std::numeric_limits<double>::infinity();
+        Point begin{};
+        Point end{};
+
+        RadialSweep sweep{ points };
+        if (points.size() >= 3 && triangulate(sweep))
+        {
+            size_t const triangles_count = sweep.triangles.size() / 3;
+
+            std::vector<Point> centers(triangles_count);
+            for (size_t i = 0; i < triangles_count; ++i)
+            {
+                Circumcircle const circle = get_circumcircle(points[sweep.triangles[3 * i]], points[sweep.triangles[3 * i + 1]], points[sweep.triangles[3 * i + 2]]);
+                centers[i] = { static_cast<float>(circle.x), static_cast<float>(circle.y) };
+            }
+
+            // Union-find of the triangles that share a cell vertex, at the center of the root of their group,
+            // with the triangles of every group in a circular list. The dual edge of a delaunay edge between
+            // cocircular sites has no length, so their triangles are a single vertex.
+            std::vector<size_t> parents(triangles_count);
+            std::iota(parents.begin(), parents.end(), size_t{ 0 });
+            std::vector<size_t> next_members(parents);
+
+            auto const find = [&parents](size_t triangle) noexcept
+                {
+                    while (parents[triangle] != triangle)
+                    {
+                        parents[triangle] = parents[parents[triangle]];
+                        triangle = parents[triangle];
+                    }
+
+                    return triangle;
+                };
+
+            auto const merge = [&parents, &next_members](size_t group, size_t into) noexcept
+                {
+                    parents[group] = into;
+                    std::swap(next_members[group], next_members[into]);
+                };
+
+            for (size_t i = 0; i < sweep.triangles.size(); ++i)
+            {
+                size_t const opposite = sweep.opposite_edges[i];
+                if (opposite == no_site || opposite < i)
+                {
+                    continue;
+                }
+
+                size_t const triangle = i - i % 3;
+                if (incircle(points[sweep.triangles[triangle]], points[sweep.triangles[triangle + 1]], points[sweep.triangles[triangle + 2]],
+                    points[sweep.triangles[get_next_half_edge(get_next_half_edge(opposite))]]) != 0.)
+                {
+                    continue;
+                }
+
+                size_t const group = find(i / 3);
+                size_t const other_group = find(opposite / 3);
+                if (group != other_group)
+                {
+                    centers[group] = centers[other_group];
+                    merge(group, other_group);
+                }
+            }
+
+            // Half-edges out of the same site before and after the edge counterclockwise in other groups,
+            // no_site past the hull or if the cell has no other group.
+            auto const get_previous_edge = [&](size_t edge) noexcept
+                {
+                    size_t const group = find(edge / 3);
+                    for (size_t previous = sweep.opposite_edges[edge]; previous != no_site; previous = sweep.opposite_edges[previous])
+                    {
+                        previous = get_next_half_edge(previous);
+                        if (previous == edge)
+                        {
+                            break;
+                        }
+                        if (find(previous / 3) != group)
+                        {
+                            return previous;
+                        }
+                    }
+
+                    return no_site;
+                };
+
+            auto const get_next_edge = [&](size_t edge) noexcept
+                {
+                    size_t const group = find(edge / 3);
+                    for (size_t next = sweep.opposite_edges[get_next_half_edge(get_next_half_edge(edge))]; next != no_site && next != edge;
+                        next = sweep.opposite_edges[get_next_half_edge(get_next_half_edge(next))])
+                    {
+                        if (find(next / 3) != group)
+                        {
+                            return next;
+                        }
+                    }
+
+                    return no_site;
+                };
+
+            // the cell of the origin of the edge turns left at the group of its triangle, a cell going to infinity there has no turn
+            auto const is_left_turn = [&](size_t edge) noexcept
+                {
+                    size_t const previous_edge = get_previous_edge(edge);
+                    size_t const next_edge = get_next_edge(edge);
+                    if (previous_edge == no_site || next_edge == no_site)
+                    {
+                        return true;
+                    }
+
+                    size_t const previous = find(previous_edge / 3);
+                    size_t const next = find(next_edge / 3);
+
+                    return previous != next && orient2d(centers[previous], centers[find(edge / 3)], centers[next]) > 0.;
+                };
+
+            // the turns that depend on the center of the group: at it and at its neighbors in every cell around it
+            std::vector<size_t> affected_edges{};
+            auto const get_affected_edges = [&](size_t group) noexcept
+                {
+                    affected_edges.clear();
+
+                    size_t triangle = group;
+                    do
+                    {
+                        for (size_t edge = 3 * triangle; edge < 3 * triangle + 3; ++edge)
+                        {
+                            affected_edges.push_back(edge);
+
+                            size_t const previous_edge = get_previous_edge(edge);
+                            if (previous_edge != no_site)
+                            {
+                                affected_edges.push_back(previous_edge);
+                            }
+
+                            size_t const next_edge = get_next_edge(edge);
+                            if (next_edge != no_site)
+                            {
+                                affected_edges.push_back(next_edge);
+                            }
+                        }
+                        triangle = next_members[triangle];
+                    } while (triangle != group);
+                };
+
+            // a merge keeps at least three groups in every closed cell around the group
+            auto const is_mergeable = [&](size_t group, size_t into) noexcept
+                {
+                    auto const get_group = [&](size_t edge) noexcept
+                        {
+                            size_t const edge_group = find(edge / 3);
+                            return edge_group == group ? into : edge_group;
+                        };
+
+                    size_t triangle = group;
+                    do
+                    {
+                        for (size_t edge = 3 * triangle; edge < 3 * triangle + 3; ++edge)
+                        {
+                            size_t changes = 0;
+                            size_t current = edge;
+                            do
+                            {
+                                size_t const next = sweep.opposite_edges[get_next_half_edge(get_next_half_edge(current))];
+                                if (next == no_site)
+                                {
+                                    changes = 3;
+                                    break;
+                                }
+                                if (get_group(next) != get_group(current))
+                                {
+                                    ++changes;
+                                }
+                                current = next;
+                            } while (current != edge && changes < 3);
+
+                            if (changes < 3)
+                            {
+                                return false;
+                            }
+                        }
+                        triangle = next_members[triangle];
+                    } while (triangle != group);
+
+                    return true;
+                };
+
+            // The exact cells are convex, but a rounded center of nearly cocircular sites may lose its side of an edge
+            // going nearly along the others, so the cell turns right there and its edges may cross.
+            // Such a center is moved by a few floats to where every turn depending on it is left, so the wrong turns only get fewer,
+            // or if there is none, its group is merged into the nearer neighbor group in that cell, so the groups only get fewer.
+            std::vector<std::pair<int, int>> steps{};
+            for (int x = -2; x <= 2; ++x)
+            {
+                for (int y = -2; y <= 2; ++y)
+                {
+                    if (x != 0 || y != 0)
+                    {
+                        steps.push_back({ x, y });
+                    }
+                }
+            }
+            std::stable_sort(steps.begin(), steps.end(), [](std::pair<int, int> first, std::pair<int, int> second) noexcept
+                {
+                    return first.first * first.first + first.second * first.second < second.first * second.first + second.second * second.second;
+                });
+
+            auto const get_moved = [](float value, int steps) noexcept
+                {
+                    for (; steps > 0; --steps)
+                    {
+                        value = std::nextafter(value, std::numeric_limits<float>::infinity());
+                    }
+                    for (; steps < 0; ++steps)
+                    {
+                        value = std::nextafter(value, -std::numeric_limits<float>::infinity());
+                    }
+
+                    return value;
+                };
+
+            std::vector<size_t> wrong_edges{};
+            for (size_t i = 0; i < sweep.triangles.size(); ++i)
+            {
+                if (!is_left_turn(i))
+                {
+                    wrong_edges.push_back(i);
+                }
+            }
+
+            while (!wrong_edges.empty())
+            {
+                size_t const edge = wrong_edges.back();
+                wrong_edges.pop_back();
+
+                if (is_left_turn(edge))
+                {
+                    continue;
+                }
+
+                size_t const group = find(edge / 3);
+                Point const center = centers[group];
+                get_affected_edges(group);
+
+                bool is_moved = false;
+                for (std::pair<int, int> const step : steps)
+                {
+                    centers[group] = { get_moved(center.x, step.first), get_moved(center.y, step.second) };
+                    is_moved = std::all_of(affected_edges.begin(), affected_edges.end(), is_left_turn);
+                    if (is_moved)
+                    {
+                        break;
+                    }
+                }
+
+                if (is_moved)
+                {
+                    continue;
+                }
+
+                centers[group] = center;
+
+                size_t const previous = find(get_previous_edge(edge) / 3);
+                size_t const next = find(get_next_edge(edge) / 3);
+                double const previous_dx = static_cast<double>(centers[previous].x) - center.x;
+                double const previous_dy = static_cast<double>(centers[previous].y) - center.y;
+                double const next_dx = static_cast<double>(centers[next].x) - center.x;
+                double const next_dy = static_cast<double>(centers[next].y) - center.y;
+                bool const is_previous_nearer = previous_dx * previous_dx + previous_dy * previous_dy < next_dx * next_dx + next_dy * next_dy;
+
+                size_t const into = is_mergeable(group, is_previous_nearer ? previous : next) ? (is_previous_nearer ? previous : next) :
+                    is_mergeable(group, is_previous_nearer ? next : previous) ? (is_previous_nearer ? next : previous) : no_site;
+                if (into == no_site)
+                {
+                    continue;
+                }
+
+                merge(group, into);
+
+                get_affected_edges(into);
+                wrong_edges.insert(wrong_edges.end(), affected_edges.begin(), affected_edges.end());
+            }
+
+            for (size_t i = 0; i < triangles_count; ++i)
+            {
+                centers[i] = centers[find(i)];
+            }
+
+            std::vector<size_t> center_vertices(triangles_count, no_site);
+
+            // a center is a cell vertex if it is inside of the box
+            auto const get_vertex = [&](Point point, size_t triangle) noexcept
+                {
+                    if (is_on_boundary(box, point))
+                    {
+                        return add_boundary_point(point);
+                    }
+
+                    size_t const root = find(triangle);
+                    if (center_vertices[root] == no_site)
+                    {
+                        center_vertices[root] = cell_points.size();
+                        cell_points.push_back(centers[root]);
+                    }
+
+                    return center_vertices[root];
+                };
+
+            // Every delaunay edge from a to b is dual to the cell edge between a and b.
+            // Around a the triangle on the right of ab comes first, so the piece of the cell of a goes from its center
+            // to the center of the triangle on the left, on the hull it comes from infinity on the right of ab.
+            std::vector<CellPiece> pieces(sweep.triangles.size());
+            for (size_t i = 0; i < sweep.triangles.size(); ++i)
+            {
+                size_t const opposite = sweep.opposite_edges[i];
+                if (opposite != no_site && opposite < i)
+                {
+                    continue;
+                }
+
+                Point const center = centers[i / 3];
+
+                if (opposite == no_site)
+                {
+                    Point const a = points[sweep.triangles[i]];
+                    Point const b = points[sweep.triangles[get_next_half_edge(i)]];
+                    double const normal_x = -(static_cast<double>(b.y) - a.y);
+                    double const normal_y = static_cast<double>(b.x) - a.x;
+
+                    if (clip_to_box(box, center.x, center.y, -normal_x, -normal_y, 0., infinity, begin, end))
+                    {
+                        pieces[i] = { get_vertex(end, i / 3), get_vertex(begin, i / 3) };
+                    }
+                    continue;
+                }
+
+                Point const other_center = centers[opposite / 3];
+                double const dx = static_cast<double>(center.x) - other_center.x;
+                double const dy = static_cast<double>(center.y) - other_center.y;
+
+                if (clip_to_box(box, other_center.x, other_center.y, dx, dy, 0., 1., begin, end))
+                {
+                    pieces[i] = { get_vertex(begin, opposite / 3), get_vertex(end, i / 3) };
+                }
+            }
+
+            // half-edge going out of every site, the first one counterclockwise for the sites on the hull
+            std::vector<size_t> vertex_edges(points.size(), no_site);
+            for (size_t i = 0; i < sweep.triangles.size(); ++i)
+            {
+                vertex_edges[sweep.triangles[i]] = i;
+            }
+            for (size_t i = 0; i < sweep.triangles.size(); ++i)
+            {
+                if (sweep.opposite_edges[i] == no_site)
+                {
+                    vertex_edges[sweep.triangles[i]] = i;
+                }
+            }
+
+            // The rays of the hull edges end on the boundary in the order of the hull, the cell of a site on the hull is between
+            // the ends of the rays before and after it. Nearly collinear hull sites have rays ending apart by less than the rounding,
+            // so the end of a ray not after the previous one is moved after it, unless it is past box.min.
+            double const half_perimeter = static_cast<double>(box.max.x) - box.min.x + (static_cast<double>(box.max.y) - box.min.y);
+            size_t previous_end = no_site;
+            size_t hull_edge = vertex_edges[sweep.hull_start];
+            do
+            {
+                size_t const end = pieces[hull_edge].begin_vertex;
+                if (end != no_site && previous_end != no_site)
+                {
+                    Point & point = boundary_points[end & ~boundary_flag];
+                    Point const previous_point = boundary_points[previous_end & ~boundary_flag];
+                    double const offset = get_boundary_position(box, point) - get_boundary_position(box, previous_point);
+                    if (offset <= 0. && offset > -half_perimeter)
+                    {
+                        point = get_next_boundary_point(box, previous_point);
+                    }
+                }
+
+                previous_end = end;
+                hull_edge = vertex_edges[sweep.triangles[get_next_half_edge(hull_edge)]];
+            } while (hull_edge != vertex_edges[sweep.hull_start]);
+
+            cell_pieces.reserve(sweep.triangles.size() + points.size());
+            cell_piece_offsets.reserve(points.size() + 1);
+
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                size_t const start = vertex_edges[i];
+                size_t edge = start;
+
+                while (edge != no_site)
+                {
+                    size_t const opposite = sweep.opposite_edges[edge];
+                    add_cell_piece(opposite == no_site || edge < opposite ? pieces[edge] : get_reversed(pieces[opposite]));
+
+                    // the next edge counterclockwise goes out of the triangle before this one
+                    size_t const previous = get_next_half_edge(get_next_half_edge(edge));
+                    edge = sweep.opposite_edges[previous];
+
+                    if (edge == no_site)
+                    {
+                        add_cell_piece(get_reversed(pieces[previous]));
+                    }
+                    else if (edge == start)
+                    {
+                        break;
+                    }
+                }
+
+                cell_piece_offsets.push_back(cell_pieces.size());
+            }
+        }
+        else
+        {
+            // on a line, so the cells are strips between the bisectors
+            std::vector<CellPiece> bisectors(points.empty() ? 0 : points.size() - 1);
+            for (size_t i = 0; i < bisectors.size(); ++i)
+            {
+                double const middle_x = (static_cast<double>(points[i].x) + points[i + 1].x) / 2.;
+                double const middle_y = (static_cast<double>(points[i].y) + points[i + 1].y) / 2.;
+                double const normal_x = -(static_cast<double>(points[i + 1].y) - points[i].y);
+                double const normal_y = static_cast<double>(points[i + 1].x) - points[i].x;
+
+                // the cell of points[i] is on the left
+                if (clip_to_box(box, middle_x, middle_y, normal_x, normal_y, -infinity, infinity, begin, end))
+                {
+                    bisectors[i] = { add_boundary_point(begin), add_boundary_point(end) };
+                }
+            }
+
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                if (i < bisectors.size())
+                {
+                    add_cell_piece(bisectors[i]);
+                }
+                if (i > 0)
+                {
+                    add_cell_piece(get_reversed(bisectors[i - 1]));
+                }
+                cell_piece_offsets.push_back(cell_pieces.size());
+            }
+        }
+
+        // the boundary points counterclockwise from box.min, equal ones are one vertex
+        std::vector<std::pair<double, size_t>> boundary_order(boundary_points.size());
+        for (size_t i = 0; i < boundary_points.size(); ++i)
+        {
+            boundary_order[i] = { get_boundary_position(box, boundary_points[i]), i };
+        }
+        std::sort(boundary_order.begin(), boundary_order.end());
+
+        std::vector<size_t> boundary_vertices(boundary_points.size());
+        std::vector<size_t> boundary_cycle{};
+        for (std::pair<double, size_t> const & item : boundary_order)
+        {
+            Point const point = boundary_points[item.second];
+            if (boundary_cycle.empty() || cell_points[boundary_cycle.back()].x != point.x || cell_points[boundary_cycle.back()].y != point.y)
+            {
+                boundary_cycle.push_back(cell_points.size());
+                cell_points.push_back(point);
+            }
+            boundary_vertices[item.second] = boundary_cycle.back();
+        }
+
+        std::vector<size_t> boundary_indices(cell_points.size(), no_site);
+        for (size_t i = 0; i < boundary_cycle.size(); ++i)
+        {
+            boundary_indices[boundary_cycle[i]] = i;
+        }
+
+        for (CellPiece & piece : cell_pieces)
+        {
+            if (piece.begin_vertex & boundary_flag)
+            {
+                piece.begin_vertex = boundary_vertices[piece.begin_vertex & ~boundary_flag];
+            }
+            if (piece.end_vertex & boundary_flag)
+            {
+                piece.end_vertex = boundary_vertices[piece.end_vertex & ~boundary_flag];
+            }
+        }
+
+        // Cells are the pieces joined by the boundary between the end of a piece and the beginning of the next one,
+        // if a cell leaves the box there. Sites with cells outside of the box get no face.
+        std::vector<size_t> cells{};
+        std::vector<size_t> cell_offsets{ 0 };
+        std::vector<size_t> face_sites{ no_site };
+
+        cells.reserve(cell_pieces.size() + boundary_cycle.size() + 2 * points.size());
+        cell_offsets.reserve(points.size() + 1);
+        face_sites.reserve(points.size() + 1);
+
+        auto const add_boundary_vertices = [&cells, &boundary_cycle, &boundary_indices](size_t from, size_t to) noexcept
+            {
+                if (boundary_indices[from] == no_site || boundary_indices[to] == no_site)
+                {
+                    cells.push_back(from);
+                    return;
+                }
+
+                for (size_t i = boundary_indices[from]; boundary_cycle[i] != to; i = (i + 1) % boundary_cycle.size())
+                {
+                    cells.push_back(boundary_cycle[i]);
+                }
+            };
+
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            size_t const first = cell_piece_offsets[i];
+            size_t const last = cell_piece_offsets[i + 1];
+
+            if (first == last)
+            {
+                continue;
+            }
+
+            for (size_t j = first; j < last; ++j)
+            {
+                if (j != first && cell_pieces[j - 1].end_vertex != cell_pieces[j].begin_vertex)
+                {
+                    add_boundary_vertices(cell_pieces[j - 1].end_vertex, cell_pieces[j].begin_vertex);
+                }
+                cells.push_back(cell_pieces[j].begin_vertex);
+            }
+
+            if (cell_pieces[last - 1].end_vertex != cell_pieces[first].begin_vertex)
+            {
+                add_boundary_vertices(cell_pieces[last - 1].end_vertex, cell_pieces[first].begin_vertex);
+            }
+
+            cell_offsets.push_back(cells.size());
+            face_sites.push_back(point_sites[i]);
+        }
+
+        // no cell edge crosses the box, so it is inside of a single cell
+        if (cell_offsets.size() == 1)
+        {
+            cells = boundary_cycle;
+            cell_offsets.push_back(cells.size());
+
+            size_t nearest = no_site;
+            double min_distance = infinity;
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                double const dx = points[i].x - (static_cast<double>(box.min.x) + box.max.x) / 2.;
+                double const dy = points[i].y - (static_cast<double>(box.min.y) + box.max.y) / 2.;
+                if (dx * dx + dy * dy < min_distance)
+                {
+                    nearest = point_sites[i];
+                    min_distance = dx * dx + dy * dy;
+                }
+            }
+            face_sites.push_back(nearest);
+        }
+
+        return { make_dcel_from_cells(cell_points, cells, cell_offsets), std::move(face_sites) };
+    }
+
+    VoronoiDiagram build_voronoi_diagram(vvve::VVVE const & sites) noexcept
+    {
+        Box box = empty_box;
+        for (vvve::VVVE::Vertex const & vertex : sites.vertices)
+        {
+            extend_box(box, vertex.coordinate);
+        }
+
+        if (sites.vertices.empty())
+        {
+            box = { { 0.f, 0.f }, { 1.f, 1.f } };
+        }
+
+        float const margin = std::max({ box.max.x - box.min.x, box.max.y - box.min.y, 1.f }) / 10.f;
+
+        return build_voronoi_diagram(sites, { { box.min.x - margin, box.min.y - margin }, { box.max.x + margin, box.max.y + margin } });
+    }
+}
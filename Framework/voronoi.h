@@ -0,0 +1,31 @@
+#pragma once
+
+
+#include "dcel.h"
+#include "vvve.h"
+#include "view_culling.h"
+
+#include <vector>
+
+
+namespace frm
+{
+    struct VoronoiDiagram
+    {
+        dcel::DCEL dcel;
+        // vertex of the sites of every face, std::numeric_limits<size_t>::max() for the outside face 0
+        std::vector<size_t> face_sites;
+    };
+
+    // Delaunay triangulation of the vertices by a radial sweep, O(n log(n)) expected, then its dual clipped to the box:
+    // the cell of a site is walked around it through the triangles, so the faces are linked in O(n log(n)) without
+    // searching for intersections. Equal sites share a cell, sites with cells outside of the box get no face.
+    // The cell of a site is the face get_face_index finds for any point nearer to it than to the others.
+    // Vertices are the centers of the delaunay triangles rounded to float, the triangles of cocircular sites are one vertex.
+    // A rounded vertex where a cell turns right is moved by a few floats to where all the cells around turn left,
+    // or merged into its neighbor in the cell if there is no such place, so cells of nearly cocircular sites stay convex.
+    VoronoiDiagram build_voronoi_diagram(vvve::VVVE const & sites, Box const & box) noexcept;
+
+    // box of the sites with a tenth of its size around
+    VoronoiDiagram build_voronoi_diagram(vvve::VVVE const & sites) noexcept;
+}
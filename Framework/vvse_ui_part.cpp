@@ -1,5 +1,6 @@
 #include "vvve.h"
 #include "common_ui_part.h"
+#include "profiler.h"
 
 #include "imgui/imgui.h"
 
@@ -31,7 +32,7 @@ namespace frm
             return {};
         }
 
-        bool show_vertices(VVVE & vvve, sf::RenderWindow & window) noexcept
+        bool show_vertices(VVVE & vvve, MarkerBatch & markers) noexcept
         {
             bool is_dirty = false;
 
@@ -48,11 +49,17 @@ namespace frm
                 static float circle_color[4] = { 1.f, 0.0f, 0.f, 0.7f };
                 static float radius = 10.f;
 
-                Point & point = vvve.vertices[current].coordinate;
-                draw_vertex_highlighted(point, circle_color, radius, window);
+                Point point = vvve.vertices[current].coordinate;
+                draw_vertex_highlighted(markers, point, circle_color, radius);
 
-                is_dirty |= ImGui::SliderFloat("X", &point.x, 0.f, 1000.f);
-                is_dirty |= ImGui::SliderFloat("Y", &point.y, 0.f, 1000.f);
+                bool is_moved = ImGui::SliderFloat("X", &point.x, 0.f, 1000.f);
+                is_moved |= ImGui::SliderFloat("Y", &point.y, 0.f, 1000.f);
+
+                if (is_moved)
+                {
+                    move_vertex(vvve, current, point);
+                    is_dirty = true;
+                }
 
                 ImGui::SliderFloat("Radius", &radius, 0.01f, 100.f);
                 ImGui::ColorEdit3("Circle", circle_color);
@@ -69,7 +76,7 @@ namespace frm
 
                 static Point new_vertex = { 100.f, 100.f };
 
-                draw_vertex_highlighted(new_vertex, circle_color, radius, window);
+                draw_vertex_highlighted(markers, new_vertex, circle_color, radius);
 
                 ImGui::SliderFloat("new X", &new_vertex.x, 0.f, 1000.f);
                 ImGui::SliderFloat("new Y", &new_vertex.y, 0.f, 1000.f);
@@ -83,7 +90,7 @@ namespace frm
             return is_dirty;
         }
 
-        bool show_edges(VVVE & vvve, sf::RenderWindow & window) noexcept
+        bool show_edges(VVVE & vvve, MarkerBatch & markers) noexcept
         {
             bool is_dirty = false;
 
@@ -103,17 +110,27 @@ namespace frm
                 VVVE::edge_t edge = get_edge_by_index(vvve, current);
 
                 size_t const begin_origin = edge.first;
-                Point & begin_point = vvve.vertices[begin_origin].coordinate;
+                Point begin_point = vvve.vertices[begin_origin].coordinate;
                 size_t const end_origin = edge.second;
-                Point & end_point = vvve.vertices[end_origin].coordinate;
+                Point end_point = vvve.vertices[end_origin].coordinate;
 
-                draw_edge_highlighted(begin_point, end_point, color, width, window);
+                draw_edge_highlighted(markers, begin_point, end_point, color, width);
 
-                is_dirty |= ImGui::SliderFloat("X begin", &begin_point.x, 0.f, 1000.f);
-                is_dirty |= ImGui::SliderFloat("Y begin", &begin_point.y, 0.f, 1000.f);
+                bool is_begin_moved = ImGui::SliderFloat("X begin", &begin_point.x, 0.f, 1000.f);
+                is_begin_moved |= ImGui::SliderFloat("Y begin", &begin_point.y, 0.f, 1000.f);
 
-                is_dirty |= ImGui::SliderFloat("X end", &end_point.x, 0.f, 1000.f);
-                is_dirty |= ImGui::SliderFloat("Y end", &end_point.y, 0.f, 1000.f);
+                bool is_end_moved = ImGui::SliderFloat("X end", &end_point.x, 0.f, 1000.f);
+                is_end_moved |= ImGui::SliderFloat("Y end", &end_point.y, 0.f, 1000.f);
+
+                if (is_begin_moved)
+                {
+                    move_vertex(vvve, begin_origin, begin_point);
+                }
+                if (is_end_moved)
+                {
+                    move_vertex(vvve, end_origin, end_point);
+                }
+                is_dirty |= is_begin_moved || is_end_moved;
 
                 ImGui::SliderFloat("Width", &width, 0.01f, 100.f);
                 ImGui::ColorEdit3("Line", color);
@@ -137,13 +154,13 @@ namespace frm
                 if (begin_vertex < vvve.vertices.size())
                 {
                     Point const & point = vvve.vertices[begin_vertex].coordinate;
-                    draw_vertex_highlighted(point, color, radius, window);
+                    draw_vertex_highlighted(markers, point, color, radius);
                 }
 
                 if (end_vertex < vvve.vertices.size())
                 {
                     Point const & point = vvve.vertices[end_vertex].coordinate;
-                    draw_vertex_highlighted(point, color, radius, window);
+                    draw_vertex_highlighted(markers, point, color, radius);
                 }
 
                 if (begin_vertex < vvve.vertices.size() && begin_vertex != end_vertex)
@@ -160,8 +177,14 @@ namespace frm
 
         bool spawn_ui(VVVE & vvve, sf::RenderWindow & window, std::string const & path) noexcept
         {
+            ProfileScope const scope{ "vvve::spawn_ui" };
+
             bool is_dirty = false;
 
+            // markers of the panels, drawn with a single call after them
+            static MarkerBatch markers{};
+            markers.vertices.clear();
+
             std::string const name = std::filesystem::path{ path }.stem().string();
 
             static bool is_active = false;
@@ -206,50 +229,231 @@ namespace frm
 
                 if (current_item == items[0])
                 {
-                    is_dirty |= show_vertices(vvve, window);
+                    is_dirty |= show_vertices(vvve, markers);
                 }
                 if (current_item == items[1])
                 {
-                    is_dirty |= show_edges(vvve, window);
+                    is_dirty |= show_edges(vvve, markers);
                 }
             }
             ImGui::End();
 
+            frm::draw(markers, window);
+
             return is_dirty;
         }
 
+        void push_edge_line(VVVE const & vvve, VVVE::edge_t edge, sf::Color const & color, std::vector<sf::Vertex> & vertices) noexcept
+        {
+            Point const begin = vvve.vertices[edge.first].coordinate;
+            Point const end = vvve.vertices[edge.second].coordinate;
+
+            vertices.push_back({ { begin.x, begin.y }, color });
+            vertices.push_back({ { end.x, end.y }, color });
+        }
+
+        void draw_vertices(VVVE const & vvve, sf::RenderWindow & window, sf::Color const & color) noexcept
+        {
+            MarkerBatch markers{};
+            markers.vertices.reserve(marker_vertices_count * vvve.vertices.size());
+
+            for (VVVE::Vertex const & vertex : vvve.vertices)
+            {
+                add_vertex_marker(markers, vertex.coordinate, color, vertex_marker_radius);
+            }
+
+            frm::draw(markers, window);
+        }
+
         void draw(VVVE const & vvve, sf::RenderWindow & window, sf::Color const & color) noexcept
         {
-            sf::VertexArray vertices{ sf::Lines, 2 * vvve.edges.size() };
+            std::vector<sf::Vertex> vertices{};
+            vertices.reserve(2 * vvve.edges.size());
+
+            for (VVVE::edge_t const & current : vvve.edges)
+            {
+                push_edge_line(vvve, current, color, vertices);
+            }
+
+            window.draw(vertices.data(), vertices.size(), sf::Lines);
+
+            draw_vertices(vvve, window, color);
+        }
+
+        void rebuild_render_cache(VVVE const & vvve, RenderCache & cache, sf::Color const & color) noexcept
+        {
+            cache.vertices.clear();
+            cache.vertices.reserve(2 * vvve.edges.size());
+
+            for (VVVE::edge_t const & current : vvve.edges)
+            {
+                push_edge_line(vvve, current, color, cache.vertices);
+            }
+
+            // counting sort of the buffer positions by vertex
+            cache.vertex_positions_offsets.assign(vvve.vertices.size() + 1, 0);
+            for (VVVE::edge_t const & current : vvve.edges)
+            {
+                ++cache.vertex_positions_offsets[current.first + 1];
+                ++cache.vertex_positions_offsets[current.second + 1];
+            }
+            for (size_t i = 1; i < cache.vertex_positions_offsets.size(); ++i)
+            {
+                cache.vertex_positions_offsets[i] += cache.vertex_positions_offsets[i - 1];
+            }
+
+            cache.vertex_positions.resize(cache.vertices.size());
+            std::vector<size_t> next_positions(cache.vertex_positions_offsets.begin(), cache.vertex_positions_offsets.end() - 1);
+            for (size_t i = 0; i < vvve.edges.size(); ++i)
+            {
+                cache.vertex_positions[next_positions[vvve.edges[i].first]++] = 2 * i;
+                cache.vertex_positions[next_positions[vvve.edges[i].second]++] = 2 * i + 1;
+            }
+
+            cache.markers.vertices.clear();
+            cache.markers.vertices.reserve(marker_vertices_count * vvve.vertices.size());
+
+            cache.bounds = empty_box;
+
+            for (VVVE::Vertex const & vertex : vvve.vertices)
+            {
+                add_vertex_marker(cache.markers, vertex.coordinate, color, vertex_marker_radius);
+                extend_box(cache.bounds, vertex.coordinate);
+            }
+
+            if (sf::VertexBuffer::isAvailable() &&
+                cache.buffer.create(cache.vertices.size()) &&
+                cache.markers_buffer.create(cache.markers.vertices.size()))
+            {
+                cache.buffer.update(cache.vertices.data());
+                cache.markers_buffer.update(cache.markers.vertices.data());
+            }
+
+            cache.version = vvve.version;
+            cache.color = color;
+        }
+
+        void patch_render_cache(VVVE const & vvve, RenderCache & cache, size_t vertex_index) noexcept
+        {
+            sf::Vector2f const position{ vvve.vertices[vertex_index].coordinate.x, vvve.vertices[vertex_index].coordinate.y };
+
+            for (size_t i = cache.vertex_positions_offsets[vertex_index]; i < cache.vertex_positions_offsets[vertex_index + 1]; ++i)
+            {
+                size_t const vertex_position = cache.vertex_positions[i];
+
+                cache.vertices[vertex_position].position = position;
+                if (cache.buffer.getVertexCount() == cache.vertices.size())
+                {
+                    cache.buffer.update(&cache.vertices[vertex_position], 1, static_cast<unsigned>(vertex_position));
+                }
+            }
+
+            size_t const marker_position = marker_vertices_count * vertex_index;
+            set_vertex_marker(&cache.markers.vertices[marker_position], vvve.vertices[vertex_index].coordinate, cache.color, vertex_marker_radius);
+            if (cache.markers_buffer.getVertexCount() == cache.markers.vertices.size())
+            {
+                cache.markers_buffer.update(&cache.markers.vertices[marker_position], marker_vertices_count, static_cast<unsigned>(marker_position));
+            }
+
+            extend_box(cache.bounds, vvve.vertices[vertex_index].coordinate);
+
+            cache.version = vvve.version;
+        }
+
+        void update_render_cache(VVVE const & vvve, RenderCache & cache, sf::Color const & color) noexcept
+        {
+            if (cache.version != vvve.version || cache.color != color)
+            {
+                bool const is_single_move = cache.version + 1 == vvve.version &&
+                    cache.color == color &&
+                    vvve.moved_vertex != std::numeric_limits<size_t>::max();
+
+                if (is_single_move)
+                {
+                    patch_render_cache(vvve, cache, vvve.moved_vertex);
+                }
+                else
+                {
+                    rebuild_render_cache(vvve, cache, color);
+                }
+            }
+        }
+
+        void update_grids(VVVE const & vvve, RenderCache & cache) noexcept
+        {
+            if (!update_dependency(cache.grids_dependency, vvve))
+            {
+                return;
+            }
 
-            size_t index = 0;
+            cache.edges_grid.segments.clear();
+            cache.edges_grid.segments.reserve(vvve.edges.size());
 
             for (VVVE::edge_t const & current : vvve.edges)
             {
-                size_t const begin_origin = current.first;
-                vertices[2 * index].position = { vvve.vertices[begin_origin].coordinate.x, vvve.vertices[begin_origin].coordinate.y };
-                vertices[2 * index].color = color;
+                cache.edges_grid.segments.emplace_back(vvve.vertices[current.first].coordinate, vvve.vertices[current.second].coordinate);
+            }
 
-                size_t const end_origin = current.second;
-                vertices[2 * index + 1].position = { vvve.vertices[end_origin].coordinate.x, vvve.vertices[end_origin].coordinate.y };
-                vertices[2 * index + 1].color = color;
+            cache.vertices_grid.segments.clear();
+            cache.vertices_grid.segments.reserve(vvve.vertices.size());
 
-                ++index;
+            for (VVVE::Vertex const & vertex : vvve.vertices)
+            {
+                cache.vertices_grid.segments.emplace_back(vertex.coordinate, vertex.coordinate);
             }
 
-            window.draw(vertices);
+            build_segment_grid(cache.edges_grid);
+            build_segment_grid(cache.vertices_grid);
+        }
+
+        void draw(VVVE const & vvve, RenderCache & cache, sf::RenderWindow & window, sf::Color const & color) noexcept
+        {
+            ProfileScope const scope{ "vvve::draw" };
+
+            Box const view_box = get_view_box(window);
+            float const pixel_size = get_pixel_size(window);
+
+            // the buffers are kept up to date in both cases, their bounds choose between them
+            update_render_cache(vvve, cache, color);
+
+            // markers stick out of the bounds of the vertices by their radius
+            Box const marker_bounds{
+                { cache.bounds.min.x - vertex_marker_radius, cache.bounds.min.y - vertex_marker_radius },
+                { cache.bounds.max.x + vertex_marker_radius, cache.bounds.max.y + vertex_marker_radius } };
 
-            for (size_t i = 0; i < vvve.vertices.size(); ++i)
+            if (pixel_size <= lod_pixel_size && is_box_inside(marker_bounds, view_box))
             {
-                float const radius = 3.f;
-                Point const point = vvve.vertices[i].coordinate;
+                if (cache.buffer.getVertexCount() == cache.vertices.size())
+                {
+                    window.draw(cache.buffer);
+                }
+                else
+                {
+                    window.draw(cache.vertices.data(), cache.vertices.size(), sf::Lines);
+                }
 
-                sf::CircleShape circle{ radius };
-                circle.setFillColor(color);
-                circle.setOrigin(radius, radius);
-                circle.setPosition(point.x, point.y);
-                window.draw(circle);
+                if (cache.markers_buffer.getVertexCount() == cache.markers.vertices.size())
+                {
+                    window.draw(cache.markers_buffer, get_marker_render_states());
+                }
+                else
+                {
+                    frm::draw(cache.markers, window);
+                }
+                return;
+            }
+
+            if (is_visible_geometry_outdated(cache.visible, view_box, pixel_size, vvve.version, color))
+            {
+                update_grids(vvve, cache);
+
+                begin_visible_geometry(cache.visible, view_box, pixel_size, vvve.version, color);
+                add_visible_segments(cache.visible, cache.edges_grid);
+                add_visible_vertices(cache.visible, cache.vertices_grid, vertex_marker_radius);
+                end_visible_geometry(cache.visible);
             }
+
+            frm::draw(cache.visible, window);
         }
     }
 }
\ No newline at end of file
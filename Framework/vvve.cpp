@@ -35,6 +35,8 @@ namespace frm
 
         std::istream & operator>>(std::istream & is, VVVE & vvve) noexcept
         {
+            mark_changed(vvve);
+
             std::string additional_symbols;
 
             is >> additional_symbols;
@@ -76,8 +78,34 @@ namespace frm
             file_input >> vvve;
         }
 
+        void mark_changed(VVVE & vvve) noexcept
+        {
+            ++vvve.version;
+            ++vvve.structure_version;
+            ++vvve.geometry_version;
+            vvve.moved_vertex = std::numeric_limits<size_t>::max();
+        }
+
+        void mark_structure_changed(VVVE & vvve) noexcept
+        {
+            ++vvve.version;
+            ++vvve.structure_version;
+            vvve.moved_vertex = std::numeric_limits<size_t>::max();
+        }
+
+        void move_vertex(VVVE & vvve, size_t vertex_index, Point coordinate) noexcept
+        {
+            vvve.vertices[vertex_index].coordinate = coordinate;
+
+            ++vvve.version;
+            ++vvve.geometry_version;
+            vvve.moved_vertex = vertex_index;
+        }
+
         void add_vertex(VVVE & vvve, Point coordinate) noexcept
         {
+            mark_structure_changed(vvve);
+
             vvve.vertices.push_back({ coordinate });
         }
 
@@ -86,6 +114,8 @@ namespace frm
             assert(begin_vertex_index < vvve.vertices.size());
             assert(end_vertex_index < vvve.vertices.size());
 
+            mark_structure_changed(vvve);
+
             VVVE::edge_t edge{};
             edge.first = begin_vertex_index;
             edge.second = end_vertex_index;
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "common.h"
+#include "common_ui_part.h"
+#include "view_culling.h"
+#include "dependency.h"
 
 #include "SFML\Graphics.hpp"
 
 #include <vector>
+#include <limits>
 
 
 namespace frm
@@ -24,6 +28,48 @@ namespace frm
 
             std::vector<Vertex> vertices{};
             std::vector<edge_t> edges{};
+
+            // incremented by every change, see mark_changed and move_vertex
+            size_t version{ 0 };
+            // incremented when elements are added, removed or reconnected
+            size_t structure_version{ 0 };
+            // incremented when existing vertices are moved or removed,
+            // appended vertices change only the structure
+            size_t geometry_version{ 0 };
+            // vertex moved by the last change,
+            // std::numeric_limits<size_t>::max() if the last change was not a single vertex move
+            size_t moved_vertex{ std::numeric_limits<size_t>::max() };
+        };
+
+        // radius of the disc drawn at every vertex
+        static constexpr float vertex_marker_radius = 3.f;
+
+        // Edges and vertex markers of a vvve kept in GPU memory between frames,
+        // rebuilt only if the vvve version changes and patched in place for a single vertex move.
+        // If a part of the vvve is outside of the view or the view is zoomed out,
+        // only the visible edges and vertices found by the grids are drawn.
+        struct RenderCache
+        {
+            sf::VertexBuffer buffer{ sf::Lines, sf::VertexBuffer::Static };
+            // copy of the buffer, drawn directly if vertex buffers are not available
+            std::vector<sf::Vertex> vertices{};
+            // positions in vertices that belong to vertex i:
+            // vertex_positions[vertex_positions_offsets[i], vertex_positions_offsets[i + 1])
+            std::vector<size_t> vertex_positions_offsets{};
+            std::vector<size_t> vertex_positions{};
+            // marker of vertex i starts at i * marker_vertices_count
+            MarkerBatch markers{};
+            sf::VertexBuffer markers_buffer{ sf::Triangles, sf::VertexBuffer::Static };
+            // bounds of the vertices, only grow with patches
+            Box bounds{ empty_box };
+            size_t version{ std::numeric_limits<size_t>::max() };
+            sf::Color color{};
+
+            // built on demand
+            SegmentGrid edges_grid{};
+            SegmentGrid vertices_grid{};
+            Dependency grids_dependency{};
+            VisibleGeometry visible{};
         };
 
         std::ostream & operator<<(std::ostream & os, VVVE const & vvve) noexcept;
@@ -32,6 +78,13 @@ namespace frm
         void safe_to_file(std::string const & path, VVVE const & vvve) noexcept;
         void load_from_file(std::string const & path, VVVE & vvve) noexcept;
 
+        // Every change of a vvve made outside of the functions below has to be reported,
+        // so the data built from the vvve (render cache) can find out that it is outdated
+        // changes of both structure and geometry
+        void mark_changed(VVVE & vvve) noexcept;
+        void mark_structure_changed(VVVE & vvve) noexcept;
+        void move_vertex(VVVE & vvve, size_t vertex_index, Point coordinate) noexcept;
+
         void add_vertex(VVVE & vvve, Point coordinate) noexcept;
 
         void add_edge_between_two_vertices(VVVE & vvve, size_t begin_vertex_index, size_t end_vertex_index) noexcept(!IS_DEBUG);
@@ -39,5 +92,8 @@ namespace frm
         bool spawn_ui(VVVE & vvve, sf::RenderWindow & window, std::string const & path) noexcept;
 
         void draw(VVVE const & vvve, sf::RenderWindow & window, sf::Color const & color = sf::Color::White) noexcept;
+        // O(1) if neither vvve nor the view changed since the previous call with this cache,
+        // a changed view costs only the visible edges and vertices
+        void draw(VVVE const & vvve, RenderCache & cache, sf::RenderWindow & window, sf::Color const & color = sf::Color::White) noexcept;
     }
 }
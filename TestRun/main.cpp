@@ -5,11 +5,13 @@
 
 #include "triangulation.h"
 #include "trapezoidal_decomposition.h"
-#include "quick_hull.h"
+#include "dynamic_hull.h"
 #include "common_ui_part.h"
 #include "nearest_point.h"
 #include "nearest_line.h"
 #include "apply_hull.h"
+#include "dcel_history.h"
+#include "profiler.h"
 
 
 #include "imgui/imgui.h"
@@ -30,15 +32,39 @@ int main()
     frm::Application application{};
 
     bool need_trapezoid_data = false;
-    bool is_dirty = true;
-
-    application.set_on_event([&dcel,
+    // incremented when the selection is changed by a click, so the panels take it
+    size_t selection_version = 0;
+
+    // hull of the first hull_vertices_count vertices of dcel,
+    // appended vertices are inserted, other changes of the vertices make it start over
+    frm::DynamicHull hull{};
+    size_t hull_vertices_count = 0;
+    frm::Dependency hull_dependency{ frm::DependsOn::Geometry };
+
+    frm::dcel::RenderCache render_cache{};
+    // markers of the selection, drawn with a single call
+    frm::MarkerBatch selection_markers{};
+
+    // undo of the changes made by the panels and the triangulation
+    frm::dcel::History history{};
+
+    // triangulation and trapezoid map are built by background jobs on snapshots of dcel
+    size_t triangulation_job = frm::Application::invalid_job_id;
+    size_t trapezoid_job = frm::Application::invalid_job_id;
+    frm::Dependency trapezoid_dependency{};
+    frm::set_up_to_date(trapezoid_dependency, dcel);
+    // versions the trapezoid job was cancelled at, it is not started again until dcel changes
+    frm::Dependency trapezoid_cancelled_dependency{};
+
+    application.set_on_event([&application,
+        &dcel,
         &current_vertex,
         &current_edge,
         &current_face,
         &trapezoid_data_and_graph_root,
         &need_trapezoid_data,
-        &is_dirty
+        &selection_version,
+        &trapezoid_dependency
     ](sf::Event current_event) noexcept
         {
             if (current_event.type == sf::Event::MouseButtonPressed &&
@@ -47,9 +73,15 @@ int main()
                 int x = current_event.mouseButton.x;
                 int y = current_event.mouseButton.y;
 
-                frm::Point point{ static_cast<float>(x), static_cast<float>(y) };
+                // the view may be zoomed or moved
+                sf::Vector2f const position = application.get_window().mapPixelToCoords({ x, y });
+
+                frm::Point point{ position.x, position.y };
+
+                frm::ProfileScope const scope{ "selection queries" };
 
-                if (need_trapezoid_data)
+                // the map of an older dcel may point to faces that don't exist anymore
+                if (need_trapezoid_data && !frm::is_outdated(trapezoid_dependency, dcel))
                 {
                     current_face = frm::get_face_index(trapezoid_data_and_graph_root, point);
                 }
@@ -57,67 +89,153 @@ int main()
                 current_vertex = frm::nearest_point(dcel, point);
                 current_edge = frm::nearest_line(dcel, point);
 
-                is_dirty = true;
+                ++selection_version;
             }
         });
 
-    application.set_on_update([&dcel,
+    application.set_on_update([&application,
+        &dcel,
         &trapezoid_data_and_graph_root,
         &current_vertex,
         &current_edge,
         &current_face,
         &need_trapezoid_data,
-        &is_dirty
+        &selection_version,
+        &hull,
+        &hull_vertices_count,
+        &hull_dependency,
+        &render_cache,
+        &selection_markers,
+        &history,
+        &triangulation_job,
+        &trapezoid_job,
+        &trapezoid_dependency,
+        &trapezoid_cancelled_dependency
     ](float dt, sf::RenderWindow & window) noexcept
         {
-            frm::dcel::draw(dcel, window);
-
-            bool is_dirty_trapezoid = false;
+            frm::dcel::draw(dcel, render_cache, window);
 
             static bool is_active = false;
             if (ImGui::Begin("Triangulation", &is_active))
             {
-                if (ImGui::Button("Triangulate"))
+                if (application.is_job_running(triangulation_job))
+                {
+                    ImGui::Text("Triangulating");
+                }
+                else if (ImGui::Button("Triangulate"))
                 {
-                    frm::vvve::VVVE vvve = frm::dcel_to_vvve(dcel);
-                    frm::quick_hull(vvve);
+                    // only vertices added since the last time are inserted into the hull
+                    frm::HullDelta hull_delta{};
 
-                    frm::apply_hull(dcel, vvve);
+                    for (; hull_vertices_count < dcel.vertices.size(); ++hull_vertices_count)
+                    {
+                        if (dcel.vertices[hull_vertices_count].is_exist)
+                        {
+                            frm::merge_hull_delta(hull_delta,
+                                frm::insert_point(hull, dcel.vertices[hull_vertices_count].coordinate, hull_vertices_count));
+                        }
+                    }
 
-                    frm::triangulation(dcel);
-                    is_dirty_trapezoid = true;
+                    auto const snapshot = std::make_shared<frm::dcel::DCEL>(dcel);
+
+                    frm::Dependency snapshot_dependency{};
+                    frm::set_up_to_date(snapshot_dependency, dcel);
+
+                    triangulation_job = application.start_job("Triangulation",
+                        [snapshot, added_edges = std::move(hull_delta.added_edges)](frm::JobProgress & progress) noexcept
+                        {
+                            frm::apply_hull(*snapshot, added_edges);
+
+                            if (!progress.is_cancelled)
+                            {
+                                frm::triangulation(*snapshot, &progress.is_cancelled, &progress.progress);
+                            }
+                        },
+                        [&dcel, &hull, &hull_vertices_count, snapshot, snapshot_dependency](bool is_cancelled) noexcept
+                        {
+                            // dcel was changed while the job was running, the result is outdated
+                            if (is_cancelled || frm::is_outdated(snapshot_dependency, dcel))
+                            {
+                                // edges of the inserted vertices were not applied
+                                frm::clear(hull);
+                                hull_vertices_count = 0;
+                                return;
+                            }
+
+                            // versions of the snapshot continue the ones of dcel
+                            dcel = std::move(*snapshot);
+                        });
                 }
             }
             ImGui::End();
 
-            is_dirty_trapezoid |= frm::dcel::spawn_ui(dcel, current_vertex, current_edge, current_face,  window, "Dcel_1.dat", is_dirty);
+            frm::dcel::spawn_ui(dcel, current_vertex, current_edge, current_face,  window, "Dcel_1.dat", selection_version);
+            frm::dcel::spawn_history_ui(history, dcel);
+
+            // vertices were moved, removed or reloaded, hull has to be built again
+            if (frm::update_dependency(hull_dependency, dcel))
+            {
+                frm::clear(hull);
+                hull_vertices_count = 0;
+            }
 
             if (ImGui::Begin("Need trapezoid data"))
             {
-                is_dirty_trapezoid |= ImGui::Checkbox("need_trapezoid_data", &need_trapezoid_data);
+                ImGui::Checkbox("need_trapezoid_data", &need_trapezoid_data);
             }
             ImGui::End();
 
             if (need_trapezoid_data)
             {
-                if (is_dirty_trapezoid)
+                // a single job at a time, changes made while it runs start the next one
+                if (frm::is_outdated(trapezoid_dependency, dcel) &&
+                    frm::is_outdated(trapezoid_cancelled_dependency, dcel) &&
+                    !application.is_job_running(trapezoid_job))
                 {
-                    trapezoid_data_and_graph_root = frm::generate_trapezoid_data_and_graph_root(dcel);
-                    current_face = frm::dcel::get_outside_face_index(dcel);
+                    auto const snapshot = std::make_shared<frm::dcel::DCEL>(dcel);
+                    auto const result = std::make_shared<frm::trapezoid_data_and_graph_root_t>();
+
+                    frm::Dependency snapshot_dependency{};
+                    frm::set_up_to_date(snapshot_dependency, dcel);
+
+                    trapezoid_job = application.start_job("Trapezoid map",
+                        [snapshot, result](frm::JobProgress & progress) noexcept
+                        {
+                            *result = frm::generate_trapezoid_data_and_graph_root(*snapshot, &progress.is_cancelled);
+                            progress.progress = 1.f;
+                        },
+                        [&dcel, &trapezoid_data_and_graph_root, &current_face, &trapezoid_dependency, &trapezoid_cancelled_dependency, result, snapshot_dependency](bool is_cancelled) noexcept
+                        {
+                            if (is_cancelled)
+                            {
+                                trapezoid_cancelled_dependency = snapshot_dependency;
+                                return;
+                            }
+
+                            if (frm::is_outdated(snapshot_dependency, dcel))
+                            {
+                                return;
+                            }
+
+                            trapezoid_data_and_graph_root = std::move(*result);
+                            trapezoid_dependency = snapshot_dependency;
+                            current_face = frm::dcel::get_outside_face_index(dcel);
+                        });
                 }
 
                 float color[4] = { 0.f, 0.f, 1.f, 0.5f };
                 float radius = 10.f;
+                selection_markers.vertices.clear();
                 if (frm::dcel::is_vertices_mode())
                 {
-                    frm::draw_vertex_highlighted(dcel.vertices[current_vertex].coordinate, color, radius, window);
+                    frm::draw_vertex_highlighted(selection_markers, dcel.vertices[current_vertex].coordinate, color, radius);
                 }
                 if (frm::dcel::is_edges_mode())
                 {
                     frm::Point begin_point = dcel.vertices[dcel.edges[current_edge].origin_vertex].coordinate;
                     frm::Point end_point = dcel.vertices[dcel.edges[dcel.edges[current_edge].twin_edge].origin_vertex].coordinate;
 
-                    frm::draw_edge_highlighted(begin_point, end_point, color, radius, window);
+                    frm::draw_edge_highlighted(selection_markers, begin_point, end_point, color, radius);
                 }
                 if (frm::dcel::is_faces_mode())
                 {
@@ -126,6 +244,8 @@ int main()
                         frm::dcel::draw_face_highlighted(current_face, dcel, color, window);
                     }
                 }
+
+                frm::draw(selection_markers, window);
             }
         });
 
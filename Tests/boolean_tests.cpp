@@ -0,0 +1,129 @@
+#include "tests.h"
+#include "reference.h"
+
+#include "dcel.h"
+#include "dcel_validation.h"
+#include "generators.h"
+#include "boolean_operations.h"
+#include "view_culling.h"
+
+#include <vector>
+#include <random>
+#include <utility>
+
+
+static frm::dcel::BooleanOperation const boolean_operations[] = {
+    frm::dcel::BooleanOperation::Union,
+    frm::dcel::BooleanOperation::Intersection,
+    frm::dcel::BooleanOperation::Difference,
+    frm::dcel::BooleanOperation::SymmetricDifference };
+
+static bool is_inside(frm::dcel::BooleanOperation operation, bool is_in_first, bool is_in_second) noexcept
+{
+    switch (operation)
+    {
+    case frm::dcel::BooleanOperation::Union:
+        return is_in_first || is_in_second;
+    case frm::dcel::BooleanOperation::Intersection:
+        return is_in_first && is_in_second;
+    case frm::dcel::BooleanOperation::Difference:
+        return is_in_first && !is_in_second;
+    default:
+        return is_in_first != is_in_second;
+    }
+}
+
+// Random points must be inside of the result exactly when the operation takes them from the regions of the inputs,
+// the regions are all the faces but the outside ones. Points too close to an edge of any of the three are skipped.
+static size_t get_inside_mismatches_count(frm::dcel::DCEL const & first,
+    frm::dcel::DCEL const & second,
+    frm::dcel::BooleanOperation operation,
+    frm::dcel::BooleanResult const & result) noexcept
+{
+    frm::Box bounds = frm::empty_box;
+    for (frm::dcel::DCEL const * const dcel : { &first, &second })
+    {
+        for (frm::dcel::DCEL::Vertex const & vertex : dcel->vertices)
+        {
+            frm::extend_box(bounds, vertex.coordinate);
+        }
+    }
+
+    size_t const first_outside_face = frm::dcel::get_outside_face_index(first);
+    size_t const second_outside_face = frm::dcel::get_outside_face_index(second);
+
+    std::mt19937 engine{ 9 };
+    std::uniform_real_distribution<float> x_distribution{ bounds.min.x - 10.f, bounds.max.x + 10.f };
+    std::uniform_real_distribution<float> y_distribution{ bounds.min.y - 10.f, bounds.max.y + 10.f };
+
+    size_t mismatches_count = 0;
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        frm::Point const point{ x_distribution(engine), y_distribution(engine) };
+        size_t const first_face = get_face_index_by_ray(first, point);
+        size_t const second_face = get_face_index_by_ray(second, point);
+        // nothing is inside of an empty result
+        size_t const face = result.dcel.edges.empty() ? 0 : get_face_index_by_ray(result.dcel, point);
+
+        if (face != no_face && first_face != no_face && second_face != no_face &&
+            (result.is_face_inside[face] != 0) != is_inside(operation, first_face != first_outside_face, second_face != second_outside_face))
+        {
+            ++mismatches_count;
+        }
+    }
+
+    return mismatches_count;
+}
+
+void add_boolean_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "boolean/regions", [](TestContext & context) noexcept
+        {
+            std::pair<frm::dcel::DCEL, frm::dcel::DCEL> const inputs[] = {
+                { frm::generate_simple_polygon(80, 1), frm::generate_grid(6, 6, 2) },
+                { frm::generate_polygon_with_holes(300, 4, 3), frm::generate_simple_polygon(100, 4) },
+                { frm::generate_nested_islands(4, 3, 20, 5), frm::generate_cell_map(8, 8, 6) },
+                // the boundaries overlap everywhere
+                { frm::generate_simple_polygon(50, 7), frm::generate_simple_polygon(50, 7) } };
+
+            for (std::pair<frm::dcel::DCEL, frm::dcel::DCEL> const & input : inputs)
+            {
+                for (frm::dcel::BooleanOperation const operation : boolean_operations)
+                {
+                    frm::dcel::BooleanResult const result = frm::dcel::apply_boolean_operation(input.first, input.second, operation);
+
+                    CHECK(context, frm::dcel::validate(result.dcel).issues_count == 0);
+                    CHECK(context, result.is_face_inside.size() == result.dcel.faces.size());
+                    CHECK(context, get_inside_mismatches_count(input.first, input.second, operation, result) == 0);
+                }
+            }
+        } });
+
+    tests.push_back({ "boolean/empty_result", [](TestContext & context) noexcept
+        {
+            // the polygon is centered at the origin, the grid is far to the right of it
+            frm::dcel::DCEL const polygon = frm::generate_simple_polygon(30, 1);
+            frm::dcel::DCEL grid = frm::generate_grid(3, 3, 2);
+            for (size_t i = 0; i < grid.vertices.size(); ++i)
+            {
+                frm::Point const coordinate = grid.vertices[i].coordinate;
+                frm::dcel::move_vertex(grid, i, { coordinate.x + 1e4f, coordinate.y });
+            }
+
+            for (frm::dcel::BooleanResult const & result : {
+                frm::dcel::apply_boolean_operation(polygon, grid, frm::dcel::BooleanOperation::Intersection),
+                frm::dcel::apply_boolean_operation(polygon, polygon, frm::dcel::BooleanOperation::Difference),
+                frm::dcel::apply_boolean_operation(polygon, polygon, frm::dcel::BooleanOperation::SymmetricDifference) })
+            {
+                CHECK(context, result.dcel.edges.empty());
+                CHECK(context, frm::dcel::validate(result.dcel).issues_count == 0);
+
+                bool is_nothing_inside = true;
+                for (uint8_t const is_face_inside : result.is_face_inside)
+                {
+                    is_nothing_inside &= is_face_inside == 0;
+                }
+                CHECK(context, is_nothing_inside);
+            }
+        } });
+}
@@ -0,0 +1,34 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "dcel_validation.h"
+#include "generators.h"
+
+#include <vector>
+
+
+static frm::SubdivisionKind const subdivision_kinds[] = {
+    frm::SubdivisionKind::SimplePolygon,
+    frm::SubdivisionKind::PolygonWithHoles,
+    frm::SubdivisionKind::Grid,
+    frm::SubdivisionKind::CellMap,
+    frm::SubdivisionKind::NestedIslands };
+
+void add_generator_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "generators/small_sizes", [](TestContext & context) noexcept
+        {
+            // sizes below the smallest subdivision of the kind are clamped to it
+            for (frm::SubdivisionKind const kind : subdivision_kinds)
+            {
+                for (size_t size = 0; size <= 3; ++size)
+                {
+                    frm::dcel::DCEL const dcel = frm::generate_dcel(kind, size, 1);
+
+                    CHECK(context, dcel.vertices.size() >= 3);
+                    CHECK(context, dcel.faces.size() >= 2);
+                    CHECK(context, frm::dcel::validate(dcel).issues_count == 0);
+                }
+            }
+        } });
+}
@@ -0,0 +1,187 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "dcel_history.h"
+#include "generators.h"
+
+#include <vector>
+
+
+static bool is_same_dcel(frm::dcel::DCEL const & a, frm::dcel::DCEL const & b) noexcept
+{
+    if (a.vertices.size() != b.vertices.size() || a.edges.size() != b.edges.size() || a.faces.size() != b.faces.size() ||
+        a.free_vertices != b.free_vertices || a.free_edges != b.free_edges || a.free_faces != b.free_faces)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.vertices.size(); ++i)
+    {
+        frm::dcel::DCEL::Vertex const & first = a.vertices[i];
+        frm::dcel::DCEL::Vertex const & second = b.vertices[i];
+
+        if (first.coordinate.x != second.coordinate.x || first.coordinate.y != second.coordinate.y ||
+            first.incident_edge != second.incident_edge || first.is_exist != second.is_exist)
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < a.edges.size(); ++i)
+    {
+        frm::dcel::DCEL::Edge const & first = a.edges[i];
+        frm::dcel::DCEL::Edge const & second = b.edges[i];
+
+        if (first.origin_vertex != second.origin_vertex || first.twin_edge != second.twin_edge ||
+            first.incident_face != second.incident_face || first.next_edge != second.next_edge ||
+            first.previous_edge != second.previous_edge || first.is_exist != second.is_exist)
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < a.faces.size(); ++i)
+    {
+        if (a.faces[i].edge != b.faces[i].edge || a.faces[i].is_exist != b.faces[i].is_exist)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// index of the vertex the next insertion takes
+static size_t get_next_vertex_index(frm::dcel::DCEL const & dcel) noexcept
+{
+    return dcel.free_vertices.empty() ? dcel.vertices.size() : dcel.free_vertices.back();
+}
+
+void add_history_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "history/undo_redo", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL dcel = frm::generate_grid(3, 3, 1);
+            frm::dcel::History history{};
+            frm::dcel::update_history(history, dcel);
+
+            std::vector<frm::dcel::DCEL> states{ dcel };
+
+            // appended vertex and edges
+            size_t const new_vertex = get_next_vertex_index(dcel);
+            frm::dcel::add_vertex_and_connect_to_edge_origin(dcel, { -1.f, -1.f }, 0);
+            frm::dcel::update_history(history, dcel);
+            states.push_back(dcel);
+
+            // every moved vertex is kept once however often it moves
+            frm::dcel::move_vertex(dcel, new_vertex, { -2.f, -1.f });
+            frm::dcel::move_vertex(dcel, 1, { 0.5f, 0.1f });
+            frm::dcel::move_vertex(dcel, new_vertex, { -3.f, -1.f });
+            frm::dcel::move_vertex(dcel, 1, { 0.5f, 0.2f });
+            frm::dcel::update_history(history, dcel);
+            states.push_back(dcel);
+            CHECK(context, history.undo_deltas.back().vertices.indices.size() == 2);
+            CHECK(context, history.undo_deltas.back().vertices.previous_records.size() == 2);
+
+            // freed elements taken again from the free lists
+            frm::dcel::remove_vertex_with_single_edge(dcel, new_vertex);
+            size_t const reused_vertex = get_next_vertex_index(dcel);
+            frm::dcel::add_vertex_and_connect_to_edge_origin(dcel, { 4.f, 4.f }, 2);
+            frm::dcel::move_vertex(dcel, reused_vertex, { 5.f, 4.f });
+            frm::dcel::update_history(history, dcel);
+            states.push_back(dcel);
+            CHECK(context, reused_vertex == new_vertex);
+
+            for (size_t i = states.size() - 1; i-- > 0;)
+            {
+                CHECK(context, frm::dcel::undo(history, dcel));
+                CHECK(context, is_same_dcel(dcel, states[i]));
+            }
+            CHECK(context, !frm::dcel::undo(history, dcel));
+
+            for (size_t i = 1; i < states.size(); ++i)
+            {
+                CHECK(context, frm::dcel::redo(history, dcel));
+                CHECK(context, is_same_dcel(dcel, states[i]));
+            }
+            CHECK(context, !frm::dcel::redo(history, dcel));
+
+            // a new change drops the redo stack
+            frm::dcel::undo(history, dcel);
+            frm::dcel::move_vertex(dcel, 0, { 0.1f, 0.1f });
+            CHECK(context, !frm::dcel::redo(history, dcel));
+            CHECK(context, frm::dcel::undo(history, dcel));
+            CHECK(context, is_same_dcel(dcel, states[2]));
+        } });
+
+    tests.push_back({ "history/continued_move", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL dcel = frm::generate_grid(3, 3, 1);
+            frm::dcel::History history{};
+            frm::dcel::update_history(history, dcel);
+
+            frm::dcel::DCEL const original = dcel;
+
+            // a drag moves the vertex on every update, it is a single delta
+            for (size_t i = 1; i <= 10; ++i)
+            {
+                frm::dcel::move_vertex(dcel, 4, { 1.f + 0.01f * static_cast<float>(i), 1.f });
+                frm::dcel::update_history(history, dcel, true);
+            }
+            frm::dcel::update_history(history, dcel);
+            CHECK(context, history.undo_deltas.size() == 1);
+
+            frm::dcel::DCEL const dragged = dcel;
+
+            // the next drag of the same vertex is a new delta
+            frm::dcel::move_vertex(dcel, 4, { 1.f, 1.5f });
+            frm::dcel::update_history(history, dcel, true);
+            frm::dcel::move_vertex(dcel, 4, { 1.f, 1.6f });
+            frm::dcel::update_history(history, dcel, true);
+            CHECK(context, history.undo_deltas.size() == 2);
+
+            // another vertex or other changes are not merged into the drag
+            frm::dcel::move_vertex(dcel, 0, { 0.1f, 0.f });
+            frm::dcel::update_history(history, dcel, true);
+            CHECK(context, history.undo_deltas.size() == 3);
+
+            CHECK(context, frm::dcel::undo(history, dcel));
+            CHECK(context, frm::dcel::undo(history, dcel));
+            CHECK(context, is_same_dcel(dcel, dragged));
+            CHECK(context, frm::dcel::undo(history, dcel));
+            CHECK(context, is_same_dcel(dcel, original));
+
+            CHECK(context, frm::dcel::redo(history, dcel));
+            CHECK(context, is_same_dcel(dcel, dragged));
+        } });
+
+    tests.push_back({ "history/memory_limit", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL dcel = frm::generate_grid(3, 3, 1);
+            frm::dcel::History history{};
+            frm::dcel::update_history(history, dcel);
+
+            frm::dcel::move_vertex(dcel, 0, { 0.1f, 0.f });
+            frm::dcel::update_history(history, dcel);
+            size_t const delta_memory_size = history.memory_size;
+
+            // room for two deltas of a moved vertex, the oldest one is dropped
+            history.memory_limit = 2 * delta_memory_size;
+            frm::dcel::move_vertex(dcel, 0, { 0.2f, 0.f });
+            frm::dcel::update_history(history, dcel);
+            frm::dcel::move_vertex(dcel, 0, { 0.3f, 0.f });
+            frm::dcel::update_history(history, dcel);
+            CHECK(context, history.undo_deltas.size() == 2);
+            CHECK(context, history.memory_size <= history.memory_limit);
+
+            // a delta above the limit alone can't be kept and the older ones can't be undone without it
+            for (size_t i = 0; i < 16; ++i)
+            {
+                frm::dcel::move_vertex(dcel, i, { static_cast<float>(i), 10.f });
+            }
+            frm::dcel::update_history(history, dcel);
+            CHECK(context, history.undo_deltas.empty());
+            CHECK(context, history.memory_size == 0);
+            CHECK(context, !frm::dcel::undo(history, dcel));
+        } });
+}
@@ -0,0 +1,201 @@
+#include "tests.h"
+
+#include "convex_hull.h"
+#include "quick_hull.h"
+#include "dynamic_hull.h"
+#include "generators.h"
+#include "predicates.h"
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+
+static frm::PointDistribution const hull_distributions[] = {
+    frm::PointDistribution::Uniform,
+    frm::PointDistribution::Clustered,
+    frm::PointDistribution::Circular,
+    frm::PointDistribution::Collinear };
+
+static size_t const hull_sizes[] = { 3, 10, 1000, 100000 };
+
+static std::vector<frm::Point> get_points(frm::vvve::VVVE const & vvve) noexcept
+{
+    std::vector<frm::Point> points(vvve.vertices.size());
+
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        points[i] = vvve.vertices[i].coordinate;
+    }
+
+    return points;
+}
+
+// hull vertices sorted by x and then by y, so hulls with other duplicates of the same points are equal
+static std::vector<std::pair<float, float>> get_hull_points(frm::vvve::VVVE const & vvve, std::vector<frm::vvve::VVVE::edge_t> const & edges) noexcept
+{
+    std::vector<std::pair<float, float>> points{};
+
+    for (frm::vvve::VVVE::edge_t const & edge : edges)
+    {
+        for (size_t const index : { edge.first, edge.second })
+        {
+            frm::Point const point = vvve.vertices[index].coordinate;
+            points.push_back({ point.x, point.y });
+        }
+    }
+
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    return points;
+}
+
+// quick_hull may keep points lying on a hull edge, every such point must have
+// two hull neighbours collinear with it
+static bool has_collinear_neighbours(frm::vvve::VVVE const & vvve, std::vector<frm::vvve::VVVE::edge_t> const & edges, std::pair<float, float> point) noexcept
+{
+    std::vector<frm::Point> neighbours{};
+
+    for (frm::vvve::VVVE::edge_t const & edge : edges)
+    {
+        frm::Point const first = vvve.vertices[edge.first].coordinate;
+        frm::Point const second = vvve.vertices[edge.second].coordinate;
+
+        if (first.x == point.first && first.y == point.second)
+        {
+            neighbours.push_back(second);
+        }
+        else if (second.x == point.first && second.y == point.second)
+        {
+            neighbours.push_back(first);
+        }
+    }
+
+    return neighbours.size() == 2 && frm::orient2d(neighbours[0], { point.first, point.second }, neighbours[1]) == 0.;
+}
+
+// edges as unordered index pairs, sorted, the algorithms emit them in different order
+static std::vector<frm::vvve::VVVE::edge_t> get_sorted_edges(std::vector<frm::vvve::VVVE::edge_t> edges) noexcept
+{
+    for (frm::vvve::VVVE::edge_t & edge : edges)
+    {
+        edge = { std::min(edge.first, edge.second), std::max(edge.first, edge.second) };
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    return edges;
+}
+
+void add_hull_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "hull/quick_hull", [](TestContext & context) noexcept
+        {
+            for (frm::PointDistribution const distribution : hull_distributions)
+            {
+                for (size_t const size : hull_sizes)
+                {
+                    frm::vvve::VVVE vvve = frm::generate_vvve(distribution, size, 7);
+                    std::vector<frm::Point> const points = get_points(vvve);
+                    std::vector<std::pair<float, float>> const expected = get_hull_points(vvve, frm::convex_hull(points.data(), points.size(), frm::HullAlgorithm::MonotoneChain));
+
+                    frm::quick_hull(vvve);
+                    std::vector<std::pair<float, float>> const found = get_hull_points(vvve, vvve.edges);
+
+                    CHECK(context, std::includes(found.begin(), found.end(), expected.begin(), expected.end()));
+
+                    std::vector<std::pair<float, float>> extra{};
+                    std::set_difference(found.begin(), found.end(), expected.begin(), expected.end(), std::back_inserter(extra));
+
+                    for (std::pair<float, float> const point : extra)
+                    {
+                        CHECK(context, has_collinear_neighbours(vvve, vvve.edges, point));
+                    }
+                }
+            }
+        } });
+
+    tests.push_back({ "hull/quick_hull_parallel", [](TestContext & context) noexcept
+        {
+            // the largest size splits into tasks over several levels
+            for (frm::PointDistribution const distribution : hull_distributions)
+            {
+                for (size_t const size : { size_t{ 3 }, size_t{ 1000 }, size_t{ 1000000 } })
+                {
+                    frm::vvve::VVVE vvve = frm::generate_vvve(distribution, size, 11);
+                    frm::vvve::VVVE parallel_vvve = vvve;
+
+                    frm::quick_hull(vvve);
+                    frm::quick_hull_parallel(parallel_vvve);
+
+                    CHECK(context, get_sorted_edges(parallel_vvve.edges) == get_sorted_edges(vvve.edges));
+                }
+            }
+        } });
+
+    tests.push_back({ "hull/algorithms_agree", [](TestContext & context) noexcept
+        {
+            for (frm::PointDistribution const distribution : hull_distributions)
+            {
+                for (size_t const size : hull_sizes)
+                {
+                    std::vector<frm::Point> const points = get_points(frm::generate_vvve(distribution, size, 5));
+                    std::vector<frm::vvve::VVVE::edge_t> const expected = frm::convex_hull(points.data(), points.size(), frm::HullAlgorithm::MonotoneChain);
+
+                    CHECK(context, frm::convex_hull(points.data(), points.size(), frm::HullAlgorithm::QuickHull) == expected);
+                    CHECK(context, frm::convex_hull(points.data(), points.size(), frm::HullAlgorithm::Chan) == expected);
+                }
+            }
+        } });
+
+    tests.push_back({ "hull/signed_zeros", [](TestContext & context) noexcept
+        {
+            // -0 and +0 are the same x, so the leftmost point is the lower one of the left edge
+            std::vector<frm::Point> const points = { { -0.f, 5.f }, { 0.f, 1.f }, { 1.f, 0.f }, { 1.f, 6.f } };
+            std::vector<frm::vvve::VVVE::edge_t> const expected = { { 1, 2 }, { 2, 3 }, { 3, 0 }, { 0, 1 } };
+
+            for (frm::HullAlgorithm const algorithm : { frm::HullAlgorithm::QuickHull, frm::HullAlgorithm::MonotoneChain, frm::HullAlgorithm::Chan })
+            {
+                CHECK(context, frm::convex_hull(points.data(), points.size(), algorithm) == expected);
+            }
+        } });
+
+    tests.push_back({ "hull/dynamic_hull", [](TestContext & context) noexcept
+        {
+            // collinear points are left out, the degenerate hulls of the static algorithms differ
+            for (frm::PointDistribution const distribution : { frm::PointDistribution::Uniform, frm::PointDistribution::Clustered, frm::PointDistribution::Circular })
+            {
+                std::vector<frm::Point> const points = get_points(frm::generate_vvve(distribution, 2000, 3));
+
+                // the first half is inserted before the accumulated delta, the second half into it
+                frm::DynamicHull hull{};
+                size_t const middle = points.size() / 2;
+
+                for (size_t i = 0; i < middle; ++i)
+                {
+                    frm::insert_point(hull, points[i], i);
+                }
+
+                std::vector<frm::vvve::VVVE::edge_t> edges = get_sorted_edges(frm::get_hull_edges(hull));
+                frm::HullDelta delta{};
+
+                for (size_t i = middle; i < points.size(); ++i)
+                {
+                    frm::merge_hull_delta(delta, frm::insert_point(hull, points[i], i));
+                }
+
+                std::vector<frm::vvve::VVVE::edge_t> const removed_edges = get_sorted_edges(delta.removed_edges);
+                CHECK(context, std::includes(edges.begin(), edges.end(), removed_edges.begin(), removed_edges.end()));
+
+                std::vector<frm::vvve::VVVE::edge_t> kept_edges{};
+                std::set_difference(edges.begin(), edges.end(), removed_edges.begin(), removed_edges.end(), std::back_inserter(kept_edges));
+                kept_edges.insert(kept_edges.end(), delta.added_edges.begin(), delta.added_edges.end());
+
+                std::vector<frm::vvve::VVVE::edge_t> const hull_edges = get_sorted_edges(frm::get_hull_edges(hull));
+                CHECK(context, get_sorted_edges(kept_edges) == hull_edges);
+                CHECK(context, delta.added_edge_positions.size() == delta.added_edges.size());
+                CHECK(context, hull_edges == get_sorted_edges(frm::convex_hull(points.data(), points.size(), frm::HullAlgorithm::MonotoneChain)));
+            }
+        } });
+}
@@ -0,0 +1,86 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "generators.h"
+
+#include <vector>
+#include <algorithm>
+
+
+static bool has_change(std::vector<frm::dcel::Change> const & changes,
+    frm::dcel::Change::Element element,
+    frm::dcel::Change::Kind kind,
+    size_t index) noexcept
+{
+    return std::any_of(changes.begin(), changes.end(), [element, kind, index](frm::dcel::Change const & change) noexcept
+        {
+            return change.element == element && change.kind == kind && change.index == index;
+        });
+}
+
+void add_journal_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "journal/changes_since", [](TestContext & context) noexcept
+        {
+            using Element = frm::dcel::Change::Element;
+            using Kind = frm::dcel::Change::Kind;
+
+            frm::dcel::DCEL dcel = frm::generate_grid(3, 3, 1);
+            std::vector<frm::dcel::Change> changes{};
+
+            // nothing is known while the journal is disabled
+            CHECK(context, !frm::dcel::get_changes_since(dcel, dcel.version, changes));
+
+            frm::dcel::enable_journal(dcel);
+            size_t const version = dcel.version;
+
+            frm::dcel::move_vertex(dcel, 2, { 0.5f, 0.5f });
+            size_t const moved_version = dcel.version;
+
+            size_t const new_vertex = dcel.vertices.size();
+            frm::dcel::add_vertex_and_connect_to_edge_origin(dcel, { -1.f, -1.f }, 0);
+
+            CHECK(context, frm::dcel::get_changes_since(dcel, version, changes));
+            CHECK(context, has_change(changes, Element::Vertex, Kind::Modified, 2));
+            CHECK(context, has_change(changes, Element::Vertex, Kind::Inserted, new_vertex));
+            CHECK(context, changes.front().element == Element::Vertex && changes.front().index == 2);
+
+            // only the changes after the version
+            changes.clear();
+            CHECK(context, frm::dcel::get_changes_since(dcel, moved_version, changes));
+            CHECK(context, !has_change(changes, Element::Vertex, Kind::Modified, 2));
+            CHECK(context, has_change(changes, Element::Vertex, Kind::Inserted, new_vertex));
+
+            changes.clear();
+            CHECK(context, frm::dcel::get_changes_since(dcel, dcel.version, changes));
+            CHECK(context, changes.empty());
+
+            // versions before the journal was cleared and untracked changes are unknown
+            frm::dcel::clear_journal(dcel);
+            CHECK(context, !frm::dcel::get_changes_since(dcel, version, changes));
+
+            size_t const cleared_version = dcel.version;
+            frm::dcel::mark_structure_changed(dcel);
+            CHECK(context, !frm::dcel::get_changes_since(dcel, cleared_version, changes));
+        } });
+
+    tests.push_back({ "journal/previous_records", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL dcel = frm::generate_grid(3, 3, 1);
+            frm::Point const coordinate = dcel.vertices[4].coordinate;
+
+            frm::dcel::enable_journal(dcel, true);
+            frm::dcel::move_vertex(dcel, 4, { 0.5f, 0.5f });
+            frm::dcel::move_vertex(dcel, 4, { 0.6f, 0.6f });
+
+            // one record for every change, appended elements have none
+            CHECK(context, dcel.journal.previous_vertices.size() == 2);
+            CHECK(context, dcel.journal.previous_vertices[0].coordinate.x == coordinate.x);
+            CHECK(context, dcel.journal.previous_vertices[1].coordinate.x == 0.5f);
+
+            size_t const previous_vertices_count = dcel.journal.previous_vertices.size();
+            frm::dcel::add_vertex(dcel, { 10.f, 10.f });
+            CHECK(context, dcel.journal.previous_vertices.size() == previous_vertices_count);
+            CHECK(context, dcel.journal.changes.back().is_appended);
+        } });
+}
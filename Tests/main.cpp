@@ -0,0 +1,93 @@
+#include "tests.h"
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+
+bool check(TestContext & context, bool condition, char const * expression, char const * file, int line) noexcept
+{
+    ++context.checks_count;
+
+    if (!condition)
+    {
+        ++context.failures_count;
+        std::cerr << file << '(' << line << "): failed " << expression << '\n';
+    }
+
+    return condition;
+}
+
+std::vector<Test> create_tests() noexcept
+{
+    std::vector<Test> tests{};
+
+    add_boolean_tests(tests);
+    add_generator_tests(tests);
+    add_history_tests(tests);
+    add_hull_tests(tests);
+    add_journal_tests(tests);
+    add_overlay_tests(tests);
+    add_point_in_face_tests(tests);
+    add_profiler_tests(tests);
+    add_range_index_tests(tests);
+    add_segment_intersection_tests(tests);
+    add_trapezoid_tests(tests);
+    add_triangulation_tests(tests);
+    add_validation_tests(tests);
+    add_voronoi_tests(tests);
+    add_version_tests(tests);
+
+    return tests;
+}
+
+// --filter <substring> runs only the tests with the substring in their names,
+// the exit code is the number of failed tests
+int main(int argc, char ** argv)
+{
+    std::string filter{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const argument = argv[i];
+
+        if (argument == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else
+        {
+            std::cerr << "unknown option " << argument << '\n';
+            return 1;
+        }
+    }
+
+    int failed_tests_count = 0;
+    size_t tests_count = 0;
+
+    for (Test const & test : create_tests())
+    {
+        if (test.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        TestContext context{};
+        test.run(context);
+        ++tests_count;
+
+        if (context.failures_count == 0)
+        {
+            std::cout << "ok     " << test.name << " (" << context.checks_count << " checks)\n";
+        }
+        else
+        {
+            std::cout << "FAILED " << test.name << " (" << context.failures_count << " of " << context.checks_count << " checks)\n";
+            ++failed_tests_count;
+        }
+    }
+
+    std::cout << tests_count - static_cast<size_t>(failed_tests_count) << " of " << tests_count << " tests passed\n";
+
+    return failed_tests_count;
+}
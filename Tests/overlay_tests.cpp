@@ -0,0 +1,82 @@
+#include "tests.h"
+#include "reference.h"
+
+#include "dcel.h"
+#include "dcel_validation.h"
+#include "generators.h"
+#include "overlay.h"
+#include "view_culling.h"
+
+#include <vector>
+#include <random>
+#include <utility>
+
+
+// Faces of the overlay found for random points must be labelled with the faces of the inputs found for them,
+// points too close to an edge of any of the three are skipped.
+static size_t get_label_mismatches_count(frm::dcel::DCEL const & first, frm::dcel::DCEL const & second, frm::dcel::Overlay const & overlay) noexcept
+{
+    frm::Box bounds = frm::empty_box;
+    for (frm::dcel::DCEL const * const dcel : { &first, &second })
+    {
+        for (frm::dcel::DCEL::Vertex const & vertex : dcel->vertices)
+        {
+            frm::extend_box(bounds, vertex.coordinate);
+        }
+    }
+
+    std::mt19937 engine{ 5 };
+    std::uniform_real_distribution<float> x_distribution{ bounds.min.x - 10.f, bounds.max.x + 10.f };
+    std::uniform_real_distribution<float> y_distribution{ bounds.min.y - 10.f, bounds.max.y + 10.f };
+
+    size_t mismatches_count = 0;
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        frm::Point const point{ x_distribution(engine), y_distribution(engine) };
+        size_t const face = get_face_index_by_ray(overlay.dcel, point);
+        size_t const first_face = get_face_index_by_ray(first, point);
+        size_t const second_face = get_face_index_by_ray(second, point);
+
+        if (face != no_face && first_face != no_face && second_face != no_face &&
+            overlay.source_faces[face] != std::pair<size_t, size_t>{ first_face, second_face })
+        {
+            ++mismatches_count;
+        }
+    }
+
+    return mismatches_count;
+}
+
+void add_overlay_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "overlay/source_faces", [](TestContext & context) noexcept
+        {
+            std::pair<frm::dcel::DCEL, frm::dcel::DCEL> const inputs[] = {
+                { frm::generate_grid(8, 8, 1), frm::generate_simple_polygon(60, 2) },
+                { frm::generate_cell_map(6, 8, 3), frm::generate_polygon_with_holes(200, 4, 4) },
+                { frm::generate_nested_islands(4, 3, 20, 5), frm::generate_grid(10, 10, 6) },
+                // every edge overlaps an edge of the other input
+                { frm::generate_grid(5, 5, 7), frm::generate_grid(5, 5, 7) } };
+
+            for (std::pair<frm::dcel::DCEL, frm::dcel::DCEL> const & input : inputs)
+            {
+                frm::dcel::Overlay const overlay = frm::dcel::overlay(input.first, input.second);
+
+                CHECK(context, frm::dcel::validate(overlay.dcel).issues_count == 0);
+                CHECK(context, overlay.source_faces.size() == overlay.dcel.faces.size());
+                CHECK(context, get_label_mismatches_count(input.first, input.second, overlay) == 0);
+            }
+
+            // the overlay with itself keeps the faces
+            frm::dcel::DCEL const grid = frm::generate_grid(5, 5, 7);
+            frm::dcel::Overlay const overlay = frm::dcel::overlay(grid, grid);
+            CHECK(context, overlay.dcel.faces.size() == grid.faces.size());
+
+            bool is_every_face_labelled_twice = true;
+            for (std::pair<size_t, size_t> const & source_faces : overlay.source_faces)
+            {
+                is_every_face_labelled_twice &= source_faces.first == source_faces.second;
+            }
+            CHECK(context, is_every_face_labelled_twice);
+        } });
+}
@@ -0,0 +1,88 @@
+#include "tests.h"
+#include "reference.h"
+
+#include "dcel.h"
+#include "generators.h"
+#include "point_in_face.h"
+#include "view_culling.h"
+
+#include <vector>
+#include <random>
+
+
+// random points in the bounds of the face and a bit around them
+static std::vector<frm::Point> get_points_around(frm::dcel::FacePolygon const & polygon, size_t size, uint32_t seed) noexcept
+{
+    std::mt19937 engine{ seed };
+    std::uniform_real_distribution<float> x_distribution{ polygon.bounds.min.x - 1.f, polygon.bounds.max.x + 1.f };
+    std::uniform_real_distribution<float> y_distribution{ polygon.bounds.min.y - 1.f, polygon.bounds.max.y + 1.f };
+
+    std::vector<frm::Point> points(size);
+    for (frm::Point & point : points)
+    {
+        point = { x_distribution(engine), y_distribution(engine) };
+    }
+
+    return points;
+}
+
+// points inside of the face by the crossing tests or the trapezoid map that the ray from them does not find in it,
+// faces have no holes, points too close to an edge are skipped
+static size_t get_inside_mismatches_count(frm::dcel::DCEL const & dcel, size_t face_index, std::vector<frm::Point> const & points, std::vector<uint8_t> const & is_inside) noexcept
+{
+    size_t mismatches_count = 0;
+
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        size_t const expected = get_face_index_by_ray(dcel, points[i]);
+
+        if (expected != no_face && (is_inside[i] != 0) != (expected == face_index))
+        {
+            ++mismatches_count;
+        }
+    }
+
+    return mismatches_count;
+}
+
+void add_point_in_face_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "point_in_face/small_batches", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL const dcels[] = {
+                frm::generate_simple_polygon(100, 1),
+                frm::generate_grid(6, 6, 2),
+                frm::generate_cell_map(5, 5, 3) };
+
+            for (frm::dcel::DCEL const & dcel : dcels)
+            {
+                for (size_t face_index = 1; face_index < dcel.faces.size(); ++face_index)
+                {
+                    frm::dcel::FacePolygon const polygon = frm::dcel::make_face_polygon(dcel, face_index);
+                    std::vector<frm::Point> const points = get_points_around(polygon, 20, static_cast<uint32_t>(face_index));
+
+                    std::vector<uint8_t> is_inside(points.size());
+                    for (size_t i = 0; i < points.size(); ++i)
+                    {
+                        is_inside[i] = frm::dcel::is_point_inside(polygon, points[i]);
+                    }
+
+                    CHECK(context, get_inside_mismatches_count(dcel, face_index, points, is_inside) == 0);
+                    CHECK(context, frm::dcel::get_points_inside(dcel, face_index, polygon, points) == is_inside);
+                }
+            }
+        } });
+
+    tests.push_back({ "point_in_face/trapezoid_map", [](TestContext & context) noexcept
+        {
+            // enough points for the trapezoid map of the face to be cheaper than the crossing tests
+            frm::dcel::DCEL const dcel = frm::generate_simple_polygon(2000, 4);
+            frm::dcel::FacePolygon const polygon = frm::dcel::make_face_polygon(dcel, 1);
+            std::vector<frm::Point> const points = get_points_around(polygon, 20000, 5);
+
+            CHECK(context, frm::dcel::is_trapezoid_map_cheaper(2000, points.size()));
+
+            std::vector<uint8_t> const is_inside = frm::dcel::get_points_inside(dcel, 1, points);
+            CHECK(context, get_inside_mismatches_count(dcel, 1, points, is_inside) == 0);
+        } });
+}
@@ -0,0 +1,87 @@
+#include "tests.h"
+
+#include "profiler.h"
+
+#include <thread>
+#include <string>
+#include <fstream>
+#include <cstdio>
+
+
+// lines of the saved profile without the header
+static std::vector<std::string> get_saved_samples() noexcept
+{
+    std::string const path = "profiler_tests.csv";
+    frm::save_profile_to_csv(path);
+
+    std::ifstream file_input{ path };
+    std::vector<std::string> lines{};
+
+    for (std::string line{}; std::getline(file_input, line);)
+    {
+        lines.push_back(line);
+    }
+
+    file_input.close();
+    std::remove(path.c_str());
+
+    if (!lines.empty())
+    {
+        lines.erase(lines.begin());
+    }
+
+    return lines;
+}
+
+void add_profiler_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "profiler/thread_samples", [](TestContext & context) noexcept
+        {
+            // nothing is recorded before the first frame
+            {
+                frm::ProfileScope const scope{ "before frames" };
+            }
+            frm::begin_profiler_frame();
+            frm::end_profiler_frame();
+            frm::begin_profiler_frame();
+            CHECK(context, get_saved_samples().empty());
+
+            // samples of other threads are collected by the end of the frame
+            {
+                frm::ProfileScope const scope{ "main thread" };
+
+                std::thread worker{ []() noexcept
+                    {
+                        frm::ProfileScope const outer_scope{ "worker thread" };
+                        frm::ProfileScope const inner_scope{ "worker thread inner" };
+                    } };
+                worker.join();
+            }
+            frm::end_profiler_frame();
+            frm::begin_profiler_frame();
+
+            std::vector<std::string> const samples = get_saved_samples();
+            CHECK(context, samples.size() == 3);
+
+            // thread,depth of the sample with the name, threads are numbered by their first sample
+            auto const get_thread_and_depth = [&samples](std::string const & name) noexcept
+            {
+                for (std::string const & sample : samples)
+                {
+                    // frame,thread,depth,name,begin_us,duration_us
+                    size_t const thread_begin = sample.find(',') + 1;
+                    size_t const name_begin = sample.find(',', sample.find(',', thread_begin) + 1) + 1;
+
+                    if (sample.compare(name_begin, name.size() + 1, name + ',') == 0)
+                    {
+                        return sample.substr(thread_begin, name_begin - 1 - thread_begin);
+                    }
+                }
+                return std::string{};
+            };
+
+            CHECK(context, get_thread_and_depth("worker thread") == "0,0");
+            CHECK(context, get_thread_and_depth("worker thread inner") == "0,1");
+            CHECK(context, get_thread_and_depth("main thread") == "1,0");
+        } });
+}
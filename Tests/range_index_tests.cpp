@@ -0,0 +1,167 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "generators.h"
+#include "range_index.h"
+#include "view_culling.h"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+
+static frm::Box get_random_box(std::mt19937 & engine, frm::Box const & bounds, float max_size) noexcept
+{
+    std::uniform_real_distribution<float> x_distribution{ bounds.min.x - max_size, bounds.max.x };
+    std::uniform_real_distribution<float> y_distribution{ bounds.min.y - max_size, bounds.max.y };
+    std::uniform_real_distribution<float> size_distribution{ 0.f, max_size };
+
+    frm::Point const min{ x_distribution(engine), y_distribution(engine) };
+
+    return { min, { min.x + size_distribution(engine), min.y + size_distribution(engine) } };
+}
+
+static frm::Box get_bounds(frm::dcel::DCEL const & dcel) noexcept
+{
+    frm::Box bounds = frm::empty_box;
+    for (frm::dcel::DCEL::Vertex const & vertex : dcel.vertices)
+    {
+        frm::extend_box(bounds, vertex.coordinate);
+    }
+
+    return bounds;
+}
+
+// sorted items of the query and of the O(n) scan of every vertex and edge, they have to be equal
+static size_t get_query_mismatches_count(frm::dcel::RangeIndex const & index, frm::dcel::DCEL const & dcel, uint32_t seed) noexcept
+{
+    std::mt19937 engine{ seed };
+    frm::Box const bounds = get_bounds(dcel);
+    size_t mismatches_count = 0;
+
+    for (size_t i = 0; i < 200; ++i)
+    {
+        frm::Box const box = get_random_box(engine, bounds, 0.2f * (bounds.max.x - bounds.min.x));
+
+        std::vector<size_t> vertices{};
+        frm::dcel::query_vertices(index, dcel, box, [&vertices](size_t vertex) { vertices.push_back(vertex); });
+        std::sort(vertices.begin(), vertices.end());
+
+        std::vector<size_t> expected_vertices{};
+        for (size_t j = 0; j < dcel.vertices.size(); ++j)
+        {
+            if (dcel.vertices[j].is_exist && frm::is_point_in_box(box, dcel.vertices[j].coordinate))
+            {
+                expected_vertices.push_back(j);
+            }
+        }
+
+        std::vector<size_t> edges{};
+        frm::dcel::query_edges(index, dcel, box, [&edges](size_t edge) { edges.push_back(edge); });
+        std::sort(edges.begin(), edges.end());
+
+        std::vector<size_t> expected_edges{};
+        for (size_t j = 0; j < dcel.edges.size(); ++j)
+        {
+            frm::dcel::DCEL::Edge const & edge = dcel.edges[j];
+
+            if (edge.is_exist && j < edge.twin_edge && frm::dcel::is_segment_intersecting_box(dcel.vertices[edge.origin_vertex].coordinate,
+                dcel.vertices[dcel.edges[edge.twin_edge].origin_vertex].coordinate, box))
+            {
+                expected_edges.push_back(j);
+            }
+        }
+
+        mismatches_count += vertices != expected_vertices;
+        mismatches_count += edges != expected_edges;
+    }
+
+    return mismatches_count;
+}
+
+void add_range_index_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "range_index/range_tree", [](TestContext & context) noexcept
+        {
+            // a single item is the root, then one and more levels of nodes
+            for (size_t const size : { size_t{ 0 }, size_t{ 1 }, size_t{ 2 }, size_t{ 16 }, size_t{ 17 }, size_t{ 300 }, size_t{ 5000 } })
+            {
+                std::mt19937 engine{ static_cast<uint32_t>(size) };
+                frm::Box const bounds{ { 0.f, 0.f }, { 100.f, 100.f } };
+
+                std::vector<frm::Box> boxes(size);
+                std::vector<size_t> indices(size);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    boxes[i] = get_random_box(engine, bounds, 5.f);
+                    indices[i] = 10 * i;
+                }
+
+                frm::dcel::RangeTree tree{};
+                frm::dcel::build_range_tree(tree, boxes, indices);
+
+                size_t mismatches_count = 0;
+                for (size_t i = 0; i < 500; ++i)
+                {
+                    frm::Box const box = get_random_box(engine, bounds, 20.f);
+
+                    std::vector<size_t> found{};
+                    frm::dcel::query_range_tree(tree, box, [&found](size_t item) { found.push_back(item); });
+                    std::sort(found.begin(), found.end());
+
+                    std::vector<size_t> expected{};
+                    for (size_t j = 0; j < size; ++j)
+                    {
+                        if (frm::is_boxes_intersected(boxes[j], box))
+                        {
+                            expected.push_back(indices[j]);
+                        }
+                    }
+
+                    mismatches_count += found != expected;
+                }
+
+                CHECK(context, mismatches_count == 0);
+            }
+        } });
+
+    tests.push_back({ "range_index/dcel_queries", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL dcel = frm::generate_cell_map(20, 20, 1);
+            frm::dcel::enable_journal(dcel);
+
+            frm::dcel::RangeIndex index{};
+            frm::dcel::build_range_index(index, dcel);
+            CHECK(context, get_query_mismatches_count(index, dcel, 1) == 0);
+
+            // a single move is known without the journal, the split from the journal
+            frm::dcel::move_vertex(dcel, 5, { -10.f, -10.f });
+            frm::dcel::update_range_index(index, dcel);
+            CHECK(context, index.changed_vertices.size() == 1);
+            CHECK(context, get_query_mismatches_count(index, dcel, 2) == 0);
+
+            frm::dcel::add_vertex_and_split_edge(dcel, { 1000.f, 1000.f }, 0);
+            frm::dcel::update_range_index(index, dcel);
+            CHECK(context, get_query_mismatches_count(index, dcel, 3) == 0);
+
+            // more changes than a sixteenth of the items rebuild the trees
+            std::mt19937 engine{ 4 };
+            frm::Box const bounds = get_bounds(dcel);
+            std::uniform_real_distribution<float> x_distribution{ bounds.min.x, bounds.max.x };
+            std::uniform_real_distribution<float> y_distribution{ bounds.min.y, bounds.max.y };
+            for (size_t i = 0; i < dcel.vertices.size() / 4; ++i)
+            {
+                frm::dcel::move_vertex(dcel, engine() % dcel.vertices.size(), { x_distribution(engine), y_distribution(engine) });
+            }
+            frm::dcel::update_range_index(index, dcel);
+            CHECK(context, index.changed_vertices.empty());
+            CHECK(context, get_query_mismatches_count(index, dcel, 5) == 0);
+            frm::dcel::clear_journal(dcel);
+
+            // an untracked change rebuilds them too
+            frm::dcel::mark_changed(dcel);
+            frm::dcel::update_range_index(index, dcel);
+            CHECK(context, index.version == dcel.version);
+            CHECK(context, get_query_mismatches_count(index, dcel, 6) == 0);
+        } });
+}
@@ -0,0 +1,46 @@
+#include "reference.h"
+
+#include <limits>
+#include <cmath>
+
+
+size_t get_face_index_by_ray(frm::dcel::DCEL const & dcel, frm::Point point) noexcept
+{
+    size_t face_index = frm::dcel::get_outside_face_index(dcel);
+    float hit_y = std::numeric_limits<float>::max();
+
+    for (frm::dcel::DCEL::Edge const & edge : dcel.edges)
+    {
+        if (!edge.is_exist)
+        {
+            continue;
+        }
+
+        frm::Point const begin = dcel.vertices[edge.origin_vertex].coordinate;
+        frm::Point const end = dcel.vertices[dcel.edges[edge.twin_edge].origin_vertex].coordinate;
+
+        // edges going to the left have the face under them on their left
+        if (begin.x == point.x || end.x == point.x)
+        {
+            return no_face;
+        }
+        if (!(end.x < point.x && point.x < begin.x))
+        {
+            continue;
+        }
+
+        float const y = begin.y + (end.y - begin.y) * (point.x - begin.x) / (end.x - begin.x);
+
+        if (std::abs(y - point.y) < 1e-3f)
+        {
+            return no_face;
+        }
+        if (y > point.y && y < hit_y)
+        {
+            hit_y = y;
+            face_index = edge.incident_face;
+        }
+    }
+
+    return face_index;
+}
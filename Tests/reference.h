@@ -0,0 +1,15 @@
+#pragma once
+
+
+#include "dcel.h"
+
+#include <limits>
+
+
+// Slow and simple versions of the framework queries the tests compare with
+
+static constexpr size_t no_face = std::numeric_limits<size_t>::max();
+
+// Face under the first edge the upward ray from the point hits, O(n),
+// no_face if the point is too close to an edge or a vertex has its x
+size_t get_face_index_by_ray(frm::dcel::DCEL const & dcel, frm::Point point) noexcept;
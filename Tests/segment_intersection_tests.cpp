@@ -0,0 +1,178 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "dcel_validation.h"
+#include "predicates.h"
+#include "segment_intersections.h"
+
+#include <vector>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+
+// Points on a small integer grid, so many segments are collinear, touch or overlap.
+// Some points are repeated under another index, segments meet at them like at any other point.
+static std::vector<frm::Point> get_grid_points(std::mt19937 & generator, size_t size) noexcept
+{
+    std::vector<frm::Point> points(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        points[i] = i % 8 == 7 ?
+            points[generator() % i] :
+            frm::Point{ static_cast<float>(generator() % 16), static_cast<float>(generator() % 16) };
+    }
+
+    return points;
+}
+
+static std::vector<std::pair<size_t, size_t>> get_random_segments(std::mt19937 & generator, size_t points_count, size_t size) noexcept
+{
+    std::vector<std::pair<size_t, size_t>> segments(size);
+
+    for (std::pair<size_t, size_t> & segment : segments)
+    {
+        segment = { generator() % points_count, generator() % points_count };
+    }
+
+    return segments;
+}
+
+static bool is_zero_length_segment(std::vector<frm::Point> const & points, std::pair<size_t, size_t> segment) noexcept
+{
+    return points[segment.first].x == points[segment.second].x && points[segment.first].y == points[segment.second].y;
+}
+
+static bool is_on_segment(frm::Point begin, frm::Point end, frm::Point point) noexcept
+{
+    return std::min(begin.x, end.x) <= point.x && point.x <= std::max(begin.x, end.x) &&
+        std::min(begin.y, end.y) <= point.y && point.y <= std::max(begin.y, end.y);
+}
+
+// O(1) by the exact predicates: any common point, but a common end vertex only counts
+// if the segments go the same way from it
+static bool is_intersected(std::vector<frm::Point> const & points, std::pair<size_t, size_t> first, std::pair<size_t, size_t> second) noexcept
+{
+    frm::Point const a = points[first.first];
+    frm::Point const b = points[first.second];
+    frm::Point const c = points[second.first];
+    frm::Point const d = points[second.second];
+
+    int const c_side = frm::get_orientation(a, b, c);
+    int const d_side = frm::get_orientation(a, b, d);
+    int const a_side = frm::get_orientation(c, d, a);
+    int const b_side = frm::get_orientation(c, d, b);
+
+    bool const is_collinear = c_side == 0 && d_side == 0;
+
+    for (size_t const vertex : { first.first, first.second })
+    {
+        if (vertex == second.first || vertex == second.second)
+        {
+            frm::Point const common = points[vertex];
+            frm::Point const far_end = vertex == first.first ? b : a;
+            frm::Point const other_far_end = vertex == second.first ? d : c;
+
+            return is_collinear &&
+                (far_end.x - common.x) * (other_far_end.x - common.x) + (far_end.y - common.y) * (other_far_end.y - common.y) > 0.f;
+        }
+    }
+
+    if (is_collinear)
+    {
+        return is_on_segment(a, b, c) || is_on_segment(a, b, d) || is_on_segment(c, d, a) || is_on_segment(c, d, b);
+    }
+
+    return c_side * d_side <= 0 && a_side * b_side <= 0;
+}
+
+static float get_distance_to_segment(frm::Point begin, frm::Point end, frm::Point point) noexcept
+{
+    float const dx = end.x - begin.x;
+    float const dy = end.y - begin.y;
+    float const t = std::clamp(((point.x - begin.x) * dx + (point.y - begin.y) * dy) / (dx * dx + dy * dy), 0.f, 1.f);
+
+    return std::hypot(begin.x + t * dx - point.x, begin.y + t * dy - point.y);
+}
+
+void add_segment_intersection_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "intersections/brute_force", [](TestContext & context) noexcept
+        {
+            for (uint32_t seed = 1; seed <= 20; ++seed)
+            {
+                std::mt19937 generator{ seed };
+                std::vector<frm::Point> const points = get_grid_points(generator, 100);
+                std::vector<std::pair<size_t, size_t>> const segments = get_random_segments(generator, points.size(), 150);
+
+                std::vector<std::pair<size_t, size_t>> expected{};
+
+                for (size_t i = 0; i < segments.size(); ++i)
+                {
+                    for (size_t j = i + 1; j < segments.size(); ++j)
+                    {
+                        bool const is_zero_length = is_zero_length_segment(points, segments[i]) || is_zero_length_segment(points, segments[j]);
+
+                        if (!is_zero_length && is_intersected(points, segments[i], segments[j]))
+                        {
+                            expected.push_back({ i, j });
+                        }
+                    }
+                }
+
+                std::vector<frm::SegmentIntersection> const intersections = frm::find_segment_intersections(points, segments);
+
+                std::vector<std::pair<size_t, size_t>> found{};
+                bool is_every_point_on_segments = true;
+
+                for (frm::SegmentIntersection const & intersection : intersections)
+                {
+                    found.push_back({ intersection.first_segment, intersection.second_segment });
+
+                    for (size_t const segment : { intersection.first_segment, intersection.second_segment })
+                    {
+                        is_every_point_on_segments &= get_distance_to_segment(points[segments[segment].first],
+                            points[segments[segment].second], intersection.point) < 1e-4f;
+                    }
+                }
+
+                // sorted and listed once, so equal to the pairs in the order of the loops
+                CHECK(context, found == expected);
+                CHECK(context, is_every_point_on_segments);
+            }
+        } });
+
+    tests.push_back({ "intersections/arrangement", [](TestContext & context) noexcept
+        {
+            for (uint32_t seed = 1; seed <= 20; ++seed)
+            {
+                std::mt19937 generator{ seed };
+                std::vector<frm::Point> const points = get_grid_points(generator, 60);
+                std::vector<std::pair<size_t, size_t>> const segments = get_random_segments(generator, points.size(), 60);
+
+                frm::dcel::Arrangement const arrangement = frm::dcel::build_arrangement(points, segments);
+
+                CHECK(context, frm::dcel::validate(arrangement.dcel).issues_count == 0);
+
+                // every piece goes along its segment
+                bool is_every_piece_on_segment = true;
+
+                for (frm::dcel::SegmentEdge const & segment_edge : arrangement.segment_edges)
+                {
+                    frm::dcel::DCEL::Edge const & edge = arrangement.dcel.edges[segment_edge.edge];
+                    frm::Point const begin = points[segments[segment_edge.segment].first];
+                    frm::Point const end = points[segments[segment_edge.segment].second];
+                    frm::Point const piece_begin = arrangement.dcel.vertices[edge.origin_vertex].coordinate;
+                    frm::Point const piece_end = arrangement.dcel.vertices[arrangement.dcel.edges[edge.twin_edge].origin_vertex].coordinate;
+
+                    is_every_piece_on_segment &= get_distance_to_segment(begin, end, piece_begin) < 1e-4f &&
+                        get_distance_to_segment(begin, end, piece_end) < 1e-4f &&
+                        (piece_end.x - piece_begin.x) * (end.x - begin.x) + (piece_end.y - piece_begin.y) * (end.y - begin.y) > 0.f;
+                }
+
+                CHECK(context, is_every_piece_on_segment);
+            }
+        } });
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include <functional>
+
+
+// Checks made by the running test, it fails if any of them failed
+struct TestContext
+{
+    size_t checks_count{ 0 };
+    size_t failures_count{ 0 };
+};
+
+// counts the check and prints the expression with its place if it failed, the test goes on
+bool check(TestContext & context, bool condition, char const * expression, char const * file, int line) noexcept;
+
+#define CHECK(context, condition) check(context, (condition), #condition, __FILE__, __LINE__)
+
+struct Test
+{
+    std::string name;
+    std::function<void(TestContext & context)> run;
+};
+
+// every file of tests adds its tests to the list
+void add_boolean_tests(std::vector<Test> & tests) noexcept;
+void add_generator_tests(std::vector<Test> & tests) noexcept;
+void add_history_tests(std::vector<Test> & tests) noexcept;
+void add_hull_tests(std::vector<Test> & tests) noexcept;
+void add_journal_tests(std::vector<Test> & tests) noexcept;
+void add_overlay_tests(std::vector<Test> & tests) noexcept;
+void add_point_in_face_tests(std::vector<Test> & tests) noexcept;
+void add_profiler_tests(std::vector<Test> & tests) noexcept;
+void add_range_index_tests(std::vector<Test> & tests) noexcept;
+void add_segment_intersection_tests(std::vector<Test> & tests) noexcept;
+void add_trapezoid_tests(std::vector<Test> & tests) noexcept;
+void add_triangulation_tests(std::vector<Test> & tests) noexcept;
+void add_validation_tests(std::vector<Test> & tests) noexcept;
+void add_voronoi_tests(std::vector<Test> & tests) noexcept;
+void add_version_tests(std::vector<Test> & tests) noexcept;
@@ -0,0 +1,67 @@
+#include "tests.h"
+#include "reference.h"
+
+#include "dcel.h"
+#include "generators.h"
+#include "trapezoidal_decomposition.h"
+#include "view_culling.h"
+
+#include <random>
+#include <atomic>
+
+
+void add_trapezoid_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "trapezoid/cancel", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL const dcel = frm::generate_grid(10, 10, 1);
+
+            std::atomic<bool> is_cancelled{ true };
+            frm::trapezoid_data_and_graph_root_t const cancelled = frm::generate_trapezoid_data_and_graph_root(dcel, &is_cancelled);
+            CHECK(context, cancelled.second.second == nullptr);
+            CHECK(context, cancelled.second.first.trapezoids.empty());
+
+            is_cancelled = false;
+            frm::trapezoid_data_and_graph_root_t const built = frm::generate_trapezoid_data_and_graph_root(dcel, &is_cancelled);
+            CHECK(context, built.second.second != nullptr);
+            CHECK(context, built.first == frm::dcel::get_outside_face_index(dcel));
+        } });
+
+    tests.push_back({ "trapezoid/get_face_index", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL const dcels[] = {
+                frm::generate_grid(12, 9, 1),
+                frm::generate_cell_map(10, 10, 2),
+                frm::generate_polygon_with_holes(200, 5, 3) };
+
+            for (frm::dcel::DCEL const & dcel : dcels)
+            {
+                frm::trapezoid_data_and_graph_root_t const trapezoid_data_and_graph_root = frm::generate_trapezoid_data_and_graph_root(dcel);
+
+                frm::Box bounds = frm::empty_box;
+                for (frm::dcel::DCEL::Vertex const & vertex : dcel.vertices)
+                {
+                    frm::extend_box(bounds, vertex.coordinate);
+                }
+
+                // queries a bit around the bounds reach the outside face too
+                std::mt19937 engine{ 7 };
+                std::uniform_real_distribution<float> x_distribution{ bounds.min.x - 10.f, bounds.max.x + 10.f };
+                std::uniform_real_distribution<float> y_distribution{ bounds.min.y - 10.f, bounds.max.y + 10.f };
+
+                size_t mismatches_count = 0;
+                for (size_t i = 0; i < 2000; ++i)
+                {
+                    frm::Point const point{ x_distribution(engine), y_distribution(engine) };
+                    size_t const expected = get_face_index_by_ray(dcel, point);
+
+                    if (expected != no_face && frm::get_face_index(trapezoid_data_and_graph_root, point) != expected)
+                    {
+                        ++mismatches_count;
+                    }
+                }
+
+                CHECK(context, mismatches_count == 0);
+            }
+        } });
+}
@@ -0,0 +1,126 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "generators.h"
+#include "triangulation.h"
+#include "dcel_validation.h"
+
+#include <atomic>
+#include <random>
+#include <cmath>
+#include <vector>
+
+
+static size_t get_face_edges_count(frm::dcel::DCEL const & dcel, size_t face_index) noexcept
+{
+    size_t edges_count = 0;
+    size_t edge = dcel.faces[face_index].edge;
+
+    do
+    {
+        ++edges_count;
+        edge = dcel.edges[edge].next_edge;
+    } while (edge != dcel.faces[face_index].edge);
+
+    return edges_count;
+}
+
+// Star shaped polygon with jagged radii, the vertices are snapped to a few rows
+// and some of them moved up by less than frm::epsilon, so many of them have equal or nearly equal y
+static frm::dcel::DCEL get_jagged_polygon(size_t size, uint32_t seed) noexcept
+{
+    std::mt19937 engine{ seed };
+
+    std::vector<frm::Point> points{};
+    std::vector<size_t> cell(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        double const angle = 2. * 3.14159265358979 * (static_cast<double>(i) + 0.0005 * static_cast<double>(engine() % 1000)) / static_cast<double>(size);
+        double const radius = static_cast<double>(100 + engine() % 800);
+
+        float const x = 1000.f + static_cast<float>(radius * std::cos(angle));
+        float const y = 1000.f + static_cast<float>(radius * std::sin(angle));
+
+        points.push_back({ x, std::round(y / 50.f) * 50.f + 0.0003f * static_cast<float>(engine() % 3) });
+        cell[i] = i;
+    }
+
+    return frm::make_dcel_from_cells(points, cell, { 0, size });
+}
+
+void add_triangulation_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "triangulation/valid", [](TestContext & context) noexcept
+        {
+            for (frm::SubdivisionKind const kind : { frm::SubdivisionKind::SimplePolygon, frm::SubdivisionKind::Grid, frm::SubdivisionKind::CellMap })
+            {
+                for (uint32_t seed = 1; seed <= 3; ++seed)
+                {
+                    frm::dcel::DCEL dcel = frm::generate_dcel(kind, 500, seed);
+
+                    // only the main face is split, a face of k edges into k - 2 triangles
+                    size_t const main_face_index = frm::dcel::get_possibly_main_face_index(dcel);
+                    size_t const main_face_edges_count = get_face_edges_count(dcel, main_face_index);
+                    size_t const faces_count = dcel.faces.size();
+
+                    frm::triangulation(dcel);
+
+                    CHECK(context, frm::dcel::validate(dcel).issues_count == 0);
+                    CHECK(context, dcel.faces.size() == faces_count + main_face_edges_count - 3);
+
+                    bool is_every_face_triangle = get_face_edges_count(dcel, main_face_index) == 3;
+                    for (size_t i = faces_count; i < dcel.faces.size(); ++i)
+                    {
+                        is_every_face_triangle &= get_face_edges_count(dcel, i) == 3;
+                    }
+                    CHECK(context, is_every_face_triangle);
+                }
+            }
+        } });
+
+    tests.push_back({ "triangulation/jagged", [](TestContext & context) noexcept
+        {
+            // collinear vertices on a row and edges flatter than frm::epsilon
+            size_t invalid_count = 0;
+            size_t wrong_faces_count = 0;
+
+            for (uint32_t seed = 1; seed <= 300; ++seed)
+            {
+                size_t const size = 8 + seed % 40;
+                frm::dcel::DCEL dcel = get_jagged_polygon(size, seed);
+
+                // snapping may make the polygon self intersecting
+                if (frm::dcel::validate(dcel).issues_count != 0)
+                {
+                    continue;
+                }
+
+                frm::triangulation(dcel);
+
+                invalid_count += frm::dcel::validate(dcel).issues_count != 0;
+                wrong_faces_count += dcel.faces.size() != size - 1;
+            }
+
+            CHECK(context, invalid_count == 0);
+            CHECK(context, wrong_faces_count == 0);
+        } });
+
+    tests.push_back({ "triangulation/cancel", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL dcel = frm::generate_dcel(frm::SubdivisionKind::SimplePolygon, 2000, 1);
+            size_t const version = dcel.version;
+
+            // a job cancelled before the sweep adds no diagonals
+            std::atomic<bool> is_cancelled{ true };
+            std::atomic<float> progress{ 0.f };
+            frm::triangulation(dcel, &is_cancelled, &progress);
+            CHECK(context, dcel.version == version);
+            CHECK(context, progress.load() == 0.f);
+
+            is_cancelled = false;
+            frm::triangulation(dcel, &is_cancelled, &progress);
+            CHECK(context, frm::dcel::validate(dcel).issues_count == 0);
+            CHECK(context, progress.load() == 1.f);
+        } });
+}
@@ -0,0 +1,40 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "dcel_validation.h"
+#include "boolean_operations.h"
+#include "generators.h"
+
+#include <vector>
+#include <limits>
+
+
+static constexpr size_t no_index = std::numeric_limits<size_t>::max();
+
+// single square cell with its lower left corner at (x, y)
+static frm::dcel::DCEL get_square(float x, float y) noexcept
+{
+    return frm::make_dcel_from_cells({ { x, y }, { x + 1.f, y }, { x + 1.f, y + 1.f }, { x, y + 1.f } }, { 0, 1, 2, 3 }, { 0, 4 });
+}
+
+void add_validation_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "validation/empty", [](TestContext & context) noexcept
+        {
+            // only the outside face without a boundary
+            frm::dcel::DCEL dcel{};
+            dcel.faces.push_back({ no_index });
+            CHECK(context, frm::dcel::validate(dcel).issues_count == 0);
+
+            // the same as the result of a boolean operation that selects nothing
+            frm::dcel::BooleanResult const result = frm::dcel::apply_boolean_operation(get_square(0.f, 0.f), get_square(10.f, 0.f),
+                frm::dcel::BooleanOperation::Intersection);
+            CHECK(context, frm::dcel::validate(result.dcel).issues_count == 0);
+
+            // any other face needs its boundary
+            dcel.faces.push_back({ no_index });
+            frm::dcel::ValidationResult const broken = frm::dcel::validate(dcel);
+            CHECK(context, broken.issues_count == 1 && broken.issues[0].kind == frm::dcel::ValidationIssue::Kind::BadReference &&
+                broken.issues[0].index == 1);
+        } });
+}
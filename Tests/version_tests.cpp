@@ -0,0 +1,96 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "vvve.h"
+#include "dependency.h"
+#include "generators.h"
+
+#include <limits>
+
+
+static constexpr size_t no_vertex = std::numeric_limits<size_t>::max();
+
+void add_version_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "version/dcel_operations", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL dcel = frm::generate_grid(2, 2, 1);
+            size_t const version = dcel.version;
+            size_t const structure_version = dcel.structure_version;
+            size_t const geometry_version = dcel.geometry_version;
+
+            frm::dcel::move_vertex(dcel, 0, { 0.5f, 0.5f });
+            CHECK(context, dcel.version == version + 1);
+            CHECK(context, dcel.structure_version == structure_version);
+            CHECK(context, dcel.geometry_version == geometry_version + 1);
+            CHECK(context, dcel.moved_vertex == 0);
+
+            // appended vertices change only the structure
+            frm::dcel::add_vertex(dcel, { 10.f, 10.f });
+            CHECK(context, dcel.version == version + 2);
+            CHECK(context, dcel.structure_version == structure_version + 1);
+            CHECK(context, dcel.geometry_version == geometry_version + 1);
+            CHECK(context, dcel.moved_vertex == no_vertex);
+
+            frm::dcel::mark_structure_changed(dcel);
+            CHECK(context, dcel.structure_version == structure_version + 2);
+            CHECK(context, dcel.geometry_version == geometry_version + 1);
+
+            frm::dcel::mark_changed(dcel);
+            CHECK(context, dcel.version == version + 4);
+            CHECK(context, dcel.structure_version == structure_version + 3);
+            CHECK(context, dcel.geometry_version == geometry_version + 2);
+        } });
+
+    tests.push_back({ "version/vvve_operations", [](TestContext & context) noexcept
+        {
+            frm::vvve::VVVE vvve{};
+
+            frm::vvve::add_vertex(vvve, { 0.f, 0.f });
+            frm::vvve::add_vertex(vvve, { 1.f, 0.f });
+            frm::vvve::add_edge_between_two_vertices(vvve, 0, 1);
+            CHECK(context, vvve.version == 3);
+            CHECK(context, vvve.structure_version == 3);
+            CHECK(context, vvve.geometry_version == 0);
+
+            frm::vvve::move_vertex(vvve, 1, { 2.f, 0.f });
+            CHECK(context, vvve.version == 4);
+            CHECK(context, vvve.structure_version == 3);
+            CHECK(context, vvve.geometry_version == 1);
+            CHECK(context, vvve.moved_vertex == 1);
+
+            frm::vvve::mark_changed(vvve);
+            CHECK(context, vvve.moved_vertex == no_vertex);
+            CHECK(context, vvve.geometry_version == 2);
+        } });
+
+    tests.push_back({ "version/dependency", [](TestContext & context) noexcept
+        {
+            frm::dcel::DCEL dcel = frm::generate_grid(2, 2, 1);
+
+            // a new dependency is outdated until the first update
+            frm::Dependency everything{};
+            frm::Dependency geometry{ frm::DependsOn::Geometry };
+            frm::Dependency structure{ frm::DependsOn::Structure };
+            CHECK(context, frm::update_dependency(everything, dcel));
+            CHECK(context, frm::update_dependency(geometry, dcel));
+            CHECK(context, frm::update_dependency(structure, dcel));
+            CHECK(context, !frm::update_dependency(everything, dcel));
+
+            frm::dcel::move_vertex(dcel, 0, { 0.5f, 0.5f });
+            CHECK(context, frm::is_outdated(everything, dcel));
+            CHECK(context, frm::is_outdated(geometry, dcel));
+            CHECK(context, !frm::is_outdated(structure, dcel));
+
+            frm::set_up_to_date(everything, dcel);
+            frm::set_up_to_date(geometry, dcel);
+
+            frm::dcel::add_vertex(dcel, { 10.f, 10.f });
+            CHECK(context, frm::is_outdated(everything, dcel));
+            CHECK(context, !frm::is_outdated(geometry, dcel));
+            CHECK(context, frm::is_outdated(structure, dcel));
+
+            CHECK(context, frm::update_dependency(structure, dcel));
+            CHECK(context, !frm::is_outdated(structure, dcel));
+        } });
+}
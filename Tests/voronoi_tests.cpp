@@ -0,0 +1,86 @@
+#include "tests.h"
+
+#include "dcel.h"
+#include "dcel_validation.h"
+#include "generators.h"
+#include "voronoi.h"
+#include "trapezoidal_decomposition.h"
+
+#include <algorithm>
+#include <vector>
+
+
+static frm::PointDistribution const voronoi_distributions[] = {
+    frm::PointDistribution::Uniform,
+    frm::PointDistribution::Clustered,
+    frm::PointDistribution::Circular,
+    frm::PointDistribution::Collinear };
+
+void add_voronoi_tests(std::vector<Test> & tests) noexcept
+{
+    tests.push_back({ "voronoi/valid", [](TestContext & context) noexcept
+        {
+            // circular sites are nearly cocircular, their centers are apart by about the rounding
+            for (frm::PointDistribution const distribution : voronoi_distributions)
+            {
+                for (size_t const size : { size_t{ 3 }, size_t{ 100 }, size_t{ 300 }, size_t{ 1000 }, size_t{ 10000 } })
+                {
+                    for (uint32_t seed = 1; seed <= 3; ++seed)
+                    {
+                        frm::VoronoiDiagram const diagram = frm::build_voronoi_diagram(frm::generate_vvve(distribution, size, seed));
+
+                        CHECK(context, frm::dcel::validate(diagram.dcel).issues_count == 0);
+                        CHECK(context, diagram.face_sites.size() == diagram.dcel.faces.size());
+                    }
+                }
+            }
+        } });
+
+    tests.push_back({ "voronoi/circular_cells", [](TestContext & context) noexcept
+        {
+            // the trapezoid map needs a planar subdivision, every site is inside of its own cell
+            for (size_t const size : { size_t{ 300 }, size_t{ 1000 } })
+            {
+                frm::vvve::VVVE const sites = frm::generate_vvve(frm::PointDistribution::Circular, size, 1);
+                frm::VoronoiDiagram const diagram = frm::build_voronoi_diagram(sites);
+                frm::trapezoid_data_and_graph_root_t const trapezoid_data_and_graph_root = frm::generate_trapezoid_data_and_graph_root(diagram.dcel);
+
+                size_t mismatches_count = 0;
+                for (size_t i = 1; i < diagram.face_sites.size(); ++i)
+                {
+                    if (frm::get_face_index(trapezoid_data_and_graph_root, sites.vertices[diagram.face_sites[i]].coordinate) != i)
+                    {
+                        ++mismatches_count;
+                    }
+                }
+
+                CHECK(context, mismatches_count == 0);
+            }
+        } });
+
+    tests.push_back({ "voronoi/dense_circle", [](TestContext & context) noexcept
+        {
+            // a hundred thousand sites on a circle are apart by about the rounding of their cell vertices,
+            // every distinct site still gets its own face
+            frm::vvve::VVVE const sites = frm::generate_vvve(frm::PointDistribution::Circular, 100000, 1);
+            frm::VoronoiDiagram const diagram = frm::build_voronoi_diagram(sites);
+
+            std::vector<frm::Point> points{};
+            points.reserve(sites.vertices.size());
+            for (frm::vvve::VVVE::Vertex const & vertex : sites.vertices)
+            {
+                points.push_back(vertex.coordinate);
+            }
+            std::sort(points.begin(), points.end(), [](frm::Point first, frm::Point second) noexcept
+                {
+                    return first.x < second.x || (first.x == second.x && first.y < second.y);
+                });
+            size_t const distinct_count = static_cast<size_t>(std::unique(points.begin(), points.end(), [](frm::Point first, frm::Point second) noexcept
+                {
+                    return first.x == second.x && first.y == second.y;
+                }) - points.begin());
+
+            CHECK(context, frm::dcel::validate(diagram.dcel).issues_count == 0);
+            CHECK(context, diagram.dcel.faces.size() == distinct_count + 1);
+        } });
+}